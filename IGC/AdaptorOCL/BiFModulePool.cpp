@@ -0,0 +1,115 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "AdaptorOCL/BiFModulePool.h"
+#include "AdaptorOCL/OCL/BuiltinResource.h"
+#include "AdaptorOCL/OCL/LoadBuffer.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Support/Error.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "Probe/Assertion.h"
+
+#include <cstdio>
+
+namespace TC
+{
+
+BiFModulePool& BiFModulePool::get()
+{
+    static BiFModulePool pool;
+    return pool;
+}
+
+const llvm::BitcodeModule* BiFModulePool::getBitcode(Entry& E, int ResourceId)
+{
+    std::call_once(E.Loaded, [&]()
+    {
+        char ResName[8] = { '-' };
+        snprintf(ResName, sizeof(ResName), "#%d", ResourceId);
+        E.Buffer.reset(llvm::LoadBufferFromResource(ResName, "BC"));
+        if (!E.Buffer)
+        {
+            return;
+        }
+
+        auto ModulesOrErr = llvm::getBitcodeModuleList(E.Buffer->getMemBufferRef());
+        if (!ModulesOrErr)
+        {
+            llvm::consumeError(ModulesOrErr.takeError());
+            return;
+        }
+        if (ModulesOrErr->size() == 1)
+        {
+            E.Bitcode.emplace(ModulesOrErr->front());
+        }
+    });
+    return E.Bitcode ? &*E.Bitcode : nullptr;
+}
+
+bool BiFModulePool::getModules(
+    llvm::LLVMContext& Context,
+    unsigned PtrSizeInBits,
+    Modules& Result,
+    std::string& ErrorMsg)
+{
+    const llvm::BitcodeModule* Generic = getBitcode(m_Generic, OCL_BC);
+    if (!Generic)
+    {
+        ErrorMsg = "Error loading the Generic builtin resource";
+        return false;
+    }
+
+    const llvm::BitcodeModule* SizeT = nullptr;
+    switch (PtrSizeInBits)
+    {
+    case 32:
+        SizeT = getBitcode(m_SizeT32, OCL_BC_32);
+        break;
+    case 64:
+        SizeT = getBitcode(m_SizeT64, OCL_BC_64);
+        break;
+    default:
+        IGC_ASSERT_MESSAGE(0, "Unknown bitness of compiled module");
+    }
+    if (!SizeT)
+    {
+        ErrorMsg = "Error loading the size_t builtin resource";
+        return false;
+    }
+
+    // BitcodeModule only holds references into the pooled buffer, so working
+    // on a local copy keeps concurrent compilations independent.
+    llvm::BitcodeModule GenericBC = *Generic;
+    auto GenericOrErr = GenericBC.getLazyModule(Context, false, false);
+    if (!GenericOrErr)
+    {
+        llvm::consumeError(GenericOrErr.takeError());
+        ErrorMsg = "Error lazily loading bitcode for generic builtins,"
+                   "is bitcode the right version and correctly formed?";
+        return false;
+    }
+
+    llvm::BitcodeModule SizeTBC = *SizeT;
+    auto SizeTOrErr = SizeTBC.getLazyModule(Context, false, false);
+    if (!SizeTOrErr)
+    {
+        llvm::consumeError(SizeTOrErr.takeError());
+        ErrorMsg = "Error lazily loading bitcode for size_t builtins";
+        return false;
+    }
+
+    Result.Generic = std::move(*GenericOrErr);
+    Result.SizeT = std::move(*SizeTOrErr);
+    Result.Generic->setDataLayout(Result.SizeT->getDataLayout());
+    Result.Generic->setTargetTriple(Result.SizeT->getTargetTriple());
+    return true;
+}
+
+} // namespace TC
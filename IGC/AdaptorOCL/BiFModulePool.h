@@ -0,0 +1,87 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace TC
+{
+
+// Process-wide pool of the OpenCL builtin (BiF) bitcode resources.
+//
+// Every SPMD compilation links the generic BiF module and the pointer-size
+// dependent size_t module into the kernel module. The resources are loaded
+// and the bitcode containers are indexed once per process (once per pointer
+// size for the size_t module); a compilation then creates the lazy
+// modules in its own LLVMContext, whose function bodies are materialized on
+// demand when UnifyIR links the builtins that are actually used.
+//
+// What the pool saves per compilation is the copy of the resources (on Linux
+// they are copied out of the library image) and the scan of the bitcode
+// container. getModules still calls getLazyModule on every compilation, which
+// reads the module-level records of both modules (types, attributes, the
+// declaration of every builtin and the metadata) into the given context.
+// That part is not cached: a module belongs to one LLVMContext, each build
+// creates its own (LLVMContextWrapper), and LLVM cannot clone a module into
+// another context.
+//
+// The builtin resources do not depend on the target platform, so the pool is
+// keyed on pointer size only.
+class BiFModulePool
+{
+public:
+    static BiFModulePool& get();
+
+    struct Modules
+    {
+        std::unique_ptr<llvm::Module> Generic;
+        std::unique_ptr<llvm::Module> SizeT;
+    };
+
+    // Creates lazily loaded generic and size_t builtin modules in the given
+    // context. The generic module takes the data layout and triple of the
+    // size_t one. On failure returns false and fills ErrorMsg.
+    bool getModules(
+        llvm::LLVMContext& Context,
+        unsigned PtrSizeInBits,
+        Modules& Result,
+        std::string& ErrorMsg);
+
+private:
+    BiFModulePool() = default;
+    BiFModulePool(const BiFModulePool&) = delete;
+    BiFModulePool& operator=(const BiFModulePool&) = delete;
+
+    struct Entry
+    {
+        std::once_flag Loaded;
+        // Owns the resource bytes for the lifetime of the process. The lazy
+        // modules handed out keep referring to them.
+        std::unique_ptr<llvm::MemoryBuffer> Buffer;
+        std::optional<llvm::BitcodeModule> Bitcode;
+    };
+
+    const llvm::BitcodeModule* getBitcode(Entry& E, int ResourceId);
+
+    Entry m_Generic;
+    Entry m_SizeT32;
+    Entry m_SizeT64;
+};
+
+} // namespace TC
@@ -0,0 +1,571 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "AdaptorOCL/KernelBinaryCache.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "common/igc_regkeys.hpp"
+#include "common/secure_mem.h"
+#include "iStdLib/utility.h"
+#include "Probe/Assertion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+// IGC_REVISION is provided by the generated ocl_igc_interface/impl/version.h
+// when the build knows its git revision.
+#include "version.h"
+
+namespace TC
+{
+
+namespace
+{
+
+constexpr uint32_t CacheEntryMagic = 0x4B434749; // "IGCK"
+constexpr uint32_t CacheEntryVersion = 3;
+constexpr const char* CacheEntryExtension = ".igcbin";
+constexpr const char* CacheTempExtension = ".tmp";
+
+// Temporary files older than this were left behind by a process that died
+// in the middle of a store and can be removed.
+constexpr std::chrono::hours StaleTempFileAge{ 1 };
+
+#if defined(IGC_REVISION)
+constexpr const char* IGCBuildId = IGC_REVISION;
+#else
+// Without a revision nothing reliably tells two builds of the compiler apart,
+// so the cache is disabled rather than serving binaries of an older build.
+constexpr const char* IGCBuildId = nullptr;
+#endif
+
+// Size and modification time of the library file this code was loaded from.
+// A developer rebuilding with uncommitted changes keeps the git revision, so
+// the revision alone would serve binaries of the previous build. Empty if the
+// file cannot be located; the key then relies on the revision only.
+std::string getLibraryStamp()
+{
+    std::string path;
+#if defined(_WIN32)
+    HMODULE hMod = NULL;
+    char fileName[MAX_PATH];
+    if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+            GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+            reinterpret_cast<LPCSTR>(&getLibraryStamp), &hMod) &&
+        GetModuleFileNameA(hMod, fileName, MAX_PATH) != 0)
+    {
+        path = fileName;
+    }
+#else
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&getLibraryStamp), &info) && info.dli_fname)
+    {
+        path = info.dli_fname;
+    }
+#endif
+    llvm::sys::fs::file_status status;
+    if (path.empty() || llvm::sys::fs::status(path, status))
+    {
+        return std::string();
+    }
+    return std::to_string(status.getSize()) + ":" +
+        std::to_string(status.getLastModificationTime().time_since_epoch().count());
+}
+
+constexpr unsigned NumKeyWords = 8;
+
+struct CacheEntryHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    QWORD key[NumKeyWords];
+    uint64_t keyDataSize;
+    uint64_t outputSize;
+    uint64_t debugDataSize;
+};
+
+void toKeyWords(const ShaderHash& key, QWORD (&words)[NumKeyWords])
+{
+    words[0] = key.asmHash;
+    words[1] = key.nosHash;
+    words[2] = key.psoHash;
+    words[3] = key.perShaderPsoHash;
+    words[4] = key.rtlHash;
+    words[5] = key.dcHash;
+    words[6] = key.ltoHash;
+    words[7] = key.stateHash;
+}
+
+// iSTD::Hash works on whole DWORDs; fold the tail bytes and the size in so
+// that inputs which are not DWORD-aligned (e.g. LLVM text) are fully covered.
+QWORD hashBytes(const void* data, size_t size, QWORD seed = 0)
+{
+    const DWORD numDWords = static_cast<DWORD>(size / sizeof(DWORD));
+    QWORD bodyHash = data ? iSTD::Hash(static_cast<const DWORD*>(data), numDWords) : 0;
+
+    DWORD tail = 0;
+    if (data && size % sizeof(DWORD))
+    {
+        memcpy_s(&tail, sizeof(tail),
+            static_cast<const char*>(data) + numDWords * sizeof(DWORD),
+            size % sizeof(DWORD));
+    }
+
+    const DWORD trailer[] = {
+        tail,
+        static_cast<DWORD>(size),
+        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+        static_cast<DWORD>(bodyHash),
+        static_cast<DWORD>(bodyHash >> 32),
+        static_cast<DWORD>(seed),
+        static_cast<DWORD>(seed >> 32),
+    };
+    return iSTD::Hash(trailer, static_cast<DWORD>(std::size(trailer)));
+}
+
+// vISA options that write dumps, traces or statistics.
+bool hasVISADumpOption(llvm::StringRef visaOptions)
+{
+    llvm::SmallVector<llvm::StringRef, 16> options;
+    visaOptions.split(options, ' ', -1, false);
+    for (llvm::StringRef option : options)
+    {
+        if (option.startswith("-dump") || option.startswith("-output") ||
+            option == "-asmToConsole" || option == "-isaasmToConsole" ||
+            option == "-ratrace" || option == "-printregusage" ||
+            option == "-compileTrace")
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Dumps are written as a side effect of compiling, so a build that asks for
+// any of them has to run the compiler. Every key of the "Shader dumping"
+// group and every key named after a dump counts as asking for one.
+bool isDumpRequested(const STB_TranslateInputArgs* pInputArgs)
+{
+    llvm::StringRef options(pInputArgs->pOptions ? pInputArgs->pOptions : "",
+        pInputArgs->pOptions ? pInputArgs->OptionsSize : 0);
+    if (options.contains("-dump-opt-llvm") ||
+        hasVISADumpOption(IGC_GET_REGKEYSTRING(VISAOptions)))
+    {
+        return true;
+    }
+
+    bool inDumpGroup = false;
+    bool requested = false;
+#define DECLARE_IGC_GROUP(groupName) \
+    inDumpGroup = strcmp(groupName, "Shader dumping") == 0;
+#define DECLARE_IGC_REGKEY(dataType, regkeyName, defaultValue, description, releaseMode) \
+    if ((inDumpGroup || strstr(#regkeyName, "Dump") != nullptr) &&                       \
+        IGC_GET_FLAG_VALUE(regkeyName) != IGC_GET_FLAG_DEFAULT_VALUE(regkeyName))        \
+    {                                                                                    \
+        requested = true;                                                                \
+    }
+#include "common/igc_regkeys.h"
+#undef DECLARE_IGC_REGKEY
+#undef DECLARE_IGC_GROUP
+    return requested;
+}
+
+std::string toHex(QWORD value)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+    return buf;
+}
+
+} // anonymous namespace
+
+KernelBinaryCache& KernelBinaryCache::get()
+{
+    static KernelBinaryCache cache;
+    return cache;
+}
+
+bool KernelBinaryCache::isCacheable(const STB_TranslateInputArgs* pInputArgs) const
+{
+    if (IGC_IS_FLAG_DISABLED(EnableKernelBinaryCache))
+    {
+        return false;
+    }
+    if (IGCBuildId == nullptr)
+    {
+        static const bool reported = [] {
+            if (IGC_IS_FLAG_ENABLED(KernelBinaryCacheVerbose))
+            {
+                fprintf(stderr, "IGC kernel binary cache disabled: this IGC build has no git revision\n");
+            }
+            return true;
+        }();
+        (void)reported;
+        return false;
+    }
+
+    // Instrumented or debugged builds are not reproducible from the key alone,
+    // and users asking for dumps or overrides expect the compiler to run.
+    if (pInputArgs->GTPinInput != nullptr ||
+        pInputArgs->TracingOptionsCount != 0 ||
+        IGC_IS_FLAG_ENABLED(ShaderOverride) ||
+        isDumpRequested(pInputArgs))
+    {
+        return false;
+    }
+    return true;
+}
+
+KernelBinaryCache::Key KernelBinaryCache::computeKey(
+    const STB_TranslateInputArgs* pInputArgs,
+    TB_DATA_FORMAT inputDataFormat,
+    const IGC::CPlatform& platform,
+    float profilingTimerResolution) const
+{
+    Key key;
+
+    // Hashes a field into hash and appends it to the key data, prefixed with
+    // its size so that different splits of the same bytes do not compare
+    // equal.
+    auto addField = [&key](QWORD& hash, const void* data, size_t size)
+    {
+        hash = hashBytes(data, size, hash);
+        const uint64_t fieldSize = data ? size : 0;
+        key.data.append(reinterpret_cast<const char*>(&fieldSize), sizeof(fieldSize));
+        if (fieldSize > 0)
+        {
+            key.data.append(static_cast<const char*>(data), fieldSize);
+        }
+    };
+    auto addString = [&addField](QWORD& hash, const char* str)
+    {
+        addField(hash, str, str ? strlen(str) : 0);
+    };
+
+    addField(key.hash.asmHash, pInputArgs->pInput, pInputArgs->InputSize);
+
+    addField(key.hash.nosHash, pInputArgs->pOptions, pInputArgs->OptionsSize);
+    addField(key.hash.nosHash, pInputArgs->pInternalOptions, pInputArgs->InternalOptionsSize);
+
+    addField(key.hash.psoHash, pInputArgs->pSpecConstantsIds,
+        pInputArgs->SpecConstantsSize * sizeof(*pInputArgs->pSpecConstantsIds));
+    addField(key.hash.psoHash, pInputArgs->pSpecConstantsValues,
+        pInputArgs->SpecConstantsSize * sizeof(*pInputArgs->pSpecConstantsValues));
+
+    const PLATFORM& platformInfo = platform.getPlatformInfo();
+    const GT_SYSTEM_INFO sysInfo = platform.GetGTSystemInfo();
+    addField(key.hash.stateHash, &platformInfo, sizeof(platformInfo));
+    addField(key.hash.stateHash, &platform.getWATable(), sizeof(WA_TABLE));
+    addField(key.hash.stateHash, &platform.getSkuTable(), sizeof(SKU_FEATURE_TABLE));
+    addField(key.hash.stateHash, &sysInfo, sizeof(sysInfo));
+    // The timer resolution is baked into the profiling timestamp code.
+    addField(key.hash.stateHash, &profilingTimerResolution, sizeof(profilingTimerResolution));
+
+    static const std::string libraryStamp = getLibraryStamp();
+    addString(key.hash.ltoHash, IGCBuildId);
+    addString(key.hash.ltoHash, libraryStamp.c_str());
+    addField(key.hash.ltoHash, &inputDataFormat, sizeof(inputDataFormat));
+    for (uint32_t i = 0; i < pInputArgs->NumVISAAsmsToLink; ++i)
+    {
+        addString(key.hash.ltoHash, pInputArgs->pVISAAsmToLinkArray[i]);
+    }
+    for (uint32_t i = 0; i < pInputArgs->NumDirectCallFunctions; ++i)
+    {
+        addString(key.hash.ltoHash, pInputArgs->pDirectCallFunctions[i]);
+    }
+
+#if defined(IGC_DEBUG_VARIABLES)
+    // Keys that only steer the cache itself must not change the key, or e.g.
+    // turning on KernelBinaryCacheVerbose would always miss. A string key
+    // shares its storage with m_Value, so it is hashed as the whole string.
+    auto addRegkey = [&](const char* name, bool isString, const SRegKeyVariableMetaData& regkey)
+    {
+        if (!regkey.m_isSetToNonDefaultValue || strstr(name, "KernelBinaryCache") != nullptr)
+        {
+            return;
+        }
+        addString(key.hash.dcHash, name);
+        if (isString)
+        {
+            addString(key.hash.dcHash, regkey.m_string);
+        }
+        else
+        {
+            addField(key.hash.dcHash, &regkey.m_Value, sizeof(regkey.m_Value));
+        }
+    };
+#define DECLARE_IGC_REGKEY(dataType, regkeyName, defaultValue, description, releaseMode) \
+    addRegkey(#regkeyName, strcmp(#dataType, "debugString") == 0, g_RegKeyList.regkeyName);
+#include "common/igc_regkeys.h"
+#undef DECLARE_IGC_REGKEY
+#endif
+
+    return key;
+}
+
+std::string KernelBinaryCache::getCacheDir() const
+{
+    const char* customDir = IGC_GET_REGKEYSTRING(KernelBinaryCacheDir);
+    if (customDir && customDir[0] != '\0')
+    {
+        return customDir;
+    }
+
+    llvm::SmallString<256> dir;
+    if (!llvm::sys::path::cache_directory(dir))
+    {
+        return "";
+    }
+    llvm::sys::path::append(dir, "igc_kernel_cache");
+    return std::string(dir.str());
+}
+
+std::string KernelBinaryCache::getEntryPath(const std::string& dir, const ShaderHash& hash) const
+{
+    QWORD words[NumKeyWords];
+    toKeyWords(hash, words);
+    QWORD combined = hashBytes(words, sizeof(words));
+
+    llvm::SmallString<256> path(dir);
+    llvm::sys::path::append(path, toHex(hash.asmHash) + "-" + toHex(combined) + CacheEntryExtension);
+    return std::string(path.str());
+}
+
+bool KernelBinaryCache::lookup(const Key& key, STB_TranslateOutputArgs& outputArgs)
+{
+    const std::string dir = getCacheDir();
+    if (dir.empty())
+    {
+        return false;
+    }
+    const std::string path = getEntryPath(dir, key.hash);
+
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+        /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+    {
+        ++m_misses;
+        printStats("miss");
+        return false;
+    }
+    const llvm::MemoryBuffer& buffer = **bufferOrErr;
+
+    // Anything that does not look exactly like an entry for this key is
+    // treated as a miss; the following store() will overwrite it.
+    CacheEntryHeader header;
+    QWORD words[NumKeyWords];
+    toKeyWords(key.hash, words);
+    bool valid = buffer.getBufferSize() >= sizeof(header);
+    if (valid)
+    {
+        memcpy_s(&header, sizeof(header), buffer.getBufferStart(), sizeof(header));
+        valid = header.magic == CacheEntryMagic &&
+            header.version == CacheEntryVersion &&
+            memcmp(header.key, words, sizeof(words)) == 0 &&
+            header.keyDataSize == key.data.size() &&
+            header.outputSize != 0 &&
+            sizeof(header) + header.keyDataSize + header.outputSize + header.debugDataSize ==
+                buffer.getBufferSize() &&
+            memcmp(buffer.getBufferStart() + sizeof(header), key.data.data(), key.data.size()) == 0;
+    }
+    if (!valid)
+    {
+        ++m_misses;
+        printStats("miss (invalid entry)");
+        return false;
+    }
+
+    const char* payload = buffer.getBufferStart() + sizeof(header) + header.keyDataSize;
+
+    outputArgs.OutputSize = static_cast<uint32_t>(header.outputSize);
+    outputArgs.pOutput = new char[header.outputSize];
+    memcpy_s(outputArgs.pOutput, header.outputSize, payload, header.outputSize);
+
+    if (header.debugDataSize > 0)
+    {
+        outputArgs.DebugDataSize = static_cast<uint32_t>(header.debugDataSize);
+        outputArgs.pDebugData = new char[header.debugDataSize];
+        memcpy_s(outputArgs.pDebugData, header.debugDataSize,
+            payload + header.outputSize, header.debugDataSize);
+    }
+
+    // Refresh the entry so that LRU eviction keeps it around.
+    int fd = -1;
+    if (!llvm::sys::fs::openFileForReadWrite(path, fd,
+            llvm::sys::fs::CD_OpenExisting, llvm::sys::fs::OF_None))
+    {
+        llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+        llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    }
+
+    ++m_hits;
+    printStats("hit");
+    return true;
+}
+
+void KernelBinaryCache::store(const Key& key, const STB_TranslateOutputArgs& outputArgs)
+{
+    if (outputArgs.pOutput == nullptr || outputArgs.OutputSize == 0 ||
+        outputArgs.pErrorString != nullptr)
+    {
+        return;
+    }
+
+    const std::string dir = getCacheDir();
+    if (dir.empty() || llvm::sys::fs::create_directories(dir))
+    {
+        return;
+    }
+
+    CacheEntryHeader header = {};
+    header.magic = CacheEntryMagic;
+    header.version = CacheEntryVersion;
+    toKeyWords(key.hash, header.key);
+    header.keyDataSize = key.data.size();
+    header.outputSize = outputArgs.OutputSize;
+    header.debugDataSize = outputArgs.pDebugData ? outputArgs.DebugDataSize : 0;
+
+    // Write to a unique temporary file first and rename it into place, so
+    // that concurrent readers only ever see complete entries.
+    llvm::SmallString<256> tempPath;
+    int fd = -1;
+    if (llvm::sys::fs::createUniqueFile(
+            dir + "/entry-%%%%%%%%%%%%" + CacheTempExtension, fd, tempPath))
+    {
+        return;
+    }
+
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os.write(key.data.data(), key.data.size());
+        os.write(outputArgs.pOutput, header.outputSize);
+        if (header.debugDataSize > 0)
+        {
+            os.write(outputArgs.pDebugData, header.debugDataSize);
+        }
+        os.close();
+        if (os.has_error())
+        {
+            os.clear_error();
+            llvm::sys::fs::remove(tempPath);
+            return;
+        }
+    }
+
+    if (llvm::sys::fs::rename(tempPath, getEntryPath(dir, key.hash)))
+    {
+        llvm::sys::fs::remove(tempPath);
+        return;
+    }
+
+    ++m_stores;
+    evict(dir);
+}
+
+void KernelBinaryCache::evict(const std::string& dir)
+{
+    struct Entry
+    {
+        std::string path;
+        uint64_t size;
+        llvm::sys::TimePoint<> lastUsed;
+    };
+
+    const uint64_t maxSize = static_cast<uint64_t>(IGC_GET_FLAG_VALUE(KernelBinaryCacheMaxSizeMB)) * 1024 * 1024;
+    const auto now = std::chrono::system_clock::now();
+
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+
+    std::error_code ec;
+    for (llvm::sys::fs::directory_iterator it(dir, ec), end; it != end && !ec; it.increment(ec))
+    {
+        llvm::StringRef path = it->path();
+        llvm::ErrorOr<llvm::sys::fs::basic_file_status> status = it->status();
+        if (!status || status->type() != llvm::sys::fs::file_type::regular_file)
+        {
+            continue;
+        }
+
+        if (path.endswith(CacheTempExtension))
+        {
+            if (now - status->getLastModificationTime() > StaleTempFileAge)
+            {
+                llvm::sys::fs::remove(path);
+            }
+            continue;
+        }
+        if (!path.endswith(CacheEntryExtension))
+        {
+            continue;
+        }
+
+        entries.push_back({ path.str(), status->getSize(), status->getLastModificationTime() });
+        totalSize += status->getSize();
+    }
+
+    if (maxSize == 0 || totalSize <= maxSize)
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+
+    // Another process may be evicting at the same time; failing to remove an
+    // entry that is already gone is fine.
+    for (const Entry& entry : entries)
+    {
+        if (totalSize <= maxSize)
+        {
+            break;
+        }
+        if (!llvm::sys::fs::remove(entry.path, /*IgnoreNonExisting=*/false))
+        {
+            ++m_evictions;
+        }
+        totalSize -= entry.size;
+    }
+}
+
+void KernelBinaryCache::printStats(const char* event) const
+{
+    if (IGC_IS_FLAG_ENABLED(KernelBinaryCacheVerbose))
+    {
+        fprintf(stderr, "IGC kernel binary cache %s (hits: %llu, misses: %llu, stores: %llu, evictions: %llu)\n",
+            event,
+            static_cast<unsigned long long>(m_hits),
+            static_cast<unsigned long long>(m_misses),
+            static_cast<unsigned long long>(m_stores),
+            static_cast<unsigned long long>(m_evictions));
+    }
+}
+
+} // namespace TC
@@ -0,0 +1,98 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+
+#include "AdaptorOCL/TranslationBlock.h"
+#include "Compiler/CISACodeGen/Platform.hpp"
+#include "common/shaderHash.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace TC
+{
+
+// On-disk, content-addressed cache of final program binaries (zebin or
+// patch-token) produced by TranslateBuild.
+//
+// The key is a ShaderHash whose fields cover everything that can change the
+// produced binary:
+//   asmHash   - input module bytes
+//   nosHash   - build options and internal options
+//   psoHash   - specialization constants
+//   stateHash - CPlatform (platform, SKU/WA tables, GT system info)
+//   ltoHash   - IGC build ID, input format and extra link inputs
+//   dcHash    - regkeys set explicitly for this process
+//
+// The hashes only name the entry. Each entry also stores the hashed fields
+// themselves, and a lookup compares them, so that a hash collision is a miss
+// rather than a wrong binary.
+//
+// Entries are written to a temporary file and atomically renamed into place,
+// so several processes may share one cache directory. The directory is kept
+// under KernelBinaryCacheMaxSizeMB by evicting the least recently used
+// entries; every hit refreshes the modification time of its entry.
+class KernelBinaryCache
+{
+public:
+    static KernelBinaryCache& get();
+
+    // Returns true when the cache is enabled and the given compilation is
+    // deterministic enough to be served from it (no GTPin / tracing input,
+    // no shader override or dumps requested). Dumps may be requested by
+    // regkeys, including the ones scoped to the current shader hash, by the
+    // vISA options or by the build options, so this has to be called once
+    // the regkeys of the build are loaded and its shader hash is set.
+    bool isCacheable(const STB_TranslateInputArgs* pInputArgs) const;
+
+    struct Key
+    {
+        ShaderHash hash;
+        // The hashed fields, each prefixed with its size.
+        std::string data;
+    };
+
+    Key computeKey(
+        const STB_TranslateInputArgs* pInputArgs,
+        TB_DATA_FORMAT inputDataFormat,
+        const IGC::CPlatform& platform,
+        float profilingTimerResolution) const;
+
+    // On a hit fills pOutput/pDebugData of outputArgs with new[]-allocated
+    // copies of the cached binaries and returns true.
+    bool lookup(const Key& key, STB_TranslateOutputArgs& outputArgs);
+
+    // Stores the binaries of a successful compilation. Compilations that
+    // produced warnings are not cached since the message would be lost on a
+    // later hit.
+    void store(const Key& key, const STB_TranslateOutputArgs& outputArgs);
+
+    uint64_t getHitCount() const { return m_hits; }
+    uint64_t getMissCount() const { return m_misses; }
+    uint64_t getStoreCount() const { return m_stores; }
+    uint64_t getEvictionCount() const { return m_evictions; }
+
+private:
+    KernelBinaryCache() = default;
+    KernelBinaryCache(const KernelBinaryCache&) = delete;
+    KernelBinaryCache& operator=(const KernelBinaryCache&) = delete;
+
+    std::string getCacheDir() const;
+    std::string getEntryPath(const std::string& dir, const ShaderHash& hash) const;
+    void evict(const std::string& dir);
+    void printStats(const char* event) const;
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_stores{ 0 };
+    std::atomic<uint64_t> m_evictions{ 0 };
+};
+
+} // namespace TC
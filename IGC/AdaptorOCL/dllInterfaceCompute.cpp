@@ -19,6 +19,7 @@ SPDX-License-Identifier: MIT
 #include <stdexcept>
 #include <fstream>
 #include <mutex>
+#include <shared_mutex>
 #include <numeric>
 
 #include "AdaptorCommon/customApi.hpp"
@@ -28,6 +29,8 @@ SPDX-License-Identifier: MIT
 
 #include "AdaptorOCL/UnifyIROCL.hpp"
 #include "AdaptorOCL/DriverInfoOCL.hpp"
+#include "AdaptorOCL/KernelBinaryCache.h"
+#include "AdaptorOCL/BiFModulePool.h"
 
 #include "Compiler/CISACodeGen/OpenCLKernelCodeGen.hpp"
 #include "Compiler/MetaDataApi/IGCMetaDataHelper.h"
@@ -149,11 +152,92 @@ using namespace IGC;
 namespace TC
 {
 
-static std::mutex llvm_mutex;
+// LLVM keeps its command line options in global cl::opt storage. SPMD builds
+// only read it and hold cl_opt_mutex shared. VC builds re-parse and reset the
+// options and hold it exclusively, which also serializes them, as VC still
+// keeps parts of its configuration in global variables. The per-thread lock
+// state lets the exception guards of the CIF entry points release the mutex
+// when a compilation is abandoned without unwinding.
+enum class ClOptLock
+{
+    None,
+    Shared,
+    Exclusive,
+};
+static std::shared_mutex cl_opt_mutex;
+static thread_local ClOptLock cl_opt_lock_held = ClOptLock::None;
+
+// Sets the LLVM options every SPMD build depends on. Must be called with
+// cl_opt_mutex held exclusively.
+static void ApplyLLVMGlobalOptions()
+{
+    // Disable code sinking in instruction combining.
+    // This is a workaround for a performance issue caused by code sinking
+    // that is being done in LLVM's instcombine pass.
+    // This code will be removed once sinking is removed from instcombine.
+    auto optionsMap = llvm::cl::getRegisteredOptions();
+    llvm::StringRef instCombineFlag = "-instcombine-code-sinking=0";
+    auto instCombineSinkingSwitch = optionsMap.find(instCombineFlag.trim("-=0"));
+    if (instCombineSinkingSwitch != optionsMap.end())
+    {
+        if (instCombineSinkingSwitch->getValue()->getNumOccurrences() == 0)
+        {
+            const char* const args[] = { "igc", instCombineFlag.data() };
+            llvm::cl::ParseCommandLineOptions(std::size(args), args);
+        }
+    }
+}
 
 void UnlockMutex()
 {
-    llvm_mutex.unlock();
+    switch (cl_opt_lock_held)
+    {
+    case ClOptLock::Shared:
+        cl_opt_mutex.unlock_shared();
+        break;
+    case ClOptLock::Exclusive:
+        // VC resets all option occurrences and values when it is done, so
+        // restore the ones SPMD builds rely on before they read them again.
+        ApplyLLVMGlobalOptions();
+        cl_opt_mutex.unlock();
+        break;
+    case ClOptLock::None:
+        break;
+    }
+    cl_opt_lock_held = ClOptLock::None;
+}
+
+struct ClOptLockGuard
+{
+    explicit ClOptLockGuard(ClOptLock mode)
+    {
+        IGC_ASSERT(cl_opt_lock_held == ClOptLock::None);
+        if (mode == ClOptLock::Exclusive)
+            cl_opt_mutex.lock();
+        else
+            cl_opt_mutex.lock_shared();
+        cl_opt_lock_held = mode;
+    }
+    ~ClOptLockGuard() { UnlockMutex(); }
+};
+
+// Process-wide state needed by every SPMD build that does not depend on the
+// input.
+static void InitializeLLVMGlobalStateOnce()
+{
+    static std::once_flag initFlag;
+    std::call_once(initFlag, []()
+    {
+        {
+            std::lock_guard<std::shared_mutex> lock(cl_opt_mutex);
+            ApplyLLVMGlobalOptions();
+        }
+
+        if (IGC_IS_FLAG_ENABLED(QualityMetricsEnable))
+        {
+            IGC::Debug::SetDebugFlag(IGC::Debug::DebugFlag::SHADER_QUALITY_METRICS, true);
+        }
+    });
 }
 
 extern bool ProcessElfInput(
@@ -1129,13 +1213,6 @@ void dumpOCLProgramBinary(OpenCLProgramContext &Ctx, const char *binaryOutput,
   dumpOCLProgramBinary(name.str().data(), binaryOutput, binarySize);
 }
 
-static std::unique_ptr<llvm::MemoryBuffer> GetGenericModuleBuffer()
-{
-    char Resource[5] = {'-'};
-    _snprintf(Resource, sizeof(Resource), "#%d", OCL_BC);
-    return std::unique_ptr<llvm::MemoryBuffer>{llvm::LoadBufferFromResource(Resource, "BC")};
-}
-
 static void WriteSpecConstantsDump(
     const STB_TranslateInputArgs* pInputArgs,
     QWORD hash)
@@ -1159,32 +1236,15 @@ bool TranslateBuildSPMD(
     float profilingTimerResolution,
     const ShaderHash& inputShHash)
 {
-    // This part of code is a critical-section for threads,
-    // due static LLVM object which handles options.
-    // Setting mutex to ensure that single thread will enter and setup this flag.
-    {
-        const std::lock_guard<std::mutex> lock(llvm_mutex);
-        // Disable code sinking in instruction combining.
-        // This is a workaround for a performance issue caused by code sinking
-        // that is being done in LLVM's instcombine pass.
-        // This code will be removed once sinking is removed from instcombine.
-        auto optionsMap = llvm::cl::getRegisteredOptions();
-        llvm::StringRef instCombineFlag = "-instcombine-code-sinking=0";
-        auto instCombineSinkingSwitch = optionsMap.find(instCombineFlag.trim("-=0"));
-        if (instCombineSinkingSwitch != optionsMap.end())
-        {
-            if (instCombineSinkingSwitch->getValue()->getNumOccurrences() == 0)
-            {
-                const char* const args[] = { "igc", instCombineFlag.data() };
-                llvm::cl::ParseCommandLineOptions(std::size(args), args);
-            }
-        }
-    }
-
-    if (IGC_IS_FLAG_ENABLED(QualityMetricsEnable))
-    {
-        IGC::Debug::SetDebugFlag(IGC::Debug::DebugFlag::SHADER_QUALITY_METRICS, true);
-    }
+    InitializeLLVMGlobalStateOnce();
+#if GET_MEM_STATS
+    // The memory report is process-wide and reset per build, so concurrent
+    // builds are not supported with it: take the lock exclusively to run
+    // them one at a time.
+    ClOptLockGuard clOptLock(ClOptLock::Exclusive);
+#else
+    ClOptLockGuard clOptLock(ClOptLock::Shared);
+#endif
 
     MEM_USAGERESET;
 
@@ -1328,6 +1388,10 @@ bool TranslateBuildSPMD(
     // set retry manager
     bool retry = false;
     oclContext.m_retryManager.Enable(ShaderType::OPENCL_SHADER);
+    if (oclContext.m_InternalOptions.DisableRecompilation)
+    {
+        oclContext.m_retryManager.Disable(true);
+    }
     do
     {
         llvm::TinyPtrVector<const llvm::Function*> kernelFunctions;
@@ -1365,8 +1429,6 @@ bool TranslateBuildSPMD(
 
             std::unique_ptr<llvm::Module> BuiltinGenericModule = nullptr;
             std::unique_ptr<llvm::Module> BuiltinSizeModule = nullptr;
-            std::unique_ptr<llvm::MemoryBuffer> pGenericBuffer = nullptr;
-            std::unique_ptr<llvm::MemoryBuffer> pSizeTBuffer = nullptr;
             {
                 // IGC has two BIF Modules:
                 //            1. kernel Module (pKernelModule)
@@ -1388,73 +1450,21 @@ bool TranslateBuildSPMD(
                 // when linking M1 into M0 (M0 : dstModule, M1 : srcModule), the final type is the type
                 // used in M0.
 
-                // Load the builtin module -  Generic BC
-                // Load the builtin module -  Generic BC
+                // Load the builtin modules - generic and pointer size dependent.
+                // The resources are shared by all compilations in the process,
+                // only the lazy modules are created in this context.
+                COMPILER_TIME_START(&oclContext, TIME_OCL_LazyBiFLoading);
+                BiFModulePool::Modules BuiltinModules;
+                std::string BiFError;
+                if (!BiFModulePool::get().getModules(
+                        *oclContext.getLLVMContext(), PtrSzInBits, BuiltinModules, BiFError))
                 {
-                    COMPILER_TIME_START(&oclContext, TIME_OCL_LazyBiFLoading);
-
-                    pGenericBuffer = GetGenericModuleBuffer();
-
-                    if (pGenericBuffer == NULL)
-                    {
-                        SetErrorMessage("Error loading the Generic builtin resource", *pOutputArgs);
-                        return false;
-                    }
-
-                    llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-                        getLazyBitcodeModule(pGenericBuffer->getMemBufferRef(), *oclContext.getLLVMContext());
-
-                    if (llvm::Error EC = ModuleOrErr.takeError())
-                    {
-                        std::string error_str = "Error lazily loading bitcode for generic builtins,"
-                                                "is bitcode the right version and correctly formed?";
-                        SetErrorMessage(error_str, *pOutputArgs);
-                        return false;
-                    }
-                    else
-                    {
-                        BuiltinGenericModule = std::move(*ModuleOrErr);
-                    }
-
-                    if (BuiltinGenericModule == NULL)
-                    {
-                        SetErrorMessage("Error loading the Generic builtin module from buffer", *pOutputArgs);
-                        return false;
-                    }
-                    COMPILER_TIME_END(&oclContext, TIME_OCL_LazyBiFLoading);
-                }
-
-                // Load the builtin module -  pointer depended
-                {
-                    char ResNumber[5] = { '-' };
-                    switch (PtrSzInBits)
-                    {
-                    case 32:
-                        _snprintf_s(ResNumber, sizeof(ResNumber), 5, "#%d", OCL_BC_32);
-                        break;
-                    case 64:
-                        _snprintf_s(ResNumber, sizeof(ResNumber), 5, "#%d", OCL_BC_64);
-                        break;
-                    default:
-                        IGC_ASSERT_MESSAGE(0, "Unknown bitness of compiled module");
-                    }
-
-                    // the MemoryBuffer becomes owned by the module and does not need to be managed
-                    pSizeTBuffer.reset(llvm::LoadBufferFromResource(ResNumber, "BC"));
-                    IGC_ASSERT_MESSAGE(pSizeTBuffer, "Error loading builtin resource");
-
-                    llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-                        getLazyBitcodeModule(pSizeTBuffer->getMemBufferRef(), *oclContext.getLLVMContext());
-                    if (llvm::Error EC = ModuleOrErr.takeError())
-                        IGC_ASSERT_MESSAGE(0, "Error lazily loading bitcode for size_t builtins");
-                    else
-                        BuiltinSizeModule = std::move(*ModuleOrErr);
-
-                    IGC_ASSERT_MESSAGE(BuiltinSizeModule, "Error loading builtin module from buffer");
+                    SetErrorMessage(BiFError, *pOutputArgs);
+                    return false;
                 }
-
-                BuiltinGenericModule->setDataLayout(BuiltinSizeModule->getDataLayout());
-                BuiltinGenericModule->setTargetTriple(BuiltinSizeModule->getTargetTriple());
+                BuiltinGenericModule = std::move(BuiltinModules.Generic);
+                BuiltinSizeModule = std::move(BuiltinModules.SizeT);
+                COMPILER_TIME_END(&oclContext, TIME_OCL_LazyBiFLoading);
             }
 
             oclContext.getModuleMetaData()->csInfo.forcedSIMDSize |= IGC_GET_FLAG_VALUE(ForceOCLSIMDWidth);
@@ -1681,11 +1691,11 @@ bool TranslateBuildVC(
                strstr(pInputArgs->pOptions, "-cmc")));
 
     // Currently, VC compiler effectively uses global variables to store
-    // some configuration information. This may lead to problems
-    // during multi-threaded compilations. The mutex below serializes
-    // the whole compilation process.
-    // This is a temporary measure till a proper re-design is done.
-    const std::lock_guard<std::mutex> lock(llvm_mutex);
+    // some configuration information and re-parses the LLVM options. This
+    // may lead to problems during multi-threaded compilations. The lock
+    // below serializes the whole compilation process against every other
+    // build. This is a temporary measure till a proper re-design is done.
+    ClOptLockGuard lock(ClOptLock::Exclusive);
 
     std::error_code status =
         vc::translateBuild(pInputArgs, pOutputArgs, inputDataFormatTemp,
@@ -1701,6 +1711,16 @@ bool TranslateBuild(
     const IGC::CPlatform& IGCPlatform,
     float profilingTimerResolution)
 {
+    // The events of this build are appended to CompileTraceFile on return,
+    // after the TranslateBuild event itself has been recorded.
+    CompileTrace::Recorder::get().enable(
+        IGC_GET_REGKEYSTRING(CompileTraceFile), IGC_GET_FLAG_VALUE(CompileTraceLevel));
+    struct CompileTraceFlush
+    {
+        ~CompileTraceFlush() { CompileTrace::Recorder::get().flush(); }
+    } traceFlush;
+    CompileTrace::Scope traceBuild("IGC", "TranslateBuild");
+
     ShaderHash inputShHash;
     if (IGC_IS_FLAG_ENABLED(EnableKernelNamesBasedHash))
     {
@@ -1747,21 +1767,45 @@ bool TranslateBuild(
     }
 #endif // defined(IGC_VC_ENABLED)
 
+    // Serve the program binary from the persistent cache when possible. The
+    // regkeys of the build, including -igc_opts, are loaded and the shader
+    // hash that scopes them is set by now.
+    KernelBinaryCache& binaryCache = KernelBinaryCache::get();
+    const bool useBinaryCache = binaryCache.isCacheable(pInputArgs);
+    KernelBinaryCache::Key binaryCacheKey;
+    if (useBinaryCache)
+    {
+        binaryCacheKey = binaryCache.computeKey(pInputArgs, inputDataFormatTemp, IGCPlatform,
+                                                profilingTimerResolution);
+        if (binaryCache.lookup(binaryCacheKey, *pOutputArgs))
+        {
+            return true;
+        }
+    }
+
+    bool ret = false;
     if (inputDataFormatTemp != TB_DATA_FORMAT_SPIR_V)
     {
-        return TranslateBuildSPMD(pInputArgs, pOutputArgs, inputDataFormatTemp,
-                                  IGCPlatform, profilingTimerResolution,
-                                  inputShHash);
+        ret = TranslateBuildSPMD(pInputArgs, pOutputArgs, inputDataFormatTemp,
+                                 IGCPlatform, profilingTimerResolution,
+                                 inputShHash);
+    }
+    else
+    {
+        // Recognize if SPIR-V module contains SPMD,ESIMD or SPMD+ESIMD code and compile it.
+        std::string errorMessage;
+        ret = VLD::TranslateBuildSPMDAndESIMD(
+            pInputArgs, pOutputArgs, inputDataFormatTemp, IGCPlatform,
+            profilingTimerResolution, inputShHash, errorMessage);
+        if (!ret && !errorMessage.empty())
+        {
+            SetErrorMessage(errorMessage, *pOutputArgs);
+        }
     }
 
-    // Recognize if SPIR-V module contains SPMD,ESIMD or SPMD+ESIMD code and compile it.
-    std::string errorMessage;
-    bool ret = VLD::TranslateBuildSPMDAndESIMD(
-        pInputArgs, pOutputArgs, inputDataFormatTemp, IGCPlatform,
-        profilingTimerResolution, inputShHash, errorMessage);
-    if (!ret && !errorMessage.empty())
+    if (ret && useBinaryCache)
     {
-        SetErrorMessage(errorMessage, *pOutputArgs);
+        binaryCache.store(binaryCacheKey, *pOutputArgs);
     }
     return ret;
 }
@@ -4722,12 +4722,12 @@ namespace IGC
         {
             SaveOption(vISA_AvoidUsingR0R1, true);
         }
-        if (IGC_IS_FLAG_ENABLED(FastCompileRA)
+        if ((IGC_IS_FLAG_ENABLED(FastCompileRA) || context->m_forceFastCompileRA)
             && (!hasStackCall || IGC_IS_FLAG_ENABLED(PartitionWithFastHybridRA)))
         {
             SaveOption(vISA_FastCompileRA, true);
         }
-        if (IGC_IS_FLAG_ENABLED(HybridRAWithSpill)
+        if ((IGC_IS_FLAG_ENABLED(HybridRAWithSpill) || context->m_forceHybridRAWithSpill)
             && (!hasStackCall || IGC_IS_FLAG_ENABLED(PartitionWithFastHybridRA)))
         {
             SaveOption(vISA_HybridRAWithSpill, true);
@@ -6205,7 +6205,6 @@ namespace IGC
     {
         IGC_ASSERT(nullptr != m_program);
         CodeGenContext* const context = m_program->GetContext();
-        SProgramOutput* const pOutput = m_program->ProgramOutput();
         const std::vector<const char*>* additionalVISAAsmToLink = nullptr;
         bool emitVisaOnly = false;
 
@@ -6262,11 +6261,64 @@ namespace IGC
             pMainKernel->GetJitInfo(jitInfo);
 
             jitInfo->stats.scratchSpaceSizeLimit = m_program->ProgramOutput()->m_scratchSpaceSizeLimit;
+
+            if (context->type == ShaderType::OPENCL_SHADER &&
+                static_cast<OpenCLProgramContext*>(context)->m_SIMDCompilePool)
+            {
+                // Only the finalization runs on the pool; the result is processed
+                // on this thread by FinishCompile() once CodeGen has decided which
+                // SIMD variant is kept.
+                auto& pool = *static_cast<OpenCLProgramContext*>(context)->m_SIMDCompilePool;
+                std::string isaasmName = m_enableVISAdump ? GetDumpFileName("isaasm") : "";
+                m_pendingHasSymbolTable = hasSymbolTable;
+                m_pendingFGA = pFGA;
+                std::string traceName = m_program->entry->getName().str();
+                const unsigned simd = numLanes(m_program->m_dispatchSize);
+                m_pendingCompile = pool.async([this, isaasmName, emitVisaOnly, traceName, simd]() {
+                    CompileTrace::KernelScope traceKernel(traceName, simd);
+                    CompileTrace::Scope traceCompile("IGC", "ParallelSIMDCompile");
+                    m_vIsaCompileStatus = vbuilder->Compile(isaasmName.c_str(), emitVisaOnly);
+                });
+                return;
+            }
+
             m_vIsaCompileStatus = vbuilder->Compile(
                 m_enableVISAdump ? GetDumpFileName("isaasm").c_str() : "",
                 emitVisaOnly);
         }
 
+        CompleteCompile(pMainKernel, jitInfo, kernelName, hasSymbolTable, emitVisaOnly,
+            additionalVISAAsmToLink != nullptr, pFGA);
+    }
+
+    void CEncoder::FinishCompile()
+    {
+        IGC_ASSERT(HasPendingCompile());
+        m_pendingCompile.wait();
+        m_pendingCompile = std::shared_future<void>();
+
+        vISA::FINALIZER_INFO* jitInfo = nullptr;
+        vMainKernel->GetJitInfo(jitInfo);
+        CompleteCompile(vMainKernel, jitInfo, std::string(), m_pendingHasSymbolTable,
+            false, false, m_pendingFGA);
+    }
+
+    void CEncoder::DiscardCompile()
+    {
+        IGC_ASSERT(HasPendingCompile());
+        m_pendingCompile.wait();
+        m_pendingCompile = std::shared_future<void>();
+        m_vIsaCompileStatus = VISA_FAILURE;
+        COMPILER_TIME_END(m_program->GetContext(), TIME_CG_vISACompile);
+    }
+
+    void CEncoder::CompleteCompile(VISAKernel* pMainKernel, vISA::FINALIZER_INFO* jitInfo,
+        const std::string& kernelName, bool hasSymbolTable, bool emitVisaOnly,
+        bool hasAdditionalVISAAsmToLink, GenXFunctionGroupAnalysis*& pFGA)
+    {
+        CodeGenContext* const context = m_program->GetContext();
+        SProgramOutput* const pOutput = m_program->ProgramOutput();
+
         COMPILER_TIME_END(m_program->GetContext(), TIME_CG_vISACompile);
 
 #if GET_TIME_STATS
@@ -6287,7 +6339,7 @@ namespace IGC
         if (jitInfo->numBarriers != 0)
         {
             if (context->getModuleMetaData()->NBarrierCnt > 0 ||
-                additionalVISAAsmToLink)
+                hasAdditionalVISAAsmToLink)
             {
                 m_program->SetBarrierNumber(NamedBarriersResolution::AlignNBCnt2BarrierNumber(jitInfo->numBarriers));
             }
@@ -15,6 +15,7 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CISACodeGen/GenCodeGenModule.h"
 #include "visa_wa.h"
 #include "inc/common/sku_wa.h"
+#include <future>
 
 namespace IGC
 {
@@ -137,6 +138,14 @@ namespace IGC
         void MarkAsOutput(CVariable* var);
         void MarkAsPayloadLiveOut(CVariable* var);
         void Compile(bool hasSymbolTable, GenXFunctionGroupAnalysis*& pFGA);
+        /// \brief With parallel SIMD compilation Compile() only submits the vISA
+        /// finalization to the pool of the OCL context. FinishCompile() waits for
+        /// it and processes the result as Compile() would have; DiscardCompile()
+        /// waits for it and drops the result, leaving the encoder as if the
+        /// variant had never been compiled.
+        bool HasPendingCompile() const { return m_pendingCompile.valid(); }
+        void FinishCompile();
+        void DiscardCompile();
         std::string GetShaderName();
 
         CEncoder();
@@ -716,6 +725,12 @@ namespace IGC
             const std::vector<std::string> &visaOverrideFiles,
             const std::string kernelName);
 
+        /// process the result of vbuilder->Compile(): stats, retry state and the
+        /// final binary with its tables
+        void CompleteCompile(VISAKernel* pMainKernel, vISA::FINALIZER_INFO* jitInfo,
+            const std::string& kernelName, bool hasSymbolTable, bool emitVisaOnly,
+            bool hasAdditionalVISAAsmToLink, GenXFunctionGroupAnalysis*& pFGA);
+
         // setup m_retryManager according to jitinfo and other factors
         void SetKernelRetryState(CodeGenContext* context, vISA::FINALIZER_INFO* jitInfo, GenXFunctionGroupAnalysis*& pFGA);
 
@@ -817,6 +832,11 @@ namespace IGC
         CShader* m_program;
         int m_vIsaCompileStatus = VISA_FAILURE;
 
+        // State of a vbuilder->Compile() running on the SIMD compile pool
+        std::shared_future<void> m_pendingCompile;
+        bool m_pendingHasSymbolTable = false;
+        GenXFunctionGroupAnalysis* m_pendingFGA = nullptr;
+
         // Keep a map between a function and its per-function attributes needed for function pointer support
         struct FuncAttrib
         {
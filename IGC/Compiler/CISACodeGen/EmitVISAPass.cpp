@@ -43,6 +43,7 @@ SPDX-License-Identifier: MIT
 #include "common/LLVMWarningsPop.hpp"
 #include "Probe/Assertion.h"
 
+#include <atomic>
 #include <fstream>
 
 using namespace llvm;
@@ -52,6 +53,15 @@ using namespace std;
 
 char EmitPass::ID = 0;
 
+/// Remaining CodePatchLimit budget. The limit counts the shaders patched by
+/// the whole process, so concurrent compilations share one atomic counter
+/// instead of writing the regkey back.
+static std::atomic<DWORD>& codePatchLimit()
+{
+    static std::atomic<DWORD> limit(IGC_GET_FLAG_VALUE(CodePatchLimit));
+    return limit;
+}
+
 /// Divide N into multiple of M (must be power of two), and the remaining into M/2,
 /// M/4, ..., 1. Each sequence takes two elements in execsizeSeq, in which first
 /// one has execsize, and the second one the starting offset.
@@ -602,6 +612,23 @@ void EmitPass::CreateKernelShaderMap(CodeGenContext* ctx, MetaDataUtils* pMdUtil
     }
 }
 
+void EmitPass::SetMidThreadPreemption(CShader* shader)
+{
+    if ((shader->GetShaderType() == ShaderType::COMPUTE_SHADER ||
+        shader->GetShaderType() == ShaderType::OPENCL_SHADER) &&
+        shader->m_Platform->supportDisableMidThreadPreemptionSwitch() &&
+        IGC_IS_FLAG_ENABLED(EnableDisableMidThreadPreemptionOpt) &&
+        (shader->GetContext()->m_instrTypes.numLoopInsts == 0) &&
+        (shader->ProgramOutput()->m_InstructionCount < IGC_GET_FLAG_VALUE(MidThreadPreemptionDisableThreshold)))
+    {
+
+        {
+            COpenCLKernel* kernel = static_cast<COpenCLKernel*>(shader);
+            kernel->SetDisableMidthreadPreemption();
+        }
+    }
+}
+
 bool EmitPass::runOnFunction(llvm::Function& F)
 {
     m_currFuncHasSubroutine = false;
@@ -622,6 +649,8 @@ bool EmitPass::runOnFunction(llvm::Function& F)
 
     m_pCtx->createFunctionIDs();
 
+    CompileTrace::KernelScope traceKernel(F.getName().str(), numLanes(m_SimdMode));
+
     m_FGA = getAnalysisIfAvailable<GenXFunctionGroupAnalysis>();
 
     if ((IsStage1BestPerf(m_pCtx->m_CgFlag, m_pCtx->m_StagingCtx) ||
@@ -738,7 +767,7 @@ bool EmitPass::runOnFunction(llvm::Function& F)
             m_currShader->IsPatchablePS() &&
             m_SimdMode == SIMDMode::SIMD16 &&
             (m_ShaderDispatchMode != ShaderDispatchMode::NOT_APPLICABLE || prevKernel) &&
-            (IGC_GET_FLAG_VALUE(CodePatchLimit) == 0 || 2 <= IGC_GET_FLAG_VALUE(CodePatchLimit)))
+            (codePatchLimit().load() == 0 || 2 <= codePatchLimit().load()))
         {
             m_encoder->SetIsCodePatchCandidate(true);
 
@@ -1247,13 +1276,13 @@ bool EmitPass::runOnFunction(llvm::Function& F)
             }
             else
             {
-                if (IGC_GET_FLAG_VALUE(CodePatchLimit) >= 2)
+                DWORD limit = codePatchLimit();
+                while (limit >= 2 && !codePatchLimit().compare_exchange_weak(limit, limit - 1))
                 {
-                    IGC_SET_FLAG_VALUE(CodePatchLimit, IGC_GET_FLAG_VALUE(CodePatchLimit) - 1);
                 }
                 if (IGC_GET_FLAG_VALUE(CodePatchExperiments))
                 {
-                    errs() << IGC_GET_FLAG_VALUE(CodePatchLimit) << " Prologue/CodePatch : " << m_encoder->GetShaderName() << "\n";
+                    errs() << codePatchLimit().load() << " Prologue/CodePatch : " << m_encoder->GetShaderName() << "\n";
                 }
             }
         }
@@ -1261,7 +1290,7 @@ bool EmitPass::runOnFunction(llvm::Function& F)
         {
             if (IGC_GET_FLAG_VALUE(CodePatchExperiments))
             {
-                errs() << IGC_GET_FLAG_VALUE(CodePatchLimit) << " not : " << m_encoder->GetShaderName() << "\n";
+                errs() << codePatchLimit().load() << " not : " << m_encoder->GetShaderName() << "\n";
             }
         }
     }
@@ -1320,10 +1349,13 @@ bool EmitPass::runOnFunction(llvm::Function& F)
             IDebugEmitter::Release(m_pDebugEmitter);
         }
 
-        if (!m_encoder->IsCodePatchCandidate() ||
+        // With parallel SIMD compilation the builder is still being finalized
+        // on the compile pool; CodeGen destroys it once the result is collected.
+        if (!m_encoder->HasPendingCompile() &&
+            (!m_encoder->IsCodePatchCandidate() ||
             m_encoder->HasPrevKernel() ||
             !m_currShader->ProgramOutput()->m_programBin ||
-            m_currShader->ProgramOutput()->m_scratchSpaceUsedBySpills)
+            m_currShader->ProgramOutput()->m_scratchSpaceUsedBySpills))
         {
             m_pCtx->m_prevShader = nullptr;
             // Postpone destroying VISA builder to
@@ -1336,18 +1368,9 @@ bool EmitPass::runOnFunction(llvm::Function& F)
         }
     }
 
-    if ((m_currShader->GetShaderType() == ShaderType::COMPUTE_SHADER ||
-        m_currShader->GetShaderType() == ShaderType::OPENCL_SHADER) &&
-        m_currShader->m_Platform->supportDisableMidThreadPreemptionSwitch() &&
-        IGC_IS_FLAG_ENABLED(EnableDisableMidThreadPreemptionOpt) &&
-        (m_currShader->GetContext()->m_instrTypes.numLoopInsts == 0) &&
-        (m_currShader->ProgramOutput()->m_InstructionCount < IGC_GET_FLAG_VALUE(MidThreadPreemptionDisableThreshold)))
+    if (!m_encoder->HasPendingCompile())
     {
-
-        {
-            COpenCLKernel* kernel = static_cast<COpenCLKernel*>(m_currShader);
-            kernel->SetDisableMidthreadPreemption();
-        }
+        SetMidThreadPreemption(m_currShader);
     }
 
     if (IGC_IS_FLAG_ENABLED(ForceBestSIMD))
@@ -84,6 +84,9 @@ public:
     virtual llvm::StringRef getPassName() const  override { return "EmitPass"; }
 
     void CreateKernelShaderMap(CodeGenContext* ctx, IGC::IGCMD::MetaDataUtils* pMdUtils, llvm::Function& F);
+    /// Disable mid-thread preemption for short loop-free compute kernels.
+    /// Needs the instruction count of the compiled shader.
+    static void SetMidThreadPreemption(CShader* shader);
 
     void Frc(const SSource& source, const DstModifier& modifier);
     void Floor(const SSource& source, const DstModifier& modifier);
@@ -3205,6 +3205,66 @@ namespace IGC
         return result;
     }
 
+    // Parallel SIMD compilation is only done when the SIMD variants of a kernel
+    // are alternatives of each other: the serial flow compiles them in
+    // 32 -> 16 -> 8 order and stops at the first one that succeeds.
+    static bool CanCompileSIMDInParallel(OpenCLProgramContext* ctx)
+    {
+        if (IGC_GET_FLAG_VALUE(ParallelSIMDCompileThreads) == 0)
+            return false;
+        // The finalizer may not be safe to run on several builders at once.
+        if (!VISABuilderSupportsConcurrentCompile())
+            return false;
+        if (ctx->m_DriverInfo.sendMultipleSIMDModes() ||
+            ctx->m_enableSimdVariantCompilation ||
+            ctx->getModuleMetaData()->csInfo.forcedSIMDSize != 0)
+            return false;
+        // Debug info is emitted by DebugInfoPass from the live vISA builders.
+        if (ctx->m_instrTypes.hasDebugInfo)
+            return false;
+        // vISA text input goes through the serialized vISA parser.
+        if (!ctx->m_VISAAsmToLink.empty() ||
+            ctx->m_InternalOptions.EmitVisaOnly ||
+            IGC_IS_FLAG_ENABLED(ShaderOverride) ||
+            IGC_IS_FLAG_ENABLED(DumpVISAASMToConsole))
+            return false;
+        // vISA compile time counters are process-wide.
+        if (ctx->m_compilerTimeStats)
+            return false;
+        return true;
+    }
+
+    // Collects the SIMD variants finalized on the compile pool. For each kernel
+    // the variants are processed in the order the serial flow would have
+    // compiled them; once one succeeds the remaining ones are dropped so that
+    // retry state, spill sizes and the selected SIMD size match the serial flow.
+    static void FinishParallelSIMDCompiles(CShaderProgram::KernelShaderMap& shaders)
+    {
+        for (auto& kernel : shaders)
+        {
+            CShaderProgram* pKernelProgram = kernel.second;
+            bool compiled = false;
+            for (SIMDMode simdMode : { SIMDMode::SIMD32, SIMDMode::SIMD16, SIMDMode::SIMD8 })
+            {
+                COpenCLKernel* shader = static_cast<COpenCLKernel*>(pKernelProgram->GetShader(simdMode));
+                if (!shader || !shader->GetEncoder().HasPendingCompile())
+                    continue;
+
+                if (compiled)
+                {
+                    shader->GetEncoder().DiscardCompile();
+                }
+                else
+                {
+                    shader->GetEncoder().FinishCompile();
+                    EmitPass::SetMidThreadPreemption(shader);
+                    compiled = COpenCLKernel::IsValidShader(shader);
+                }
+                shader->GetEncoder().DestroyVISABuilder();
+            }
+        }
+    }
+
     static void CodeGen(OpenCLProgramContext* ctx, CShaderProgram::KernelShaderMap& shaders)
     {
         COMPILER_TIME_START(ctx, TIME_CodeGen);
@@ -3309,7 +3369,21 @@ namespace IGC
         Passes.add(new DebugInfoPass(shaders));
         COMPILER_TIME_END(ctx, TIME_CG_Add_Passes);
 
+        // With ParallelSIMDCompileThreads every candidate SIMD variant is
+        // emitted and its vISA finalization runs on the pool while the next
+        // variants are emitted. Results are collected once all are submitted.
+        if (CanCompileSIMDInParallel(ctx))
+        {
+            ctx->m_SIMDCompilePool = IGCLLVM::createThreadPool(IGC_GET_FLAG_VALUE(ParallelSIMDCompileThreads));
+        }
+
         Passes.run(*(ctx->getModule()));
+
+        if (ctx->m_SIMDCompilePool)
+        {
+            FinishParallelSIMDCompiles(shaders);
+            ctx->m_SIMDCompilePool.reset();
+        }
         COMPILER_TIME_END(ctx, TIME_CodeGen);
         DumpLLVMIR(ctx, "codegen");
     }
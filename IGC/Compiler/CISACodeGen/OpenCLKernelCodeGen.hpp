@@ -9,6 +9,9 @@ SPDX-License-Identifier: MIT
 #pragma once
 #include "Compiler/CISACodeGen/ComputeShaderBase.hpp"
 #include "Compiler/CISACodeGen/OpenCLOptions.hpp"
+#include "common/LLVMWarningsPush.hpp"
+#include "llvmWrapper/Support/ThreadPool.h"
+#include "common/LLVMWarningsPop.hpp"
 
 namespace IGC
 {
@@ -48,6 +51,9 @@ namespace IGC
         std::vector<const char*> m_VISAAsmToLink;
         // Functions that are forced to be direct calls.
         std::unordered_set<std::string> m_DirectCallFunctions;
+        // Pool running the vISA finalization of the SIMD variants when
+        // ParallelSIMDCompileThreads is set. Only alive during CodeGen.
+        std::unique_ptr<IGCLLVM::ThreadPool> m_SIMDCompilePool;
 
         OpenCLProgramContext(
             const COCLBTILayout& btiLayout,
@@ -136,7 +136,7 @@ void InternalOptions::parseOptions(const char* internalOpts)
     }
     if (internalOptions.hasArg(OPT_disable_recompilation_common))
     {
-        IGC_SET_FLAG_VALUE(DisableRecompilation, true);
+        DisableRecompilation = true;
     }
 
     if (internalOptions.hasArg(OPT_force_emu_int32divrem_common))
@@ -55,6 +55,7 @@ public:
     bool DisableNoMaskWA                            = false;
     bool IgnoreBFRounding                           = false;   // If true, ignore BFloat rounding when folding bf operations
     bool CompileOneKernelAtTime                     = false;
+    bool DisableRecompilation                       = false;
 
     // Generic address related
     bool ForceGlobalMemoryAllocation                = false;
@@ -219,34 +219,30 @@ IGC_INITIALIZE_PASS_END(PreRAScheduler, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PAS
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
 void PreRAScheduler::dumpDDGContents()
 {
-    IGC_SET_FLAG_VALUE(PrintToConsole, 1);
-
     DenseMap<unsigned, Node*>::iterator instToNodeMapItBegin = m_pInstToNodeMap.begin(),
         instToNodeMapItEnd = m_pInstToNodeMap.end();
     for (; instToNodeMapItBegin != instToNodeMapItEnd; instToNodeMapItBegin++)
     {
-        ods() << "Instruction:  ";
-        ods() << "Number of Predecessors: " << instToNodeMapItBegin->second->numPredecessors << "\t";
-        ods() << "Node Delay: " << instToNodeMapItBegin->second->nodeDelay << "\t";
-        ods() << "Node Instruction Number: " << instToNodeMapItBegin->second->nodeInstrNum << "\t";
-        ods() << "Node Earliest Cycle: " << instToNodeMapItBegin->second->earliestCycle << "\t";
-        ods() << "Node Scheduled? : " << instToNodeMapItBegin->second->scheduled << "\t";
+        dbgs() << "Instruction:  ";
+        dbgs() << "Number of Predecessors: " << instToNodeMapItBegin->second->numPredecessors << "\t";
+        dbgs() << "Node Delay: " << instToNodeMapItBegin->second->nodeDelay << "\t";
+        dbgs() << "Node Instruction Number: " << instToNodeMapItBegin->second->nodeInstrNum << "\t";
+        dbgs() << "Node Earliest Cycle: " << instToNodeMapItBegin->second->earliestCycle << "\t";
+        dbgs() << "Node Scheduled? : " << instToNodeMapItBegin->second->scheduled << "\t";
 
         std::vector<Edge*>::iterator edgeItBegin = instToNodeMapItBegin->second->successors.begin(),
             edgeItEnd = instToNodeMapItBegin->second->successors.end();
 
         for (; edgeItBegin != edgeItEnd; edgeItBegin++)
         {
-            ods() << " Successor: end ";
+            dbgs() << " Successor: end ";
             (*edgeItBegin)->end->dump();
-            ods() << "\t";
-            ods() << " Successor: delay " << (*edgeItBegin)->delay << "\n";
+            dbgs() << "\t";
+            dbgs() << " Successor: delay " << (*edgeItBegin)->delay << "\n";
         }
 
-        ods() << " ================ End of NODE data ======================== \n";
+        dbgs() << " ================ End of NODE data ======================== \n";
     }
-
-    IGC_SET_FLAG_VALUE(PrintToConsole, 0);
 }
 #endif
 
@@ -838,23 +834,21 @@ void PreRAScheduler::dumpPriorityQueueContents()
     llvm::PriorityQueue<Node*, std::vector<Node*>, PreRAScheduler::OrderByEarliestCycle> holdQueueCopy = readyNodeHoldQueue;
     llvm::PriorityQueue<Node*, std::vector<Node*>, PreRAScheduler::OrderByLatency> shortLatencyQueueCopy = shortLatencySortedReadyQueue;
 
-    IGC_SET_FLAG_VALUE(PrintToConsole, 1);
-
-    ods() << "Begin of longLatencyDelaySortedReadyQueue contents" << "\n";
+    dbgs() << "Begin of longLatencyDelaySortedReadyQueue contents" << "\n";
     while (!longLatencyQueueCopy.empty())
     {
         longLatencyQueueCopy.top()->instruction->dump();
-        ods() << longLatencyQueueCopy.top()->nodeDelay << "\n";
-        ods() << longLatencyQueueCopy.top()->earliestCycle << "\n";
-        ods() << longLatencyQueueCopy.top()->successors.size() << "\n";
-        ods() << longLatencyQueueCopy.top()->nodeInstrNum << "\n";
+        dbgs() << longLatencyQueueCopy.top()->nodeDelay << "\n";
+        dbgs() << longLatencyQueueCopy.top()->earliestCycle << "\n";
+        dbgs() << longLatencyQueueCopy.top()->successors.size() << "\n";
+        dbgs() << longLatencyQueueCopy.top()->nodeInstrNum << "\n";
 
         longLatencyQueueCopy.pop();
     }
     longLatencyQueueCopy.clear();
-    ods() << "End of longLatencyDelaySortedReadyQueue contents" << "\n";
+    dbgs() << "End of longLatencyDelaySortedReadyQueue contents" << "\n";
 
-    ods() << "Begin of map contents" << "\n";
+    dbgs() << "Begin of map contents" << "\n";
     // map contents
     for (DenseMap<int, std::vector<Node*>>::iterator readyMapIt = longLatencyTextureIdxSortedReadyMap.begin();
         readyMapIt != longLatencyTextureIdxSortedReadyMap.end();
@@ -865,43 +859,41 @@ void PreRAScheduler::dumpPriorityQueueContents()
             readyMapNodeIt++)
         {
             (*readyMapNodeIt)->instruction->dump();
-            ods() << (*readyMapNodeIt)->nodeDelay << "\n";
-            ods() << (*readyMapNodeIt)->earliestCycle << "\n";
-            ods() << (*readyMapNodeIt)->successors.size() << "\n";
-            ods() << (*readyMapNodeIt)->nodeInstrNum << "\n";
+            dbgs() << (*readyMapNodeIt)->nodeDelay << "\n";
+            dbgs() << (*readyMapNodeIt)->earliestCycle << "\n";
+            dbgs() << (*readyMapNodeIt)->successors.size() << "\n";
+            dbgs() << (*readyMapNodeIt)->nodeInstrNum << "\n";
         }
     }
-    ods() << "End of map contents" << "\n";
+    dbgs() << "End of map contents" << "\n";
 
-    ods() << "Begin of shortLatencySortedReadyQueue contents" << "\n";
+    dbgs() << "Begin of shortLatencySortedReadyQueue contents" << "\n";
     while (!shortLatencyQueueCopy.empty())
     {
         shortLatencyQueueCopy.top()->instruction->dump();
-        ods() << shortLatencyQueueCopy.top()->nodeDelay << "\n";
-        ods() << shortLatencyQueueCopy.top()->earliestCycle << "\n";
-        ods() << shortLatencyQueueCopy.top()->successors.size() << "\n";
-        ods() << shortLatencyQueueCopy.top()->nodeInstrNum << "\n";
+        dbgs() << shortLatencyQueueCopy.top()->nodeDelay << "\n";
+        dbgs() << shortLatencyQueueCopy.top()->earliestCycle << "\n";
+        dbgs() << shortLatencyQueueCopy.top()->successors.size() << "\n";
+        dbgs() << shortLatencyQueueCopy.top()->nodeInstrNum << "\n";
 
         shortLatencyQueueCopy.pop();
     }
     shortLatencyQueueCopy.clear();
-    ods() << "End of shortLatencySortedReadyQueue contents" << "\n";
+    dbgs() << "End of shortLatencySortedReadyQueue contents" << "\n";
 
-    ods() << "Begin of readyNodeHoldQueue contents" << "\n";
+    dbgs() << "Begin of readyNodeHoldQueue contents" << "\n";
     while (!holdQueueCopy.empty())
     {
         holdQueueCopy.top()->instruction->dump();
-        ods() << holdQueueCopy.top()->nodeDelay << "\n";
-        ods() << holdQueueCopy.top()->earliestCycle << "\n";
-        ods() << holdQueueCopy.top()->successors.size() << "\n";
-        ods() << holdQueueCopy.top()->nodeInstrNum << "\n";
+        dbgs() << holdQueueCopy.top()->nodeDelay << "\n";
+        dbgs() << holdQueueCopy.top()->earliestCycle << "\n";
+        dbgs() << holdQueueCopy.top()->successors.size() << "\n";
+        dbgs() << holdQueueCopy.top()->nodeInstrNum << "\n";
 
         holdQueueCopy.pop();
     }
     holdQueueCopy.clear();
-    ods() << "End of readyNodeHoldQueue contents" << "\n";
-
-    IGC_SET_FLAG_VALUE(PrintToConsole, 0);
+    dbgs() << "End of readyNodeHoldQueue contents" << "\n";
 }
 #endif
 
@@ -122,6 +122,7 @@ SPDX-License-Identifier: MIT
 #include "common/igc_regkeys.hpp"
 #include "common/debug/Dump.hpp"
 #include "common/MemStats.h"
+#include "common/ModuleSplitter.h"
 #include <iStdLib/utility.h>
 #include "common/LLVMWarningsPush.hpp"
 #include "llvm/Config/llvm-config.h"
@@ -402,15 +403,15 @@ void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSignature
 
     if (highAllocaPressure || isPotentialHPCKernel)
     {
-        IGC_SET_FLAG_VALUE(FastCompileRA, 1);
-        IGC_SET_FLAG_VALUE(HybridRAWithSpill, 1);
+        ctx.m_forceFastCompileRA = true;
+        ctx.m_forceHybridRAWithSpill = true;
     }
     // In case of presence of Unmasked regions disable loop invariant motion after
     // Unmasked functions are inlined at the end of optimization phase
     if (IGC_IS_FLAG_ENABLED(EnableUnmaskedFunctions) &&
         IGC_IS_FLAG_DISABLED(LateInlineUnmaskedFunc) &&
         ctx.m_instrTypes.hasUnmaskedRegion) {
-        IGC_SET_FLAG_VALUE(allowLICM, false);
+        ctx.m_disableLICM = true;
     }
     bool disableConvergentInstructionsHoisting =
         ctx.m_DriverInfo.DisableConvergentInstructionsHoisting() &&
@@ -473,7 +474,7 @@ void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSignature
 
         mpm.add(createBarrierNoopPass());
 
-        if (IGC_IS_FLAG_ENABLED(allowLICM) && ctx.m_retryManager.AllowLICM())
+        if (ctx.isLICMAllowed() && ctx.m_retryManager.AllowLICM())
         {
             mpm.add(createDisableLICMForSpecificLoops());
             mpm.add(llvm::createLICMPass());
@@ -850,7 +851,7 @@ void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSignature
         {
             mpm.add(createSinkingPass());
         }
-        if (!fastCompile && !highAllocaPressure && !isPotentialHPCKernel && IGC_IS_FLAG_ENABLED(allowLICM) && ctx.m_retryManager.AllowLICM())
+        if (!fastCompile && !highAllocaPressure && !isPotentialHPCKernel && ctx.isLICMAllowed() && ctx.m_retryManager.AllowLICM())
         {
             mpm.add(createDisableLICMForSpecificLoops());
             mpm.add(createLICMPass());
@@ -1210,6 +1211,30 @@ static void alwaysInlineForNoOpt(CodeGenContext* pContext, bool NoOpt)
 
 #define GFX_ONLY_PASS if(pContext->type != ShaderType::OPENCL_SHADER)
 
+// Adds to a standalone function pass manager the immutable analyses that
+// OptimizeIR registers for its function passes.
+static void addFunctionPipelineAnalyses(CodeGenContext* const pContext, legacy::PassManagerBase& PM)
+{
+    TargetLibraryInfoImpl TLI;
+    TLI.disableAllFunctions();
+    PM.add(new llvm::TargetLibraryInfoWrapperPass(TLI));
+    PM.add(new CodeGenContextWrapper(pContext));
+    PM.add(new TargetTransformInfoWrapperPass(TargetIRAnalysis([pContext](const Function& F) {
+        GenIntrinsicsTTIImpl GTTI(pContext);
+        return TargetTransformInfo(GTTI);
+    })));
+
+    PM.add(llvm::createBasicAAWrapperPass());
+    PM.add(createAddressSpaceAAWrapperPass());
+    if (pContext->type == ShaderType::RAYTRACING_SHADER || pContext->hasSyncRTCalls())
+    {
+        if (IGC_IS_FLAG_DISABLED(DisableRTAliasAnalysis))
+            PM.add(createRayTracingAddressSpaceAAWrapperPass());
+    }
+    PM.add(createExternalAAWrapperPass(&addAddressSpaceAAResult));
+    PM.add(createScopedNoAliasAAWrapperPass());
+}
+
 void OptimizeIR(CodeGenContext* const pContext)
 {
     IGC_ASSERT(nullptr != pContext);
@@ -1413,7 +1438,7 @@ void OptimizeIR(CodeGenContext* const pContext)
                 mpm.add(llvm::createLCSSAPass());
                 mpm.add(llvm::createLoopSimplifyPass());
 
-                if (IGC_IS_FLAG_ENABLED(allowLICM) && pContext->m_retryManager.AllowLICM())
+                if (pContext->isLICMAllowed() && pContext->m_retryManager.AllowLICM())
                 {
                     mpm.add(createDisableLICMForSpecificLoops());
                     int licmTh = IGC_GET_FLAG_VALUE(LICMStatThreshold);
@@ -1470,7 +1495,7 @@ void OptimizeIR(CodeGenContext* const pContext)
                 // LoopUnroll and LICM.
                 mpm.add(createBarrierNoopPass());
 
-                if (IGC_IS_FLAG_ENABLED(allowLICM) && pContext->m_retryManager.AllowLICM())
+                if (pContext->isLICMAllowed() && pContext->m_retryManager.AllowLICM())
                 {
                     mpm.add(createDisableLICMForSpecificLoops());
                     mpm.add(llvm::createLICMPass());
@@ -1504,7 +1529,7 @@ void OptimizeIR(CodeGenContext* const pContext)
                     !useStatelessToStateful(*pContext) &&
                     pContext->m_retryManager.IsFirstTry())
                 {
-                    mpm.add(createGEPLoopStrengthReductionPass(IGC_IS_FLAG_ENABLED(allowLICM) &&
+                    mpm.add(createGEPLoopStrengthReductionPass(pContext->isLICMAllowed() &&
                             pContext->m_retryManager.AllowLICM()));
                 }
             }
@@ -1517,25 +1542,46 @@ void OptimizeIR(CodeGenContext* const pContext)
             // more address computation.
             // Do not apply reordering on vertex-shader as CustomUnsafeOptPass
             // does.
-            if (IGC_IS_FLAG_ENABLED(OCLEnableReassociate) &&
-                pContext->type == ShaderType::OPENCL_SHADER)
+            auto addScalarCleanupPasses = [pContext](legacy::PassManagerBase& PM)
             {
-                mpm.add(createReassociatePass());
-            }
+                if (IGC_IS_FLAG_ENABLED(OCLEnableReassociate) &&
+                    pContext->type == ShaderType::OPENCL_SHADER)
+                {
+                    PM.add(createReassociatePass());
+                }
 
-            mpm.add(createPromoteConstantStructsPass());
+                PM.add(createPromoteConstantStructsPass());
 
-            if (IGC_IS_FLAG_ENABLED(EnableGVN))
-            {
-                mpm.add(llvm::createGVNPass());
-            }
-            mpm.add(createGenOptLegalizer());
+                if (IGC_IS_FLAG_ENABLED(EnableGVN))
+                {
+                    PM.add(llvm::createGVNPass());
+                }
+                PM.add(createGenOptLegalizer());
 
-            mpm.add(llvm::createSCCPPass());
+                PM.add(llvm::createSCCPPass());
 
-            mpm.add(llvm::createDeadCodeEliminationPass());
-            if (!extensiveShader(pContext))
-                mpm.add(llvm::createAggressiveDCEPass());
+                PM.add(llvm::createDeadCodeEliminationPass());
+                if (!extensiveShader(pContext))
+                    PM.add(llvm::createAggressiveDCEPass());
+            };
+
+            // These passes are function-local and only read the context, so
+            // independent kernels can go through them concurrently.
+            const unsigned parallelOptThreads = IGC_GET_FLAG_VALUE(ParallelOptimizeIRThreads);
+            if (parallelOptThreads > 1)
+            {
+                mpm.add(createParallelFunctionPipelinePass(pContext, parallelOptThreads,
+                    IGC_GET_FLAG_VALUE(ParallelOptimizeIRMinInstsPerThread),
+                    [pContext, addScalarCleanupPasses](legacy::PassManagerBase& PM)
+                    {
+                        addFunctionPipelineAnalyses(pContext, PM);
+                        addScalarCleanupPasses(PM);
+                    }));
+            }
+            else
+            {
+                addScalarCleanupPasses(mpm);
+            }
 
             mpm.add(new BreakConstantExpr());
             mpm.add(new IGCConstProp(IGC_IS_FLAG_ENABLED(EnableSimplifyGEP)));
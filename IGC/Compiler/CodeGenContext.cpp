@@ -795,6 +795,11 @@ namespace IGC
         return false;
     }
 
+    bool CodeGenContext::isLICMAllowed() const
+    {
+        return IGC_IS_FLAG_ENABLED(allowLICM) && !m_disableLICM;
+    }
+
     /// parameter "returnDefault" controls what to return when
     /// there is no user-forced setting
     uint32_t CodeGenContext::getNumGRFPerThread(bool returnDefault)
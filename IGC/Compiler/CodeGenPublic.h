@@ -904,6 +904,12 @@ namespace IGC
         bool m_hasStackCalls = false;
         // Flag to determine if early Z culling should be called for certain patterns
         bool m_ForceEarlyZMathCheck = false;
+        // Per-compilation overrides of the FastCompileRA, HybridRAWithSpill and
+        // allowLICM regkeys chosen by the legalization heuristics. They live in the
+        // context so that concurrent compilations do not see each other's choices.
+        bool m_forceFastCompileRA = false;
+        bool m_forceHybridRAWithSpill = false;
+        bool m_disableLICM = false;
         // Adding multiversioning to partially redundant samples, if AIL is on.
         bool m_enableSampleMultiversioning = false;
 
@@ -1098,6 +1104,7 @@ namespace IGC
         virtual uint32_t getPrivateMemoryMinimalSizePerThread() const;
         virtual uint32_t getIntelScratchSpacePrivateMemoryMinimalSizePerThread() const;
         virtual bool enableZEBinary() const;
+        bool isLICMAllowed() const;
         bool isPOSH() const;
 
         UserAddrSpaceMD& getUserAddrSpaceMD() {
@@ -245,3 +245,4 @@ void initializeHandleSpirvDecorationMetadataPass(llvm::PassRegistry&);
 void initializeNontemporalLoadsAndStoresInAssertPass(llvm::PassRegistry&);
 void initializeHandleDevicelibAssertPass(llvm::PassRegistry&);
 void initializeStackOverflowDetectionPassPass(llvm::PassRegistry &);
+void initializeParallelFunctionPipelineTestPass(llvm::PassRegistry&);
@@ -23,6 +23,7 @@ SPDX-License-Identifier: MIT
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/Debug.h"
 #include "common/LLVMWarningsPop.hpp"
 #include "AdaptorCommon/ImplicitArgs.hpp"
 #include "AdaptorCommon/AddImplicitArgs.hpp"
@@ -41,6 +42,8 @@ SPDX-License-Identifier: MIT
 #include "AdaptorOCL/OCL/BuiltinResource.h"
 #include "AdaptorOCL/OCL/LoadBuffer.h"
 
+#include <mutex>
+#include <optional>
 #include <vector>
 #include <utility>
 
@@ -53,6 +56,7 @@ using namespace IGC::IGCMD;
 #define PASS_DESCRIPTION "PreCompiledFuncImport"
 #define PASS_CFG_ONLY false
 #define PASS_ANALYSIS false
+#define DEBUG_TYPE PASS_FLAG
 IGC_INITIALIZE_PASS_BEGIN(PreCompiledFuncImport, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
@@ -625,6 +629,35 @@ void PreCompiledFuncImport::removeLLVMModuleFlag(Module* M)
     }
 }
 
+// The emulation libraries are embedded in the IGC binary. Each bitcode
+// container is indexed once per process, directly over the embedded array
+// without copying it. A compilation then only creates a lazy module from the
+// cached index, and the linker materializes just the referenced functions and
+// their transitive callees.
+static const BitcodeModule* getLibraryBitcode(
+    const LibraryModuleInfo& libInfo, int libIdx)
+{
+    static std::once_flag indexed[PreCompiledFuncImport::NUM_LIBMODS];
+    static std::optional<BitcodeModule> bitcode[PreCompiledFuncImport::NUM_LIBMODS];
+
+    std::call_once(indexed[libIdx], [&]()
+    {
+        MemoryBufferRef bufferRef(
+            StringRef((const char*)libInfo.Mod, libInfo.ModSize), "");
+        Expected<std::vector<BitcodeModule>> modulesOrErr = getBitcodeModuleList(bufferRef);
+        if (!modulesOrErr)
+        {
+            consumeError(modulesOrErr.takeError());
+            return;
+        }
+        if (modulesOrErr->size() == 1)
+        {
+            bitcode[libIdx].emplace(modulesOrErr->front());
+        }
+    });
+    return bitcode[libIdx] ? &*bitcode[libIdx] : nullptr;
+}
+
 bool PreCompiledFuncImport::runOnModule(Module& M)
 {
     m_pCtx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
@@ -651,7 +684,6 @@ bool PreCompiledFuncImport::runOnModule(Module& M)
 
     for (int i = 0; i < NUM_LIBMODS; ++i) {
         m_libModuleToBeImported[i] = false;
-        m_libModuleAlreadyImported[i] = false;
     }
     m_allNewCallInsts.clear();
 
@@ -686,22 +718,25 @@ bool PreCompiledFuncImport::runOnModule(Module& M)
                     continue;
                 }
 
-                if (m_libModuleAlreadyImported[i])
+                const BitcodeModule* libBitcode = getLibraryBitcode(m_libModInfos[i], i);
+                IGC_ASSERT_MESSAGE(libBitcode, "llvm version mismatch - could not load llvm module");
+                if (!libBitcode)
+                {
                     continue;
+                }
 
-                const char* pLibraryModule = (const char*)m_libModInfos[i].Mod;
-                uint32_t libSize = m_libModInfos[i].ModSize;
-
-                // Load the module we want to compile and link it to existing module
-                StringRef BitRef(pLibraryModule, libSize);
+                // BitcodeModule only refers to the embedded array, so the lazy
+                // module is created from a local copy of the shared index.
+                BitcodeModule libBitcodeCopy = *libBitcode;
                 llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-                    llvm::parseBitcodeFile(MemoryBufferRef(BitRef.str(), ""), M.getContext());
+                    libBitcodeCopy.getLazyModule(M.getContext(), false, false);
                 if (llvm::Error EC = ModuleOrErr.takeError())
                 {
-                    IGC_ASSERT_MESSAGE(0, "llvm getLazyBitcodeModule - FAILED to parse bitcode");
+                    consumeError(std::move(EC));
+                    IGC_ASSERT_MESSAGE(0, "llvm getLazyModule - FAILED to parse bitcode");
+                    continue;
                 }
                 std::unique_ptr<llvm::Module> m_pBuiltinModule = std::move(*ModuleOrErr);
-                IGC_ASSERT_MESSAGE(m_pBuiltinModule, "llvm version mismatch - could not load llvm module");
 
                 // Set target triple and datalayout to the original module (emulation func
                 // works for both 64 & 32 bit applications).
@@ -709,12 +744,29 @@ bool PreCompiledFuncImport::runOnModule(Module& M)
                 m_pBuiltinModule->setTargetTriple(M.getTargetTriple());
                 removeLLVMModuleFlag(m_pBuiltinModule.get());
 
-                // Linking the two modules
-                if (ld.linkInModule(std::move(m_pBuiltinModule)))
+                SmallPtrSet<Function*, 32> definedBeforeLink;
+                LLVM_DEBUG(
+                    for (Function& F : M)
+                    {
+                        if (!F.isDeclaration())
+                            definedBeforeLink.insert(&F);
+                    });
+
+                // Link in only the functions the module refers to. A library
+                // may be linked again on the second round; functions already
+                // defined by the first round are reused.
+                if (ld.linkInModule(std::move(m_pBuiltinModule), llvm::Linker::LinkOnlyNeeded))
                 {
                     IGC_ASSERT_MESSAGE(0, "Error linking the two modules");
                 }
-                m_libModuleAlreadyImported[i] = true;
+
+                LLVM_DEBUG(
+                    for (Function& F : M)
+                    {
+                        if (!F.isDeclaration() && !definedBeforeLink.count(&F))
+                            dbgs() << "PreCompiledFuncImport: library " << i
+                                   << " materialized " << F.getName() << "\n";
+                    });
                 m_pBuiltinModule = nullptr;
             }
         }
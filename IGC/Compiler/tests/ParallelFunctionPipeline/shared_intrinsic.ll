@@ -0,0 +1,42 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2023 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+;
+; REQUIRES: llvm-14-plus
+;
+; RUN: igc_opt --igc-parallel-function-pipeline-test -S < %s | FileCheck %s
+; ------------------------------------------------
+; ParallelFunctionPipeline
+; ------------------------------------------------
+
+; test_a and test_b are optimized in separate function groups, and instcombine
+; turns the select in each of them into a call to llvm.abs.i32, which the
+; module didn't declare. Both calls must be merged back to the same
+; declaration rather than to a renamed copy.
+
+; CHECK-LABEL: define i32 @test_a(
+; CHECK: call i32 @llvm.abs.i32(i32 %x,
+; CHECK-LABEL: define i32 @test_b(
+; CHECK: call i32 @llvm.abs.i32(i32 %y,
+; CHECK-NOT: @llvm.abs.i32.1
+; CHECK: declare i32 @llvm.abs.i32(i32, i1
+; CHECK-NOT: @llvm.abs.i32.1
+
+define i32 @test_a(i32 %x) {
+  %neg = sub nsw i32 0, %x
+  %cmp = icmp slt i32 %x, 0
+  %abs = select i1 %cmp, i32 %neg, i32 %x
+  ret i32 %abs
+}
+
+define i32 @test_b(i32 %y) {
+  %neg = sub nsw i32 0, %y
+  %cmp = icmp slt i32 %y, 0
+  %abs = select i1 %cmp, i32 %neg, i32 %y
+  %res = add i32 %abs, 1
+  ret i32 %res
+}
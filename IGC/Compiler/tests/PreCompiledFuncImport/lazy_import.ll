@@ -0,0 +1,37 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2023 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+; REQUIRES: regkeys
+;
+; RUN: igc_opt -regkey TestIGCPreCompiledFunctions=1 --platformdg2 --igc-precompiled-import -S < %s 2>&1 | FileCheck %s
+; ------------------------------------------------
+; PreCompiledFuncImport
+; ------------------------------------------------
+
+; Emulation libraries are linked lazily: only the functions referenced by the
+; module are materialized. dp_add/dp_sub and dp_fma/dp_mul share libraries,
+; and only dp_add and dp_fma are used here.
+
+define void @test(double addrspace(1)* %p, double %a, double %b, double %c) #0 {
+entry:
+; CHECK-LABEL: @test
+; CHECK: call double @__igcbuiltin_dp_add(
+; CHECK: call double @__igcbuiltin_dp_fma(
+  %add = fadd double %a, %b
+  %fma = call double @llvm.fma.f64(double %add, double %b, double %c)
+  store double %fma, double addrspace(1)* %p, align 8
+  ret void
+}
+
+declare double @llvm.fma.f64(double, double, double)
+
+; CHECK-DAG: define internal double @__igcbuiltin_dp_add(
+; CHECK-DAG: define internal double @__igcbuiltin_dp_fma(
+; CHECK-NOT: define {{.*}} @__igcbuiltin_dp_sub(
+; CHECK-NOT: define {{.*}} @__igcbuiltin_dp_mul(
+
+attributes #0 = { nounwind }
@@ -0,0 +1,37 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2023 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+; REQUIRES: debug, regkeys
+;
+; RUN: igc_opt -regkey TestIGCPreCompiledFunctions=1 --platformdg2 --igc-precompiled-import -debug-only=igc-precompiled-import -disable-output < %s 2>&1 | FileCheck %s
+; ------------------------------------------------
+; PreCompiledFuncImport
+; ------------------------------------------------
+
+; The pass erases unused library functions after linking, so the final IR
+; looks the same whether a library is linked whole or lazily. Check the
+; functions materialized by the linker instead: dp_sub and dp_mul live in the
+; same libraries as dp_add and dp_fma but are never pulled in.
+
+; CHECK-NOT: materialized __igcbuiltin_dp_sub
+; CHECK-NOT: materialized __igcbuiltin_dp_mul
+; CHECK-DAG: materialized __igcbuiltin_dp_add
+; CHECK-DAG: materialized __igcbuiltin_dp_fma
+; CHECK-NOT: materialized __igcbuiltin_dp_sub
+; CHECK-NOT: materialized __igcbuiltin_dp_mul
+
+define void @test(double addrspace(1)* %p, double %a, double %b, double %c) #0 {
+entry:
+  %add = fadd double %a, %b
+  %fma = call double @llvm.fma.f64(double %add, double %b, double %c)
+  store double %fma, double addrspace(1)* %p, align 8
+  ret void
+}
+
+declare double @llvm.fma.f64(double, double, double)
+
+attributes #0 = { nounwind }
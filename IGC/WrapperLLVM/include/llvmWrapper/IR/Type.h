@@ -20,6 +20,16 @@ namespace IGCLLVM {
         return PtrTy->getPointerElementType();
 #else
         return PtrTy->getNonOpaquePointerElementType();
+#endif
+    }
+
+    inline bool isOpaquePointerTy(const llvm::Type *Ty) {
+#if LLVM_VERSION_MAJOR < 14
+        return false;
+#elif LLVM_VERSION_MAJOR < 17
+        return Ty->isOpaquePointerTy();
+#else
+        return Ty->isPointerTy();
 #endif
     }
 }
@@ -0,0 +1,35 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#ifndef IGCLLVM_SUPPORT_THREADPOOL_H
+#define IGCLLVM_SUPPORT_THREADPOOL_H
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include <memory>
+
+namespace IGCLLVM {
+#if LLVM_VERSION_MAJOR >= 18
+using ThreadPool = llvm::StdThreadPool;
+#else
+using ThreadPool = llvm::ThreadPool;
+#endif
+
+// Creates a pool of at most NumThreads worker threads.
+inline std::unique_ptr<ThreadPool> createThreadPool(unsigned NumThreads) {
+#if LLVM_VERSION_MAJOR < 10
+  return std::make_unique<ThreadPool>(NumThreads);
+#else
+  return std::make_unique<ThreadPool>(llvm::hardware_concurrency(NumThreads));
+#endif
+}
+} // namespace IGCLLVM
+
+#endif // IGCLLVM_SUPPORT_THREADPOOL_H
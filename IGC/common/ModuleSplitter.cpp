@@ -8,14 +8,30 @@ SPDX-License-Identifier: MIT
 
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/ADT/SetVector.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/InstIterator.h>
+#include <llvm/Support/raw_ostream.h>
 #include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
 #include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/InstCombine/InstCombine.h>
+#include <llvmWrapper/IR/DerivedTypes.h>
+#include <llvmWrapper/IR/Module.h>
+#include <llvmWrapper/IR/Type.h>
+#include <llvmWrapper/Support/ThreadPool.h>
+#include <llvmWrapper/Transforms/Utils/Cloning.h>
 #include "common/LLVMWarningsPop.hpp"
 
+#include <algorithm>
+#include <numeric>
+
 #include <common/LLVMUtils.h>
+#include <common/Stats.hpp>
 #include <common/ModuleSplitter.h>
 #include <Compiler/CodeGenPublic.h>
+#include <Compiler/CodeGenContextWrapper.hpp>
+#include <Compiler/IGCPassSupport.h>
 #include "Compiler/CISACodeGen/OpenCLKernelCodeGen.hpp"
 
 namespace IGC {
@@ -111,4 +127,559 @@ void KernelModuleSplitter::setSplittedModuleInOCLContext()
         _oclContext.setModule(_splittedModule.get());
     }
 }
-} // namespace IGC
\ No newline at end of file
+
+namespace {
+using namespace llvm;
+
+// Identified struct types of a worker module are renamed to
+// "<prefix><index>" before the module is sent back, so that they can be
+// matched with the original types after being parsed into the original
+// context (where the original names are already taken).
+const char* const StructTokenPrefix = "__igc.pfp.";
+
+// Optimized bodies of one group of functions, as produced by a worker.
+struct OptimizedGroup
+{
+    std::string bitcode;
+    // Original names of the identified struct types, indexed by token.
+    std::vector<std::string> structNames;
+    std::string error;
+};
+
+// Maps the token struct types of a parsed worker module to the original
+// types, rebuilding derived types that contain them.
+class TokenTypeRemapper : public ValueMapTypeRemapper
+{
+public:
+    bool init(Module& M, Module& OptM, const std::vector<std::string>& structNames)
+    {
+        for (StructType* ST : OptM.getIdentifiedStructTypes())
+        {
+            StringRef name = ST->getName();
+            unsigned idx = 0;
+            if (!name.consume_front(StructTokenPrefix) ||
+                name.consumeInteger(10, idx) ||
+                idx >= structNames.size())
+            {
+                return false;
+            }
+            StructType* origST = IGCLLVM::getTypeByName(M, structNames[idx]);
+            if (!origST)
+            {
+                return false;
+            }
+            m_typeMap[ST] = origST;
+        }
+        return true;
+    }
+
+    bool empty() const { return m_typeMap.empty(); }
+
+    Type* remapType(Type* Ty) override
+    {
+        auto it = m_typeMap.find(Ty);
+        if (it != m_typeMap.end())
+        {
+            return it->second;
+        }
+
+        Type* newTy = Ty;
+        if (auto* ST = dyn_cast<StructType>(Ty))
+        {
+            // Identified structs are all in the map already.
+            if (ST->isLiteral())
+            {
+                SmallVector<Type*, 8> elts;
+                for (Type* eltTy : ST->elements())
+                    elts.push_back(remapType(eltTy));
+                newTy = StructType::get(Ty->getContext(), elts, ST->isPacked());
+            }
+        }
+        else if (Ty->isPointerTy() && !IGCLLVM::isOpaquePointerTy(Ty))
+        {
+            newTy = PointerType::get(
+                remapType(IGCLLVM::getNonOpaquePtrEltTy(Ty)), Ty->getPointerAddressSpace());
+        }
+        else if (auto* AT = dyn_cast<ArrayType>(Ty))
+        {
+            newTy = ArrayType::get(remapType(AT->getElementType()), AT->getNumElements());
+        }
+        else if (auto* VT = dyn_cast<IGCLLVM::FixedVectorType>(Ty))
+        {
+            newTy = IGCLLVM::FixedVectorType::get(remapType(VT->getElementType()), VT->getNumElements());
+        }
+        else if (auto* FT = dyn_cast<FunctionType>(Ty))
+        {
+            SmallVector<Type*, 8> params;
+            for (Type* paramTy : FT->params())
+                params.push_back(remapType(paramTy));
+            newTy = FunctionType::get(remapType(FT->getReturnType()), params, FT->isVarArg());
+        }
+
+        m_typeMap[Ty] = newTy;
+        return newTy;
+    }
+
+private:
+    DenseMap<Type*, Type*> m_typeMap;
+};
+
+// Mapping of a parsed worker module onto the original module.
+struct GroupMapping
+{
+    TokenTypeRemapper types;
+    ValueToValueMapTy values;
+};
+
+class ParallelFunctionPipeline : public ModulePass
+{
+public:
+    static char ID;
+
+    ParallelFunctionPipeline(
+        CodeGenContext* pContext, unsigned numThreads, unsigned minInstsPerThread,
+        FunctionPipelineBuilder addPasses)
+        : ModulePass(ID), m_pContext(pContext), m_numThreads(numThreads),
+          m_minInstsPerThread(minInstsPerThread), m_addPasses(std::move(addPasses))
+    {}
+
+    StringRef getPassName() const override { return "ParallelFunctionPipeline"; }
+
+    bool runOnModule(Module& M) override;
+
+private:
+    bool canRunInParallel(const Module& M) const;
+    std::vector<std::vector<unsigned>> partitionFunctions(const Module& M) const;
+    OptimizedGroup optimizeGroup(StringRef bitcode, const std::vector<unsigned>& group) const;
+    bool mapGroup(Module& M, Module& OptM, const OptimizedGroup& result, GroupMapping& mapping) const;
+    void mergeGroup(Module& M, Module& OptM, GroupMapping& mapping) const;
+    bool runSerially(Module& M) const;
+
+    CodeGenContext* const m_pContext;
+    const unsigned m_numThreads;
+    const unsigned m_minInstsPerThread;
+    const FunctionPipelineBuilder m_addPasses;
+};
+
+char ParallelFunctionPipeline::ID = 0;
+
+bool ParallelFunctionPipeline::canRunInParallel(const Module& M) const
+{
+    if (m_pContext->m_hasLegacyDebugInfo || M.getNamedMetadata("llvm.dbg.cu"))
+    {
+        return false;
+    }
+    for (StructType* ST : M.getIdentifiedStructTypes())
+    {
+        if (!ST->hasName())
+            return false;
+    }
+    for (const GlobalAlias& GA : M.aliases())
+    {
+        if (!GA.hasName())
+            return false;
+    }
+    for (const Function& F : M)
+    {
+        if (!F.hasName())
+            return false;
+        for (const BasicBlock& BB : F)
+        {
+            if (BB.hasAddressTaken())
+                return false;
+        }
+    }
+    return true;
+}
+
+// Groups the defined functions that reference each other and distributes the
+// groups over at most m_numThreads buckets of similar instruction count. Each
+// bucket gets at least m_minInstsPerThread instructions, so that the bitcode
+// round trip of every worker is paid for by the passes it runs.
+// Functions are identified by their position in the module function list,
+// which is preserved by the bitcode round trip.
+std::vector<std::vector<unsigned>> ParallelFunctionPipeline::partitionFunctions(const Module& M) const
+{
+    DenseMap<const Function*, unsigned> funcIdx;
+    std::vector<const Function*> funcs;
+    for (const Function& F : M)
+    {
+        funcIdx[&F] = funcs.size();
+        funcs.push_back(&F);
+    }
+
+    std::vector<unsigned> leader(funcs.size());
+    std::iota(leader.begin(), leader.end(), 0);
+    auto findLeader = [&](unsigned idx) {
+        while (leader[idx] != idx)
+        {
+            leader[idx] = leader[leader[idx]];
+            idx = leader[idx];
+        }
+        return idx;
+    };
+
+    for (unsigned idx = 0; idx < funcs.size(); ++idx)
+    {
+        if (funcs[idx]->isDeclaration())
+            continue;
+        for (const Instruction& I : instructions(funcs[idx]))
+        {
+            for (const Value* Op : I.operands())
+            {
+                auto* Callee = dyn_cast<Function>(Op->stripPointerCasts());
+                if (Callee && !Callee->isDeclaration())
+                    leader[findLeader(funcIdx[Callee])] = findLeader(idx);
+            }
+        }
+    }
+
+    DenseMap<unsigned, unsigned> groupOfLeader;
+    std::vector<std::pair<size_t, std::vector<unsigned>>> groups;
+    for (unsigned idx = 0; idx < funcs.size(); ++idx)
+    {
+        if (funcs[idx]->isDeclaration())
+            continue;
+        auto res = groupOfLeader.try_emplace(findLeader(idx), groups.size());
+        if (res.second)
+            groups.emplace_back();
+        auto& group = groups[res.first->second];
+        group.first += funcs[idx]->getInstructionCount();
+        group.second.push_back(idx);
+    }
+
+    std::vector<std::vector<unsigned>> buckets;
+    size_t numInsts = 0;
+    for (auto& group : groups)
+        numInsts += group.first;
+    size_t numBuckets = std::min<size_t>(m_numThreads, groups.size());
+    if (m_minInstsPerThread > 0)
+        numBuckets = std::min<size_t>(numBuckets, numInsts / m_minInstsPerThread);
+    if (numBuckets < 2)
+    {
+        return buckets;
+    }
+
+    std::stable_sort(groups.begin(), groups.end(),
+        [](const auto& a, const auto& b) { return a.first > b.first; });
+    buckets.resize(numBuckets);
+    std::vector<size_t> load(buckets.size(), 0);
+    for (auto& group : groups)
+    {
+        size_t b = std::min_element(load.begin(), load.end()) - load.begin();
+        load[b] += group.first;
+        buckets[b].insert(buckets[b].end(), group.second.begin(), group.second.end());
+    }
+    for (auto& bucket : buckets)
+        std::sort(bucket.begin(), bucket.end());
+    return buckets;
+}
+
+OptimizedGroup ParallelFunctionPipeline::optimizeGroup(
+    StringRef bitcode, const std::vector<unsigned>& group) const
+{
+    OptimizedGroup result;
+    LLVMContext context;
+#ifdef __IGC_OPAQUE_POINTERS_FORCE_DISABLED__
+    context.setOpaquePointers(false);
+#endif
+    Expected<std::unique_ptr<Module>> moduleOrErr =
+        getLazyBitcodeModule(MemoryBufferRef(bitcode, "ParallelFunctionPipeline"), context);
+    if (!moduleOrErr)
+    {
+        result.error = toString(moduleOrErr.takeError());
+        return result;
+    }
+    std::unique_ptr<Module> M = std::move(*moduleOrErr);
+
+    // Materialize only the bodies of this group; everything else becomes a
+    // declaration.
+    unsigned idx = 0;
+    auto groupIt = group.begin();
+    for (Function& F : *M)
+    {
+        if (groupIt != group.end() && *groupIt == idx)
+        {
+            if (Error E = F.materialize())
+            {
+                result.error = toString(std::move(E));
+                return result;
+            }
+            ++groupIt;
+        }
+        else if (!F.isDeclaration())
+        {
+            F.deleteBody();
+        }
+        ++idx;
+    }
+    if (Error E = M->materializeAll())
+    {
+        result.error = toString(std::move(E));
+        return result;
+    }
+
+    legacy::FunctionPassManager FPM(M.get());
+    m_addPasses(FPM);
+    FPM.doInitialization();
+    for (Function& F : *M)
+    {
+        if (!F.isDeclaration())
+            FPM.run(F);
+    }
+    FPM.doFinalization();
+
+    for (StructType* ST : M->getIdentifiedStructTypes())
+    {
+        const size_t token = result.structNames.size();
+        result.structNames.push_back(ST->getName().str());
+        ST->setName((StructTokenPrefix + Twine(token)).str());
+    }
+
+    raw_string_ostream OS(result.bitcode);
+    WriteBitcodeToFile(*M, OS);
+    OS.flush();
+    return result;
+}
+
+// Maps the types and global values referenced by OptM onto M. Returns false
+// if OptM cannot be mapped; M is not changed either way.
+bool ParallelFunctionPipeline::mapGroup(
+    Module& M, Module& OptM, const OptimizedGroup& result, GroupMapping& mapping) const
+{
+    if (!mapping.types.init(M, OptM, result.structNames))
+    {
+        return false;
+    }
+
+    // Function passes do not add or remove global variables, so they keep
+    // their order (and are matched by position, as they may be unnamed).
+    if (M.global_size() != OptM.global_size())
+    {
+        return false;
+    }
+    for (auto it = std::make_pair(M.global_begin(), OptM.global_begin());
+         it.first != M.global_end();
+         ++it.first, ++it.second)
+    {
+        if (it.first->getName() != it.second->getName())
+            return false;
+        mapping.values[&*it.second] = &*it.first;
+    }
+    for (GlobalAlias& GA : OptM.aliases())
+    {
+        GlobalAlias* origGA = M.getNamedAlias(GA.getName());
+        if (!origGA)
+            return false;
+        mapping.values[&GA] = origGA;
+    }
+    for (Function& F : OptM)
+    {
+        Function* origF = M.getFunction(F.getName());
+        if (origF)
+            mapping.values[&F] = origF;
+        else if (!F.isDeclaration())
+            return false;
+    }
+    return true;
+}
+
+// Moves the optimized bodies of OptM into the corresponding functions of M.
+void ParallelFunctionPipeline::mergeGroup(Module& M, Module& OptM, GroupMapping& mapping) const
+{
+    ValueToValueMapTy& VMap = mapping.values;
+    for (Function& F : OptM)
+    {
+        if (!VMap.count(&F))
+        {
+            // Declaration added by the pipeline, e.g. an intrinsic. The groups
+            // are mapped before any is merged, so a group merged earlier may
+            // have added it to M already.
+            FunctionType* FTy = cast<FunctionType>(mapping.types.remapType(F.getFunctionType()));
+            if (Function* existingF = M.getFunction(F.getName()))
+            {
+                if (existingF->getFunctionType() == FTy)
+                    VMap[&F] = existingF;
+                else
+                    VMap[&F] = ConstantExpr::getBitCast(
+                        existingF, PointerType::get(FTy, existingF->getAddressSpace()));
+                continue;
+            }
+            Function* newF = Function::Create(FTy, F.getLinkage(), F.getName(), &M);
+            newF->setAttributes(F.getAttributes());
+            VMap[&F] = newF;
+        }
+    }
+
+    ValueMapTypeRemapper* TypeMapper = mapping.types.empty() ? nullptr : &mapping.types;
+    for (Function& F : OptM)
+    {
+        if (F.isDeclaration())
+            continue;
+
+        // Keep everything but the body of the original function.
+        Function* origF = cast<Function>(VMap[&F]);
+        const GlobalValue::LinkageTypes linkage = origF->getLinkage();
+        const AttributeList attrs = origF->getAttributes();
+        SmallVector<std::pair<unsigned, MDNode*>, 4> MDs;
+        origF->getAllMetadata(MDs);
+
+        origF->deleteBody();
+        for (auto args = std::make_pair(F.arg_begin(), origF->arg_begin());
+             args.first != F.arg_end();
+             ++args.first, ++args.second)
+        {
+            VMap[&*args.first] = &*args.second;
+        }
+        SmallVector<ReturnInst*, 8> returns;
+        IGCLLVM::CloneFunctionInto(origF, &F, VMap,
+            IGCLLVM::CloneFunctionChangeType::DifferentModule, returns, "", nullptr, TypeMapper);
+
+        origF->setLinkage(linkage);
+        origF->setAttributes(attrs);
+        origF->clearMetadata();
+        for (auto& MD : MDs)
+            origF->setMetadata(MD.first, MD.second);
+    }
+}
+
+bool ParallelFunctionPipeline::runSerially(Module& M) const
+{
+    legacy::FunctionPassManager FPM(&M);
+    m_addPasses(FPM);
+    bool changed = FPM.doInitialization();
+    for (Function& F : M)
+    {
+        if (!F.isDeclaration())
+            changed |= FPM.run(F);
+    }
+    changed |= FPM.doFinalization();
+    return changed;
+}
+
+bool ParallelFunctionPipeline::runOnModule(Module& M)
+{
+    std::vector<std::vector<unsigned>> buckets;
+    if (m_numThreads > 1 && canRunInParallel(M))
+    {
+        buckets = partitionFunctions(M);
+    }
+    if (buckets.size() < 2)
+    {
+        return runSerially(M);
+    }
+
+    std::string bitcode;
+    {
+        raw_string_ostream OS(bitcode);
+        WriteBitcodeToFile(M, OS);
+    }
+
+    std::vector<OptimizedGroup> results(buckets.size());
+    {
+        auto pool = IGCLLVM::createThreadPool(static_cast<unsigned>(buckets.size()));
+        for (unsigned i = 0; i < buckets.size(); ++i)
+        {
+            pool->async([&, i]() {
+                CompileTrace::Scope traceGroup("IGC", "ParallelFunctionGroup");
+                results[i] = optimizeGroup(bitcode, buckets[i]);
+            });
+        }
+        pool->wait();
+    }
+
+    // Parse every result before changing M, so that any failure can still
+    // fall back to the serial pipeline on the unmodified module.
+    std::vector<std::unique_ptr<Module>> optModules;
+    for (auto& result : results)
+    {
+        if (!result.error.empty())
+        {
+            IGC_ASSERT_MESSAGE(0, result.error.c_str());
+            return runSerially(M);
+        }
+        Expected<std::unique_ptr<Module>> moduleOrErr = parseBitcodeFile(
+            MemoryBufferRef(result.bitcode, "ParallelFunctionPipeline"), M.getContext());
+        if (!moduleOrErr)
+        {
+            IGC_ASSERT_MESSAGE(0, toString(moduleOrErr.takeError()).c_str());
+            return runSerially(M);
+        }
+        optModules.push_back(std::move(*moduleOrErr));
+    }
+
+    std::vector<std::unique_ptr<GroupMapping>> mappings;
+    for (unsigned i = 0; i < optModules.size(); ++i)
+    {
+        mappings.push_back(std::make_unique<GroupMapping>());
+        if (!mapGroup(M, *optModules[i], results[i], *mappings.back()))
+        {
+            IGC_ASSERT_MESSAGE(0, "Cannot map parallel function pipeline results");
+            return runSerially(M);
+        }
+    }
+
+    CompileTrace::Scope traceMerge("IGC", "ParallelFunctionMerge");
+    for (unsigned i = 0; i < optModules.size(); ++i)
+    {
+        mergeGroup(M, *optModules[i], *mappings[i]);
+    }
+    return true;
+}
+
+// Runs instcombine through the parallel function pipeline, so that igc_opt
+// tests can check how the optimized groups are merged back.
+class ParallelFunctionPipelineTest : public ModulePass
+{
+public:
+    static char ID;
+
+    ParallelFunctionPipelineTest() : ModulePass(ID)
+    {
+        initializeParallelFunctionPipelineTestPass(*PassRegistry::getPassRegistry());
+    }
+
+    StringRef getPassName() const override
+    {
+        return "ParallelFunctionPipelineTest";
+    }
+
+    void getAnalysisUsage(AnalysisUsage& AU) const override
+    {
+        AU.addRequired<CodeGenContextWrapper>();
+    }
+
+    bool runOnModule(Module& M) override
+    {
+        ParallelFunctionPipeline pipeline(
+            getAnalysis<CodeGenContextWrapper>().getCodeGenContext(), 4, 0,
+            [](legacy::PassManagerBase& PM) { PM.add(createInstructionCombiningPass()); });
+        return pipeline.runOnModule(M);
+    }
+};
+
+char ParallelFunctionPipelineTest::ID = 0;
+} // namespace
+} // namespace IGC
+
+using namespace llvm;
+using namespace IGC;
+
+#define PASS_FLAG "igc-parallel-function-pipeline-test"
+#define PASS_DESCRIPTION "Run instcombine through the parallel function pipeline"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+IGC_INITIALIZE_PASS_BEGIN(ParallelFunctionPipelineTest, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_END(ParallelFunctionPipelineTest, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+
+namespace IGC {
+llvm::ModulePass* createParallelFunctionPipelinePass(
+    CodeGenContext* pContext,
+    unsigned numThreads,
+    unsigned minInstsPerThread,
+    FunctionPipelineBuilder addPasses)
+{
+    return new ParallelFunctionPipeline(pContext, numThreads, minInstsPerThread, std::move(addPasses));
+}
+} // namespace IGC
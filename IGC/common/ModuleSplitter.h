@@ -10,6 +10,13 @@ SPDX-License-Identifier: MIT
 
 #include <Compiler/CodeGenPublic.h>
 
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Pass.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <functional>
+
 namespace IGC {
 // Class for splitting llvm::Module per kernel
 // handles splitting, owns split module, handles proper cleanup
@@ -28,4 +35,29 @@ private:
     llvm::Module& _originalModule;
     std::unique_ptr<llvm::Module> _splittedModule;
 };
-} // namespace IGC
\ No newline at end of file
+
+// Adds the function passes (and the immutable analyses they need) that the
+// parallel function pipeline runs on every defined function.
+using FunctionPipelineBuilder = std::function<void(llvm::legacy::PassManagerBase&)>;
+
+// Runs a pipeline of function passes over all defined functions of a module,
+// optimizing independent function groups concurrently.
+//
+// Functions are grouped by the call graph (a kernel together with the
+// functions it calls). Every group is materialized from a bitcode snapshot of
+// the module into a private LLVMContext on a worker thread, optimized there,
+// and the resulting bodies are moved back into the original functions, so the
+// llvm::Function objects and the IGC metadata keyed by them stay valid.
+//
+// The pipeline may only contain passes that change nothing outside the
+// function they run on and that treat the CodeGenContext as read-only.
+// Modules with debug info, block addresses or unnamed identified struct types,
+// and modules with a single function group, are optimized serially. Modules
+// are also optimized serially when they are too small to give every worker
+// minInstsPerThread instructions (0 - no limit).
+llvm::ModulePass* createParallelFunctionPipelinePass(
+    CodeGenContext* pContext,
+    unsigned numThreads,
+    unsigned minInstsPerThread,
+    FunctionPipelineBuilder addPasses);
+} // namespace IGC
@@ -299,6 +299,39 @@ const char* g_cCompTimeIntervals[MAX_COMPILE_TIME_INTERVALS+1] =
 #undef DEFINE_TIME_STAT
 };
 
+// Start times of the intervals and passes traced on this thread; a time of 0
+// means the interval was not started while tracing was enabled.
+static thread_local uint64_t s_traceIntervalStart[MAX_COMPILE_TIME_INTERVALS];
+static thread_local std::vector<uint64_t> s_tracePassStart;
+
+void compileTraceIntervalStart(COMPILE_TIME_INTERVALS cti)
+{
+    s_traceIntervalStart[cti] = CompileTrace::Recorder::get().now();
+}
+
+void compileTraceIntervalEnd(COMPILE_TIME_INTERVALS cti)
+{
+    if (s_traceIntervalStart[cti] != 0)
+    {
+        CompileTrace::Recorder::get().record("IGC", g_cCompTimeIntervals[cti], s_traceIntervalStart[cti]);
+        s_traceIntervalStart[cti] = 0;
+    }
+}
+
+void compileTracePassStart()
+{
+    s_tracePassStart.push_back(CompileTrace::Recorder::get().now());
+}
+
+void compileTracePassEnd(std::string const& passName)
+{
+    if (!s_tracePassStart.empty())
+    {
+        CompileTrace::Recorder::get().record("LLVM", passName, s_tracePassStart.back());
+        s_tracePassStart.pop_back();
+    }
+}
+
 std::string str(COMPILE_TIME_INTERVALS cti)
 {
     switch (cti)
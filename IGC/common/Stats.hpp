@@ -25,6 +25,7 @@ SPDX-License-Identifier: MIT
 #include "common/MemStats.h"
 
 #include "AdaptorCommon/customApi.hpp"
+#include "CompileTrace.h"
 
 #include <3d/common/iStdLib/utility.h>
 
@@ -184,6 +185,14 @@ bool isDashboardTimer( COMPILE_TIME_INTERVALS cti );
 COMPILE_TIME_INTERVALS parentInterval( COMPILE_TIME_INTERVALS cti );
 int parentIntervalDepth( COMPILE_TIME_INTERVALS cti );
 
+// CompileTrace recording of the COMPILER_TIME_* intervals and passes. Unlike
+// TimeStats it does not need m_compilerTimeStats, so it also works in release
+// drivers (see CompileTraceFile).
+void compileTraceIntervalStart( COMPILE_TIME_INTERVALS cti );
+void compileTraceIntervalEnd( COMPILE_TIME_INTERVALS cti );
+void compileTracePassStart();
+void compileTracePassEnd( std::string const& passName );
+
 #if GET_TIME_STATS
 
 struct PerPassTimeStat
@@ -282,6 +291,10 @@ private:
         { \
                 (pointer)->m_compilerTimeStats->recordTimerStart( compileTimeInterval );  \
         } \
+        if( CompileTrace::isEnabled() ) \
+        { \
+                compileTraceIntervalStart( compileTimeInterval ); \
+        } \
     } while (0)
 #define COMPILER_TIME_END( pointer, compileTimeInterval ) \
     do \
@@ -290,6 +303,10 @@ private:
         { \
                 (pointer)->m_compilerTimeStats->recordTimerEnd( compileTimeInterval ); \
         } \
+        if( CompileTrace::isEnabled() ) \
+        { \
+                compileTraceIntervalEnd( compileTimeInterval ); \
+        } \
     } while (0)
 
 #define COMPILER_TIME_PASS_START( pointer, name ) \
@@ -299,6 +316,10 @@ private:
         { \
                 (pointer)->m_compilerTimeStats->recordPerPassTimerStart( name );  \
         } \
+        if( CompileTrace::isEnabled( CompileTrace::Passes ) ) \
+        { \
+                compileTracePassStart(); \
+        } \
     } while (0)
 #define COMPILER_TIME_PASS_END( pointer, name ) \
     do \
@@ -307,6 +328,10 @@ private:
         { \
                 (pointer)->m_compilerTimeStats->recordPerPassTimerEnd( name ); \
         } \
+        if( CompileTrace::isEnabled( CompileTrace::Passes ) ) \
+        { \
+                compileTracePassEnd( name ); \
+        } \
     } while (0)
 
 #define COMPILER_TIME_SUM( pointerDst, pointerSrc ) \
@@ -513,6 +538,9 @@ protected:
     std::list<unsigned>::iterator iter;
 };
 
+// g_MemoryReport counts the allocations of the whole process, so it only
+// describes a single compilation when compilations do not overlap. Builds
+// that collect it serialize SPMD compilations (see TranslateBuildSPMD).
 extern CMemoryReport g_MemoryReport;
 // Helper functions
 void MemUsageSnapshot( IGC::SHADER_MEMORY_SNAPSHOT phase );
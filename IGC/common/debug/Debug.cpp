@@ -277,12 +277,14 @@ namespace {
 
 void RegisterErrHandlers()
 {
-    static bool executed = false;
-    if (!executed)
+    // Function-local static initialization is thread-safe, so concurrent
+    // compilations install the handler exactly once.
+    static const bool installed = []()
     {
         install_fatal_error_handler( FatalErrorHandler, nullptr );
-        executed = true;
-    }
+        return true;
+    }();
+    (void)installed;
 }
 
 void RegisterComputeErrHandlers(LLVMContext &C)
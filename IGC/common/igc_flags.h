@@ -41,8 +41,6 @@ DECLARE_IGC_REGKEY(bool, EnableIGAEncoder,              false, "Enable VISA IGA
 DECLARE_IGC_REGKEY(bool, EnableVISADumpCommonISA,       false, "Enable VISA Dump Common ISA", true)
 DECLARE_IGC_REGKEY(bool, DumpVISAASMToConsole,          false, "Dump VISAASM to console and do early exit", true)
 DECLARE_IGC_REGKEY(bool, DumpASMToConsole,              false, "Dump ASM to console and do early exit", true)
-DECLARE_IGC_REGKEY(bool, EnableVISABinary,              false, "Enable VISA Binary", true)
-DECLARE_IGC_REGKEY(bool, EnableVISAOutput,              false, "Enable VISA GenISA output", true)
 DECLARE_IGC_REGKEY(bool, EnableVISASlowpath,            false, "Enable VISA Slowpath. Needed to dump .visaasm", true)
 DECLARE_IGC_REGKEY(bool, EnableVISADotAll,              false, "Enable VISA DotAll. Dumps dot files for intermediate stages", false)
 DECLARE_IGC_REGKEY(bool, EnableVISADebug,               false, "Runs VISA in debug mode, all optimizations disabled", false)
@@ -358,6 +356,8 @@ DECLARE_IGC_REGKEY(DWORD, ShaderDumpEnableIGAJSON,      false, "adds IGA JSON ou
 DECLARE_IGC_REGKEY(bool, ShaderDumpEnableRAMetadata,   false, "adds RA Metadata file to shader dumps", true)
 DECLARE_IGC_REGKEY(bool,  ShaderDumpInstNamer,          false, "dump all unnamed LLVM IR instruction with variable names 'tmp' which makes easier for shaderoverriding", true)
 DECLARE_IGC_REGKEY(debugString, ShaderDumpFilter,       0,     "Only dump files matching the given regex", true)
+DECLARE_IGC_REGKEY(bool, EnableVISABinary,              false, "Enable VISA Binary", true)
+DECLARE_IGC_REGKEY(bool, EnableVISAOutput,              false, "Enable VISA GenISA output", true)
 DECLARE_IGC_REGKEY(bool, DumpZEInfoToConsole,           false, "Dump zeinfo to console", true)
 DECLARE_IGC_REGKEY(debugString, ProgbinDumpFileName,    0,     "Specify filename to use for dumping progbin file to current dir", true)
 DECLARE_IGC_REGKEY(bool, ElfDumpEnable,                 false, "dump ELF file", true)
@@ -390,6 +390,8 @@ DECLARE_IGC_REGKEY(bool, EnableScalarizerDebugLog,      false, "print step by st
 DECLARE_IGC_REGKEY(bool, DumpTimeStats,                 false, "Timing of translation, code generation, finalizer, etc", true)
 DECLARE_IGC_REGKEY(bool, DumpTimeStatsCoarse,           false, "Only collect/dump coarse level time stats, i.e. skip opt detail timer for now", true)
 DECLARE_IGC_REGKEY(bool, DumpTimeStatsPerPass,          false, "Collect Timing of IGC/LLVM passes", true)
+DECLARE_IGC_REGKEY(debugString, CompileTraceFile,     0,     "Record IGC, vISA and IGA compile phases per kernel/SIMD as Chrome trace events (chrome://tracing) and append them to this file", true)
+DECLARE_IGC_REGKEY(DWORD, CompileTraceLevel,            1,     "Detail of CompileTraceFile. 1 - IGC time stat intervals and vISA/IGA phases, 2 - also every IGC/LLVM pass", true)
 DECLARE_IGC_REGKEY(bool, DumpHasNonKernelArgLdSt,       false, "Print if hasNonKernelArg load/store to stderr", true)
 DECLARE_IGC_REGKEY(bool, PrintPsoDdiHash,               true,  "Print psoDDIHash in TimeStats_Shaders.csv file", true)
 DECLARE_IGC_REGKEY(bool, ShaderDataBaseStats,           false, "Enable gathering sends' sizes for shader statistics", false)
@@ -579,6 +581,13 @@ DECLARE_IGC_REGKEY(bool, ForceFormatConversionDG2Plus,  false,
 DECLARE_IGC_REGKEY(bool, EnableDivergentBarrierWA, false, "Generate continuation code to handle shaders that places barriers in divergent control flow", false)
 DECLARE_IGC_REGKEY(bool, ForcePrefetchToL1Cache, false, "Forces standard builtin prefetch to use L1 cache", true)
 DECLARE_IGC_REGKEY(bool, DisablePrefetchToL1Cache, false, "Disable prefetch to L1 cache", true)
+DECLARE_IGC_REGKEY(bool, EnableKernelBinaryCache,       false, "Enable the persistent on-disk cache of OCL program binaries keyed by input, options, spec constants, platform, IGC revision and the size and modification time of the IGC library. Builds without a known revision and builds with dumps enabled bypass it", true)
+DECLARE_IGC_REGKEY(debugString, KernelBinaryCacheDir,   0,     "Directory of the OCL program binary cache. Defaults to <user cache dir>/igc_kernel_cache", true)
+DECLARE_IGC_REGKEY(DWORD, KernelBinaryCacheMaxSizeMB,   256,   "Maximum size of the OCL program binary cache in MB; least recently used entries are evicted above it. 0 disables eviction", true)
+DECLARE_IGC_REGKEY(bool, KernelBinaryCacheVerbose,      false, "Print OCL program binary cache hits/misses and counters to stderr", true)
+DECLARE_IGC_REGKEY(DWORD, ParallelSIMDCompileThreads,   0, "Number of threads used to finalize the SIMD8/16/32 variants of OCL kernels in parallel. All candidate variants are emitted and the first successful one in 32-16-8 order is kept. 0 - disabled (serial SIMD selection)", true)
+DECLARE_IGC_REGKEY(DWORD, ParallelOptimizeIRThreads,    0, "Number of threads used to run the scalar cleanup part of OptimizeIR (Reassociate..ADCE) concurrently over independent kernel/function groups. 0 or 1 - disabled", true)
+DECLARE_IGC_REGKEY(DWORD, ParallelOptimizeIRMinInstsPerThread, 20000, "Minimum number of LLVM instructions each ParallelOptimizeIRThreads worker must get. Smaller modules use fewer workers or run serially, since each worker pays a bitcode round trip. 0 - no minimum", true)
 
 DECLARE_IGC_GROUP("Performance experiments")
 DECLARE_IGC_REGKEY(bool, ForceNonCoherentStatelessBTI,  false, "Enable gneeration of non cache coherent stateless messages", false)
@@ -0,0 +1,90 @@
+# ========================== begin_copyright_notice ============================
+#
+# Copyright (C) 2023 Intel Corporation
+#
+# SPDX-License-Identifier: MIT
+#
+# =========================== end_copyright_notice =============================
+
+# Compares a build that ran some of its work on a thread pool with the serial
+# build of the same input.
+#
+#   compare_parallel_build.py --event NAME [--event NAME ...] SERIAL PARALLEL
+#
+# SERIAL and PARALLEL are ocloc output directories, each holding the binaries
+# of one build and the trace.json written there through IGC_CompileTraceFile.
+# Both directories must have the same .bin files with the same contents, the
+# serial trace must not have any of the NAME events and the parallel trace
+# must have each of them.
+#
+# Prints the NAME events of the parallel trace as "NAME [kernel [simd]]", one
+# per line and sorted, so that the caller can check what ran on the pool.
+
+import argparse
+import filecmp
+import glob
+import json
+import os
+import sys
+
+
+def read_events(path, names):
+    # The trace is a Chrome trace array with one event per line; its closing
+    # ']' is optional and left out by CompileTrace.
+    events = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip().rstrip(',')
+            if not line.startswith('{'):
+                continue
+            event = json.loads(line)
+            if event['name'] not in names:
+                continue
+            args = event.get('args', {})
+            events.append(' '.join([event['name']] +
+                                   [str(args[a]) for a in ('kernel', 'simd')
+                                    if a in args]))
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--event', required=True, action='append')
+    parser.add_argument('serial')
+    parser.add_argument('parallel')
+    args = parser.parse_args()
+
+    failed = False
+    serial_bins = sorted(os.path.basename(p) for p in
+                         glob.glob(os.path.join(args.serial, '*.bin')))
+    parallel_bins = sorted(os.path.basename(p) for p in
+                           glob.glob(os.path.join(args.parallel, '*.bin')))
+    if not serial_bins or serial_bins != parallel_bins:
+        print('builds do not have the same binaries: %s vs %s' %
+              (serial_bins, parallel_bins))
+        failed = True
+    for name in serial_bins:
+        if name in parallel_bins and not filecmp.cmp(
+                os.path.join(args.serial, name),
+                os.path.join(args.parallel, name), shallow=False):
+            print('%s: parallel build differs from the serial one' % name)
+            failed = True
+
+    serial = read_events(os.path.join(args.serial, 'trace.json'), args.event)
+    parallel = read_events(os.path.join(args.parallel, 'trace.json'),
+                           args.event)
+    for name in args.event:
+        if any(e.split(' ')[0] == name for e in serial):
+            print('%s: found in the serial trace' % name)
+            failed = True
+        if not any(e.split(' ')[0] == name for e in parallel):
+            print('%s: not found in the parallel trace' % name)
+            failed = True
+
+    for event in sorted(parallel):
+        print(event)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
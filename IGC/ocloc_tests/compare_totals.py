@@ -0,0 +1,85 @@
+# ========================== begin_copyright_notice ============================
+#
+# Copyright (C) 2023 Intel Corporation
+#
+# SPDX-License-Identifier: MIT
+#
+# =========================== end_copyright_notice =============================
+
+# Compares a total taken from two compiler outputs of the same build, e.g. the
+# "//.spill size" header lines of two -asmToConsole dumps.
+#
+#   compare_totals.py --field REGEX --expect {less,not-more} [--label NAME]
+#                     BASE NEW
+#
+# REGEX is matched at the start of every line. If it has a named group "value"
+# the integers it captures are summed, otherwise matching lines are counted;
+# an output without any matching line has a total of 0. If REGEX has a named
+# group "key" the totals are kept and compared per key, and both outputs must
+# have the same keys in the same order. BASE and NEW are files or dump
+# directories; for a directory, the files matching --glob in it are read.
+#
+# Prints "NAME: <base> -> <new>" per total and exits with 1 if NEW is not
+# less than (--expect less) or is more than (--expect not-more) BASE.
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+
+def read_totals(path, field, pattern):
+    paths = sorted(glob.glob(os.path.join(path, pattern))) \
+        if os.path.isdir(path) else [path]
+    # Header fields such as "//.spill size" are left out when they are zero.
+    totals = {} if 'key' in field.groupindex else {'': 0}
+    for p in paths:
+        with open(p, errors='replace') as f:
+            for m in map(field.match, f):
+                if not m:
+                    continue
+                key = m.group('key') if 'key' in field.groupindex else ''
+                value = int(m.group('value')) \
+                    if 'value' in field.groupindex else 1
+                totals[key] = totals.get(key, 0) + value
+    return totals
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--field', required=True)
+    parser.add_argument('--expect', required=True, choices=['less', 'not-more'])
+    parser.add_argument('--label', default='total')
+    parser.add_argument('--glob', default='*')
+    parser.add_argument('base')
+    parser.add_argument('new')
+    args = parser.parse_args()
+
+    field = re.compile(args.field)
+    base = read_totals(args.base, field, args.glob)
+    new = read_totals(args.new, field, args.glob)
+    if not base:
+        # With no keys to compare, any --expect would pass.
+        print('%s: no keys found in %s' % (args.label, args.base))
+        return 1
+    if list(base) != list(new):
+        print('%s: outputs do not have the same keys' % args.label)
+        return 1
+
+    failed = False
+    for key, before in base.items():
+        after = new[key]
+        label = '%s %s' % (key, args.label) if key else args.label
+        print('%s: %d -> %d' % (label, before, after))
+        if args.expect == 'less' and after >= before:
+            print('%s: did not shrink' % label)
+            failed = True
+        elif args.expect == 'not-more' and after > before:
+            print('%s: grew' % label)
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,43 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks the -dumpBCReport bank conflict report on an FMA loop, and
+// that assigning the bank hints from the kernel-wide conflict graph
+// (-globalBCGraph) does not leave more conflicts than the per-BB heuristics.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-dumpBCReport'" -device pvc 2> %t/base.txt
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-dumpBCReport -globalBCGraph'" -device pvc 2> %t/global.txt
+// RUN: FileCheck %s --input-file=%t/base.txt
+// RUN: FileCheck %s --input-file=%t/global.txt
+// RUN: %python %S/../../compare_totals.py --field 'Bank conflicts in (?P<key>[^:]+): (?P<value>[0-9]+) of ' --expect not-more --label 'residual conflicts' %t/base.txt %t/global.txt | FileCheck %s --check-prefix=CMP
+
+// CHECK: Bank conflicts in bank_conflict_report: {{[0-9]+}} of {{[1-9][0-9]*}} three source instructions, weighted {{[0-9.e+]+}}
+// CHECK-NEXT: {{^}}  loop {{[0-9]+}} (header BB{{[0-9]+}}, depth 1): {{[0-9]+}} of {{[1-9][0-9]*}}, weighted {{[0-9.e+]+}}
+
+// CMP: bank_conflict_report residual conflicts: {{[0-9]+}} -> {{[0-9]+}}
+// CMP-NOT: grew
+
+kernel void bank_conflict_report(global float4* out, global const float4* a,
+                                 global const float4* b, int n) {
+  int i = get_global_id(0);
+  float4 acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+  for (int k = 0; k < n; ++k) {
+    float4 x0 = a[k * 4 + 0], x1 = a[k * 4 + 1];
+    float4 y0 = b[k * 4 + 2], y1 = b[k * 4 + 3];
+    acc0 = fma(x0, y0, acc0);
+    acc1 = fma(x1, y0, acc1);
+    acc2 = fma(x0, y1, acc2);
+    acc3 = fma(x1, y1, acc3);
+    acc0 = fma(acc1, acc2, acc0);
+    acc3 = fma(acc2, acc0, acc3);
+  }
+  out[i] = acc0 + acc1 + acc2 + acc3;
+}
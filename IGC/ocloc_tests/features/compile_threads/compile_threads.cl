@@ -0,0 +1,62 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that with -compileThreads the kernel and its stack-call
+// functions are compiled on the worker threads, and that the binary is the
+// same as the one of a serial build. The functions contain loops so that the
+// per-kernel scalar jmp decision is exercised on every compile thread.
+// The asm each unit prints with -asmToConsole is buffered on its thread and
+// has to come out in the same order as in the serial build.
+
+// UNSUPPORTED: system-windows
+// REQUIRES: regkeys
+
+// RUN: rm -rf %t && mkdir -p %t/serial %t/parallel
+// RUN: env IGC_FunctionControl=3 IGC_VISAOptions="-asmToConsole" IGC_CompileTraceFile=%t/serial/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/serial > %t/serial.asm
+// RUN: env IGC_FunctionControl=3 IGC_VISAOptions="-asmToConsole -compileThreads 4" IGC_CompileTraceFile=%t/parallel/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/parallel > %t/parallel.asm
+// RUN: diff %t/serial.asm %t/parallel.asm
+// RUN: FileCheck %s --check-prefix=ASM --input-file=%t/parallel.asm
+// RUN: %python %S/../../compare_parallel_build.py --event ParallelCompileUnit %t/serial %t/parallel | FileCheck %s
+
+// ASM: //.kernel
+// ASM: Build succeeded.
+
+// Every unit is compiled on the pool.
+// CHECK-DAG: ParallelCompileUnit compile_threads
+// CHECK-DAG: ParallelCompileUnit {{[^ ]*}}sum_a
+// CHECK-DAG: ParallelCompileUnit {{[^ ]*}}sum_b
+// CHECK-DAG: ParallelCompileUnit {{[^ ]*}}count_c
+
+__attribute__((noinline)) float sum_a(global const float* in, int n) {
+  float acc = 0.0f;
+  for (int k = 0; k < n; ++k)
+    acc += in[k] * (float)k;
+  return acc;
+}
+
+__attribute__((noinline)) float sum_b(global const float* in, int n) {
+  float acc = 1.0f;
+  for (int k = n - 1; k >= 0; --k)
+    acc = acc * in[k] + 1.0f;
+  return acc;
+}
+
+__attribute__((noinline)) int count_c(global const int* in, int n) {
+  int c = 0;
+  for (int k = 0; k < n; ++k)
+    if (in[k] > k)
+      ++c;
+  return c;
+}
+
+kernel void compile_threads(global float* out, global const float* in,
+                            global const int* idx, int n) {
+  int i = get_global_id(0);
+  out[i] = sum_a(in, n) + sum_b(in, i % n) + (float)count_c(idx, n);
+}
@@ -0,0 +1,28 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that CompileTraceFile records IGC, LLVM pass, vISA and IGA
+// events as Chrome trace events, attributed to the kernel being compiled.
+
+// UNSUPPORTED: system-windows
+// REQUIRES: regkeys
+
+// RUN: rm -f %t.json
+// RUN: ocloc compile -file %s -options " -igc_opts 'CompileTraceFile=%t.json,CompileTraceLevel=2'" -device dg2
+// RUN: FileCheck %s --input-file=%t.json
+
+// CHECK: [
+// CHECK-DAG: {"name":"OptimizationPasses","cat":"IGC","ph":"X",{{.*}}}
+// CHECK-DAG: {"name":"OPT_{{.*}}","cat":"LLVM","ph":"X",{{.*}}}
+// CHECK-DAG: {"name":"Total_RA","cat":"vISA","ph":"X",{{.*}},"args":{"kernel":"test_trace","simd":{{[0-9]+}}}},
+// CHECK-DAG: {"name":"IGA_Encoding","cat":"IGA","ph":"X",{{.*}},"args":{"kernel":"test_trace",{{.*}}}},
+// CHECK-DAG: {"name":"TranslateBuild","cat":"IGC","ph":"X",{{.*}}},
+
+kernel void test_trace(global float* out, global const float* in) {
+  int i = get_global_id(0);
+  out[i] = in[i] * in[i] + 1.0f;
+}
@@ -0,0 +1,59 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test compiles several modules that link different builtins from
+// multiple threads of a fresh process, before any serial build, so the
+// threads race to load and index the shared pre-indexed BiF modules and then
+// materialize different builtin bodies from them at once. Every binary must
+// be bit-identical to the one produced by a later serial build of the same
+// module.
+
+// REQUIRES: ocloc-lib
+// UNSUPPORTED: sys32
+
+// RUN: %python %S/concurrent_translate.py --ocloc-lib-dir %ocloc_lib_dir --source %s --device dg2 --modules 8 --threads 8 --iterations 2 --concurrent-first | FileCheck %s
+
+// CHECK: PASS: 8 modules, 8 threads, 16 concurrent builds
+
+#ifndef VARIANT
+#define VARIANT 0
+#endif
+
+float4 apply(float4 x, int i) {
+#if VARIANT == 0
+  return sin(x) + cos(x);
+#elif VARIANT == 1
+  return exp(x) - log(fabs(x) + 1.0f);
+#elif VARIANT == 2
+  return pow(fabs(x), (float4)(1.5f)) + atan2(x, (float4)(i + 1));
+#elif VARIANT == 3
+  return convert_float4(convert_int4_sat_rte(x * 1000.0f));
+#elif VARIANT == 4
+  return (float4)(sub_group_reduce_add(x.x), sub_group_scan_inclusive_max(x.y),
+                  sub_group_broadcast(x.z, 0), x.w);
+#elif VARIANT == 5
+  return tanh(x) * erf(x);
+#elif VARIANT == 6
+  return remainder(x, (float4)(i + 2)) + fmod(x, (float4)3.0f);
+#else
+  return smoothstep((float4)(0.0f), (float4)(1.0f), x) + cbrt(x);
+#endif
+}
+
+kernel void concurrent_bif(global float4* out, global const float4* in,
+                           volatile global int* counter, int n) {
+  size_t gid = get_global_id(0);
+  float4 acc = (float4)(0.0f);
+  for (int i = 0; i < n; ++i)
+    acc += apply(in[(gid + i) % n], i);
+  out[gid] = acc;
+#if VARIANT % 2
+  atomic_inc(counter);
+#else
+  atomic_add(counter, (int)get_local_id(0));
+#endif
+}
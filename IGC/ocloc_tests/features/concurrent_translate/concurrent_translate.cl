@@ -0,0 +1,40 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test compiles several different modules from multiple threads of a
+// single process and checks that every binary is bit-identical to the one
+// produced by a serial build of the same module.
+
+// REQUIRES: ocloc-lib
+// UNSUPPORTED: sys32
+
+// RUN: %python %S/concurrent_translate.py --ocloc-lib-dir %ocloc_lib_dir --source %s --device dg2 --modules 8 --threads 8 --iterations 2 | FileCheck %s
+
+// CHECK: PASS: 8 modules, 8 threads, 16 concurrent builds
+
+#ifndef VARIANT
+#define VARIANT 0
+#endif
+
+float poly(float x) {
+  float r = 0.0f;
+  for (int i = 0; i <= VARIANT + 2; ++i)
+    r = r * x + (float)(i + 1);
+  return r;
+}
+
+kernel void stress(global float* out, global const float* in, int n) {
+  int gid = get_global_id(0);
+  float acc = 0.0f;
+  for (int i = 0; i < n; ++i)
+    acc += poly(in[(gid + i * (VARIANT + 1)) % n]);
+#if VARIANT % 2
+  out[gid] = sqrt(acc);
+#else
+  out[gid] = acc * (float)VARIANT;
+#endif
+}
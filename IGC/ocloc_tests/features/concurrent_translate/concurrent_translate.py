@@ -0,0 +1,133 @@
+# ========================== begin_copyright_notice ============================
+#
+# Copyright (C) 2023 Intel Corporation
+#
+# SPDX-License-Identifier: MIT
+#
+# =========================== end_copyright_notice =============================
+
+# Compiles N variants of one OpenCL source through the in-process ocloc
+# library, first serially and then from several threads at once, and checks
+# that the concurrent builds produce the same binaries as the serial ones.
+# With --concurrent-first the concurrent builds run before any serial one, so
+# process-wide state that IGC sets up on first use (such as the BiF module
+# pool) is set up by racing threads.
+# ctypes releases the GIL for the duration of each oclocInvoke call, so the
+# builds really run concurrently inside IGC.
+
+import argparse
+import ctypes
+import glob
+import os
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+c_uint8_pp = ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8))
+c_uint64_p = ctypes.POINTER(ctypes.c_uint64)
+c_char_pp = ctypes.POINTER(ctypes.c_char_p)
+
+
+def load_ocloc(lib_dir):
+    pattern = 'ocloc*.dll' if os.name == 'nt' else 'libocloc*.so*'
+    for path in sorted(glob.glob(os.path.join(lib_dir, pattern))):
+        lib = ctypes.CDLL(path)
+        lib.oclocInvoke.restype = ctypes.c_int
+        lib.oclocInvoke.argtypes = [
+            ctypes.c_uint, c_char_pp,
+            ctypes.c_uint32, c_uint8_pp, c_uint64_p, c_char_pp,
+            ctypes.c_uint32, c_uint8_pp, c_uint64_p, c_char_pp,
+            ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(c_uint8_pp),
+            ctypes.POINTER(c_uint64_p), ctypes.POINTER(c_char_pp)]
+        lib.oclocFreeOutput.restype = ctypes.c_int
+        lib.oclocFreeOutput.argtypes = [
+            ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(c_uint8_pp),
+            ctypes.POINTER(c_uint64_p), ctypes.POINTER(c_char_pp)]
+        return lib
+    sys.exit('error: ocloc library not found in ' + lib_dir)
+
+
+def compile_module(lib, source, name, device, variant):
+    args = [b'ocloc', b'compile', b'-file', name, b'-device', device.encode(),
+            b'-options', ('-D VARIANT=%d' % variant).encode()]
+    argv = (ctypes.c_char_p * len(args))(*args)
+
+    data = (ctypes.c_uint8 * len(source)).from_buffer_copy(source)
+    sources = (ctypes.POINTER(ctypes.c_uint8) * 1)(
+        ctypes.cast(data, ctypes.POINTER(ctypes.c_uint8)))
+    lengths = (ctypes.c_uint64 * 1)(len(source))
+    names = (ctypes.c_char_p * 1)(name)
+
+    num_outputs = ctypes.c_uint32(0)
+    out_data = c_uint8_pp()
+    out_lens = c_uint64_p()
+    out_names = c_char_pp()
+    status = lib.oclocInvoke(len(args), argv, 1, sources, lengths, names,
+                             0, None, None, None,
+                             ctypes.byref(num_outputs), ctypes.byref(out_data),
+                             ctypes.byref(out_lens), ctypes.byref(out_names))
+
+    binaries = {}
+    log = b''
+    for i in range(num_outputs.value):
+        output = ctypes.string_at(out_data[i], out_lens[i])
+        output_name = out_names[i].decode()
+        if output_name.endswith('.bin'):
+            binaries[output_name] = output
+        elif output_name == 'stdout.log':
+            log = output
+    lib.oclocFreeOutput(ctypes.byref(num_outputs), ctypes.byref(out_data),
+                        ctypes.byref(out_lens), ctypes.byref(out_names))
+
+    if status != 0 or not binaries:
+        sys.exit('error: build of variant %d failed (%d):\n%s' %
+                 (variant, status, log.decode(errors='replace')))
+    return binaries
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--ocloc-lib-dir', required=True)
+    parser.add_argument('--source', required=True)
+    parser.add_argument('--device', required=True)
+    parser.add_argument('--modules', type=int, default=8)
+    parser.add_argument('--threads', type=int, default=8)
+    parser.add_argument('--iterations', type=int, default=1)
+    parser.add_argument('--concurrent-first', action='store_true')
+    args = parser.parse_args()
+
+    lib = load_ocloc(args.ocloc_lib_dir)
+    with open(args.source, 'rb') as f:
+        source = f.read() + b'\0'
+    name = os.path.basename(args.source).encode()
+
+    def build(variant):
+        return compile_module(lib, source, name, args.device, variant)
+
+    def build_serially():
+        return [build(v) for v in range(args.modules)]
+
+    if not args.concurrent_first:
+        reference = build_serially()
+
+    jobs = [v for _ in range(args.iterations) for v in range(args.modules)]
+    with ThreadPoolExecutor(max_workers=args.threads) as pool:
+        results = list(pool.map(build, jobs))
+
+    if args.concurrent_first:
+        reference = build_serially()
+
+    mismatches = 0
+    for variant, binaries in zip(jobs, results):
+        if binaries != reference[variant]:
+            print('MISMATCH: variant %d differs from the serial build' % variant)
+            mismatches += 1
+    if mismatches:
+        return 1
+
+    print('PASS: %d modules, %d threads, %d concurrent builds' %
+          (args.modules, args.threads, len(jobs)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,42 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that per-BB liveness, RPE and reference count summaries
+// reused across RA iterations match full recomputation. Forced spills make
+// GRF RA run several iterations, and -incrementalra 2 recomputes every reused
+// summary and reports any that differ.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -forcespills -incrementalra 2'" -device dg2 2>&1 | FileCheck %s
+
+// CHECK-NOT: differ from full recomputation
+// CHECK: .kernel incremental_ra
+// CHECK: //.spill size
+// CHECK-NOT: differ from full recomputation
+// CHECK: Build succeeded.
+
+kernel void incremental_ra(global float* out, global const float* in, int n, int stride) {
+  int gid = get_global_id(0);
+  float4 acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+  for (int i = 0; i < n; ++i) {
+    float4 a = vload4(gid + i * stride, in);
+    float4 b = vload4(gid + (i + n) * stride, in);
+    acc0 = fma(a, b, acc0);
+    acc1 = fma(a.yzwx, b.wzyx, acc1);
+    if (a.x > b.x)
+      acc2 = fma(a.zwxy, b, acc2);
+    else
+      acc3 = fma(a.wxyz, b.yxwz, acc3);
+  }
+
+  vstore4(acc0, gid * 4 + 0, out);
+  vstore4(acc1, gid * 4 + 1, out);
+  vstore4(acc2, gid * 4 + 2, out);
+  vstore4(acc3, gid * 4 + 3, out);
+}
@@ -0,0 +1,60 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that with -intfThreads the per-BB interference walk runs
+// on several workers, and that the binary is the same as the one of the
+// serial build. The kernel has several thousand blocks and well over
+// 4 * 8192 instructions, so that each of the 4 workers gets at least
+// MinInstsPerIntfThread instructions. The number of interference edges RA
+// reports must not change either.
+
+// UNSUPPORTED: system-windows
+// REQUIRES: regkeys
+
+// RUN: rm -rf %t && mkdir -p %t/serial %t/parallel
+// RUN: env IGC_VISAOptions="-dumpVISAJsonStatsVerbose" IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/serial_dump \
+// RUN:   IGC_CompileTraceFile=%t/serial/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/serial | FileCheck %s --check-prefix=BUILD
+// RUN: env IGC_VISAOptions="-dumpVISAJsonStatsVerbose -intfThreads 4" IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/parallel_dump \
+// RUN:   IGC_CompileTraceFile=%t/parallel/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/parallel | FileCheck %s --check-prefix=BUILD
+// RUN: %python %S/../../compare_parallel_build.py --event ParallelInterferenceWalk %t/serial %t/parallel | FileCheck %s
+// RUN: cat %t/serial_dump/*.stats.json | grep -E '"(normIntfNum|augIntfNum)":' > %t/serial.intf
+// RUN: cat %t/parallel_dump/*.stats.json | grep -E '"(normIntfNum|augIntfNum)":' > %t/parallel.intf
+// RUN: diff %t/serial.intf %t/parallel.intf
+// RUN: FileCheck %s --check-prefix=INTF --input-file=%t/parallel.intf
+
+// BUILD: Build succeeded.
+
+// Each of the 4 workers walks its range of BBs.
+// CHECK-COUNT-4: ParallelInterferenceWalk interference_threads
+
+// INTF: "normIntfNum": {{[1-9][0-9]*}}
+
+// Every step loads a value, updates the accumulator and conditionally stores
+// it, which ends a block.
+#define STEP                                                                   \
+  {                                                                            \
+    float x = in[(i + k) & mask];                                              \
+    acc = acc > x ? acc * x + 1.0f : acc - x * 0.5f;                           \
+    if (x > 100.0f)                                                            \
+      out[k & mask] = acc;                                                     \
+    ++k;                                                                       \
+  }
+#define STEP4 STEP STEP STEP STEP
+#define STEP16 STEP4 STEP4 STEP4 STEP4
+#define STEP64 STEP16 STEP16 STEP16 STEP16
+#define STEP256 STEP64 STEP64 STEP64 STEP64
+#define STEP1024 STEP256 STEP256 STEP256 STEP256
+
+kernel void interference_threads(global float* out, global const float* in, int mask) {
+  int i = get_global_id(0);
+  int k = 0;
+  float acc = 0.0f;
+  STEP1024 STEP1024 STEP1024 STEP1024
+  out[i] = acc;
+}
@@ -0,0 +1,46 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that the kernel binary cache serves a repeated build and
+// that a string regkey differing only after its first bytes misses. Builds
+// that ask for a dump bypass the cache even when it holds an entry for the
+// key, whether the dump is asked for by a regkey or by vISA options given with
+// -igc_opts.
+// Builds without a git revision disable the cache, see
+// kernel_binary_cache_no_revision.cl.
+
+// UNSUPPORTED: system-windows
+// REQUIRES: regkeys, igc-revision
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 IGC_VISAOptions='-noLocalSplit' \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=MISS
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 IGC_VISAOptions='-noLocalSplit' \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=HIT
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 IGC_VISAOptions='-noLocalSplit -nocompaction' \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=MISS
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 IGC_VISAOptions='-noLocalSplit -nocompaction' \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=HIT
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 IGC_VISAOptions='-noLocalSplit -nocompaction' \
+// RUN:   IGC_ProgbinDumpFileName=%t/dump.progbin \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=BYPASS
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 IGC_VISAOptions='-noLocalSplit -nocompaction' \
+// RUN:   IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/dump \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=BYPASS
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 IGC_VISAOptions='-noLocalSplit -nocompaction' \
+// RUN:   ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole'" -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=BYPASS
+
+// MISS: IGC kernel binary cache miss (hits: 0, misses: 1,
+// MISS-NOT: IGC kernel binary cache hit
+// HIT: IGC kernel binary cache hit (hits: 1, misses: 0,
+// BYPASS-NOT: IGC kernel binary cache
+// BYPASS: Build succeeded.
+
+kernel void test_cache(global ulong* out, global const float* in) {
+  int i = get_global_id(0);
+  out[i] = (ulong)(in[i] * 2.0f);
+}
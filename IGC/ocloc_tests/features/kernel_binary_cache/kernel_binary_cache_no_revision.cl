@@ -0,0 +1,28 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that the kernel binary cache stays disabled in a build
+// that does not know its git revision, e.g. one built from a source tarball,
+// since nothing then tells two builds of the compiler apart.
+
+// UNSUPPORTED: system-windows, igc-revision
+// REQUIRES: regkeys
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s
+// RUN: env IGC_EnableKernelBinaryCache=1 IGC_KernelBinaryCacheDir=%t IGC_KernelBinaryCacheVerbose=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s
+
+// CHECK: IGC kernel binary cache disabled: this IGC build has no git revision
+// CHECK-NOT: IGC kernel binary cache
+// CHECK: Build succeeded.
+
+kernel void test_cache(global ulong* out, global const float* in) {
+  int i = get_global_id(0);
+  out[i] = (ulong)(in[i] * 2.0f);
+}
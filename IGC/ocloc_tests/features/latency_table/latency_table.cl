@@ -0,0 +1,80 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks the parser of vISA latency table files (-latencyTable).
+// A valid file is accepted silently. A file with a bad version or an unknown
+// key is rejected with a warning, which is printed once even though the
+// schedulers and SWSB each look the table up for every kernel.
+//
+// A rule giving the loads of the loop a much longer latency must reach the
+// post-RA scheduler: the fma waits for the loads, so the scheduler's cycle
+// estimate in the kernel stats grows compared to the built-in latencies.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: echo "# tuned for dg2" > %t/valid.txt
+// RUN: echo "version 1" >> %t/valid.txt
+// RUN: echo "param LSC_UNTYPED_L3 180" >> %t/valid.txt
+// RUN: echo "param DPAS_DG2_RC8 36 # dpas 8x8" >> %t/valid.txt
+// RUN: echo "rule class=send sfid=ugm latency=180" >> %t/valid.txt
+// RUN: echo "rule class=alu exec=16 type=f latency=12 occupancy=2" >> %t/valid.txt
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-latencyTable %t/valid.txt'" -device dg2 2>&1 | FileCheck %s --check-prefix=VALID
+
+// VALID-NOT: warning: ignoring latency table
+// VALID: Build succeeded.
+
+// RUN: echo "version 2" > %t/bad_version.txt
+// RUN: echo "param FPU 12" >> %t/bad_version.txt
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-latencyTable %t/bad_version.txt'" -device dg2 2>&1 | FileCheck %s --check-prefix=BAD-VERSION
+
+// BAD-VERSION: warning: ignoring latency table {{.*}}bad_version.txt: line 1: unsupported version 2
+// BAD-VERSION-NOT: warning: ignoring latency table
+// BAD-VERSION: Build succeeded.
+
+// RUN: echo "version 1" > %t/bad_param.txt
+// RUN: echo "param NO_SUCH_PARAM 12" >> %t/bad_param.txt
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-latencyTable %t/bad_param.txt'" -device dg2 2>&1 | FileCheck %s --check-prefix=BAD-PARAM
+
+// BAD-PARAM: warning: ignoring latency table {{.*}}bad_param.txt: line 2: unknown parameter NO_SUCH_PARAM
+// BAD-PARAM-NOT: warning: ignoring latency table
+// BAD-PARAM: Build succeeded.
+
+// RUN: echo "version 1" > %t/bad_field.txt
+// RUN: echo "rule class=send stride=2 latency=12" >> %t/bad_field.txt
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-latencyTable %t/bad_field.txt'" -device dg2 2>&1 | FileCheck %s --check-prefix=BAD-FIELD
+
+// BAD-FIELD: warning: ignoring latency table {{.*}}bad_field.txt: line 2: bad rule field stride=2
+// BAD-FIELD-NOT: warning: ignoring latency table
+// BAD-FIELD: Build succeeded.
+
+// RUN: echo "version 1" > %t/slow_send.txt
+// RUN: echo "rule class=send sfid=ugm latency=4000" >> %t/slow_send.txt
+// RUN: env IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/default \
+// RUN:   ocloc compile -file %s -options " -igc_opts 'VISAOptions=-dumpVISAJsonStats'" -device dg2 \
+// RUN:   -output_no_suffix -out_dir %t/default_out 2>&1 | FileCheck %s --check-prefix=SLOW
+// RUN: env IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/slow \
+// RUN:   ocloc compile -file %s -options " -igc_opts 'VISAOptions=-dumpVISAJsonStats -latencyTable %t/slow_send.txt'" -device dg2 \
+// RUN:   -output_no_suffix -out_dir %t/slow_out 2>&1 | FileCheck %s --check-prefix=SLOW
+// RUN: %python %S/../../compare_totals.py --field '\s*"numCycles": (?P<value>[0-9]+)' --glob '*.stats.json' --expect less --label numCycles %t/slow %t/default | FileCheck %s --check-prefix=CYCLES
+
+// SLOW-NOT: warning: ignoring latency table
+// SLOW: Build succeeded.
+
+// The totals are printed slow first, so the default build must be lower.
+// CYCLES: numCycles: {{[1-9][0-9]*}} -> {{[0-9]+}}
+// CYCLES-NOT: did not shrink
+
+kernel void latency_table(global float* out, global const float* in, int n) {
+  int gid = get_global_id(0);
+  float acc = 0.0f;
+  for (int i = 0; i < n; ++i)
+    acc = fma(in[gid + i], in[gid + i + n], acc);
+  out[gid] = acc;
+}
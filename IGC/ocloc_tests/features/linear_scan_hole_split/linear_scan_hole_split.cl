@@ -0,0 +1,79 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks when the second-chance linear scan RA splits live
+// intervals at their holes and spills instead of evicting:
+//  - v is loop-carried: it is only referenced in the loop body, where it's
+//    read before it's redefined. Its value flows around the back edge, so the
+//    redefinition must not be renamed to a separate _hs declare.
+//  - With REDEFINE, the block-local temps are independent values of one type
+//    in a single block. Variable reuse gives them one vISA variable that is
+//    fully redefined for each value, and each redefinition gets its own _hs
+//    declare.
+//  - With PRESSURE, more values are live across the loop than fit in the
+//    GRFs. Spilling some of them is cheaper than evicting the active ranges
+//    that are referenced in the loop.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -linearScan -linearScanSecondChance'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=CARRIED
+// RUN: ocloc compile -file %s -options "-DREDEFINE -igc_opts 'VISAOptions=-asmToConsole -linearScan -linearScanSecondChance'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=REDEFINE
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: env IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/dump \
+// RUN:   ocloc compile -file %s -options "-DPRESSURE -igc_opts 'VISAOptions=-asmToConsole -linearScan -linearScanSecondChance -dumpVISAJsonStatsVerbose'" -device dg2 \
+// RUN:   -output_no_suffix -out_dir %t/out 2>&1 | FileCheck %s --check-prefix=PRESSURE
+// RUN: cat %t/dump/*.stats.json | FileCheck %s --check-prefix=STATS
+
+// CARRIED: .kernel linear_scan_hole_split
+// CARRIED-NOT: //.declare {{.*}}_hs{{[0-9]+}}
+// CARRIED: Build succeeded.
+
+// REDEFINE: .kernel linear_scan_hole_split
+// REDEFINE: //.declare {{[A-Za-z0-9_]+}}_hs1 {{.*}}
+// REDEFINE: Build succeeded.
+
+// PRESSURE: .kernel linear_scan_hole_split
+// PRESSURE: //.spill size
+// PRESSURE: Build succeeded.
+
+// STATS: "name": "linear_scan_hole_split"
+// STATS: "secondChanceSpillNum": {{[1-9]}}
+
+#if defined(REDEFINE)
+kernel void linear_scan_hole_split(global float* out, global const float* in, int n) {
+  int i = get_global_id(0);
+  float t0 = in[i] * 2.0f + 1.0f;
+  out[i] = t0;
+  float t1 = in[i + n] * 3.0f + 2.0f;
+  out[i + n] = t1;
+  float t2 = in[i + 2 * n] * 4.0f + 3.0f;
+  out[i + 2 * n] = t2;
+  float t3 = in[i + 3 * n] * 5.0f + 4.0f;
+  out[i + 3 * n] = t3;
+}
+#elif defined(PRESSURE)
+kernel void linear_scan_hole_split(global float16* out, global const float16* in, int n) {
+  int i = get_global_id(0);
+  float16 a0 = in[i], a1 = in[i + n], a2 = in[i + 2 * n], a3 = in[i + 3 * n];
+  float16 a4 = in[i + 4 * n], a5 = in[i + 5 * n], a6 = in[i + 6 * n], a7 = in[i + 7 * n];
+  float16 acc = 0.0f;
+  for (int k = 0; k < n; ++k)
+    acc = acc * a0 + in[k] * a1;
+  out[i] = acc + a2 + a3 + a4 + a5 + a6 + a7;
+}
+#else
+kernel void linear_scan_hole_split(global float4* out, global const float* in, int n) {
+  float4 v;
+  for (int i = 0; i < n; ++i) {
+    out[i] = v;
+    v = (float4)(in[i], v.x, v.y, v.z);
+  }
+}
+#endif
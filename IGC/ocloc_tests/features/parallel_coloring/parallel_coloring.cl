@@ -0,0 +1,52 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that GRF coloring with several parallel attempts compiles
+// a kernel with high register pressure, and that the attempt it keeps does not
+// depend on thread timing: repeated builds produce identical binaries, also
+// with frequency based spill cost, where only the default color order is
+// tried. The parallel build must not spill more than the serial search, whose
+// first spill-free attempt is among the parallel ones.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: rm -rf %t && mkdir -p %t/a %t/b %t/c %t/d
+// RUN: ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/a -options " -igc_opts 'VISAOptions=-coloringThreads 4'"
+// RUN: ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/b -options " -igc_opts 'VISAOptions=-coloringThreads 4'"
+// RUN: cmp %t/a/parallel_coloring.bin %t/b/parallel_coloring.bin
+// RUN: ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/c -options " -igc_opts 'VISAOptions=-coloringThreads 4 -freqBasedSpillCost'"
+// RUN: ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/d -options " -igc_opts 'VISAOptions=-coloringThreads 4 -freqBasedSpillCost'"
+// RUN: cmp %t/c/parallel_coloring.bin %t/d/parallel_coloring.bin
+
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole'" > %t/serial.txt
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -coloringThreads 4'" > %t/parallel.txt
+// RUN: FileCheck %s --input-file %t/parallel.txt --check-prefix=ASM
+// RUN: %python %S/../../compare_totals.py --field '//\.spill size (?P<value>[0-9]+)' --expect not-more --label 'spill size' %t/serial.txt %t/parallel.txt | FileCheck %s --check-prefix=CMP
+
+// ASM: //.kernel parallel_coloring
+// ASM: //.BankConflicts:
+// ASM: Build succeeded.
+
+// CMP: spill size: {{[0-9]+}} -> {{[0-9]+}}
+// CMP-NOT: grew
+
+kernel void parallel_coloring(global float* out, global const float* in, int n) {
+  int gid = get_global_id(0);
+  float4 acc[8];
+  for (int k = 0; k < 8; ++k)
+    acc[k] = (float4)(0.0f);
+  for (int i = 0; i < n; ++i) {
+    float4 a = vload4(gid + i, in);
+    for (int k = 0; k < 8; ++k)
+      acc[k] = fma(a, (float4)((float)(k + 1)), acc[k].wzyx);
+  }
+  float4 r = (float4)(0.0f);
+  for (int k = 0; k < 8; ++k)
+    r += acc[k] * acc[7 - k];
+  vstore4(r, gid, out);
+}
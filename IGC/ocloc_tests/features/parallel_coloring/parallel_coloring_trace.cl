@@ -0,0 +1,39 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks, through the RA trace, that GRF coloring with several
+// parallel attempts keeps one of them, and that the serial search does not
+// report a picked attempt. The RA trace is only compiled into debug builds.
+
+// REQUIRES: regkeys, debug
+// UNSUPPORTED: system-windows
+
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-ratrace -coloringThreads 4'" | FileCheck %s --check-prefix=PARALLEL
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-ratrace'" | FileCheck %s --check-prefix=SERIAL
+
+// PARALLEL: --picked {{(round-robin|first-fit)}}{{( BCR)?}} coloring, order {{[0-2]}}, bank conflict cost {{[0-9.e+]+}}
+// PARALLEL-NOT: --no spill-free coloring
+// PARALLEL: Build succeeded.
+
+// SERIAL-NOT: --picked
+// SERIAL: Build succeeded.
+
+kernel void parallel_coloring_trace(global float* out, global const float* in, int n) {
+  int gid = get_global_id(0);
+  float4 acc[8];
+  for (int k = 0; k < 8; ++k)
+    acc[k] = (float4)(0.0f);
+  for (int i = 0; i < n; ++i) {
+    float4 a = vload4(gid + i, in);
+    for (int k = 0; k < 8; ++k)
+      acc[k] = fma(a, (float4)((float)(k + 1)), acc[k].wzyx);
+  }
+  float4 r = (float4)(0.0f);
+  for (int k = 0; k < 8; ++k)
+    r += acc[k] * acc[7 - k];
+  vstore4(r, gid, out);
+}
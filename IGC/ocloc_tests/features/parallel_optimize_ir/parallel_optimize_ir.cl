@@ -0,0 +1,62 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that kernels whose scalar cleanup passes were run
+// concurrently (in separate LLVM contexts) are merged back and compiled to
+// the same binary as a serial run of the pipeline.
+// Each kernel forms its own function group; "scale" is shared by two of them
+// and the struct type has to be mapped back to the original module.
+// The kernels are far too small to pay for the bitcode round trip, so the
+// minimum size per worker is lifted to force the parallel path, and the last
+// run checks that by default it is not taken, which makes it one more serial
+// build to compare with.
+
+// UNSUPPORTED: system-windows
+// REQUIRES: regkeys
+
+// RUN: rm -rf %t && mkdir -p %t/serial %t/parallel %t/small
+// RUN: env IGC_CompileTraceFile=%t/serial/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/serial
+// RUN: env IGC_ParallelOptimizeIRThreads=4 IGC_ParallelOptimizeIRMinInstsPerThread=0 \
+// RUN:   IGC_CompileTraceFile=%t/parallel/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/parallel
+// RUN: env IGC_ParallelOptimizeIRThreads=4 IGC_CompileTraceFile=%t/small/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/small
+// RUN: %python %S/../../compare_parallel_build.py --event ParallelFunctionGroup --event ParallelFunctionMerge \
+// RUN:   %t/serial %t/parallel | FileCheck %s
+// RUN: %python %S/../../compare_parallel_build.py --event ParallelFunctionGroup --event ParallelFunctionMerge \
+// RUN:   %t/small %t/parallel | FileCheck %s
+
+// At least two groups are optimized on the pool and merged back, rather than
+// falling back to the serial pipeline.
+// CHECK:      ParallelFunctionGroup
+// CHECK-NEXT: ParallelFunctionGroup
+// CHECK:      ParallelFunctionMerge
+
+typedef struct {
+  int a;
+  float b;
+} pair_t;
+
+int scale(pair_t p, int n) {
+  return p.a * n + (int)p.b;
+}
+
+kernel void test_a(global int* out, global pair_t* in, int n) {
+  int i = get_global_id(0);
+  out[i] = scale(in[i], n) + scale(in[i], n);
+}
+
+kernel void test_b(global int* out, global pair_t* in, int n) {
+  int i = get_global_id(0);
+  out[i] = scale(in[i], n + 1);
+}
+
+kernel void test_c(global float* out, global const float* in) {
+  int i = get_global_id(0);
+  out[i] = in[i] * in[i] + in[i];
+}
@@ -0,0 +1,67 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that with ParallelSIMDCompileThreads the SIMD variants are
+// finalized on the compile pool, that the serial build does not use it, and
+// that the binary matches the serial build. The selected SIMD size of every
+// kernel is also compared on its own: test_simd_spill keeps enough values
+// live to spill at the wider SIMD sizes, so its selection goes through the
+// abort-on-spill and retry state the parallel finalization has to carry over.
+
+// UNSUPPORTED: system-windows
+// REQUIRES: regkeys
+
+// RUN: rm -rf %t && mkdir -p %t/serial %t/parallel
+// RUN: env IGC_DumpZEInfoToConsole=1 IGC_CompileTraceFile=%t/serial/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/serial > %t/serial.zeinfo
+// RUN: env IGC_DumpZEInfoToConsole=1 IGC_ParallelSIMDCompileThreads=4 IGC_CompileTraceFile=%t/parallel/trace.json IGC_CompileTraceLevel=1 \
+// RUN:   ocloc compile -file %s -device dg2 -output_no_suffix -out_dir %t/parallel > %t/parallel.zeinfo
+// RUN: %python %S/../../compare_parallel_build.py --event ParallelSIMDCompile %t/serial %t/parallel | FileCheck %s
+
+// RUN: grep -E "^  - name:|simd_size:" %t/serial.zeinfo > %t/serial.simd
+// RUN: grep -E "^  - name:|simd_size:" %t/parallel.zeinfo > %t/parallel.simd
+// RUN: diff %t/serial.simd %t/parallel.simd
+// RUN: FileCheck %s --check-prefix=SIMD --input-file=%t/parallel.simd
+
+// SIMD:      name: test_simd_a
+// SIMD-NEXT: simd_size: {{8|16|32}}
+// SIMD:      name: test_simd_b
+// SIMD-NEXT: simd_size: {{8|16|32}}
+// SIMD:      name: test_simd_spill
+// SIMD-NEXT: simd_size: {{8|16|32}}
+
+// Every kernel has at least one SIMD variant finalized on the pool.
+// CHECK: ParallelSIMDCompile test_simd_a {{8|16|32}}
+// CHECK: ParallelSIMDCompile test_simd_b {{8|16|32}}
+// CHECK: ParallelSIMDCompile test_simd_spill {{8|16|32}}
+
+kernel void test_simd_a(global float* out, global const float* in, int n) {
+  int i = get_global_id(0);
+  float acc = 0.0f;
+  for (int k = 0; k < n; ++k)
+    acc += in[(i + k) % n] * (float)k;
+  out[i] = acc;
+}
+
+kernel void test_simd_b(global int* out, global const int* in) {
+  int i = get_global_id(0);
+  out[i] = in[i] * in[i] - in[i ^ 1];
+}
+
+kernel void test_simd_spill(global float* out, global const float* in, int n) {
+  int i = get_global_id(0);
+  float v[64];
+  for (int k = 0; k < 64; ++k)
+    v[k] = in[i * 64 + k];
+  for (int r = 0; r < n; ++r)
+    for (int k = 0; k < 64; ++k)
+      v[k] = v[k] * v[(k + r) & 63] + v[(k * 7 + 1) & 63];
+  float acc = 0.0f;
+  for (int k = 0; k < 64; ++k)
+    acc += v[k] * (float)k;
+  out[i] = acc;
+}
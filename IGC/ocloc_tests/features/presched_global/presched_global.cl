@@ -0,0 +1,63 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that -presched-global hoists the load that follows a
+// uniform if/else hammock into the block that ends with the branch, so that
+// the arms hide its latency. The load must stay below the hammock when the
+// hammock writes its address, or contains a fence or a store.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -presched-global'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=HOIST
+// RUN: ocloc compile -file %s -options "-DWRITE_ADDR -igc_opts 'VISAOptions=-asmToConsole -presched-global'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=KEEP
+// RUN: ocloc compile -file %s -options "-DFENCE -igc_opts 'VISAOptions=-asmToConsole -presched-global'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=KEEP
+// RUN: ocloc compile -file %s -options "-DSTORE -igc_opts 'VISAOptions=-asmToConsole -presched-global'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=KEEP
+
+// The block ending with the branch issues the load.
+// HOIST: //.kernel presched_global
+// HOIST: // B{{[0-9]+}}: {{.*}}Succs:{B{{[0-9]+}}, B{{[0-9]+}}}
+// HOIST-NOT: // B{{[0-9]+}}:
+// HOIST: {{(send|load)}}
+// HOIST-NOT: // B{{[0-9]+}}:
+// HOIST: {{\) +(jmpi|goto|if|brc)[ .]}}
+// HOIST: Build succeeded.
+
+// KEEP: //.kernel presched_global
+// KEEP: // B{{[0-9]+}}: {{.*}}Succs:{B{{[0-9]+}}, B{{[0-9]+}}}
+// KEEP-NOT: {{(send|load)}}
+// KEEP: {{\) +(jmpi|goto|if|brc)[ .]}}
+// KEEP: Build succeeded.
+
+kernel void presched_global(global float* out, global const float* in,
+                            global const float* a, global const float* b,
+                            int c, int n) {
+  int i = get_global_id(0);
+  int idx = i + n;
+  float x;
+  // c is a kernel argument, so the branch is uniform.
+  if (c > 0) {
+    x = a[i] * a[i + n] + 1.0f;
+#ifdef WRITE_ADDR
+    idx = i * n;
+#endif
+#ifdef FENCE
+    mem_fence(CLK_GLOBAL_MEM_FENCE);
+#endif
+  } else {
+    x = b[i * 2] - b[i * 2 + 1] * 3.0f;
+#ifdef STORE
+    out[i + 1] = x;
+#endif
+  }
+  float y = in[idx];
+  out[i] = x * y;
+}
@@ -0,0 +1,43 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that -presched-swp pipelines the load of a single-block
+// loop: the load is renamed into a _swp declare, the first iteration's load
+// is issued in the preheader, and the loop issues the next iteration's load
+// under the predicate of the back edge. A loop that also stores to memory
+// must not be pipelined.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -presched-swp'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: ocloc compile -file %s -options "-DSTORE -igc_opts 'VISAOptions=-asmToConsole -presched-swp'" -device dg2 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=STORE --implicit-check-not=_swp
+
+// CHECK: //.kernel presched_swp
+// CHECK: //.declare {{[A-Za-z0-9_]+}}_swp
+// CHECK: // [[PH:B[0-9]+]]: {{.*}}Succs:{[[LOOP:B[0-9]+]]}
+// CHECK: {{(send|load)}}
+// CHECK: // [[LOOP]]: {{.*}}Preds:{{.*}}[[PH]]{{.*}}Succs:{{.*}}[[LOOP]]
+// CHECK: {{\((W&)?~?f[0-9]+\.[0-9]+\) +(send|load)}}
+// CHECK: Build succeeded.
+
+// STORE: //.kernel presched_swp
+// STORE: Build succeeded.
+
+kernel void presched_swp(global float* out, global const float* in, int n, int stride) {
+  int i = get_global_id(0);
+  float acc = 0.0f;
+  for (int k = 0; k < n; ++k) {
+    acc = acc * in[i + k * stride] + 1.0f;
+#ifdef STORE
+    out[i + k * stride] = acc;
+#endif
+  }
+  out[i] = acc;
+}
@@ -0,0 +1,60 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that GRF RA finishes on a kernel that spills when spilled
+// ranges are rematerialized, and that rematerialization actually happens. The
+// offsets are cheap to recompute from the kernel inputs and are live across
+// the loop, so they are remat candidates; recomputing them instead of
+// spilling them must leave less to spill than the default build.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -forcespills -rematSpills'" -device dg2 > %t/remat.txt 2>&1
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -forcespills'" -device dg2 > %t/noremat.txt 2>&1
+// RUN: FileCheck %s --input-file=%t/remat.txt
+// RUN: FileCheck %s --check-prefixes=CHECK,SPILL --input-file=%t/noremat.txt
+// RUN: %python %S/../../compare_totals.py --field '//\.spill size (?P<value>[0-9]+)' --expect less --label 'spill size' %t/noremat.txt %t/remat.txt | FileCheck %s --check-prefix=CMP
+
+// CHECK: .kernel remat_spills
+// SPILL: //.spill size
+// CHECK: Build succeeded.
+
+// CMP: spill size: {{[0-9]+}} -> {{[0-9]+}}
+// CMP-NOT: did not shrink
+
+kernel void remat_spills(global float* out, global const float* in, int n, int stride) {
+  int gid = get_global_id(0);
+  int o0 = gid * stride;
+  int o1 = o0 + 1 * stride;
+  int o2 = o0 + 2 * stride;
+  int o3 = o0 + 3 * stride;
+  int o4 = o0 + 4 * stride;
+  int o5 = o0 + 5 * stride;
+  int o6 = o0 + 6 * stride;
+  int o7 = o0 + 7 * stride;
+
+  float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+  for (int i = 0; i < n; ++i) {
+    float4 a = vload4(i, in);
+    float4 b = vload4(i + n, in);
+    acc0 = fma(a.x, b.w, acc0);
+    acc1 = fma(a.y, b.z, acc1);
+    acc2 = fma(a.z, b.y, acc2);
+    acc3 = fma(a.w, b.x, acc3);
+  }
+
+  out[o0] = acc0;
+  out[o1] = acc1;
+  out[o2] = acc2;
+  out[o3] = acc3;
+  out[o4] = acc0 + acc1;
+  out[o5] = acc1 + acc2;
+  out[o6] = acc2 + acc3;
+  out[o7] = acc3 + acc0;
+}
@@ -0,0 +1,42 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks the width of coalesced LSC fills. Every value is spilled
+// with -forcespills. The four 2 GRF values are spilled to consecutive slots
+// and are used together, so their fills span 8 GRFs. With
+// -spillCoalescingMaxGRFs 8 they become a single 8 GRF fill (d32x64t on a
+// 32 byte GRF). With -spillCoalescingMaxGRFs 4, which is the default, no
+// coalesced fill is wider than 4 GRFs (d32x32t).
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -forcespills -spillCoalescingMaxGRFs 8'" -device dg2 2>&1 | FileCheck %s --check-prefixes=CHECK,MAX8
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -forcespills -spillCoalescingMaxGRFs 4'" -device dg2 2>&1 | FileCheck %s --check-prefixes=CHECK,MAX4
+// RUN: ocloc compile -file %s -options " -igc_opts 'VISAOptions=-asmToConsole -forcespills'" -device dg2 2>&1 | FileCheck %s --check-prefixes=CHECK,MAX4
+
+// CHECK: .kernel spill_coalescing
+// MAX8: d32x64t{{.*}}// fill from offset[{{[0-9]+}}*32] of COAL_FILL_
+// MAX4-NOT: d32x64t{{.*}}of COAL_FILL_
+// MAX4: d32x32t{{.*}}// fill from offset[{{[0-9]+}}*32] of COAL_FILL_
+// MAX4-NOT: d32x64t{{.*}}of COAL_FILL_
+// CHECK: Build succeeded.
+
+__attribute__((intel_reqd_sub_group_size(16)))
+kernel void spill_coalescing(global float* out, global const float* in, int n, int stride) {
+  int gid = get_global_id(0);
+  float a0 = in[gid];
+  float a1 = in[gid + stride];
+  float a2 = in[gid + 2 * stride];
+  float a3 = in[gid + 3 * stride];
+
+  float acc = 0.0f;
+  for (int i = 0; i < n; ++i)
+    acc = fma(acc, a0, in[gid + i]);
+
+  out[gid] = a0 * a1 + a2 * a3 + acc;
+}
@@ -0,0 +1,68 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks, through the RA trace, the loop split decisions made with
+// -splitonspillbycost. The two unrolled phases keep many accumulators live,
+// so the scale values live across the whole kernel are spilled. They are
+// read in the low pressure loop between the phases. Splitting them around
+// that loop replaces the fills in its body with copies in the pre-header,
+// which is worth it. Without the option the cost is not computed. The RA
+// trace is only compiled into debug builds.
+//
+// The spill statistics of the asm header then compare the weighted spill and
+// fill count of the kernel against the default split heuristic: ordering and
+// filtering the splits by cost must not leave more spill refs than it.
+
+// REQUIRES: regkeys, debug
+// UNSUPPORTED: system-windows
+
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-ratrace -splitonspillbycost'" | FileCheck %s --check-prefix=COST
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-ratrace'" | FileCheck %s --check-prefix=NOCOST
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -splitonspillbycost'" > %t/cost.txt 2>&1
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole'" > %t/default.txt 2>&1
+// RUN: FileCheck %s --check-prefix=REFS --input-file=%t/cost.txt
+// RUN: FileCheck %s --check-prefix=REFS --input-file=%t/default.txt
+// RUN: %python %S/../../compare_totals.py --field '//\.spill GRF est\. ref count (?P<value>[0-9]+)' --expect not-more --label 'spill GRF est. ref count' %t/default.txt %t/cost.txt | FileCheck %s --check-prefix=CMP
+
+// COST: --split cost of {{[A-Za-z0-9_]+}} around L{{[0-9]+}}: benefit {{[0-9.e+]+$}}
+// COST: --split {{[A-Za-z0-9_]+}} around L{{[0-9]+}}
+// COST: Build succeeded.
+
+// NOCOST-NOT: --split cost of
+// NOCOST: Build succeeded.
+
+// REFS: .kernel split_on_spill_by_cost
+// REFS: //.spill GRF est. ref count
+// REFS: Build succeeded.
+
+// CMP: spill GRF est. ref count: {{[0-9]+}} -> {{[0-9]+}}
+// CMP-NOT: grew
+
+__attribute__((intel_reqd_sub_group_size(16)))
+kernel void split_on_spill_by_cost(global float4* out, global const float4* in, int n) {
+  int gid = get_global_id(0);
+  float4 s0 = in[gid] * 3.0f;
+  float4 s1 = in[gid + n] * 5.0f;
+
+  float4 acc[24];
+  for (int k = 0; k < 24; ++k)
+    acc[k] = in[gid + k * n];
+  for (int k = 0; k < 24; ++k)
+    acc[k] = fma(acc[k], acc[23 - k].wzyx, s0);
+
+  float4 r = (float4)(0.0f);
+  for (int i = 0; i < n; ++i)
+    r = fma(in[gid + i], s0, r) + s1;
+
+  for (int k = 0; k < 24; ++k)
+    acc[k] = fma(acc[k], acc[(k + 7) % 24].yxwz, s1);
+  for (int k = 0; k < 24; ++k)
+    r += acc[k] * s0;
+  out[gid] = r;
+}
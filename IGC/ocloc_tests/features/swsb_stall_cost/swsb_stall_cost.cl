@@ -0,0 +1,59 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks SWSB token reuse by stall cost (-SWSBStallCostTokenReuse)
+// against the default token reuse selection. With only 4 tokens the loads in
+// the loop run out of tokens, and each fma waits for three loads, so every
+// fma whose loads hold different tokens needs a sync.allwr with a token mask.
+// The stall cost counts those syncs, so its asm must not have more
+// sync.allrd/sync.allwr than the default selection's. -dumpVISAJsonStats
+// reports the estimated token stall cycles in the kernel stats.
+
+// REQUIRES: regkeys
+// UNSUPPORTED: system-windows
+
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: env IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/base \
+// RUN:   ocloc compile -file %s -options " -igc_opts 'VISAOptions=-SWSBTokenNum 4 -dumpVISAJsonStats'" -device dg2 \
+// RUN:   -output_no_suffix -out_dir %t/base_out | FileCheck %s --check-prefix=BUILD
+// RUN: env IGC_ShaderDumpEnable=1 IGC_DumpToCustomDir=%t/cost \
+// RUN:   ocloc compile -file %s -options " -igc_opts 'VISAOptions=-SWSBTokenNum 4 -dumpVISAJsonStats -SWSBStallCostTokenReuse'" -device dg2 \
+// RUN:   -output_no_suffix -out_dir %t/cost_out | FileCheck %s --check-prefix=BUILD
+
+// BUILD: Build succeeded.
+
+// RUN: cat %t/base/*.stats.json | FileCheck %s --check-prefix=STATS
+// RUN: cat %t/cost/*.stats.json | FileCheck %s --check-prefix=STATS
+
+// STATS: "name": "swsb_stall_cost"
+// STATS: "tokenStallCycles":
+
+// RUN: cat %t/base/*.asm | FileCheck %s --check-prefix=BASEASM
+
+// BASEASM: sync.allwr
+
+// RUN: %python %S/../../compare_totals.py --field '\s*(\([^)]*\)\s*)?sync\.all(rd|wr)\b' --glob '*.asm' --expect not-more --label 'sync.allrd/sync.allwr' %t/base %t/cost | FileCheck %s --check-prefix=CMP
+
+// CMP: sync.allrd/sync.allwr: {{[1-9][0-9]*}} -> {{[0-9]+}}
+// CMP-NOT: grew
+
+kernel void swsb_stall_cost(global float* out, global const float* in, int n, int stride) {
+  int gid = get_global_id(0);
+  float acc = 0.0f;
+  for (int i = 0; i < n; ++i) {
+    // Strided, so that the loads are not merged into one message.
+    global const float* p = in + gid + i * 8 * stride;
+    float a0 = p[0 * stride], a1 = p[1 * stride], a2 = p[2 * stride], a3 = p[3 * stride];
+    float a4 = p[4 * stride], a5 = p[5 * stride], a6 = p[6 * stride], a7 = p[7 * stride];
+    acc += fma(a7, a0, a4);
+    acc += fma(a6, a1, a5);
+    acc += fma(a2, a3, a6);
+    out[gid + i * stride] = acc;
+  }
+  out[gid] = acc;
+}
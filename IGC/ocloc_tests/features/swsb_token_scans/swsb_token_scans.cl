@@ -0,0 +1,78 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+// This test checks that SWSB token allocation only walking the live sends
+// gives the same asm as scanning every send of the kernel
+// (-SWSBFullTokenScans), on a send-heavy kernel with only 4 tokens so that
+// every token is reused many times and sends stay live across blocks. This is
+// checked for the local, global and distance-propagation allocators, and each
+// of them must only use tokens $0 to $3. The option lines of the asm header
+// differ between the runs and are left out of the comparison. The full scans
+// are only compiled into debug builds.
+
+// REQUIRES: regkeys, debug
+// UNSUPPORTED: system-windows
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -SWSBTokenNum 4 -SWSBDepReduction'" \
+// RUN:   -output_no_suffix -out_dir %t/out > %t/local.asm 2>&1
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -SWSBTokenNum 4 -SWSBDepReduction -SWSBFullTokenScans'" \
+// RUN:   -output_no_suffix -out_dir %t/out > %t/local_full.asm 2>&1
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -SWSBTokenNum 4 -SWSBDepReduction -globalTokenAllocation'" \
+// RUN:   -output_no_suffix -out_dir %t/out > %t/global.asm 2>&1
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -SWSBTokenNum 4 -SWSBDepReduction -globalTokenAllocation -SWSBFullTokenScans'" \
+// RUN:   -output_no_suffix -out_dir %t/out > %t/global_full.asm 2>&1
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -SWSBTokenNum 4 -SWSBDepReduction -distPropTokenAllocation'" \
+// RUN:   -output_no_suffix -out_dir %t/out > %t/distprop.asm 2>&1
+// RUN: ocloc compile -file %s -device dg2 -options " -igc_opts 'VISAOptions=-asmToConsole -SWSBTokenNum 4 -SWSBDepReduction -distPropTokenAllocation -SWSBFullTokenScans'" \
+// RUN:   -output_no_suffix -out_dir %t/out > %t/distprop_full.asm 2>&1
+
+// RUN: FileCheck %s --input-file=%t/local.asm
+// RUN: FileCheck %s --input-file=%t/global.asm
+// RUN: FileCheck %s --input-file=%t/distprop.asm
+
+// RUN: grep -v -e "^//.options_string" -e "^//.full_options" %t/local.asm > %t/local.cmp
+// RUN: grep -v -e "^//.options_string" -e "^//.full_options" %t/local_full.asm > %t/local_full.cmp
+// RUN: diff %t/local.cmp %t/local_full.cmp
+// RUN: grep -v -e "^//.options_string" -e "^//.full_options" %t/global.asm > %t/global.cmp
+// RUN: grep -v -e "^//.options_string" -e "^//.full_options" %t/global_full.asm > %t/global_full.cmp
+// RUN: diff %t/global.cmp %t/global_full.cmp
+// RUN: grep -v -e "^//.options_string" -e "^//.full_options" %t/distprop.asm > %t/distprop.cmp
+// RUN: grep -v -e "^//.options_string" -e "^//.full_options" %t/distprop_full.asm > %t/distprop_full.cmp
+// RUN: diff %t/distprop.cmp %t/distprop_full.cmp
+
+// CHECK: .kernel swsb_token_scans
+// CHECK-NOT: {{\{[^}]*\$([4-9]|[1-9][0-9])[.,}]}}
+// CHECK: {{\{[^}]*\$3[.,}]}}
+// CHECK-NOT: {{\{[^}]*\$([4-9]|[1-9][0-9])[.,}]}}
+// CHECK: Build succeeded.
+
+#define LOAD8(b)                                                               \
+  float x##b##0 = in[gid + (8 * b + 0) * n];                                   \
+  float x##b##1 = in[gid + (8 * b + 1) * n];                                   \
+  float x##b##2 = in[gid + (8 * b + 2) * n];                                   \
+  float x##b##3 = in[gid + (8 * b + 3) * n];                                   \
+  float x##b##4 = in[gid + (8 * b + 4) * n];                                   \
+  float x##b##5 = in[gid + (8 * b + 5) * n];                                   \
+  float x##b##6 = in[gid + (8 * b + 6) * n];                                   \
+  float x##b##7 = in[gid + (8 * b + 7) * n];
+#define SUM8(b)                                                                \
+  (x##b##7 + x##b##6 + x##b##5 + x##b##4 + x##b##3 + x##b##2 + x##b##1 +       \
+   x##b##0)
+
+kernel void swsb_token_scans(global float* out, global const float* in, int n) {
+  int gid = get_global_id(0);
+  LOAD8(0)
+  LOAD8(1)
+  float acc = SUM8(1);
+  if (acc > 0.0f) {
+    LOAD8(2)
+    out[gid + n] = SUM8(2);
+  }
+  LOAD8(3)
+  out[gid] = acc + SUM8(0) * SUM8(3);
+}
@@ -61,6 +61,9 @@ if config.is32b == "1":
 if config.debug_build:
   config.available_features.add('debug')
 
+if config.igc_revision:
+  config.available_features.add('igc-revision')
+
 if config.use_khronos_spirv_translator_in_sc == "1":
   config.available_features.add('khronos-translator')
   config.available_features.add('khronos-translator-' + config.llvm_version_major)
@@ -68,3 +71,7 @@ if config.use_khronos_spirv_translator_in_sc == "1":
 else:
   config.available_features.add('legacy-translator')
   config.substitutions.append(('%SPV_CHECK_PREFIX%', 'CHECK-LEGACY'))
+
+if config.ocloc_lib_dir:
+  config.available_features.add('ocloc-lib')
+  config.substitutions.append(('%ocloc_lib_dir', config.ocloc_lib_dir))
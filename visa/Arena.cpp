@@ -8,6 +8,8 @@ SPDX-License-Identifier: MIT
 
 #include "Arena.h"
 
+#include <atomic>
+
 #ifdef COLLECT_ALLOCATION_STATS
 int numAllocations = 0;
 int numMallocCalls = 0;
@@ -19,6 +21,38 @@ int currentMallocSize = 0;
 #endif
 using namespace vISA;
 
+static std::atomic<size_t> totalReservedBytes{0};
+static std::atomic<size_t> peakReservedBytes{0};
+static std::atomic<size_t> totalNumArenas{0};
+static std::atomic<size_t> totalWastedBytes{0};
+static thread_local size_t threadHighWater = 0;
+
+size_t ArenaTotals::getReservedBytes() { return totalReservedBytes; }
+size_t ArenaTotals::getPeakReservedBytes() { return peakReservedBytes; }
+size_t ArenaTotals::getNumArenas() { return totalNumArenas; }
+size_t ArenaTotals::getWastedBytes() { return totalWastedBytes; }
+size_t ArenaTotals::getThreadHighWater() { return threadHighWater; }
+void ArenaTotals::setThreadHighWater(size_t bytes) { threadHighWater = bytes; }
+
+void ArenaTotals::onCreateArena(size_t dataSize, size_t retiredTailBytes) {
+  size_t reserved = totalReservedBytes.fetch_add(dataSize) + dataSize;
+  totalNumArenas++;
+  totalWastedBytes += retiredTailBytes;
+
+  size_t peak = peakReservedBytes.load(std::memory_order_relaxed);
+  while (reserved > peak &&
+         !peakReservedBytes.compare_exchange_weak(peak, reserved)) {
+  }
+  if (reserved > threadHighWater)
+    threadHighWater = reserved;
+}
+
+void ArenaTotals::onFreeArenas(const ArenaStats &stats) {
+  totalReservedBytes -= stats.reservedBytes;
+  totalNumArenas -= stats.numArenas;
+  totalWastedBytes -= stats.wastedBytes;
+}
+
 void *ArenaHeader::AllocSpace(size_t size, size_t al) {
   vASSERT(DefaultAlign(size_t(_nextByte)) == size_t(_nextByte));
 
@@ -41,6 +75,8 @@ void *ArenaHeader::AllocSpace(size_t size, size_t al) {
 }
 
 void ArenaManager::FreeArenas() {
+  ArenaTotals::onFreeArenas(_stats);
+  _stats = ArenaStats();
   while (_arenas) {
 #ifdef COLLECT_ALLOCATION_STATS
     currentMallocSize -= _arenas->size;
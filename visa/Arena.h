@@ -35,6 +35,43 @@ extern int currentMallocSize;
 
 namespace vISA {
 class Mem_Manager;
+
+// Memory accounting of an ArenaManager. Unlike COLLECT_ALLOCATION_STATS these
+// counters are always maintained, so that the memory used to compile a kernel
+// can be reported by release builds.
+struct ArenaStats {
+  // Bytes obtained from the heap for arena data.
+  size_t reservedBytes = 0;
+  // Bytes handed out by allocations, rounded up to the default alignment.
+  size_t usedBytes = 0;
+  size_t numArenas = 0;
+  // Unused tail bytes of arenas that are no longer allocated from; only the
+  // most recently created arena of a manager serves allocations.
+  size_t wastedBytes = 0;
+};
+
+// Totals over all live ArenaManagers of the process. They are only updated
+// when an arena is created or freed, which keeps the allocation fast path
+// free of atomics; hence there is no process-wide usedBytes.
+class ArenaTotals {
+public:
+  static size_t getReservedBytes();
+  static size_t getPeakReservedBytes();
+  static size_t getNumArenas();
+  static size_t getWastedBytes();
+
+  // Largest reservedBytes reached by an arena created on the calling thread
+  // since the last call to setThreadHighWater(). Used to compute the
+  // high-water mark of nested compiler phases.
+  static size_t getThreadHighWater();
+  static void setThreadHighWater(size_t bytes);
+
+private:
+  friend class ArenaManager;
+  static void onCreateArena(size_t dataSize, size_t retiredTailBytes);
+  static void onFreeArenas(const ArenaStats &stats);
+};
+
 class ArenaHeader {
   friend class ArenaManager;
 
@@ -111,11 +148,18 @@ private:
   ArenaManager(const ArenaManager&) = delete;
   ArenaManager& operator=(const ArenaManager&) = delete;
 
+  const ArenaStats &getStats() const { return _stats; }
+
   void *AllocDataSpace(size_t size, size_t al) {
     // Do separate memory allocations of debugMemAlloc is set, to allow
     // valgrind/drmemory to find more buffer over-reads/writes
 #if !defined(NDEBUG) && defined(vISA_DEBUG_MEM_ALLOC)
-    return size == 0 ? 0 : malloc(size);
+    if (size == 0)
+      return 0;
+    // Counted like an arena allocation, so that the reported usage does not
+    // depend on the allocation mode.
+    _stats.usedBytes += ArenaHeader::DefaultAlign(size);
+    return malloc(size);
 #endif
     void *space = nullptr;
 
@@ -128,6 +172,7 @@ private:
       }
 
       vASSERT(space);
+      _stats.usedBytes += ArenaHeader::DefaultAlign(size);
     }
 
 #ifdef COLLECT_ALLOCATION_STATS
@@ -147,12 +192,20 @@ private:
 
     ArenaHeader *newArena = new (arena) ArenaHeader(arenaDataSize, _arenas);
     // Add new arena to the head of queue
+    size_t retiredTailBytes = 0;
     if (_arenas != NULL) {
       newArena->_nextArena = _arenas;
+      retiredTailBytes =
+          static_cast<size_t>(_arenas->_lastByte - _arenas->_nextByte);
     }
 
     _arenas = newArena;
 
+    _stats.reservedBytes += arenaDataSize;
+    _stats.numArenas++;
+    _stats.wastedBytes += retiredTailBytes;
+    ArenaTotals::onCreateArena(arenaDataSize, retiredTailBytes);
+
 #ifdef COLLECT_ALLOCATION_STATS
     numMallocCalls++;
     totalMallocSize += arenaDataSize;
@@ -179,6 +232,7 @@ private:
 
   ArenaHeader *_arenas;
   const size_t _defaultArenaSize;
+  ArenaStats _stats;
 };
 } // namespace vISA
 #endif
@@ -19,7 +19,9 @@ SPDX-License-Identifier: MIT
 // clang-format on
 
 #include <cstdint>
+#include <functional>
 #include <sstream>
+#include <vector>
 
 namespace vISA {
 class Mem_Manager;
@@ -695,6 +697,18 @@ private:
   std::stringstream criticalMsg;
 
 private:
+  // Number of threads used to compile kernels/functions concurrently
+  // (vISA_CompileThreads); 1 when the module must be compiled serially.
+  unsigned getCompileThreads() const;
+
+  // Runs compileUnit(i) for every unit on up to numThreads threads and returns
+  // the statuses in unit order. The critical messages of each unit are
+  // buffered while it runs and appended to criticalMsg in unit order.
+  std::vector<int>
+  compileInParallel(const std::vector<VISAKernelImpl *> &units,
+                    unsigned numThreads,
+                    const std::function<int(size_t)> &compileUnit);
+
   // Summarize sub-functions' FINALIZER_INFO and propagate them into main
   // functions'. This functions handles perf stats, barrier count and
   // spill/stack size estimation. After Stitch_Compiled_Units the
@@ -9,6 +9,7 @@ SPDX-License-Identifier: MIT
 #include "Common_ISA.h"
 #include "Common_ISA_framework.h"
 #include "Common_ISA_util.h"
+#include "CompileTrace.h"
 #include "visa_igc_common_header.h"
 #ifdef DLL_MODE
 #include "RT_Jitter_Interface.h"
@@ -27,6 +28,7 @@ SPDX-License-Identifier: MIT
 #include "IGC/common/StringMacros.hpp"
 #include "MetadataDumpRA.h"
 
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -35,6 +37,7 @@ SPDX-License-Identifier: MIT
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 
 // clang-format off
 #include "common/LLVMWarningsPush.hpp"
@@ -275,6 +278,10 @@ int CISA_IR_Builder::CreateBuilder(CISA_IR_Builder *&builder,
   builder->m_options.getOptionsFromEV();
 #endif
 
+  CompileTrace::Recorder::get().enable(
+      builder->m_options.getOptionCstr(vISA_CompileTraceFile),
+      CompileTrace::Phases);
+
 #if !defined(NDEBUG) && !defined(DLL_MODE)
   auto debugPassesCstr = builder->m_options.getOptionCstr(vISA_DebugOnly);
   if (debugPassesCstr) {
@@ -340,6 +347,8 @@ int CISA_IR_Builder::DestroyBuilder(CISA_IR_Builder *builder) {
 
   delete builder;
 
+  CompileTrace::Recorder::get().flush();
+
   return VISA_SUCCESS;
 }
 
@@ -1573,6 +1582,156 @@ int CISA_IR_Builder::ParseVISAText(const std::string &visaFile) {
 
 }
 
+unsigned CISA_IR_Builder::getCompileThreads() const {
+  unsigned numThreads = m_options.getuInt32Option(vISA_CompileThreads);
+  // RA traces are written straight to std::cout from deep inside RA and
+  // cannot be buffered per kernel like the other console output.
+  if (numThreads <= 1 || m_kernelsAndFunctions.size() <= 1 ||
+      m_options.getuInt32Option(vISA_CodePatch) ||
+      m_options.getOption(vISA_RATrace))
+    return 1;
+  for (auto func : m_kernelsAndFunctions) {
+    if (func->getIsPayload())
+      return 1;
+  }
+  return numThreads;
+}
+
+std::vector<int> CISA_IR_Builder::compileInParallel(
+    const std::vector<VISAKernelImpl *> &units, unsigned numThreads,
+    const std::function<int(size_t)> &compileUnit) {
+  std::vector<int> status(units.size(), VISA_SUCCESS);
+  for (auto unit : units) {
+    unit->getIRBuilder()->bufferCriticalMsgs();
+    unit->getIRBuilder()->bufferConsoleOutput();
+  }
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < units.size(); i = next++) {
+      CompileTrace::KernelScope traceKernel(
+          units[i]->getName(), units[i]->getKernel()->getSimdSize());
+      CompileTrace::Scope traceUnit("vISA", "ParallelCompileUnit");
+      status[i] = compileUnit(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  size_t numWorkers = std::min<size_t>(numThreads, units.size());
+  for (size_t i = 1; i < numWorkers; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+
+  for (auto unit : units) {
+    criticalMsg << unit->getIRBuilder()->takeBufferedCriticalMsgs();
+    std::cout << unit->getIRBuilder()->takeBufferedConsoleOutput();
+  }
+  std::cout.flush();
+  return status;
+}
+
+// Offsets the stack of each hardware thread by a multiple of its thread id
+// when the kernel sets up a frame pointer (vISA_SSOShifter on DG2).
+static void padScratchSpaceForSSO(VISAKernelImpl *func) {
+  if (!func->getKernel()->getBEFPSetupInst())
+    return;
+
+  auto& builder = *func->getKernel()->fg.builder;
+  auto& spillMemUsed = builder.getJitInfo()->stats.spillMemUsed;
+  auto& scratchSpaceSizeLimit = builder.getJitInfo()->stats.scratchSpaceSizeLimit;
+  // Skip padding when
+  // 1. spill size is smaller than the threshold
+  // 2. spill size is larger than scratchSpaceSizeLimit
+  // (it cannot be encoded into the binary due to the limit)
+  bool skip_padding =
+    builder.kernel.getuInt32Option(vISA_SkipPaddingScratchSpaceSize) >= spillMemUsed ||
+    (scratchSpaceSizeLimit != 0 &&
+     spillMemUsed + (1U << builder.kernel.getuInt32Option(vISA_SSOShifter)) * 8 > scratchSpaceSizeLimit);
+  bool SSO_padding =
+    !skip_padding &&
+    builder.getPlatform() == Xe_DG2 &&
+    builder.kernel.getuInt32Option(vISA_SSOShifter) > 0;
+  if (SSO_padding) {
+    G4_Declare *delta = nullptr;
+    G4_Declare *stackPtr = builder.kernel.fg.stackPtrDcl;
+
+    // Temporarily use stackPtrDcl as a tmp register if padding is needed
+    // Here we are working on physical registers after RA. stackPtrDcl is
+    // guraantee no use at this point
+    G4_Declare *tmp = stackPtr;
+    BB_LIST &BBs = builder.kernel.fg.getBBList();
+    // skip prolog sections (per_thread_prolog and cross_thread_prolog)
+    G4_BB *entryBB = nullptr;
+    for (BB_LIST_ITER it = BBs.begin(); it != BBs.end(); it++) {
+      G4_BB *BB = *it;
+      auto label = BB->getLabel()->getLabelName();
+      if (strcmp(label, "per_thread_prolog") && strcmp(label, "cross_thread_prolog")) {
+        entryBB = BB;
+        break;
+      }
+    }
+    vASSERT(entryBB);
+    auto fpInst = func->getKernel()->getBEFPSetupInst();
+    vISA_ASSERT(fpInst->opcode() == G4_mov, "unexpected pattern");
+    auto spInst = func->getKernel()->getBESPSetupInst();
+    vISA_ASSERT(spInst->opcode() == G4_mov, "unexpected pattern");
+    auto insertIt = std::find_if(entryBB->begin(), entryBB->end(),
+                               [&](G4_INST *inst) { return inst == fpInst; });
+    // If we cannot find fpInst in the entryBB, it is either
+    // 1. getBEFPSetupInst() does not get correct place we initialize the FP
+    // 2. entryBB is not where we expect to contain fpInst
+    vISA_ASSERT(*insertIt == fpInst, "Cannot find fp setup inst");
+    // hwtid = sr0 & 0x7
+    auto sr0 = builder.createSrc(builder.phyregpool.getSr0Reg(), 0, 0,
+        builder.getRegionScalar(), Type_UD);
+    auto mask = builder.createImm(0x7, Type_UD);
+    auto hwtid = builder.createDst(tmp->getRegVar(), 0, 0, 1, Type_UD);
+
+    auto andInst = builder.createBinOp(G4_and, g4::SIMD1, hwtid, sr0, mask,
+        InstOpt_WriteEnable, false);
+    andInst->setVISAId(UNMAPPABLE_VISA_INDEX);
+    andInst->addComment("hwtid = sr0 & 0x7");
+    entryBB->insertBefore(insertIt, andInst);
+
+    // delta = hwtid << vISA_SSOShifter
+    auto tidSrc = builder.createSrc(hwtid->getBase(), 0, 0, builder.getRegionScalar(), Type_UD);
+    auto imm = builder.createImm(builder.kernel.getuInt32Option(vISA_SSOShifter), Type_UD);
+    delta = tmp;
+    auto shlInst = builder.createBinOp(G4_shl, g4::SIMD1,
+        builder.createDst(tmp->getRegVar(), 0, 0, 1, Type_UD),
+        tidSrc, imm,
+        InstOpt_WriteEnable, false);
+    shlInst->setVISAId(UNMAPPABLE_VISA_INDEX);
+    shlInst->addComment("delta = hwtid << vISA_SSOShifter");
+    shlInst->setDistance(1);
+    shlInst->setDistanceTypeXe(G4_INST::DistanceType::DISTALL);
+    entryBB->insertBefore(insertIt, shlInst);
+
+    // add delta to the initialization of SP and FP
+    fpInst->setOpcode(G4_add);
+    fpInst->setSrc(builder.createImm(fpInst->getSrc(0)->asImm()->getImm(), Type_UD), 1);
+    fpInst->setSrc(builder.createSrcRegRegion(delta, builder.getRegionScalar()), 0);
+    fpInst->getDst()->setType(builder, Type_UD);
+
+    spInst->setOpcode(G4_add);
+    spInst->setSrc(builder.createImm(spInst->getSrc(0)->asImm()->getImm(), Type_UD), 1);
+    spInst->setSrc(builder.createSrcRegRegion(delta, builder.getRegionScalar()), 0);
+    spInst->getDst()->setType(builder, Type_UD);
+
+    // Token is inherited by fpInst
+    andInst->inheritSWSBFrom(fpInst);
+    fpInst->setDistance(1);
+    fpInst->setDistanceTypeXe(G4_INST::DistanceType::DISTALL);
+    // Remove token
+    fpInst->setTokenType(G4_INST::TOKEN_NONE);
+
+    // preserve additional size to prevent out of bound access
+    spillMemUsed += (1U << builder.kernel.getuInt32Option(vISA_SSOShifter)) * 7;
+    spillMemUsed = ROUND(spillMemUsed, builder.kernel.numEltPerGRF<Type_UB>());
+  }
+}
+
 // default size of the kernel mem manager in bytes
 int CISA_IR_Builder::Compile(const char *isaasmFileName, bool emit_visa_only) {
   // TIMER_BUILDER is started when builder is created
@@ -1649,6 +1808,11 @@ int CISA_IR_Builder::Compile(const char *isaasmFileName, bool emit_visa_only) {
     KernelListTy::iterator iter = kernel_begin();
     KernelListTy::iterator iend = kernel_end();
     bool hasEarlyExit = false;
+    // Kernels and functions are compiled separately until stitching, so they
+    // may be compiled concurrently. Payload sections and code patching depend
+    // on the compiled shader body and keep the serial order.
+    unsigned numThreads = getCompileThreads();
+    std::vector<VISAKernelImpl *> parallelKernels;
     for (int i = 0; iter != iend; iter++, i++) {
       VISAKernelImpl *kernel = (*iter);
       if ((uint32_t)i < localScheduleStartKernelId ||
@@ -1704,6 +1868,10 @@ int CISA_IR_Builder::Compile(const char *isaasmFileName, bool emit_visa_only) {
           (kernel->getvIsaInstCount() == 0 && kernel->getIsPayload())) {
         continue;
       }
+      if (numThreads > 1) {
+        parallelKernels.push_back(kernel);
+        continue;
+      }
       int status = kernel->compileFastPath();
       if (status != VISA_SUCCESS) {
         if (status == VISA_EARLY_EXIT) {
@@ -1732,6 +1900,21 @@ int CISA_IR_Builder::Compile(const char *isaasmFileName, bool emit_visa_only) {
       }
     }
 
+    if (!parallelKernels.empty()) {
+      std::vector<int> results =
+          compileInParallel(parallelKernels, numThreads, [&](size_t i) {
+            return parallelKernels[i]->compileFastPath();
+          });
+      for (int status : results) {
+        if (status == VISA_EARLY_EXIT) {
+          hasEarlyExit = true;
+        } else if (status != VISA_SUCCESS) {
+          stopTimer(TimerID::TOTAL);
+          return status;
+        }
+      }
+    }
+
     if (hasEarlyExit) {
       // Consider early exit to still be a success as test run
       // lines may check exit status.
@@ -1872,109 +2055,13 @@ int CISA_IR_Builder::Compile(const char *isaasmFileName, bool emit_visa_only) {
         m_options.getOption(VISA_AsmFileName, raFileName);
     }
 
-    // stitch functions and compile to gen binary
-    for (auto func : mainFunctions) {
-      unsigned int genxBufferSize = 0;
-
-      if (func->getKernel()->getBEFPSetupInst())
-      {
-        auto& builder = *func->getKernel()->fg.builder;
-        auto& spillMemUsed = builder.getJitInfo()->stats.spillMemUsed;
-        auto& scratchSpaceSizeLimit = builder.getJitInfo()->stats.scratchSpaceSizeLimit;
-        // Skip padding when
-        // 1. spill size is smaller than the threshold
-        // 2. spill size is larger than scratchSpaceSizeLimit
-        // (it cannot be encoded into the binary due to the limit)
-        bool skip_padding =
-          builder.kernel.getuInt32Option(vISA_SkipPaddingScratchSpaceSize) >= spillMemUsed ||
-          (scratchSpaceSizeLimit != 0 &&
-           spillMemUsed + (1U << builder.kernel.getuInt32Option(vISA_SSOShifter)) * 8 > scratchSpaceSizeLimit);
-        bool SSO_padding =
-          !skip_padding &&
-          builder.getPlatform() == Xe_DG2 &&
-          builder.kernel.getuInt32Option(vISA_SSOShifter) > 0;
-        if (SSO_padding) {
-          G4_Declare *delta = nullptr;
-          G4_Declare *stackPtr = builder.kernel.fg.stackPtrDcl;
-
-          // Temporarily use stackPtrDcl as a tmp register if padding is needed
-          // Here we are working on physical registers after RA. stackPtrDcl is
-          // guraantee no use at this point
-          G4_Declare *tmp = stackPtr;
-          BB_LIST &BBs = builder.kernel.fg.getBBList();
-          // skip prolog sections (per_thread_prolog and cross_thread_prolog)
-          G4_BB *entryBB = nullptr;
-          for (BB_LIST_ITER it = BBs.begin(); it != BBs.end(); it++) {
-            G4_BB *BB = *it;
-            auto label = BB->getLabel()->getLabelName();
-            if (strcmp(label, "per_thread_prolog") && strcmp(label, "cross_thread_prolog")) {
-              entryBB = BB;
-              break;
-            }
-          }
-          vASSERT(entryBB);
-          auto fpInst = func->getKernel()->getBEFPSetupInst();
-          vISA_ASSERT(fpInst->opcode() == G4_mov, "unexpected pattern");
-          auto spInst = func->getKernel()->getBESPSetupInst();
-          vISA_ASSERT(spInst->opcode() == G4_mov, "unexpected pattern");
-          auto insertIt = std::find_if(entryBB->begin(), entryBB->end(),
-                                     [&](G4_INST *inst) { return inst == fpInst; });
-          // If we cannot find fpInst in the entryBB, it is either
-          // 1. getBEFPSetupInst() does not get correct place we initialize the FP
-          // 2. entryBB is not where we expect to contain fpInst
-          vISA_ASSERT(*insertIt == fpInst, "Cannot find fp setup inst");
-          // hwtid = sr0 & 0x7
-          auto sr0 = builder.createSrc(builder.phyregpool.getSr0Reg(), 0, 0,
-              builder.getRegionScalar(), Type_UD);
-          auto mask = builder.createImm(0x7, Type_UD);
-          auto hwtid = builder.createDst(tmp->getRegVar(), 0, 0, 1, Type_UD);
-
-          auto andInst = builder.createBinOp(G4_and, g4::SIMD1, hwtid, sr0, mask,
-              InstOpt_WriteEnable, false);
-          andInst->setVISAId(UNMAPPABLE_VISA_INDEX);
-          andInst->addComment("hwtid = sr0 & 0x7");
-          entryBB->insertBefore(insertIt, andInst);
-
-          // delta = hwtid << vISA_SSOShifter
-          auto tidSrc = builder.createSrc(hwtid->getBase(), 0, 0, builder.getRegionScalar(), Type_UD);
-          auto imm = builder.createImm(builder.kernel.getuInt32Option(vISA_SSOShifter), Type_UD);
-          delta = tmp;
-          auto shlInst = builder.createBinOp(G4_shl, g4::SIMD1,
-              builder.createDst(tmp->getRegVar(), 0, 0, 1, Type_UD),
-              tidSrc, imm,
-              InstOpt_WriteEnable, false);
-          shlInst->setVISAId(UNMAPPABLE_VISA_INDEX);
-          shlInst->addComment("delta = hwtid << vISA_SSOShifter");
-          shlInst->setDistance(1);
-          shlInst->setDistanceTypeXe(G4_INST::DistanceType::DISTALL);
-          entryBB->insertBefore(insertIt, shlInst);
-
-          // add delta to the initialization of SP and FP
-          fpInst->setOpcode(G4_add);
-          fpInst->setSrc(builder.createImm(fpInst->getSrc(0)->asImm()->getImm(), Type_UD), 1);
-          fpInst->setSrc(builder.createSrcRegRegion(delta, builder.getRegionScalar()), 0);
-          fpInst->getDst()->setType(builder, Type_UD);
-
-          spInst->setOpcode(G4_add);
-          spInst->setSrc(builder.createImm(spInst->getSrc(0)->asImm()->getImm(), Type_UD), 1);
-          spInst->setSrc(builder.createSrcRegRegion(delta, builder.getRegionScalar()), 0);
-          spInst->getDst()->setType(builder, Type_UD);
-
-          // Token is inherited by fpInst
-          andInst->inheritSWSBFrom(fpInst);
-          fpInst->setDistance(1);
-          fpInst->setDistanceTypeXe(G4_INST::DistanceType::DISTALL);
-          // Remove token
-          fpInst->setTokenType(G4_INST::TOKEN_NONE);
-
-          // preserve additional size to prevent out of bound access
-          spillMemUsed += (1U << builder.kernel.getuInt32Option(vISA_SSOShifter)) * 7;
-          spillMemUsed = ROUND(spillMemUsed, builder.kernel.numEltPerGRF<Type_UB>());
-        }
-      }
+    // Stitch functions and compile to gen binary. Without functions to stitch
+    // the main functions share no IR and may be finalized concurrently; the
+    // metadata and debug info are still emitted in order.
+    auto finalizeMainFunction = [&](VISAKernelImpl *func,
+                                    std::map<G4_BB *, G4_INST *> &origFCallFRet) {
+      padScratchSpaceForSSO(func);
 
-      // store the BBs with FCall and FRet, which must terminate the BB
-      std::map<G4_BB *, G4_INST *> origFCallFRet;
       if (!hasPayloadPrologue) {
         Stitch_Compiled_Units(func->getKernel(), subFunctionsNameMap,
                               origFCallFRet);
@@ -1996,8 +2083,14 @@ int CISA_IR_Builder::Compile(const char *isaasmFileName, bool emit_visa_only) {
         }
       }
 
+      unsigned int genxBufferSize = 0;
       void *genxBuffer = func->encodeAndEmit(genxBufferSize);
+      func->setGenxBinaryBuffer(genxBuffer, genxBufferSize);
+      return VISA_SUCCESS;
+    };
 
+    auto emitMainFunctionInfo = [&](VISAKernelImpl *func,
+                                    std::map<G4_BB *, G4_INST *> &origFCallFRet) {
       // create metadata for this kernel if enabled
       if (dumpMetadata) {
           metadata->addKernelMD(func->getKernel());
@@ -2006,12 +2099,28 @@ int CISA_IR_Builder::Compile(const char *isaasmFileName, bool emit_visa_only) {
           kernelName = func->getKernel()->getName();
       }
 
-      func->setGenxBinaryBuffer(genxBuffer, genxBufferSize);
       if (m_options.getOption(vISA_GenerateDebugInfo)) {
         func->computeAndEmitDebugInfo(subFunctions);
       }
       restoreFCallState(func->getKernel(), origFCallFRet);
-
+    };
+
+    // store the BBs with FCall and FRet, which must terminate the BB
+    std::vector<std::map<G4_BB *, G4_INST *>> origFCallFRets(
+        mainFunctions.size());
+    std::vector<VISAKernelImpl *> funcs(mainFunctions.begin(),
+                                        mainFunctions.end());
+    if (numThreads > 1 && subFunctionsNameMap.empty() && !hasPayloadPrologue) {
+      compileInParallel(funcs, numThreads, [&](size_t i) {
+        return finalizeMainFunction(funcs[i], origFCallFRets[i]);
+      });
+      for (size_t i = 0; i < funcs.size(); ++i)
+        emitMainFunctionInfo(funcs[i], origFCallFRets[i]);
+    } else {
+      for (size_t i = 0; i < funcs.size(); ++i) {
+        finalizeMainFunction(funcs[i], origFCallFRets[i]);
+        emitMainFunctionInfo(funcs[i], origFCallFRets[i]);
+      }
     }
 
     if (dumpMetadata) {
@@ -3931,9 +4040,17 @@ void CISA_IR_Builder::CISA_post_file_parse() { return; }
 // place it here so that internal Gen_IR files don't have to include
 // VISAKernel.h
 std::stringstream &IR_Builder::criticalMsgStream() {
+  if (bufferedCriticalMsg)
+    return *bufferedCriticalMsg;
   return const_cast<CISA_IR_Builder *>(parentBuilder)->criticalMsgStream();
 }
 
+std::ostream &IR_Builder::consoleStream() {
+  if (bufferedConsoleOutput)
+    return *bufferedConsoleOutput;
+  return std::cout;
+}
+
 bool CISA_IR_Builder::CISA_create_dpas_instruction(
     ISA_Opcode opcode, VISA_EMask_Ctrl emask, unsigned exec_size,
     VISA_opnd *dst_cisa, VISA_opnd *src0_cisa, VISA_opnd *src1_cisa,
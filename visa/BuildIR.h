@@ -12,8 +12,10 @@ SPDX-License-Identifier: MIT
 #include <cstdarg>
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
+#include <sstream>
 #include <string>
 
 #include "Assertions.h"
@@ -382,6 +384,9 @@ private:
 
   const WA_TABLE *m_pWaTable;
   Options *m_options = nullptr;
+  std::unique_ptr<std::stringstream> bufferedCriticalMsg;
+  std::unique_ptr<std::stringstream> bufferedConsoleOutput;
+  std::optional<bool> lscBackupModeOverride;
 
   std::map<const G4_INST *, G4_FCALL> m_fcallInfo;
 
@@ -501,6 +506,35 @@ public:
   void dump(std::ostream &os); // not const because G4_INST::emit isn't :(
 
   std::stringstream &criticalMsgStream();
+  // While a kernel is compiled on a worker thread its critical messages are
+  // buffered here and later appended to the parent builder in kernel order.
+  void bufferCriticalMsgs() {
+    bufferedCriticalMsg = std::make_unique<std::stringstream>();
+  }
+  std::string takeBufferedCriticalMsgs() {
+    std::string msgs = bufferedCriticalMsg ? bufferedCriticalMsg->str() : "";
+    bufferedCriticalMsg.reset();
+    return msgs;
+  }
+
+  // Likewise for the dumps printed to the console, e.g. vISA_asmToConsole.
+  std::ostream &consoleStream();
+  void bufferConsoleOutput() {
+    bufferedConsoleOutput = std::make_unique<std::stringstream>();
+  }
+  std::string takeBufferedConsoleOutput() {
+    std::string output =
+        bufferedConsoleOutput ? bufferedConsoleOutput->str() : "";
+    bufferedConsoleOutput.reset();
+    return output;
+  }
+
+  // UGM fences created by passes that need a backup mode bit different from
+  // vISA_LSCBackupMode set it here instead of in the shared option table.
+  void setLscBackupMode(bool val) { lscBackupModeOverride = val; }
+  bool getLscBackupMode() const {
+    return lscBackupModeOverride.value_or(getOption(vISA_LSCBackupMode));
+  }
 
   const USE_DEF_ALLOCATOR &getAllocator() const { return useDefAllocator; }
 
@@ -0,0 +1,114 @@
+# ========================== begin_copyright_notice ============================
+#
+# Copyright (C) 2023 Intel Corporation
+#
+# SPDX-License-Identifier: MIT
+#
+# =========================== end_copyright_notice =============================
+
+# Checks a change to SWSB token allocation on the gen_send_heavy.py corpus:
+#   - the asm, SWSB annotations included, is the same as with a baseline
+#     GenX_IR, both with the default allocation and with
+#     -globalTokenAllocation, and
+#   - the SWSB phase time of the new GenX_IR scales near-linearly with the
+#     send count under -globalTokenAllocation.
+# Prints the asm diff count per option set and the scaling exponent, and
+# exits with 1 if any asm differs or the exponent exceeds --max-exponent.
+#
+# Usage:
+#   check_swsb_tokens.py --baseline-genx-ir base/GenX_IR \
+#       --genx-ir build/GenX_IR -- -platform Xe_HPG
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import gen_send_heavy
+
+BENCH = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                     'visa_compile_bench.py')
+
+# Option sets the asm is compared under.
+TOKEN_ALLOCATIONS = [
+    ('default', []),
+    ('global', ['-globalTokenAllocation']),
+]
+
+
+def bench(args):
+    print('$ visa_compile_bench.py ' + ' '.join(args), flush=True)
+    return subprocess.call([sys.executable, BENCH] + args)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='check SWSB token allocation output and scaling')
+    parser.add_argument('--baseline-genx-ir', required=True,
+                        help='GenX_IR executable built without the change')
+    parser.add_argument('--genx-ir', default='GenX_IR',
+                        help='GenX_IR executable built with the change '
+                             '(default: %(default)s)')
+    parser.add_argument('--sends', type=int, nargs='+',
+                        default=[1024, 2048, 4096, 8192],
+                        help='send counts of the corpus '
+                             '(default: %(default)s)')
+    parser.add_argument('--max-exponent', type=float, default=1.3,
+                        help='fail if the SWSB time grows faster than '
+                             'sends**max_exponent (default: %(default)s)')
+    parser.add_argument('--keep', metavar='DIR',
+                        help='write the corpus and results here and keep '
+                             'them')
+    parser.add_argument('visa_args', nargs=argparse.REMAINDER,
+                        help='options passed to GenX_IR after "--", e.g. '
+                             '-platform')
+    args = parser.parse_args()
+    if args.visa_args and args.visa_args[0] == '--':
+        args.visa_args = args.visa_args[1:]
+    # GenX_IR runs in scratch directories.
+    for attr in ('genx_ir', 'baseline_genx_ir'):
+        if os.path.dirname(getattr(args, attr)):
+            setattr(args, attr, os.path.abspath(getattr(args, attr)))
+
+    work_dir = args.keep or tempfile.mkdtemp(prefix='visa_swsb_check_')
+    corpus = os.path.join(work_dir, 'sends')
+    os.makedirs(corpus, exist_ok=True)
+    try:
+        for sends in args.sends:
+            name = 'send_heavy_%d' % sends
+            with open(os.path.join(corpus, name + '.visaasm'), 'w') as f:
+                f.write(gen_send_heavy.gen_kernel(name, sends, 48, 16))
+
+        summary = []
+        failed = False
+        for label, options in TOKEN_ALLOCATIONS:
+            code = bench(['asm-diff', '--baseline-genx-ir',
+                          args.baseline_genx_ir, '--genx-ir', args.genx_ir,
+                          '--corpus', corpus, '--'] + args.visa_args +
+                         options)
+            summary.append('%-12s %s' % (
+                'asm ' + label, {0: 'same', 1: 'DIFFERS'}.get(code, 'FAILED')))
+            failed |= code != 0
+
+        result = os.path.join(work_dir, 'sends.json')
+        code = bench(['run', '--genx-ir', args.genx_ir, '--corpus', corpus,
+                      '--output', result, '--'] + args.visa_args +
+                     ['-globalTokenAllocation'])
+        if code == 0:
+            code = bench(['scaling', result, '--phase', 'SWSB',
+                          '--max-exponent', str(args.max_exponent)])
+        summary.append('%-12s %s' % ('scaling', {0: 'ok', 1: 'EXCEEDED'}.get(
+            code, 'FAILED')))
+        failed |= code != 0
+
+        print('\n'.join(summary))
+        return 1 if failed else 0
+    finally:
+        if not args.keep:
+            shutil.rmtree(work_dir, ignore_errors=True)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,89 @@
+# ========================== begin_copyright_notice ============================
+#
+# Copyright (C) 2023 Intel Corporation
+#
+# SPDX-License-Identifier: MIT
+#
+# =========================== end_copyright_notice =============================
+
+# Generates synthetic send-heavy .visaasm kernels of growing size for
+# visa_compile_bench.py, to check how the compile time of a phase (e.g. SWSB
+# token allocation) scales with the number of sends.
+#
+# Each kernel is a chain of blocks. A block issues a window of loads into
+# reused registers, consumes them in reverse order, stores the result and
+# conditionally skips the next block, so that sends are live across blocks
+# and more of them are in flight than there are SWSB tokens.
+#
+# Usage:
+#   gen_send_heavy.py --output corpus/ --sends 1024 2048 4096 8192
+#   visa_compile_bench.py run --genx-ir build/GenX_IR --corpus corpus/ \
+#       --output swsb.json -- -platform Xe_HPG
+#   visa_compile_bench.py scaling swsb.json --phase SWSB
+
+import argparse
+import os
+import sys
+
+
+def gen_kernel(name, sends, window, simd):
+    blocks = max(1, sends // (window + 1))
+    lines = ['.version 4.1', '', '.kernel "%s"' % name, '']
+    lines.append('.decl Addr v_type=G type=uq num_elts=%d align=GRF' % simd)
+    lines.append('.decl Acc v_type=G type=d num_elts=%d align=GRF' % simd)
+    for i in range(window):
+        lines.append('.decl D%d v_type=G type=d num_elts=%d align=GRF' %
+                     (i, simd))
+    lines.append('.decl P1 v_type=P num_elts=1')
+    lines.append('.input Addr offset=64 size=%d' % (simd * 8))
+    lines.append('.kernel_attr Target="3d"')
+    lines.append('.kernel_attr SimdSize=%d' % simd)
+    lines.append('')
+    lines.append('main:')
+    lines.append('    mov (M1, %d) Acc(0,0)<1> 0x0:d' % simd)
+    for b in range(blocks):
+        for i in range(window):
+            lines.append('    lsc_load.ugm (M1, %d) D%d:d32 flat[Addr+0x%x]:a64'
+                         % (simd, i, (b * window + i) * 4))
+        for i in reversed(range(window)):
+            lines.append('    add (M1, %d) Acc(0,0)<1> Acc(0,0)<1;1,0> '
+                         'D%d(0,0)<1;1,0>' % (simd, i))
+        lines.append('    lsc_store.ugm (M1, %d) flat[Addr+0x%x]:a64 Acc:d32' %
+                     (simd, b * 4))
+        if b + 2 <= blocks:
+            lines.append('    cmp.eq (M1, 1) P1 Acc(0,0)<0;1,0> 0x%x:d' % b)
+            lines.append('    (P1) jmp (M1, 1) BB_%d' % (b + 2))
+        lines.append('BB_%d:' % (b + 1))
+    lines.append('    ret (M1, 1)')
+    return '\n'.join(lines) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='generate send-heavy .visaasm kernels')
+    parser.add_argument('--output', required=True,
+                        help='directory the kernels are written to')
+    parser.add_argument('--sends', type=int, nargs='+',
+                        default=[512, 1024, 2048, 4096, 8192],
+                        help='approximate send count of each kernel '
+                             '(default: %(default)s)')
+    parser.add_argument('--window', type=int, default=48,
+                        help='loads in flight per block (default: %(default)s)')
+    parser.add_argument('--simd', type=int, default=16, choices=[8, 16, 32],
+                        help='execution size (default: %(default)s)')
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+    for sends in args.sends:
+        # The send count is the last number of the name, which is what
+        # "visa_compile_bench.py scaling" reads the input size from.
+        name = 'send_heavy_%d' % sends
+        path = os.path.join(args.output, name + '.visaasm')
+        with open(path, 'w') as f:
+            f.write(gen_kernel(name, sends, args.window, args.simd))
+        print(path)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
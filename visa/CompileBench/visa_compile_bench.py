@@ -0,0 +1,451 @@
+# ========================== begin_copyright_notice ============================
+#
+# Copyright (C) 2023 Intel Corporation
+#
+# SPDX-License-Identifier: MIT
+#
+# =========================== end_copyright_notice =============================
+
+# Compile-time regression benchmark for the vISA backend.
+#
+# Runs every .visaasm file of a corpus through the standalone GenX_IR
+# executable a number of times and collects, per input:
+#   - the per-phase times of the TimerDefs.h buckets (-timestats),
+#   - the wall time and peak RSS of the GenX_IR process, and the peak arena
+#     memory reported in the kernel stats,
+#   - the code-quality stats of every kernel (-dumpVISAJsonStats): binary
+#     size, spill/fill count, spill size, instruction count, cycles.
+# Times are the median over the runs; everything is written as JSON.
+#
+# A result can be compared against a baseline result, either right after a
+# run (run --baseline) or offline (compare). The comparison fails when a
+# time grows by more than the time tolerance or a code-quality metric grows
+# by more than the size tolerance, so that RA, scheduler and SWSB changes
+# can be gated on compile-time and code-quality budgets without a GPU.
+#
+# Usage:
+#   visa_compile_bench.py run --genx-ir build/GenX_IR --corpus kernels/ \
+#       --repeat 5 --output new.json -- -platform Xe_HPG
+#   visa_compile_bench.py compare base.json new.json
+#   visa_compile_bench.py scaling new.json --phase SWSB
+#   visa_compile_bench.py asm-diff --baseline-genx-ir base/GenX_IR \
+#       --genx-ir new/GenX_IR --corpus kernels/ -- -platform Xe_HPG
+
+import argparse
+import difflib
+import glob
+import json
+import math
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+RESULT_VERSION = 1
+
+# Kernel stats (from <asm>.stats.json) that are summed over all kernels and
+# functions of one input. Larger is worse for each of them.
+SUMMED_STATS = ['binarySize', 'numAsmCount', 'numGRFSpillFill',
+                'numFlagSpillStore', 'numFlagSpillLoad', 'numCycles']
+# Kernel stats for which the maximum over the input is reported.
+MAX_STATS = ['GRFSpillSize']
+QUALITY_METRICS = SUMMED_STATS + MAX_STATS
+
+
+def find_inputs(corpus):
+    inputs = []
+    for path in corpus:
+        if os.path.isdir(path):
+            for ext in ('*.visaasm', '*.isaasm'):
+                inputs += glob.glob(os.path.join(path, '**', ext),
+                                    recursive=True)
+        else:
+            inputs.append(path)
+    return sorted(set(os.path.abspath(p) for p in inputs))
+
+
+def run_process(cmd, cwd):
+    # os.wait4 gives the resource usage of this very child; it is not
+    # available on Windows, where the peak RSS is not reported.
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, cwd=cwd, stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE)
+    peak_rss_kb = None
+    if hasattr(os, 'wait4'):
+        stderr = proc.stderr.read()
+        _, status, usage = os.wait4(proc.pid, 0)
+        proc.returncode = os.waitstatus_to_exitcode(status)
+        peak_rss_kb = usage.ru_maxrss
+    else:
+        _, stderr = proc.communicate()
+    wall = time.perf_counter() - start
+    return proc.returncode, stderr.decode(errors='replace'), wall, peak_rss_kb
+
+
+def read_timers(work_dir):
+    # dumpAllTimers writes "timers.<asm name>" with one "<name>:<seconds>"
+    # line per TimerDefs.h bucket; the names of nested buckets start with
+    # tabs.
+    phases = {}
+    for path in glob.glob(os.path.join(work_dir, 'timers.*')):
+        with open(path) as f:
+            for line in f:
+                name, sep, value = line.rpartition(':')
+                if not sep:
+                    continue
+                phases[name.strip()] = phases.get(name.strip(), 0.0) + \
+                    float(value)
+    return phases
+
+
+def read_kernel_stats(work_dir):
+    kernels = []
+    for path in sorted(glob.glob(os.path.join(work_dir, '*.stats.json'))):
+        with open(path) as f:
+            kernels += json.load(f)
+    return kernels
+
+
+def summarize_stats(kernels):
+    summary = {}
+    for key in SUMMED_STATS:
+        summary[key] = sum(k.get(key, 0) for k in kernels)
+    for key in MAX_STATS:
+        summary[key] = max([k.get(key, 0) for k in kernels], default=0)
+    return summary
+
+
+def bench_input(args, path):
+    cmd = [args.genx_ir, path, '-dumpToCurrentDir', '-timestats',
+           '-dumpVISAJsonStats'] + args.visa_args
+    walls, rss, phase_runs = [], [], []
+    kernels = []
+    for _ in range(args.repeat):
+        work_dir = tempfile.mkdtemp(prefix='visa_bench_')
+        try:
+            code, stderr, wall, peak_rss_kb = run_process(cmd, work_dir)
+            if code != 0:
+                return {'error': 'GenX_IR exited with %d' % code,
+                        'stderr': stderr[-4096:]}
+            walls.append(wall)
+            if peak_rss_kb is not None:
+                rss.append(peak_rss_kb)
+            phase_runs.append(read_timers(work_dir))
+            kernels = read_kernel_stats(work_dir)
+        finally:
+            shutil.rmtree(work_dir, ignore_errors=True)
+
+    phase_names = sorted(set().union(*phase_runs))
+    result = {
+        'wallTime': statistics.median(walls),
+        'phases': {
+            name: statistics.median(run.get(name, 0.0) for run in phase_runs)
+            for name in phase_names
+        },
+        'quality': summarize_stats(kernels),
+        'kernels': kernels,
+    }
+    if rss:
+        result['peakRSSKB'] = max(rss)
+    arena_peaks = [k['memory']['peakReservedBytes'] for k in kernels
+                   if 'memory' in k]
+    if arena_peaks:
+        result['peakArenaBytes'] = max(arena_peaks)
+    return result
+
+
+def cmd_run(args):
+    inputs = find_inputs(args.corpus)
+    if not inputs:
+        print('no .visaasm inputs found', file=sys.stderr)
+        return 2
+
+    results = {}
+    failed = False
+    for path in inputs:
+        name = os.path.relpath(path, os.path.commonpath(inputs)) \
+            if len(inputs) > 1 else os.path.basename(path)
+        print('%-60s' % name, end='', flush=True)
+        results[name] = bench_input(args, path)
+        if 'error' in results[name]:
+            failed = True
+            print(' FAILED: %s' % results[name]['error'])
+            print(results[name]['stderr'], file=sys.stderr)
+        else:
+            print(' %8.3fs' % results[name]['wallTime'])
+
+    output = {
+        'version': RESULT_VERSION,
+        'genxIR': args.genx_ir,
+        'visaArgs': args.visa_args,
+        'repeat': args.repeat,
+        'inputs': results,
+    }
+    with open(args.output, 'w') as f:
+        json.dump(output, f, indent=2, sort_keys=True)
+        f.write('\n')
+
+    if failed:
+        return 2
+    if args.baseline:
+        return compare(load_result(args.baseline), output, args)
+    return 0
+
+
+def load_result(path):
+    with open(path) as f:
+        result = json.load(f)
+    if result.get('version') != RESULT_VERSION:
+        raise SystemExit('%s: unsupported result version %r' %
+                         (path, result.get('version')))
+    return result
+
+
+def check(rows, name, metric, base, new, tolerance, min_delta):
+    if base is None or new is None:
+        return False
+    delta = new - base
+    regressed = delta > min_delta and delta > base * tolerance
+    if regressed or delta != 0:
+        rows.append((name, metric, base, new, regressed))
+    return regressed
+
+
+def compare(base, new, args):
+    rows = []
+    regressed = False
+    base_inputs = base['inputs']
+    for name, result in sorted(new['inputs'].items()):
+        old = base_inputs.get(name)
+        if old is None or 'error' in old or 'error' in result:
+            continue
+        regressed |= check(rows, name, 'wallTime', old['wallTime'],
+                           result['wallTime'], args.time_tolerance,
+                           args.min_time)
+        for phase, value in sorted(result['phases'].items()):
+            regressed |= check(rows, name, 'phase:' + phase,
+                               old['phases'].get(phase), value,
+                               args.time_tolerance, args.min_time)
+        for metric in ('peakRSSKB', 'peakArenaBytes'):
+            regressed |= check(rows, name, metric, old.get(metric),
+                               result.get(metric), args.memory_tolerance, 0)
+        for metric in QUALITY_METRICS:
+            regressed |= check(rows, name, metric, old['quality'].get(metric),
+                               result['quality'].get(metric),
+                               args.size_tolerance, 0)
+
+    missing = sorted(set(base_inputs) - set(new['inputs']))
+    for name in missing:
+        print('%s: missing from the new result' % name)
+
+    for name, metric, old, value, bad in rows:
+        if not bad and not args.verbose:
+            continue
+        change = (value - old) / old * 100 if old else float('inf')
+        print('%-40s %-28s %12.4g -> %12.4g (%+.1f%%)%s' %
+              (name, metric, old, value, change,
+               '  REGRESSION' if bad else ''))
+    print('%d regression(s)' % sum(1 for row in rows if row[4]))
+    return 1 if regressed else 0
+
+
+def cmd_compare(args):
+    return compare(load_result(args.baseline), load_result(args.result), args)
+
+
+def cmd_scaling(args):
+    # The input size is the last number in the input name, e.g. the send
+    # count of the gen_send_heavy.py kernels. The exponent is the slope of
+    # log(time) over log(size) between the smallest and largest input: about
+    # 1 for linear scaling and 2 for quadratic.
+    result = load_result(args.result)
+    points = []
+    for name, data in result['inputs'].items():
+        sizes = re.findall(r'\d+', os.path.basename(name))
+        if not sizes or 'error' in data:
+            continue
+        if args.phase:
+            value = data['phases'].get(args.phase)
+        else:
+            value = data['wallTime']
+        if value is not None:
+            points.append((int(sizes[-1]), value, name))
+    points.sort()
+    if not points:
+        print('no sized inputs with %s' % (args.phase or 'wallTime'))
+        return 2
+
+    metric = 'phase:' + args.phase if args.phase else 'wallTime'
+    print('%-40s %10s %12s %14s' % ('input', 'size', metric, 'per unit'))
+    for size, value, name in points:
+        print('%-40s %10d %12.4g %14.4g' %
+              (name, size, value, value / size if size else float('inf')))
+    (size0, time0, _), (size1, time1, _) = points[0], points[-1]
+    if size1 > size0 and time0 > 0 and time1 > 0:
+        exponent = math.log(time1 / time0) / math.log(size1 / size0)
+        print('scaling exponent: %.2f' % exponent)
+        if args.max_exponent is not None and exponent > args.max_exponent:
+            print('exceeds %.2f' % args.max_exponent)
+            return 1
+    return 0
+
+
+# Header lines of the asm that may differ between two builds of GenX_IR
+# without the generated code changing.
+ASM_IGNORED = re.compile(r'^//\.(full_options|BuildID)')
+
+
+def read_asm(work_dir):
+    asm = {}
+    for path in sorted(glob.glob(os.path.join(work_dir, '*.asm'))):
+        with open(path, errors='replace') as f:
+            asm[os.path.basename(path)] = [
+                line for line in f if not ASM_IGNORED.match(line)]
+    return asm
+
+
+def compile_asm(genx_ir, path, visa_args):
+    work_dir = tempfile.mkdtemp(prefix='visa_asm_diff_')
+    try:
+        code, stderr, _, _ = run_process(
+            [genx_ir, path, '-dumpToCurrentDir', '-output'] + visa_args,
+            work_dir)
+        if code != 0:
+            return None, 'GenX_IR exited with %d\n%s' % (code, stderr[-4096:])
+        return read_asm(work_dir), None
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+
+def cmd_asm_diff(args):
+    # Compiles every input with two GenX_IR executables and diffs the
+    # generated asm, which includes the SWSB annotations. This checks that a
+    # compile-time change, e.g. to SWSB token allocation, leaves the code
+    # unchanged.
+    inputs = find_inputs(args.corpus)
+    if not inputs:
+        print('no .visaasm inputs found', file=sys.stderr)
+        return 2
+
+    num_diffs = 0
+    for path in inputs:
+        base, err = compile_asm(args.baseline_genx_ir, path, args.visa_args)
+        if base is not None:
+            new, err = compile_asm(args.genx_ir, path, args.visa_args)
+        if err:
+            print('%s: FAILED: %s' % (path, err))
+            return 2
+        if not base:
+            print('%s: no asm written' % path)
+            return 2
+        for name in sorted(set(base) | set(new)):
+            diff = list(difflib.unified_diff(
+                base.get(name, []), new.get(name, []),
+                'baseline/' + name, 'new/' + name, n=2))
+            if diff:
+                num_diffs += 1
+                sys.stdout.writelines(diff[:args.max_lines])
+    print('%d asm file(s) differ' % num_diffs)
+    return 1 if num_diffs else 0
+
+
+def add_compare_options(parser):
+    parser.add_argument('--time-tolerance', type=float, default=0.05,
+                        help='allowed relative growth of a time '
+                             '(default: %(default)s)')
+    parser.add_argument('--min-time', type=float, default=0.001,
+                        help='time growth in seconds below which a change is '
+                             'considered noise (default: %(default)s)')
+    parser.add_argument('--memory-tolerance', type=float, default=0.05,
+                        help='allowed relative growth of the peak memory '
+                             '(default: %(default)s)')
+    parser.add_argument('--size-tolerance', type=float, default=0.0,
+                        help='allowed relative growth of binary size, '
+                             'instruction, spill and cycle counts '
+                             '(default: %(default)s)')
+    parser.add_argument('-v', '--verbose', action='store_true',
+                        help='also print the changes within budget')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='vISA compile-time and code-quality benchmark')
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    run = sub.add_parser('run', help='benchmark a corpus of .visaasm files')
+    run.add_argument('--genx-ir', default='GenX_IR',
+                     help='standalone vISA executable (default: %(default)s)')
+    run.add_argument('--corpus', nargs='+', required=True,
+                     help='.visaasm files or directories searched '
+                          'recursively')
+    run.add_argument('--repeat', type=int, default=3,
+                     help='runs per input; times are the median '
+                          '(default: %(default)s)')
+    run.add_argument('--output', default='visa_bench.json',
+                     help='result file (default: %(default)s)')
+    run.add_argument('--baseline',
+                     help='result file to compare the new result against')
+    run.add_argument('visa_args', nargs=argparse.REMAINDER,
+                     help='options passed to GenX_IR after "--", e.g. '
+                          '-platform')
+    add_compare_options(run)
+
+    cmp = sub.add_parser('compare', help='compare two result files')
+    cmp.add_argument('baseline')
+    cmp.add_argument('result')
+    add_compare_options(cmp)
+
+    scaling = sub.add_parser('scaling',
+                             help='report how a time grows with input size')
+    scaling.add_argument('result')
+    scaling.add_argument('--phase',
+                         help='TimerDefs.h bucket, e.g. SWSB (default: the '
+                              'wall time)')
+    scaling.add_argument('--max-exponent', type=float,
+                         help='fail if the time grows faster than '
+                              'size**max_exponent')
+
+    asm_diff = sub.add_parser('asm-diff',
+                              help='check that two GenX_IR builds generate '
+                                   'the same asm')
+    asm_diff.add_argument('--baseline-genx-ir', required=True,
+                          help='GenX_IR executable built without the change')
+    asm_diff.add_argument('--genx-ir', default='GenX_IR',
+                          help='GenX_IR executable built with the change '
+                               '(default: %(default)s)')
+    asm_diff.add_argument('--corpus', nargs='+', required=True,
+                          help='.visaasm files or directories searched '
+                               'recursively')
+    asm_diff.add_argument('--max-lines', type=int, default=40,
+                          help='diff lines printed per file '
+                               '(default: %(default)s)')
+    asm_diff.add_argument('visa_args', nargs=argparse.REMAINDER,
+                          help='options passed to GenX_IR after "--"')
+
+    args = parser.parse_args()
+    if args.command in ('run', 'asm-diff'):
+        if args.visa_args and args.visa_args[0] == '--':
+            args.visa_args = args.visa_args[1:]
+        # GenX_IR runs in a scratch directory; a bare name is looked up in
+        # PATH.
+        for attr in ('genx_ir', 'baseline_genx_ir'):
+            path = getattr(args, attr, None)
+            if path and os.path.dirname(path):
+                setattr(args, attr, os.path.abspath(path))
+    if args.command == 'asm-diff':
+        return cmd_asm_diff(args)
+    if args.command == 'scaling':
+        return cmd_scaling(args)
+    if args.command == 'run':
+        if args.repeat < 1:
+            parser.error('--repeat must be at least 1')
+        return cmd_run(args)
+    return cmd_compare(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -22,7 +22,9 @@ SPDX-License-Identifier: MIT
 #include "iga/IGALibrary/api/iga.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
@@ -354,7 +356,7 @@ G4_BB *FlowGraph::createNewBBWithLabel(const char *LabelSuffix) {
   return newBB;
 }
 
-static int globalCount = 1;
+static std::atomic<int> globalCount{1};
 
 int64_t FlowGraph::insertDummyUUIDMov() {
   // Here when -addKernelId is passed
@@ -372,8 +374,7 @@ int64_t FlowGraph::insertDummyUUIDMov() {
       uint32_t seed = (uint32_t)std::chrono::high_resolution_clock::now()
                           .time_since_epoch()
                           .count();
-      std::mt19937 mt_rand(seed * globalCount);
-      globalCount++;
+      std::mt19937 mt_rand(seed * globalCount++);
 
       G4_DstRegRegion *nullDst = builder->createNullDst(Type_UD);
       int64_t uuID = (int64_t)mt_rand();
@@ -639,10 +640,6 @@ void FlowGraph::constructFlowGraph(INST_LIST &instlist) {
     // done before RA ToDo: just hard-wire the scratch-surface offset register?
     builder->initScratchSurfaceOffset();
   }
-  if (builder->hasFusedEU() && !builder->getOption(vISA_KeepScalarJmp) &&
-      getKernel()->getInt32KernelAttr(Attributes::ATTR_Target) == VISA_CM) {
-    getKernel()->getOptions()->setOptionInternally(vISA_EnableScalarJmp, false);
-  }
 
   //
   // The funcInfoHashTable maintains a map between the id of the function's INIT
@@ -809,7 +806,8 @@ void FlowGraph::constructFlowGraph(INST_LIST &instlist) {
     addToSubroutine(curr_BB, currSubroutine);
   }
 
-  if (builder->getOption(vISA_FreqBasedSpillCost))
+  if (builder->getOption(vISA_FreqBasedSpillCost) ||
+      builder->getOption(vISA_BlockFreqWeights))
     builder->getFreqInfoManager().updateStaticFrequency(subroutines);
 
   // we can do this only after fg is constructed
@@ -3836,6 +3834,7 @@ void vISA::FlowGraph::markStale() {
   immDom.setStale();
   pDom.setStale();
   loops.setStale();
+  blockFreqWeights.reset();
 
   // any other analysis that becomes stale when FlowGraph changes
   // should be marked as stale here.
@@ -4479,6 +4478,34 @@ bool FlowGraph::convertPredCall(
   return changed;
 }
 
+static const unsigned IN_LOOP_REFERENCE_COUNT_FACTOR = 4;
+
+uint32_t FlowGraph::getLoopNestWeight(int loopNestLevel) {
+  if (loopNestLevel == 0) {
+    return 1;
+  }
+  return (uint32_t)std::pow(IN_LOOP_REFERENCE_COUNT_FACTOR,
+                            std::min(loopNestLevel, 8));
+}
+
+float FlowGraph::getBlockWeight(G4_BB *bb) {
+  auto &freqInfo = builder->getFreqInfoManager();
+  if (!blockFreqWeights) {
+    blockFreqWeights = std::all_of(BBs.begin(), BBs.end(), [&](G4_BB *bb) {
+      return !freqInfo.getBlockFreq(bb).isZero();
+    });
+  }
+  if (*blockFreqWeights) {
+    auto freq = freqInfo.getBlockFreq(bb);
+    if (!freq.isZero())
+      return std::ldexp((float)freq.getDigits(), freq.getScale());
+    // bb was added without markStale() after the decision.
+    blockFreqWeights = false;
+  }
+  auto loop = getLoops().getInnerMostLoop(bb);
+  return (float)getLoopNestWeight(loop ? loop->getNestingLevel() : 0);
+}
+
 void FlowGraph::print(std::ostream &OS) const {
   const char *kname = nullptr;
   if (getKernel()) {
@@ -17,6 +17,7 @@ SPDX-License-Identifier: MIT
 
 #include <list>
 #include <map>
+#include <optional>
 #include <ostream>
 #include <set>
 #include <string>
@@ -224,6 +225,9 @@ class FlowGraph {
   vISA::ImmDominator immDom;
   vISA::PostDom pDom;
   vISA::LoopDetection loops;
+  // Whether getBlockWeight uses block frequencies, decided for the whole
+  // kernel the first time it is queried after a CFG change.
+  std::optional<bool> blockFreqWeights;
 
   typedef std::pair<G4_BB *, G4_BB *> Edge;
   typedef std::set<G4_BB *> Blocks;
@@ -596,6 +600,14 @@ public:
   LoopDetection &getLoops() { return loops; }
   void markStale();
 
+  // Reference weight of a block at the given loop nesting level.
+  static uint32_t getLoopNestWeight(int loopNestLevel);
+  // Expected execution count of bb. Block frequencies and loop nesting
+  // weights are not comparable, so the frequencies are used only when every
+  // block of the kernel has one; otherwise every block gets its loop nesting
+  // weight.
+  float getBlockWeight(G4_BB *bb);
+
 private:
   // Use normalized region descriptors for each source operand if possible.
   void normalizeRegionDescriptors();
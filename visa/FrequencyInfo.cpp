@@ -63,7 +63,7 @@ void FrequencyInfo::storeStaticFrequencyAsMetadata(G4_INST* i)
 void FrequencyInfo::updateStaticFrequencyForBasicBlock(G4_BB *bb) {
   G4_INST *lastInst =
       !bb->getInstList().empty() ? bb->getInstList().back() : nullptr;
-  if (hasFreqMetaData(lastInst)) {
+  if (lastInst && hasFreqMetaData(lastInst)) {
     MDNode *mn_digits = lastInst->getMetadata("stats.blockFrequency.digits");
     MDNode *mn_scale = lastInst->getMetadata("stats.blockFrequency.scale");
     Scaled64 freq =
@@ -281,6 +281,11 @@ void FrequencyInfo::sortBasedOnFreq(std::vector<LiveRange*>& lrs)
   return;
 }
 
+Scaled64 FrequencyInfo::getBlockFreq(G4_BB *bb) const {
+  auto it = BlockFreqInfo.find(bb);
+  return it != BlockFreqInfo.end() ? it->second : Scaled64::getZero();
+}
+
 bool FrequencyInfo::hasFreqMetaData(G4_INST *i) {
   MDNode *md_digits = i->getMetadata("stats.blockFrequency.digits");
   MDNode *md_scale = i->getMetadata("stats.blockFrequency.scale");
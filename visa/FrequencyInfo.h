@@ -42,6 +42,9 @@ public:
                              unsigned int numVar);
   void sortBasedOnFreq(std::vector<LiveRange *> &lrs);
   bool hasFreqMetaData(G4_INST *i);
+  // Static frequency of bb taken from the frontend metadata, zero if bb has
+  // none.
+  llvm::ScaledNumber<uint64_t> getBlockFreq(G4_BB *bb) const;
   ~FrequencyInfo() {}
   void dump() const {};
 
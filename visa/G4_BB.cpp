@@ -266,10 +266,10 @@ void G4_BB::emitInstructionSourceLineMapping(std::ostream &output,
                                              INST_LIST_ITER &it) {
   // We record the previous instruction's source code locations so that they are
   // emitted only when there's a change.
-  // Using global variables is ok here since this function is for shader dumps
-  // (i.e., debugging) only.
-  static const char *prevFilename = nullptr;
-  static int prevSrcLineNo = 0;
+  // Using thread-local variables is ok here since this function is for shader
+  // dumps (i.e., debugging) only and each kernel is dumped by a single thread.
+  static thread_local const char *prevFilename = nullptr;
+  static thread_local int prevSrcLineNo = 0;
 
   const char *curFilename = (*it)->getSrcFilename();
   int curSrcLineNo = (*it)->getLineNo();
@@ -8,6 +8,7 @@ SPDX-License-Identifier: MIT
 
 #include "GraphColor.h"
 #include "BuildIR.h"
+#include "CompileTrace.h"
 #include "DebugInfo.h"
 #include "FlagSpillCleanup.h"
 #include "FlowGraph.h"
@@ -25,11 +26,15 @@ SPDX-License-Identifier: MIT
 #include "Timer.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath> // sqrt
 #include <fstream>
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <list>
 #include <sstream>
+#include <thread>
 
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/ADT/SmallString.h>
@@ -45,8 +50,6 @@ using namespace vISA;
 const RAVarInfo GlobalRA::defaultValues;
 const char GlobalRA::StackCallStr[] = "StackCall";
 
-static const unsigned IN_LOOP_REFERENCE_COUNT_FACTOR = 4;
-
 #define BANK_CONFLICT_HEURISTIC_INST 0.04
 #define BANK_CONFLICT_HEURISTIC_REF_COUNT 0.25
 #define BANK_CONFLICT_HEURISTIC_LOOP_ITERATION 5
@@ -1023,7 +1026,7 @@ void BankConflictPass::setupBankConflictsForBBTGL(G4_BB *bb,
       } else {
         setupBankConflictsforMad(inst);
       }
-    } else if (gra.kernel.getOption(vISA_forceBCR) && !forGlobal &&
+    } else if (gra.forceBCR && !forGlobal &&
                inst->getNumSrc() == 2) {
       threeSourceInstNum++;
       setupBankConflictsforMad(inst);
@@ -1043,6 +1046,194 @@ void BankConflictPass::setupBankConflictsForBBTGL(G4_BB *bb,
   }
 }
 
+// Three source ALU instructions whose operands are read in the same cycle, and
+// so conflict when they are in the same bank.
+static bool isBankConflictCandidate(G4_INST *inst) {
+  return inst->getNumSrc() == 3 && !inst->isSend() && !inst->isCFInst() &&
+         !inst->isLabel() && !inst->isOptBarrier() && !inst->isDpas();
+}
+
+// Pairs of sources that are read together: src1/src2 on platforms with a
+// low/high bundle split, all three otherwise.
+static std::vector<std::pair<int, int>>
+getBankConflictSrcPairs(const IR_Builder &builder) {
+  if (builder.lowHighBundle())
+    return {{1, 2}};
+  return {{0, 1}, {0, 2}, {1, 2}};
+}
+
+// Assigns the bank hints from a kernel-wide conflict graph: the declares read
+// together by a three source instruction are connected by an edge weighted by
+// the frequency of the instruction's block. The graph is colored greedily with
+// the two banks, declares with the heaviest edges first, each taking the bank
+// that minimizes the weight of its conflicting edges. Ties keep the hint of the
+// per-BB heuristics. Hints stay soft: coloring prefers the hinted bank but
+// falls back to any register.
+void BankConflictPass::setupBankConflictsGlobally() {
+  G4_Kernel &kernel = gra.kernel;
+  // Platforms with a low/high bundle split keep the per-BB heuristics.
+  vISA_ASSERT(!kernel.fg.builder->lowHighBundle(),
+              "global bank conflict graph needs the even/odd bank model");
+  const std::pair<int, int> srcPairs[] = {{0, 1}, {0, 2}, {1, 2}};
+  constexpr unsigned FixedBank = UINT_MAX;
+
+  // An operand of a three source instruction: the declare (FixedBank for
+  // pre-assigned registers) and whether it starts in the opposite bank of its
+  // declare (or, for FixedBank, which bank it is in).
+  struct BankOpnd {
+    unsigned node = FixedBank;
+    bool odd = false;
+    bool valid = false;
+  };
+
+  std::unordered_map<G4_Declare *, unsigned> nodeIds;
+  std::vector<G4_Declare *> nodes;
+  // Edges keyed by (node1, node2, flip); the two operands conflict when
+  // bank(node1) ^ bank(node2) == flip. Edges to a register with a fixed bank
+  // are kept per node instead.
+  std::map<std::tuple<unsigned, unsigned, bool>, float> edges;
+  std::vector<std::array<float, 2>> fixedCost;
+  std::unordered_set<G4_Declare *> dpasDcls;
+
+  auto getNode = [&](G4_Declare *dcl) {
+    auto [it, inserted] = nodeIds.emplace(dcl, (unsigned)nodes.size());
+    if (inserted) {
+      nodes.push_back(dcl);
+      fixedCost.push_back({0.0f, 0.0f});
+    }
+    return it->second;
+  };
+
+  for (auto bb : kernel.fg) {
+    float weight = kernel.fg.getBlockWeight(bb);
+    for (auto inst : *bb) {
+      if (inst->isDpas()) {
+        for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; i++) {
+          G4_Operand *src = inst->getSrc(i);
+          if (src && src->isSrcRegRegion() && src->getTopDcl())
+            dpasDcls.insert(src->getTopDcl());
+        }
+        continue;
+      }
+      if (!isBankConflictCandidate(inst))
+        continue;
+
+      BankOpnd opnds[3];
+      for (int i = 0; i < 3; i++) {
+        G4_Operand *src = inst->getSrc(i);
+        if (!src || !src->isSrcRegRegion() || src->isAreg() ||
+            src->asSrcRegRegion()->isIndirect())
+          continue;
+        G4_Declare *dcl = GetTopDclFromRegRegion(src);
+        if (!dcl || (dcl->getRegFile() != G4_GRF &&
+                     dcl->getRegFile() != G4_INPUT))
+          continue;
+        unsigned offset = (src->getBase()->asRegVar()->getDeclare()
+                               ->getOffsetFromBase() +
+                           src->getLeftBound()) /
+                          kernel.numEltPerGRF<Type_UB>();
+        G4_RegVar *var = dcl->getRegVar();
+        if (var->isPhyRegAssigned()) {
+          if (!var->getPhyReg()->isGreg())
+            continue;
+          opnds[i].odd =
+              isOddOffset(var->getPhyReg()->asGreg()->getRegNum() + offset);
+        } else {
+          opnds[i].node = getNode(dcl);
+          opnds[i].odd = isOddOffset(offset);
+        }
+        opnds[i].valid = true;
+      }
+
+      for (auto [i, j] : srcPairs) {
+        const BankOpnd &a = opnds[i], &b = opnds[j];
+        if (!a.valid || !b.valid || a.node == b.node)
+          continue;
+        if (a.node == FixedBank) {
+          // b conflicts when bank(b) ^ b.odd == a.odd.
+          fixedCost[b.node][a.odd ^ b.odd] += weight;
+        } else if (b.node == FixedBank) {
+          fixedCost[a.node][a.odd ^ b.odd] += weight;
+        } else {
+          auto key = a.node < b.node
+                         ? std::make_tuple(a.node, b.node, a.odd != b.odd)
+                         : std::make_tuple(b.node, a.node, a.odd != b.odd);
+          edges[key] += weight;
+        }
+      }
+    }
+  }
+
+  if (nodes.empty())
+    return;
+
+  struct Edge {
+    unsigned node;
+    bool flip;
+    float weight;
+  };
+  std::vector<std::vector<Edge>> adj(nodes.size());
+  std::vector<float> totalWeight(nodes.size(), 0.0f);
+  for (auto &[key, weight] : edges) {
+    auto [n1, n2, flip] = key;
+    adj[n1].push_back({n2, flip, weight});
+    adj[n2].push_back({n1, flip, weight});
+    totalWeight[n1] += weight;
+    totalWeight[n2] += weight;
+  }
+  for (unsigned n = 0; n < nodes.size(); n++)
+    totalWeight[n] += fixedCost[n][0] + fixedCost[n][1];
+
+  auto hintBank = [&](G4_Declare *dcl) {
+    BankConflict bc = gra.getBankConflict(dcl);
+    if (bc == BANK_CONFLICT_NONE)
+      return -1;
+    return (bc == BANK_CONFLICT_FIRST_HALF_ODD ||
+            bc == BANK_CONFLICT_SECOND_HALF_ODD)
+               ? 1
+               : 0;
+  };
+
+  // Bank of each node, -1 while unassigned. Declares read by dpas keep the
+  // bank of the dpas specific heuristics.
+  std::vector<int> bank(nodes.size(), -1);
+  for (unsigned n = 0; n < nodes.size(); n++) {
+    if (dpasDcls.count(nodes[n]))
+      bank[n] = hintBank(nodes[n]);
+  }
+
+  std::vector<unsigned> order(nodes.size());
+  for (unsigned n = 0; n < nodes.size(); n++)
+    order[n] = n;
+  std::stable_sort(order.begin(), order.end(), [&](unsigned n1, unsigned n2) {
+    return totalWeight[n1] > totalWeight[n2];
+  });
+
+  float residual = 0.0f;
+  for (unsigned n : order) {
+    if (dpasDcls.count(nodes[n]))
+      continue;
+    float cost[2] = {fixedCost[n][0], fixedCost[n][1]};
+    for (const Edge &e : adj[n]) {
+      if (bank[e.node] == -1)
+        continue;
+      // n conflicts with e.node when bank(n) == bank(e.node) ^ flip.
+      cost[bank[e.node] ^ e.flip] += e.weight;
+    }
+    int hint = hintBank(nodes[n]);
+    int b = cost[0] < cost[1] ? 0 : cost[1] < cost[0] ? 1 : std::max(hint, 0);
+    bank[n] = b;
+    residual += cost[b];
+    gra.setBankConflict(nodes[n], b ? BANK_CONFLICT_SECOND_HALF_ODD
+                                    : BANK_CONFLICT_FIRST_HALF_EVEN);
+  }
+
+  RA_TRACE(std::cout << "\t--global bank conflict graph: " << nodes.size()
+                     << " declares, " << edges.size()
+                     << " edges, residual conflict weight " << residual
+                     << "\n");
+}
+
 // Use for BB sorting according to the loop nest level and the BB size.
 bool compareBBLoopLevel(G4_BB *bb1, G4_BB *bb2) {
   if (bb1->getNestLevel() > bb2->getNestLevel()) {
@@ -1119,6 +1310,11 @@ bool BankConflictPass::setupBankConflictsForKernel(bool doLocalRR,
   // instructions.
   threeSourceCandidate = true;
 
+  if (forGlobal && gra.kernel.getOption(vISA_GlobalBankConflictGraph) &&
+      !gra.kernel.fg.builder->lowHighBundle()) {
+    setupBankConflictsGlobally();
+  }
+
   if (doLocalRR && sendInstNumInKernel) {
     if (!hasDpasInst && (sendInstNumInKernel > threeSourceInstNumInKernel)) {
       return false;
@@ -1530,6 +1726,10 @@ bool Interference::interfereBetween(unsigned v1, unsigned v2) const {
     std::swap(v1, v2);
   }
 
+  if (!sparseIntf.empty()) {
+    return sparseIntf.isNeighbor(v1, v2);
+  }
+
   if (useDenseMatrix()) {
     unsigned col = v2 / BITS_DWORD;
     return matrix[v1 * rowSize + col] & (1 << (v2 % BITS_DWORD));
@@ -1596,14 +1796,15 @@ inline void Interference::filterSplitDclares(unsigned startIdx, unsigned endIdx,
 //
 void Interference::buildInterferenceWithLive(const SparseBitVector &live,
                                              unsigned i) {
+  IntfShard *shard = activeShard;
   // set interference between variable with index "i" and variable set in "live".
   // j is the valid bit index in the live.
   for (unsigned j : live) {
     if (!varSplitCheckBeforeIntf(i, j)) {
       if (j < i) {
-        safeSetInterference(j, i);
+        setWalkInterference(shard, j, i);
       } else if (j > i) {
-        safeSetInterference(i, j);
+        setWalkInterference(shard, i, j);
       }
     }
   }
@@ -1631,16 +1832,16 @@ void Interference::buildInterferenceWithLive(const SparseBitVector &live,
 
   if (is_partial) { // Don't interference with parent
     if (i < n) {
-      safeClearInterference(i, n);
+      clearWalkInterference(shard, i, n);
     } else {
-      safeClearInterference(n, i);
+      clearWalkInterference(shard, n, i);
     }
   }
   for (unsigned j = start_idx; j < end_idx; j++) { //Don't inteference with the child
     if (j < i) {
-      safeClearInterference(j, i);
+      clearWalkInterference(shard, j, i);
     } else {
-      safeClearInterference(i, j);
+      clearWalkInterference(shard, i, j);
     }
   }
 }
@@ -1676,14 +1877,14 @@ void Interference::buildInterferenceWithAllSubDcl(unsigned v1, unsigned v2) {
   if (d1->getIsSplittedDcl() && !d2->getIsPartialDcl()) {
     for (const G4_Declare *subDcl : gra.getSubDclList(d1)) {
       int subID = subDcl->getRegVar()->getId();
-      checkAndSetIntf(v2, subID);
+      checkAndSetWalkIntf(v2, subID);
     }
   }
 
   if (d2->getIsSplittedDcl() && !d1->getIsPartialDcl()) {
     for (const G4_Declare *subDcl : gra.getSubDclList(d2)) {
       int subID = subDcl->getRegVar()->getId();
-      checkAndSetIntf(v1, subID);
+      checkAndSetWalkIntf(v1, subID);
     }
   }
 
@@ -1820,14 +2021,14 @@ void Interference::markInterferenceForSend(G4_BB *bb, G4_INST *inst,
 
             if (isDstRegAllocPartaker) {
               if (!varSplitCheckBeforeIntf(dstId, srcId)) {
-                checkAndSetIntf(dstId, srcId);
+                checkAndSetWalkIntf(dstId, srcId);
                 buildInterferenceWithAllSubDcl(dstId, srcId);
               }
             } else {
               for (int j = dstPreg, sum = dstPreg + dstNumRows; j < sum; j++) {
                 int k = getGRFDclForHRA(j)->getRegVar()->getId();
                 if (!varSplitCheckBeforeIntf(k, srcId)) {
-                  checkAndSetIntf(k, srcId);
+                  checkAndSetWalkIntf(k, srcId);
                   buildInterferenceWithAllSubDcl(k, srcId);
                 }
               }
@@ -1851,7 +2052,7 @@ void Interference::markInterferenceForSend(G4_BB *bb, G4_INST *inst,
               for (int j = reg, sum = reg + numrows; j < sum; j++) {
                 int k = getGRFDclForHRA(j)->getRegVar()->getId();
                 if (!varSplitCheckBeforeIntf(dstId, k)) {
-                  checkAndSetIntf(dstId, k);
+                  checkAndSetWalkIntf(dstId, k);
                   buildInterferenceWithAllSubDcl(dstId, k);
                 }
               }
@@ -1966,7 +2167,7 @@ void Interference::markInterferenceToAvoidDstSrcOverlap(G4_BB *bb,
 #endif
                   if (isDstRegAllocPartaker) {
                     if (!varSplitCheckBeforeIntf(dstId, srcId)) {
-                      checkAndSetIntf(dstId, srcId);
+                      checkAndSetWalkIntf(dstId, srcId);
                       buildInterferenceWithAllSubDcl(dstId, srcId);
                     }
                   } else {
@@ -1974,7 +2175,7 @@ void Interference::markInterferenceToAvoidDstSrcOverlap(G4_BB *bb,
                          j++) {
                       int k = getGRFDclForHRA(j)->getRegVar()->getId();
                       if (!varSplitCheckBeforeIntf(k, srcId)) {
-                        checkAndSetIntf(k, srcId);
+                        checkAndSetWalkIntf(k, srcId);
                         buildInterferenceWithAllSubDcl(k, srcId);
                       }
                     }
@@ -2002,7 +2203,7 @@ void Interference::markInterferenceToAvoidDstSrcOverlap(G4_BB *bb,
                     for (int j = reg, sum = reg + numrows; j < sum; j++) {
                       int k = getGRFDclForHRA(j)->getRegVar()->getId();
                       if (!varSplitCheckBeforeIntf(dstId, k)) {
-                        checkAndSetIntf(dstId, k);
+                        checkAndSetWalkIntf(dstId, k);
                         buildInterferenceWithAllSubDcl(dstId, k);
                       }
                     }
@@ -2020,7 +2221,7 @@ void Interference::markInterferenceToAvoidDstSrcOverlap(G4_BB *bb,
                 unsigned srcId = pt.var->getId();
                 if (isDstRegAllocPartaker) {
                   if (!varSplitCheckBeforeIntf(dstId, srcId)) {
-                    checkAndSetIntf(dstId, srcId);
+                    checkAndSetWalkIntf(dstId, srcId);
                     buildInterferenceWithAllSubDcl(dstId, srcId);
                   }
                 } else {
@@ -2028,7 +2229,7 @@ void Interference::markInterferenceToAvoidDstSrcOverlap(G4_BB *bb,
                        j++) {
                     int k = getGRFDclForHRA(j)->getRegVar()->getId();
                     if (!varSplitCheckBeforeIntf(k, srcId)) {
-                      checkAndSetIntf(k, srcId);
+                      checkAndSetWalkIntf(k, srcId);
                       buildInterferenceWithAllSubDcl(k, srcId);
                     }
                   }
@@ -2042,12 +2243,76 @@ void Interference::markInterferenceToAvoidDstSrcOverlap(G4_BB *bb,
   }
 }
 
-uint32_t GlobalRA::getRefCount(int loopNestLevel) {
-  if (loopNestLevel == 0) {
-    return 1;
+// Prints the three source instructions whose sources ended up in the same
+// bank, by loop and weighted by block frequency, hottest loops first. The bank
+// model is the one that bank conflict reduction optimizes for.
+void GlobalRA::reportBankConflicts(std::ostream &os) {
+  struct ConflictStats {
+    unsigned numInsts = 0;
+    unsigned numConflicts = 0;
+    float weight = 0.0f;
+  };
+  const auto srcPairs = getBankConflictSrcPairs(builder);
+  auto bankOf = [this](unsigned reg) {
+    return builder.oneGRFBankDivision() ? reg % 2 : (reg % 4) / 2;
+  };
+
+  ConflictStats total;
+  std::map<unsigned, std::pair<Loop *, ConflictStats>> loopStats;
+  for (auto bb : kernel.fg) {
+    Loop *loop = kernel.fg.getLoops().getInnerMostLoop(bb);
+    float weight = kernel.fg.getBlockWeight(bb);
+    for (auto inst : *bb) {
+      if (!isBankConflictCandidate(inst))
+        continue;
+      int regs[3] = {-1, -1, -1};
+      for (int i = 0; i < 3; i++) {
+        G4_Operand *src = inst->getSrc(i);
+        if (!src || !src->isSrcRegRegion() ||
+            src->asSrcRegRegion()->isIndirect() || !src->getBase() ||
+            !src->getBase()->isRegVar())
+          continue;
+        G4_RegVar *var = src->getBase()->asRegVar();
+        if (var->getPhyReg() && var->getPhyReg()->isGreg())
+          regs[i] = src->getLinearizedStart() / kernel.numEltPerGRF<Type_UB>();
+      }
+      bool conflict = false;
+      for (auto [i, j] : srcPairs) {
+        conflict |= regs[i] != -1 && regs[j] != -1 && regs[i] != regs[j] &&
+                    bankOf(regs[i]) == bankOf(regs[j]);
+      }
+
+      auto record = [&](ConflictStats &stats) {
+        stats.numInsts++;
+        if (conflict) {
+          stats.numConflicts++;
+          stats.weight += weight;
+        }
+      };
+      record(total);
+      if (loop) {
+        auto &entry = loopStats[loop->id];
+        entry.first = loop;
+        record(entry.second);
+      }
+    }
+  }
+
+  std::vector<std::pair<Loop *, ConflictStats>> loops;
+  for (auto &entry : loopStats)
+    loops.push_back(entry.second);
+  std::stable_sort(loops.begin(), loops.end(), [](auto &l1, auto &l2) {
+    return l1.second.weight > l2.second.weight;
+  });
+
+  os << "Bank conflicts in " << kernel.getName() << ": "
+     << total.numConflicts << " of " << total.numInsts
+     << " three source instructions, weighted " << total.weight << "\n";
+  for (auto &[loop, stats] : loops) {
+    os << "  loop " << loop->id << " (header BB" << loop->getHeader()->getId()
+       << ", depth " << loop->getNestingLevel() << "): " << stats.numConflicts
+       << " of " << stats.numInsts << ", weighted " << stats.weight << "\n";
   }
-  return (uint32_t)std::pow(IN_LOOP_REFERENCE_COUNT_FACTOR,
-                            std::min(loopNestLevel, 8));
 }
 
 // handle return value interference for fcall
@@ -2148,11 +2413,11 @@ void Interference::buildInterferenceWithinBB(G4_BB *bb, SparseBitVector &live) {
         }
       } else if (liveAnalysis->livenessClass(G4_ADDRESS)) {
         // assume callee will use A0
-        auto A0Dcl = kernel.fg.fcallToPseudoDclMap[inst->asCFInst()].A0;
+        auto A0Dcl = kernel.fg.fcallToPseudoDclMap.at(inst->asCFInst()).A0;
         buildInterferenceWithLive(live, A0Dcl->getRegVar()->getId());
       } else if (liveAnalysis->livenessClass(G4_FLAG)) {
         // assume callee will use both F0 and F1
-        auto flagDcl = kernel.fg.fcallToPseudoDclMap[inst->asCFInst()].Flag;
+        auto flagDcl = kernel.fg.fcallToPseudoDclMap.at(inst->asCFInst()).Flag;
         buildInterferenceWithLive(live, flagDcl->getRegVar()->getId());
       }
     }
@@ -2180,7 +2445,7 @@ void Interference::buildInterferenceWithinBB(G4_BB *bb, SparseBitVector &live) {
         int src0Id = src0->getBase()->asRegVar()->getId();
         int src1Id = src1->getBase()->asRegVar()->getId();
 
-        checkAndSetIntf(src0Id, src1Id);
+        checkAndSetWalkIntf(src0Id, src1Id);
         buildInterferenceWithAllSubDcl(src0Id, src1Id);
       }
     }
@@ -2193,7 +2458,7 @@ void Interference::buildInterferenceWithinBB(G4_BB *bb, SparseBitVector &live) {
           src1->getBase()->isRegAllocPartaker()) {
         int dstId = dst->getBase()->asRegVar()->getId();
         int src1Id = src1->getBase()->asRegVar()->getId();
-        checkAndSetIntf(dstId, src1Id);
+        checkAndSetWalkIntf(dstId, src1Id);
         buildInterferenceWithAllSubDcl(dstId, src1Id);
       }
     }
@@ -2291,7 +2556,7 @@ void Interference::applyPartitionBias() {
   // free the callee save register throughout the function.
   for (auto i : liveAnalysis->globalVars) {
     if (kernel.fg.isPseudoVCADcl(lrs[i]->getDcl())) {
-      const auto &intfs = sparseIntf[i];
+      auto intfs = sparseIntf[i];
       for (const auto edge : intfs) {
         // no point adding bias to any variable already assigned
         if (lrs[edge]->getPhyReg())
@@ -2436,6 +2701,108 @@ void Interference::setupLRs(G4_BB *bb) {
   }
 }
 
+thread_local Interference::IntfShard *Interference::activeShard = nullptr;
+
+// Number of workers for the per-BB interference walk; 1 walks the BBs
+// serially. Each worker gets at least MinInstsPerIntfThread instructions so
+// that small kernels do not pay for the threads and shards.
+unsigned
+Interference::getInterferenceThreads(const std::vector<G4_BB *> &bbs) const {
+  constexpr size_t MinInstsPerIntfThread = 8192;
+  unsigned numThreads = builder.getOptions()->getuInt32Option(
+      vISA_InterferenceThreads);
+  // Debug info intervals are updated in place during the walk.
+  if (numThreads <= 1 || bbs.size() <= 1 ||
+      builder.getOption(vISA_GenerateDebugInfo))
+    return 1;
+  size_t numInsts = 0;
+  for (const G4_BB *bb : bbs)
+    numInsts += bb->size();
+  size_t maxThreads = std::min<size_t>(numInsts / MinInstsPerIntfThread,
+                                       bbs.size());
+  return (unsigned)std::min<size_t>(numThreads, std::max<size_t>(maxThreads, 1));
+}
+
+// Runs the per-BB walk of computeInterference on numThreads workers. The BBs
+// are cut into contiguous ranges of about the same number of instructions,
+// and every worker records its edges in its own IntfShard. The shards are then
+// merged into the matrix, the rows in parallel and the logged split dcl
+// updates in BB order, so the graph is identical to the one of the serial
+// walk.
+void Interference::buildInterferenceForBBsInParallel(
+    const std::vector<G4_BB *> &bbs, unsigned numThreads) {
+  size_t numInsts = 0;
+  for (const G4_BB *bb : bbs)
+    numInsts += bb->size();
+
+  // bbs[ranges[t], ranges[t + 1]) is walked by worker t.
+  std::vector<size_t> ranges(1, 0);
+  size_t instsSoFar = 0;
+  for (size_t i = 0; i < bbs.size() && ranges.size() < numThreads; ++i) {
+    instsSoFar += bbs[i]->size();
+    if (instsSoFar * numThreads >= numInsts * ranges.size())
+      ranges.push_back(i + 1);
+  }
+  if (ranges.back() != bbs.size())
+    ranges.push_back(bbs.size());
+  size_t numShards = ranges.size() - 1;
+
+  std::vector<IntfShard> shards(numShards);
+  auto walk = [&](size_t t) {
+    CompileTrace::KernelScope traceKernel(kernel.getName(),
+                                          kernel.getSimdSize());
+    CompileTrace::Scope traceWalk("vISA", "ParallelInterferenceWalk");
+    IntfShard &shard = shards[t];
+    shard.rows.resize(maxId);
+    activeShard = &shard;
+    SparseBitVector live;
+    for (size_t i = ranges[t]; i < ranges[t + 1]; ++i) {
+      live.clear();
+      buildInterferenceAtBBExit(bbs[i], live);
+      buildInterferenceWithinBB(bbs[i], live);
+    }
+    activeShard = nullptr;
+  };
+  // Rows are disjoint in both the dense and the sparse matrix, so the workers
+  // can merge different rows at the same time.
+  bool dense = useDenseMatrix();
+  auto merge = [&](size_t t) {
+    for (unsigned v1 = (unsigned)(maxId * t / numShards),
+                  end = (unsigned)(maxId * (t + 1) / numShards);
+         v1 < end; ++v1) {
+      for (IntfShard &shard : shards) {
+        if (dense) {
+          for (unsigned v2 : shard.rows[v1])
+            safeSetInterference(v1, v2);
+        } else {
+          sparseMatrix[v1] |= shard.rows[v1];
+        }
+        shard.rows[v1].clear();
+      }
+    }
+  };
+  auto runOnAllShards = [&](const std::function<void(size_t)> &task) {
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numShards; ++t)
+      threads.emplace_back(task, t);
+    task(0);
+    for (auto &thread : threads)
+      thread.join();
+  };
+
+  runOnAllShards(walk);
+  runOnAllShards(merge);
+  for (const IntfShard &shard : shards) {
+    for (auto [v1, v2, set] : shard.splitOps) {
+      if (set) {
+        safeSetInterference(v1, v2);
+      } else {
+        safeClearInterference(v1, v2);
+      }
+    }
+  }
+}
+
 void Interference::computeInterference() {
   startTimer(TimerID::INTERFERENCE);
 
@@ -2445,29 +2812,37 @@ void Interference::computeInterference() {
     setupLRs(bb);
   }
 
-  //
-  // create bool vector, live, to track live ranges that are currently live
-  //
-  SparseBitVector live;
-
   buildInterferenceAmongLiveOuts();
 
+  std::vector<G4_BB *> bbs;
   for (G4_BB *bb : kernel.fg) {
-    if (!incRA.intfNeededForBB(bb)) {
-      continue;
+    if (incRA.intfNeededForBB(bb)) {
+      bbs.push_back(bb);
     }
+  }
+
+  unsigned numThreads = getInterferenceThreads(bbs);
+  if (numThreads > 1) {
+    buildInterferenceForBBsInParallel(bbs, numThreads);
+  } else {
     //
-    // mark all live ranges dead
-    //
-    live.clear();
-    //
-    // start with all live ranges that are live at the exit of BB
-    //
-    buildInterferenceAtBBExit(bb, live);
-    //
-    // traverse inst in the reverse order
+    // create bool vector, live, to track live ranges that are currently live
     //
-    buildInterferenceWithinBB(bb, live);
+    SparseBitVector live;
+    for (G4_BB *bb : bbs) {
+      //
+      // mark all live ranges dead
+      //
+      live.clear();
+      //
+      // start with all live ranges that are live at the exit of BB
+      //
+      buildInterferenceAtBBExit(bb, live);
+      //
+      // traverse inst in the reverse order
+      //
+      buildInterferenceWithinBB(bb, live);
+    }
   }
 
   buildInterferenceAmongLiveIns();
@@ -2496,6 +2871,14 @@ void Interference::computeInterference() {
   // Augment interference graph to accomodate non-default masks
   aug.augmentIntfGraph();
 
+  // If option is true, try to get extra interference info from file. This
+  // has to happen while the matrix is still allocated so that the extra
+  // edges also reach the neighbor lists.
+  if (liveAnalysis->livenessClass(G4_GRF) &&
+      kernel.getOption(vISA_AddExtraIntfInfo)) {
+    getExtraInterferenceInfo();
+  }
+
   generateSparseIntfGraph();
 
   countNeighbors();
@@ -2550,45 +2933,50 @@ void Interference::getNormIntfNum() {
   RA_TRACE(std::cout << "\t--normal edge #: " << numEdges << "\n");
 }
 
-#define SPARSE_INTF_VEC_SIZE 64
-
 void Interference::generateSparseIntfGraph() {
   // Generate sparse intf graph from the dense one
   unsigned numVars = liveAnalysis->getNumSelectedVar();
 
-  sparseIntf.resize(numVars);
-
-  for (unsigned row = 0; row < numVars; row++) {
-    sparseIntf[row].reserve(SPARSE_INTF_VEC_SIZE);
-  }
-
   if (useDenseMatrix()) {
     // Iterate over intf graph matrix
-    for (unsigned row = 0; row < numVars; row++) {
-      unsigned rowOffset = row * rowSize;
-      unsigned colStart = (row + 1) / BITS_DWORD;
-      for (unsigned j = colStart; j < rowSize; j++) {
-        unsigned intfBlk = getInterferenceBlk(rowOffset + j);
-        if (intfBlk != 0) {
-          for (unsigned k = 0; k < BITS_DWORD; k++) {
-            if (intfBlk & (1 << k)) {
-              unsigned v2 = (j * BITS_DWORD) + k;
-              if (v2 != row) {
-                sparseIntf[v2].emplace_back(row);
-                sparseIntf[row].emplace_back(v2);
+    sparseIntf.build(numVars, [this, numVars](auto &&addEdge) {
+      for (unsigned row = 0; row < numVars; row++) {
+        unsigned rowOffset = row * rowSize;
+        unsigned colStart = (row + 1) / BITS_DWORD;
+        for (unsigned j = colStart; j < rowSize; j++) {
+          unsigned intfBlk = getInterferenceBlk(rowOffset + j);
+          if (intfBlk != 0) {
+            for (unsigned k = 0; k < BITS_DWORD; k++) {
+              if (intfBlk & (1 << k)) {
+                unsigned v2 = (j * BITS_DWORD) + k;
+                if (v2 != row) {
+                  addEdge(row, v2);
+                }
               }
             }
           }
         }
       }
-    }
+    });
   } else {
-    for (uint32_t v1 = 0; v1 < maxId; ++v1) {
-      auto &intfSet = sparseMatrix[v1];
-      for (uint32_t v2 : intfSet) {
-        sparseIntf[v1].emplace_back(v2);
-        sparseIntf[v2].emplace_back(v1);
+    sparseIntf.build(numVars, [this](auto &&addEdge) {
+      for (uint32_t v1 = 0; v1 < maxId; ++v1) {
+        for (uint32_t v2 : sparseMatrix[v1]) {
+          addEdge(v1, v2);
+        }
       }
+    });
+  }
+
+  // The graph is complete at this point and interfereBetween() can answer
+  // from the sorted neighbor lists, so the half triangle matrix is only kept
+  // if incremental RA updates it in the next iteration.
+  if (!IncrementalRA::isEnabled(kernel)) {
+    if (useDenseMatrix()) {
+      delete[] matrix;
+      matrix = nullptr;
+    } else {
+      std::vector<SparseBitVector>().swap(sparseMatrix);
     }
   }
 }
@@ -2604,7 +2992,7 @@ void Interference::countNeighbors() {
   uint32_t numEdges = 0;
   for (int i = 0, numVar = (int)sparseIntf.size(); i < numVar; ++i) {
     if (lrs[i]->getPhyReg() == nullptr) {
-      auto &intf = sparseIntf[i];
+      auto intf = sparseIntf[i];
       numNeighbor += (uint32_t)intf.size();
       maxNeighbor = std::max(maxNeighbor, numNeighbor);
       if (maxNeighbor == numNeighbor)
@@ -3488,7 +3876,7 @@ bool Augmentation::markNonDefaultMaskDef() {
         nonDefaultMaskDefFound = true;
       }
 
-      if (kernel.getOption(vISA_forceBCR) &&
+      if (gra.forceBCR &&
           gra.getBankConflict(dcl) != BANK_CONFLICT_NONE) {
         gra.setAugmentationMask(dcl, AugmentationMasks::NonDefault);
         nonDefaultMaskDefFound = true;
@@ -5072,7 +5460,7 @@ void GraphColor::computeDegreeForGRF() {
     unsigned degree = 0;
 
     if (!(lrs[i]->getIsPseudoNode()) && !(lrs[i]->getIsPartialDcl())) {
-      const std::vector<unsigned> &intfs = intf.getSparseIntfForVar(i);
+      auto intfs = intf.getSparseIntfForVar(i);
       unsigned bankDegree = 0;
       auto lraBC = lrs[i]->getBC();
       bool isOdd = (lraBC == BANK_CONFLICT_SECOND_HALF_EVEN ||
@@ -5139,7 +5527,7 @@ void GraphColor::computeDegreeForARF() {
     unsigned degree = 0;
 
     if (!(lrs[i]->getIsPseudoNode())) {
-      const std::vector<unsigned> &intfs = intf.getSparseIntfForVar(i);
+      auto intfs = intf.getSparseIntfForVar(i);
       for (auto it : intfs) {
         degree += edgeWeightARF(lrs[i], lrs[it]);
       }
@@ -5169,7 +5557,18 @@ void GraphColor::computeSpillCosts(bool useSplitLLRHeuristic, const RPE *rpe) {
       std::cout << "\t--using new spill cost function\n";
   });
 
-  if (useNewSpillCost && liveAnalysis.livenessClass(G4_GRF)) {
+  // With incremental RA, reference counts are summed up from per-BB counts
+  // and only BBs changed since the previous iteration are walked.
+  std::unordered_map<G4_Declare *, unsigned int> incDirectRefs;
+  std::unordered_map<G4_Declare *, unsigned int> incIndirectRefs;
+  bool useIncRefCounts = useNewSpillCost &&
+                         liveAnalysis.livenessClass(G4_GRF) &&
+                         gra.incRA.getBBSummary(kernel.fg.getEntryBB(),
+                                                &liveAnalysis) != nullptr;
+  if (useIncRefCounts) {
+    gra.incRA.computeWeightedRefCounts(&liveAnalysis, incDirectRefs,
+                                       incIndirectRefs);
+  } else if (useNewSpillCost && liveAnalysis.livenessClass(G4_GRF)) {
     // gather all instructions with indirect operands
     // for ref count computation once.
     for (auto bb : kernel.fg.getBBList()) {
@@ -5216,6 +5615,21 @@ void GraphColor::computeSpillCosts(bool useSplitLLRHeuristic, const RPE *rpe) {
 
   auto getWeightedRefCount = [&](G4_Declare *dcl, unsigned int useWt = 1,
                                  unsigned int defWt = 1) {
+    if (useIncRefCounts) {
+      // Per-BB counts assume unit weights outside loops.
+      vASSERT(useWt == 1 && defWt == 1);
+      unsigned int refCount = 0;
+      auto it = incDirectRefs.find(dcl);
+      if (it != incDirectRefs.end())
+        refCount += it->second;
+      if (dcl->getAddressed()) {
+        it = incIndirectRefs.find(dcl);
+        if (it != incIndirectRefs.end())
+          refCount += it->second;
+      }
+      return refCount == 0 ? 1 : refCount;
+    }
+
     auto defs = directRefs.getDefs(dcl);
     auto uses = directRefs.getUses(dcl);
     auto &loops = kernel.fg.getLoops();
@@ -5449,7 +5863,7 @@ void GraphColor::relaxNeighborDegreeGRF(LiveRange *lr) {
       }
     };
 
-    const std::vector<unsigned> &intfs = intf.getSparseIntfForVar(lr_id);
+    auto intfs = intf.getSparseIntfForVar(lr_id);
     for (auto it : intfs) {
       LiveRange *lrs_it = lrs[it];
 
@@ -5470,7 +5884,7 @@ void GraphColor::relaxNeighborDegreeGRF(LiveRange *lr) {
 void GraphColor::relaxNeighborDegreeARF(LiveRange *lr) {
   if (!(lr->getIsPseudoNode())) {
     unsigned lr_id = lr->getVar()->getId();
-    const std::vector<unsigned> &intfs = intf.getSparseIntfForVar(lr_id);
+    auto intfs = intf.getSparseIntfForVar(lr_id);
     for (auto it : intfs) {
       LiveRange *lrs_it = lrs[it];
 
@@ -5527,7 +5941,7 @@ void GraphColor::removeConstrained() {
   }
 }
 
-void GraphColor::determineColorOrdering() {
+void GraphColor::determineColorOrdering(ColorOrderWeight weight) {
   numColor = 0;
   if (liveAnalysis.livenessClass(G4_GRF))
     numColor = totalGRFRegCount;
@@ -5562,8 +5976,22 @@ void GraphColor::determineColorOrdering() {
   //
   if (builder.getOption(vISA_FreqBasedSpillCost))
     builder.getFreqInfoManager().sortBasedOnFreq(sorted);
-  else
+  else if (weight == ColorOrderWeight::SpillCost)
     std::sort(sorted.begin(), sorted.end(), compareSpillCost);
+  else {
+    auto weightedCost = [weight](const LiveRange *lr) {
+      if (weight == ColorOrderWeight::SpillCostPerGRF)
+        return lr->getSpillCost() / lr->getNumRegNeeded();
+      return lr->getSpillCost() / (lr->getDegree() + 1);
+    };
+    std::sort(sorted.begin(), sorted.end(),
+              [&](const LiveRange *lr1, const LiveRange *lr2) {
+                float cost1 = weightedCost(lr1), cost2 = weightedCost(lr2);
+                return cost1 < cost2 ||
+                       (cost1 == cost2 &&
+                        lr1->getVar()->getId() < lr2->getVar()->getId());
+              });
+  }
 
 
   for (unsigned i = 0; i < numUnassignedVar; i++) {
@@ -5672,11 +6100,16 @@ void PhyRegUsage::updateRegUsage(LiveRange *lr) {
 
 bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
                               bool doBankConflict, bool highInternalConflict,
-                              bool doBundleConflict) {
-  RA_TRACE(std::cout << "\t--"
-                     << (colorHeuristicGRF == ROUND_ROBIN ? "round-robin"
-                                                          : "first-fit")
-                     << (doBankConflict ? " BCR" : "") << " graph coloring\n");
+                              bool doBundleConflict, ColoringState &state) {
+  // Parallel attempts would interleave their output; assignColorsInParallel
+  // traces the picked attempt instead.
+  if (!state.isAttempt) {
+    RA_TRACE(std::cout << "\t--"
+                       << (colorHeuristicGRF == ROUND_ROBIN ? "round-robin"
+                                                            : "first-fit")
+                       << (doBankConflict ? " BCR" : "")
+                       << " graph coloring\n");
+  }
 
   unsigned bank1_end = 0;
   unsigned bank2_end = totalGRFRegCount - 1;
@@ -5717,7 +6150,7 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
   unsigned maxGRFCanBeUsed = totalGRFRegCount;
   // FIXME: the bank configs should be computed in PhyRegAllocationState instead
   // of pased in, but the strange early return from above prevents this..
-  PhyRegAllocationState parms(gra, lrs, rFile, maxGRFCanBeUsed, bank1_start,
+  PhyRegAllocationState parms(gra, state.ranges, rFile, maxGRFCanBeUsed, bank1_start,
                               bank1_end, bank2_start, bank2_end, doBankConflict,
                               doBundleConflict);
   bool noIndirForceSpills = builder.getOption(vISA_NoIndirectForceSpills);
@@ -5749,11 +6182,11 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
       //
       PhyRegUsage regUsage(parms, FPR);
 
-      const std::vector<unsigned> &intfs = intf.getSparseIntfForVar(lr_id);
+      auto intfs = intf.getSparseIntfForVar(lr_id);
       auto weakEdgeSet =
           intf.getCompatibleSparseIntf(lrVar->getDeclare()->getRootDeclare());
       for (auto it : intfs) {
-        LiveRange *lrTemp = lrs[it];
+        LiveRange *lrTemp = state.ranges[it];
         if (lrTemp->getPhyReg() != nullptr || lrTemp->getIsPartialDcl()) {
           if (lrTemp->getIsSplittedDcl()) {
             // Only interfere with children declares
@@ -5778,7 +6211,7 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
             // For dcls not assigned regs by LRA, lookup temp
             // registers assigned to LiveRange instances.
             auto id = regVar->getId();
-            auto lr = lrs[id];
+            auto lr = state.ranges[id];
             auto phyReg = lr->getPhyReg();
             if (phyReg) {
               pvar = phyReg->asGreg()->getRegNum();
@@ -5870,7 +6303,7 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
         // pass) then abort on spill
         //
         if ((heuristic == ROUND_ROBIN ||
-             (doBankConflict && !kernel.getOption(vISA_forceBCR))) &&
+             (doBankConflict && !gra.forceBCR)) &&
             (lr->getRegKind() == G4_GRF || lr->getRegKind() == G4_FLAG)) {
           return false;
         } else if (kernel.fg.isPseudoDcl(dcl)) {
@@ -5878,7 +6311,7 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
           // save/restore code will be inserted in stack call prolog/epilog
         } else {
           // for first-fit register assignment track spilled live ranges
-          spilledLRs.push_back(lr);
+          state.spilled.push_back(lr);
           lr->setSpilled(true);
         }
       }
@@ -5891,7 +6324,7 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
   };
 
   // colorOrder is in reverse order (unconstrained at front)
-  for (auto iter = colorOrder.rbegin(), iterEnd = colorOrder.rend();
+  for (auto iter = state.order.rbegin(), iterEnd = state.order.rend();
        iter != iterEnd; ++iter) {
     auto lr = (*iter);
 
@@ -5917,7 +6350,7 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
     // restriction. The fix here is to check whether
     // reserved GRF restriction can be eased for EOT.
     auto hasSpilledNeighbor = [&](unsigned int id) {
-      for (const auto *spillLR : spilledLRs) {
+      for (const auto *spillLR : state.spilled) {
         if (id != spillLR->getVar()->getId() &&
             getIntf()->interfereBetween(id, spillLR->getVar()->getId()))
           return true;
@@ -5932,7 +6365,8 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
       gra.markGraphBlockLocalVars();
     }
 
-    for (auto lrIt = spilledLRs.begin(); lrIt != spilledLRs.end(); ++lrIt) {
+    for (auto lrIt = state.spilled.begin(); lrIt != state.spilled.end();
+         ++lrIt) {
       auto lr = (*lrIt);
       bool needsEOTGRF = lr->getEOTSrc() && builder.hasEOTGRFBinding();
       if (needsEOTGRF && gra.isBlockLocal(lr->getDcl()) &&
@@ -5950,14 +6384,14 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
         lr->setPhyReg(builder.phyregpool.getGreg(kernel.getNumRegTotal() -
                                                  lr->getNumRegNeeded()),
                       0);
-        spilledLRs.erase(lrIt);
+        state.spilled.erase(lrIt);
         break;
       }
     }
   }
 
   // record RA type
-  if (liveAnalysis.livenessClass(G4_GRF)) {
+  if (liveAnalysis.livenessClass(G4_GRF) && !state.isAttempt) {
     if (colorHeuristicGRF == ROUND_ROBIN) {
       kernel.setRAType(doBankConflict ? RA_Type::GRAPH_COLORING_RR_BC_RA
                                       : RA_Type::GRAPH_COLORING_RR_RA);
@@ -5969,9 +6403,9 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
 
 #ifdef _DEBUG
   // Verify that spilledLRs has no duplicate
-  for (auto item : spilledLRs) {
+  for (auto item : state.spilled) {
     unsigned count = 0;
-    for (auto checkItem : spilledLRs) {
+    for (auto checkItem : state.spilled) {
       if (checkItem == item) {
         vISA_ASSERT(count == 0, "Duplicate entry found in spilledLRs");
         count++;
@@ -5980,19 +6414,19 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
   }
 
   // Verify that none of spilledLRs have an allocation
-  for (auto lr : spilledLRs) {
+  for (auto lr : state.spilled) {
     vISA_ASSERT(lr->getPhyReg() == nullptr,
                 "Spilled LR contains valid allocation");
   }
 
   // Verify that all spilled LRs are synced
-  for (auto lr : spilledLRs) {
+  for (auto lr : state.spilled) {
     vISA_ASSERT(lr->isSpilled(),
                 "LR not marked as spilled, but inserted in spilledLRs list");
   }
 
   // Verify if all LRs have either an allocation or are spilled
-  for (auto lr : colorOrder) {
+  for (auto lr : state.order) {
     if (!kernel.fg.isPseudoDcl(lr->getDcl())) {
       vISA_ASSERT(lr->isSpilled() || lr->getPhyReg() ||
                       lr->getDcl()->isSpilled(),
@@ -6004,6 +6438,239 @@ bool GraphColor::assignColors(ColorHeuristic colorHeuristicGRF,
   return true;
 }
 
+unsigned GraphColor::getColoringThreads() const {
+  unsigned numThreads = m_options->getuInt32Option(vISA_ColoringThreads);
+  // Hybrid, fail-safe and forced-spill coloring keep the serial search.
+  if (numThreads <= 1 || !liveAnalysis.livenessClass(G4_GRF) || isHybrid ||
+      forceSpill || failSafeIter || gra.useFastRA || gra.useHybridRAwithSpill)
+    return 1;
+  return numThreads;
+}
+
+// Colors the GRF live ranges with several configurations at the same time:
+// round-robin and first-fit, with and without bank conflict reduction, each on
+// color orders from differently weighted spill costs. Every attempt works on
+// private copies of the live ranges, so the attempts can run on numThreads
+// workers. Of the attempts that need no spill, the one with the lowest
+// estimated bank conflict cost is kept; ties go to the earlier attempt so the
+// result does not depend on thread timing. Returns false, leaving the live
+// ranges untouched, when every attempt spills.
+bool GraphColor::assignColorsInParallel(
+    bool doBankConflictReduction, bool highInternalConflict,
+    bool doBundleConflict, bool hasStackCall,
+    const std::vector<unsigned> &initialDegrees, unsigned numThreads) {
+  // Color orders indexed by ColorOrderWeight, with the live ranges each of
+  // them found unconstrained (which first-fit relies on). The degrees and
+  // flags of the default order are restored once the others are computed.
+  // With frequency based spill cost the order ignores the weight, so only the
+  // default order is tried.
+  bool useWeightedOrders = !builder.getOption(vISA_FreqBasedSpillCost);
+  std::vector<LiveRangeVec> orders;
+  std::vector<std::vector<bool>> unconstrained;
+  auto saveUnconstrained = [&]() {
+    unconstrained.emplace_back(numVar);
+    for (unsigned i = 0; i < numVar; i++)
+      unconstrained.back()[i] = lrs[i]->getIsUnconstrained();
+  };
+  orders.push_back(colorOrder);
+  saveUnconstrained();
+  std::vector<unsigned> relaxedDegrees(numVar);
+  for (unsigned i = 0; i < numVar; i++)
+    relaxedDegrees[i] = lrs[i]->getDegree();
+  LiveRangeVec defaultOrder;
+  defaultOrder.swap(colorOrder);
+  for (auto weight : {ColorOrderWeight::SpillCostPerGRF,
+                      ColorOrderWeight::SpillCostPerDegree}) {
+    if (!useWeightedOrders)
+      break;
+    for (unsigned i = 0; i < numVar; i++) {
+      lrs[i]->setDegree(initialDegrees[i]);
+      lrs[i]->setUnconstrained(false);
+    }
+    determineColorOrdering(weight);
+    orders.push_back(std::move(colorOrder));
+    colorOrder.clear();
+    saveUnconstrained();
+  }
+  for (unsigned i = 0; i < numVar; i++) {
+    lrs[i]->setDegree(relaxedDegrees[i]);
+    lrs[i]->setUnconstrained(unconstrained.front()[i]);
+  }
+  colorOrder.swap(defaultOrder);
+
+  // Same heuristics as the serial search in regAlloc.
+  bool useRoundRobin = kernel.getOption(vISA_RoundRobin) && !hasStackCall;
+  std::vector<ColoringAttempt> attempts;
+  for (auto weight :
+       {ColorOrderWeight::SpillCost, ColorOrderWeight::SpillCostPerGRF,
+        ColorOrderWeight::SpillCostPerDegree}) {
+    if ((size_t)weight >= orders.size())
+      break;
+    for (auto heuristic : {ROUND_ROBIN, FIRST_FIT}) {
+      if (heuristic == ROUND_ROBIN && !useRoundRobin)
+        continue;
+      for (bool doBankConflict : {true, false}) {
+        if (doBankConflict && useRoundRobin && !doBankConflictReduction)
+          continue;
+        // Forced BCR drops the plain first-fit fallback of round-robin.
+        if (!doBankConflict && gra.forceBCR && useRoundRobin &&
+            doBankConflictReduction)
+          continue;
+        attempts.push_back({heuristic, doBankConflict, weight});
+      }
+    }
+  }
+
+  // Three-source instructions whose GRF sources may be read from one bank.
+  struct BankConflictCandidate {
+    float weight;
+    unsigned numSrcs;
+    unsigned ids[3];
+    unsigned offsets[3];
+  };
+  std::vector<BankConflictCandidate> bcCandidates;
+  for (auto bb : kernel.fg) {
+    float weight = (float)GlobalRA::getRefCount(bb->getNestLevel());
+    for (auto inst : *bb) {
+      if (inst->getNumSrc() != 3 || inst->isSend() || inst->isDpas())
+        continue;
+      BankConflictCandidate candidate{weight, 0, {}, {}};
+      for (unsigned i = 0; i < 3; i++) {
+        auto src = inst->getSrc(i);
+        if (!src || !src->isSrcRegRegion() ||
+            src->asSrcRegRegion()->isIndirect())
+          continue;
+        auto topdcl = src->getTopDcl();
+        if (!topdcl || !topdcl->getRegVar()->isRegAllocPartaker())
+          continue;
+        unsigned id = topdcl->getRegVar()->getId();
+        if (id >= numVar || lrs[id]->getIsPartialDcl())
+          continue;
+        candidate.ids[candidate.numSrcs] = id;
+        candidate.offsets[candidate.numSrcs] = src->getLeftBound();
+        candidate.numSrcs++;
+      }
+      if (candidate.numSrcs > 1)
+        bcCandidates.push_back(candidate);
+    }
+  }
+
+  bool oneGRFBankDivision = builder.oneGRFBankDivision();
+  unsigned grfSize = kernel.numEltPerGRF<Type_UB>();
+  float conflictCycles = kernel.getSimdSize() >= g4::SIMD16
+                             ? BANK_CONFLICT_SIMD16_OVERHEAD_CYCLE
+                             : BANK_CONFLICT_SIMD8_OVERHEAD_CYCLE;
+  auto estimateCost = [&](const LiveRangeVec &ranges) {
+    float cost = 0.0f;
+    for (auto &candidate : bcCandidates) {
+      unsigned regs[3];
+      unsigned numRegs = 0;
+      for (unsigned i = 0; i < candidate.numSrcs; i++) {
+        auto lr = ranges[candidate.ids[i]];
+        if (!lr->getPhyReg() || !lr->getPhyReg()->isGreg())
+          continue;
+        regs[numRegs++] = lr->getPhyReg()->asGreg()->getRegNum() +
+                          (lr->getPhyRegOff() * lr->getDcl()->getElemSize() +
+                           candidate.offsets[i]) /
+                              grfSize;
+      }
+      for (unsigned i = 0; i < numRegs; i++) {
+        for (unsigned j = i + 1; j < numRegs; j++) {
+          unsigned bank1 = oneGRFBankDivision ? regs[i] % 2 : (regs[i] % 4) / 2;
+          unsigned bank2 = oneGRFBankDivision ? regs[j] % 2 : (regs[j] % 4) / 2;
+          if (regs[i] != regs[j] && bank1 == bank2)
+            cost += candidate.weight * conflictCycles;
+        }
+      }
+    }
+    return cost;
+  };
+
+  std::atomic<size_t> nextAttempt{0};
+  auto runAttempts = [&]() {
+    for (size_t a = nextAttempt++; a < attempts.size(); a = nextAttempt++) {
+      ColoringAttempt &attempt = attempts[a];
+      std::vector<LiveRange> copies;
+      copies.reserve(lrs.size());
+      LiveRangeVec ranges(lrs.size(), nullptr);
+      for (size_t i = 0; i < lrs.size(); i++) {
+        if (lrs[i]) {
+          copies.push_back(*lrs[i]);
+          ranges[i] = &copies.back();
+          if (i < numVar)
+            ranges[i]->setUnconstrained(
+                unconstrained[(size_t)attempt.weight][i]);
+        }
+      }
+      LiveRangeVec order;
+      order.reserve(orders[(size_t)attempt.weight].size());
+      for (auto lr : orders[(size_t)attempt.weight])
+        order.push_back(ranges[lr->getVar()->getId()]);
+      LIVERANGE_LIST spilled;
+      ColoringState state{ranges, order, spilled, true};
+
+      bool success = assignColors(attempt.heuristic, attempt.doBankConflict,
+                                  highInternalConflict, doBundleConflict,
+                                  state);
+      attempt.spillFree = success && spilled.empty();
+      if (!attempt.spillFree)
+        continue;
+
+      attempt.assignment.resize(ranges.size(), {nullptr, 0});
+      for (size_t i = 0; i < ranges.size(); i++) {
+        if (ranges[i] && ranges[i]->getPhyReg())
+          attempt.assignment[i] = {ranges[i]->getPhyReg(),
+                                   ranges[i]->getPhyRegOff()};
+      }
+      attempt.cost = estimateCost(ranges);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < std::min<size_t>(numThreads, attempts.size()); ++t)
+    threads.emplace_back(runAttempts);
+  runAttempts();
+  for (auto &thread : threads)
+    thread.join();
+
+  const ColoringAttempt *best = nullptr;
+  for (const ColoringAttempt &attempt : attempts) {
+    if (attempt.spillFree && (!best || attempt.cost < best->cost))
+      best = &attempt;
+  }
+  if (!best) {
+    RA_TRACE(std::cout << "\t--no spill-free coloring among "
+                       << attempts.size() << " attempts\n");
+    return false;
+  }
+
+  RA_TRACE(std::cout << "\t--picked "
+                     << (best->heuristic == ROUND_ROBIN ? "round-robin"
+                                                        : "first-fit")
+                     << (best->doBankConflict ? " BCR" : "")
+                     << " coloring, order " << (unsigned)best->weight
+                     << ", bank conflict cost " << best->cost << "\n");
+
+  for (size_t i = 0; i < lrs.size(); i++) {
+    if (!lrs[i])
+      continue;
+    if (best->assignment[i].first) {
+      lrs[i]->setPhyReg(best->assignment[i].first, best->assignment[i].second);
+    } else {
+      lrs[i]->resetPhyReg();
+    }
+  }
+
+  if (best->heuristic == ROUND_ROBIN) {
+    kernel.setRAType(best->doBankConflict ? RA_Type::GRAPH_COLORING_RR_BC_RA
+                                          : RA_Type::GRAPH_COLORING_RR_RA);
+  } else {
+    kernel.setRAType(best->doBankConflict ? RA_Type::GRAPH_COLORING_FF_BC_RA
+                                          : RA_Type::GRAPH_COLORING_FF_RA);
+  }
+  return true;
+}
+
 template <class REGION_TYPE>
 unsigned GlobalRA::getRegionDisp(REGION_TYPE *region, const IR_Builder &irb) {
   unsigned rowOffset = irb.numEltPerGRF<Type_UB>() * region->getRegOff();
@@ -6389,12 +7056,6 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
   intf.init();
   intf.computeInterference();
 
-  // If option is true, try to get extra interference info from file
-  if (liveAnalysis.livenessClass(G4_GRF) &&
-      kernel.getOption(vISA_AddExtraIntfInfo)) {
-    getExtraInterferenceInfo();
-  }
-
   TIME_SCOPE(COLORING);
   //
   // compute degree and spill costs for each live range
@@ -6415,6 +7076,17 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
 
   if (kernel.getOption(vISA_DumpRAIntfGraph))
     intf.dumpInterference();
+
+  // Parallel coloring attempts compute their own orderings from the degrees
+  // before determineColorOrdering relaxes them.
+  unsigned numColoringThreads = getColoringThreads();
+  std::vector<unsigned> initialDegrees;
+  if (numColoringThreads > 1) {
+    initialDegrees.resize(numVar);
+    for (unsigned i = 0; i < numVar; i++)
+      initialDegrees[i] = lrs[i]->getDegree();
+  }
+
   //
   // determine coloring order
   //
@@ -6480,6 +7152,13 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
       return !requireSpillCode();
     }
 
+    if (numColoringThreads > 1 &&
+        assignColorsInParallel(doBankConflictReduction, highInternalConflict,
+                               doBundleConflictReduction, hasStackCall,
+                               initialDegrees, numColoringThreads)) {
+      return true;
+    }
+
     if (kernel.getOption(vISA_RoundRobin) && !hasStackCall) {
       if (assignColors(ROUND_ROBIN, doBankConflictReduction,
                        highInternalConflict,
@@ -6492,7 +7171,7 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
           return false;
         }
 
-        if (!kernel.getOption(vISA_forceBCR)) {
+        if (!gra.forceBCR) {
           if (!success && doBankConflictReduction) {
             resetTemporaryRegisterAssignments();
             assignColors(FIRST_FIT);
@@ -9410,6 +10089,10 @@ void GlobalRA::stackCallSaveRestore(bool hasStackCall) {
 
 int GlobalRA::doGlobalLinearScanRA() {
   copyMissingAlignment();
+  if (builder.getOption(vISA_LinearScanSecondChance) &&
+      !builder.getOption(vISA_GenerateDebugInfo)) {
+    LinearScanRA::splitIntervalsAtHoles(*this);
+  }
   BankConflictPass bc(*this, false);
   LivenessAnalysis liveAnalysis(*this, G4_GRF | G4_INPUT);
   liveAnalysis.computeLiveness();
@@ -9491,6 +10174,26 @@ std::pair<bool, bool> GlobalRA::remat(bool fastCompile, bool rematDone,
   return std::make_pair(false, rematDone);
 }
 
+bool GlobalRA::rematSpills(bool fastCompile, LivenessAnalysis &liveAnalysis,
+                           GraphColor &coloring, RPE &rpe) {
+  if (!kernel.getOption(vISA_RematSpills) || kernel.getOption(vISA_Debug) ||
+      kernel.getOption(vISA_NoRemat) || kernel.getOption(vISA_FastSpill) ||
+      fastCompile)
+    return false;
+
+  Rematerialization remat(kernel, liveAnalysis, coloring, rpe, *this);
+  unsigned int numRematted = remat.rematerializeSpills();
+  RA_TRACE({
+    if (numRematted > 0)
+      std::cout << "\t--rematerialized " << numRematted
+                << " spilled ranges\n";
+  });
+
+  // The spilled ranges are gone, so color again before inserting any spill
+  // code for the remaining ones.
+  return numRematted > 0;
+}
+
 std::tuple<bool, bool, bool>
 GlobalRA ::alignedScalarSplit(bool fastCompile, bool alignedScalarSplitDone,
                               GraphColor &coloring) {
@@ -9888,11 +10591,8 @@ GlobalRA::insertSpillCode(bool enableSpillSpaceCompression,
 
 bool GlobalRA::rerunGRAIter(bool rerunGRA)
 {
-  if (getIterNo() == 0 && (rerunGRA || kernel.getOption(vISA_forceBCR))) {
-    if (kernel.getOption(vISA_forceBCR)) {
-      // FIXME: We shouldn't modify options. Use local bool flag instead.
-      kernel.getOptions()->setOption(vISA_forceBCR, false);
-    }
+  if (getIterNo() == 0 && (rerunGRA || forceBCR)) {
+    forceBCR = false;
     return true;
   }
   return false;
@@ -10035,7 +10735,8 @@ int GlobalRA::coloringRegAlloc() {
     createVariablesForHybridRAWithSpill();
   }
 
-  bool rematDone = false, alignedScalarSplitDone = false;
+  bool rematDone = false, rematSpillsDone = false,
+       alignedScalarSplitDone = false;
   bool reserveSpillReg = false;
   VarSplit splitPass(*this);
   DynPerfModel perfModel(kernel);
@@ -10104,7 +10805,7 @@ int GlobalRA::coloringRegAlloc() {
         iterationNo > 0 ? false : builder.getOption(vISA_ForceSpills);
     RPE rpe(*this, &liveAnalysis);
     if (!fastCompile) {
-      rpe.run();
+      rpe.run(incRA.isEnabled() ? &incRA : nullptr);
       writeVerboseRPEStats(rpe);
     }
     GraphColor coloring(liveAnalysis, false, forceSpill);
@@ -10128,6 +10829,14 @@ int GlobalRA::coloringRegAlloc() {
 
       bool rerunGRA1 = false, rerunGRA2 = false, rerunGRA3 = false,
            isEarlyExit = false, abort = false, success = false;
+      // Like remat, rematerializing spilled ranges is tried only once so
+      // that it cannot keep RA from reaching the iteration limit.
+      if (!rematSpillsDone) {
+        rematSpillsDone = true;
+        if (rematSpills(fastCompile, liveAnalysis, coloring, rpe))
+          continue;
+      }
+
       std::tie(rerunGRA1, rematDone) = remat(fastCompile, rematDone, liveAnalysis, coloring, rpe);
       std::tie(rerunGRA2, alignedScalarSplitDone, isEarlyExit) =
           alignedScalarSplit(fastCompile, alignedScalarSplitDone, coloring);
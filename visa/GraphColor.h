@@ -19,15 +19,18 @@ SPDX-License-Identifier: MIT
 // clang-format off
 #include "common/LLVMWarningsPush.hpp"
 #include "llvm/Support/Allocator.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
 #include "common/LLVMWarningsPop.hpp"
 // clang-format on
 
+#include <algorithm>
 #include <limits>
 #include <list>
 #include <map>
 #include <memory>
 #include <queue>
+#include <tuple>
 #include <unordered_set>
 #include <vector>
 
@@ -81,6 +84,7 @@ private:
                 G4_Declare **opndDcls, unsigned *offset);
   void getPrevBanks(G4_INST *inst, BankConflict *srcBC, G4_Declare **dcls,
                     G4_Declare **opndDcls, unsigned *offset);
+  void setupBankConflictsGlobally();
 
 public:
   bool setupBankConflictsForKernel(bool doLocalRR, bool &threeSourceCandidate,
@@ -420,16 +424,74 @@ public:
   }
 };
 
+// Neighbor lists of all variables of the interference graph in compressed
+// sparse row form: the neighbors of variable v are
+// neighbors[offsets[v], offsets[v + 1]), sorted by id. Compared to a vector
+// per variable this needs no per-variable allocation or slack.
+class InterferenceAdjacency {
+  std::vector<unsigned> offsets;
+  std::vector<unsigned> neighbors;
+
+public:
+  // forEachEdge(f) must call f(v1, v2) with v1 < v2 for every edge, in
+  // increasing (v1, v2) order so that the neighbor lists come out sorted. It
+  // is invoked twice: once to count the degrees and once to fill the lists.
+  template <typename EdgeIterator>
+  void build(unsigned numVars, EdgeIterator forEachEdge) {
+    offsets.assign(numVars + 1, 0);
+    forEachEdge([this](unsigned v1, unsigned v2) {
+      ++offsets[v1 + 1];
+      ++offsets[v2 + 1];
+    });
+    for (unsigned v = 0; v < numVars; ++v)
+      offsets[v + 1] += offsets[v];
+    neighbors.resize(offsets[numVars]);
+    std::vector<unsigned> next(offsets.begin(), offsets.end() - 1);
+    forEachEdge([&](unsigned v1, unsigned v2) {
+      neighbors[next[v2]++] = v1;
+      neighbors[next[v1]++] = v2;
+    });
+  }
+
+  void clear() {
+    offsets.clear();
+    neighbors.clear();
+  }
+  unsigned size() const {
+    return offsets.empty() ? 0 : (unsigned)offsets.size() - 1;
+  }
+  bool empty() const { return size() == 0; }
+  size_t getNumNeighbors() const { return neighbors.size(); }
+
+  llvm::ArrayRef<unsigned> operator[](unsigned id) const {
+    return llvm::ArrayRef<unsigned>(neighbors.data() + offsets[id],
+                                    neighbors.data() + offsets[id + 1]);
+  }
+
+  bool isNeighbor(unsigned v1, unsigned v2) const {
+    auto list1 = (*this)[v1], list2 = (*this)[v2];
+    if (list1.size() > list2.size()) {
+      std::swap(list1, list2);
+      std::swap(v1, v2);
+    }
+    return std::binary_search(list1.begin(), list1.end(), v2);
+  }
+};
+
 // This class stores base matrices used for interference building for graph coloring.
 struct InterferenceMatrixStorage {
   // This member is a half triangle representation of interference graph implemented
   // as a sparse bitvector. Interference construction uses this member. When
-  // incremental RA is enabled, this member is updated incrementally.
+  // incremental RA is enabled, this member is updated incrementally;
+  // otherwise it is released once sparseIntf is built.
   std::vector<SparseBitVector> sparseMatrix;
   // This member is constructed after SIMT and SIMD interference are computed.
   // It's a full triangle representation of interference matrix with trivial
   // traversal. This member is reconstructed in each graph color iteration.
-  std::vector<std::vector<unsigned>> sparseIntf;
+  // With incremental RA it is still rebuilt from the whole matrix, and both
+  // stay resident, so the compact lists only save memory when incremental RA
+  // is off.
+  InterferenceAdjacency sparseIntf;
 };
 
 // This class contains implementation of various methods to implement
@@ -449,7 +511,7 @@ private:
   G4_Kernel &kernel;
   LiveRangeVec lrs;
   std::vector<SparseBitVector>& sparseMatrix;
-  std::vector<std::vector<unsigned>>& sparseIntf;
+  InterferenceAdjacency &sparseIntf;
   G4_RegFileKind selectedRF = G4_RegFileKind::G4_UndefinedRF;
   unsigned int level = 0;
   std::unordered_set<G4_Declare *> needIntfUpdate;
@@ -535,6 +597,7 @@ public:
   void moveFromHybridToGlobalGRF() {
     varIdx.clear();
     maxVarIdx = 0;
+    clearBBSummaries();
     reset();
   }
 
@@ -555,8 +618,10 @@ public:
   // first available index that can be assigned to new variable.
   unsigned int getNextVarId(unsigned char RF) {
     if ((RF & selectedRF) == 0) {
+      // Summaries refer to variables by id.
       varIdx.clear();
       maxVarIdx = 0;
+      clearBBSummaries();
     }
     if (varIdx.size() == 0)
       return 0;
@@ -597,7 +662,82 @@ public:
 
   void evenAlignUpdate(G4_Declare *dcl) { evenAlignCache.insert(dcl); }
 
+  // Per-BB results of liveness, RPE and spill cost computation. They are
+  // kept across RA iterations and reused for BBs whose key (see
+  // LivenessAnalysis::computeBBKey()) didn't change, ie BBs not touched
+  // by spill/fill insertion, remat or splitting. Only the BBs touched are
+  // recomputed.
+  struct BBSummary {
+    std::vector<uint64_t> key;
+    // Liveness gen/kill sets, before scoping and IPA.
+    SparseBitVector def_out;
+    SparseBitVector use_gen;
+    SparseBitVector use_kill;
+    // Pseudo kills inserted by liveness and the instruction each precedes.
+    std::vector<std::pair<G4_Declare *, G4_INST *>> pseudoKills;
+    // Register pressure of each instruction in bottom-up order, computed for
+    // live-out set rpLiveOut.
+    bool hasRP = false;
+    SparseBitVector rpLiveOut;
+    std::vector<unsigned int> rp;
+    unsigned int maxRP = 0;
+    // Number of direct and indirect references to each variable, used for
+    // spill cost computation.
+    bool hasRefs = false;
+    std::vector<std::pair<G4_Declare *, unsigned int>> directRefs;
+    std::vector<std::pair<G4_Declare *, unsigned int>> indirectRefs;
+  };
+
+  // Invoked by liveness before computing gen/kill sets. Summaries of BBs not
+  // looked up again are dropped. Return the generation identifying the
+  // summaries recorded from now on, to be passed to getBBSummary().
+  uint64_t startBBSummaries(const LivenessAnalysis *liveness);
+
+  // Return summary of bb and whether it's unchanged since it was recorded.
+  // A changed BB gets a fresh summary to be filled in. An empty key never
+  // matches.
+  std::pair<BBSummary &, bool> lookupBBSummary(const G4_BB *bb,
+                                               std::vector<uint64_t> &&key);
+
+  // Return summary of bb recorded along with liveness, nullptr if there's
+  // none. Summaries are matched by generation rather than by liveness address
+  // as a later liveness object may reuse the storage of an earlier one.
+  BBSummary *getBBSummary(const G4_BB *bb, const LivenessAnalysis *liveness);
+
+  bool isBBUnchanged(const G4_BB *bb) const {
+    return unchangedBBs.count(bb) > 0;
+  }
+
+  // Sum up loop weighted reference counts of variables over all BBs,
+  // recounting only the BBs that changed.
+  void computeWeightedRefCounts(
+      const LivenessAnalysis *liveness,
+      std::unordered_map<G4_Declare *, unsigned int> &directRefs,
+      std::unordered_map<G4_Declare *, unsigned int> &indirectRefs);
+
+  // With verification enabled, report a reused summary that differs from
+  // full recomputation.
+  void reportBBSummaryMismatch(const G4_BB *bb, const char *what) const;
+
 private:
+  std::unordered_map<const G4_BB *, BBSummary> bbSummaries;
+  std::unordered_map<const G4_BB *, BBSummary> prevBBSummaries;
+  std::unordered_set<const G4_BB *> unchangedBBs;
+  // Generation of the current summaries, 0 if there are none.
+  uint64_t summaryGeneration = 0;
+  uint64_t lastSummaryGeneration = 0;
+  unsigned char summaryRF = 0;
+
+  void clearBBSummaries() {
+    bbSummaries.clear();
+    prevBBSummaries.clear();
+    unchangedBBs.clear();
+    summaryGeneration = 0;
+  }
+
+  void countRefs(G4_BB *bb, const LivenessAnalysis *liveness,
+                 BBSummary &summary) const;
+
   // For verification only
   std::vector<SparseBitVector> def_in;
   std::vector<SparseBitVector> def_out;
@@ -645,7 +785,7 @@ class Interference {
   Augmentation aug;
   IncrementalRA &incRA;
 
-  std::vector<std::vector<unsigned>>& sparseIntf;
+  InterferenceAdjacency &sparseIntf;
 
   // sparse interference matrix.
   // we don't directly update sparseIntf to ensure uniqueness
@@ -666,13 +806,64 @@ class Interference {
 
   G4_Declare *getGRFDclForHRA(int GRFNum) const;
 
+  // Interference edges found by one worker of the parallel per-BB walk (see
+  // buildInterferenceForBBsInParallel). Edges between two ordinary variables
+  // are only ever set, so they are kept as rows that are OR-ed into the
+  // matrix. Edges involving a split or partial dcl may also be cleared by
+  // buildInterferenceWithLive, so their updates are logged in walk order and
+  // replayed after the merge to get the same result as the serial walk.
+  struct IntfShard {
+    std::vector<SparseBitVector> rows;
+    // (v1, v2, set) with v1 < v2.
+    std::vector<std::tuple<unsigned, unsigned, bool>> splitOps;
+  };
+  // Shard of the calling thread while it walks its BBs, nullptr otherwise.
+  static thread_local IntfShard *activeShard;
+
+  bool involvesSplitDcl(unsigned v1, unsigned v2) const {
+    return lrs[v1]->getIsPartialDcl() || lrs[v1]->getIsSplittedDcl() ||
+           lrs[v2]->getIsPartialDcl() || lrs[v2]->getIsSplittedDcl();
+  }
+
+  // Per-BB walk counterparts of safeSetInterference/safeClearInterference,
+  // writing to the shard of the calling worker if there is one.
+  inline void setWalkInterference(IntfShard *shard, unsigned v1, unsigned v2) {
+    if (!shard) {
+      safeSetInterference(v1, v2);
+    } else if (involvesSplitDcl(v1, v2)) {
+      shard->splitOps.emplace_back(v1, v2, true);
+    } else {
+      shard->rows[v1].set(v2);
+    }
+  }
+
+  inline void clearWalkInterference(IntfShard *shard, unsigned v1,
+                                    unsigned v2) {
+    if (!shard) {
+      safeClearInterference(v1, v2);
+    } else {
+      // Only ever called with a split or partial dcl.
+      shard->splitOps.emplace_back(v1, v2, false);
+    }
+  }
+
+  void checkAndSetWalkIntf(unsigned v1, unsigned v2) {
+    if (v1 < v2) {
+      setWalkInterference(activeShard, v1, v2);
+    } else if (v1 > v2) {
+      setWalkInterference(activeShard, v2, v1);
+    }
+  }
+
   // Only upper-half matrix is now used in intf graph.
   inline void safeSetInterference(unsigned v1, unsigned v2) {
     // Assume v1 < v2
     if (useDenseMatrix()) {
+      vISA_ASSERT(matrix, "intf graph matrix was freed");
       unsigned col = v2 / BITS_DWORD;
       matrix[v1 * rowSize + col] |= 1 << (v2 % BITS_DWORD);
     } else {
+      vISA_ASSERT(v1 < sparseMatrix.size(), "sparse intf matrix was freed");
       sparseMatrix[v1].set(v2);
     }
   }
@@ -692,12 +883,13 @@ class Interference {
     if (useDenseMatrix()) {
 #ifdef _DEBUG
       vISA_ASSERT(
-          sparseIntf.size() == 0,
+          sparseIntf.empty(),
           "Updating intf graph matrix after populating sparse intf graph");
 #endif
-
+      vISA_ASSERT(matrix, "intf graph matrix was freed");
       matrix[v1 * rowSize + col] |= block;
     } else {
+      vISA_ASSERT(v1 < sparseMatrix.size(), "sparse intf matrix was freed");
       auto &&intfSet = sparseMatrix[v1];
       for (int i = 0; i < BITS_DWORD; ++i) {
         if (block & (1 << i)) {
@@ -737,6 +929,10 @@ class Interference {
 
   void buildInterferenceWithLocalRA(G4_BB *bb);
 
+  unsigned getInterferenceThreads(const std::vector<G4_BB *> &bbs) const;
+  void buildInterferenceForBBsInParallel(const std::vector<G4_BB *> &bbs,
+                                         unsigned numThreads);
+
   void buildInterferenceAmongLiveOuts();
   void buildInterferenceAmongLiveIns();
 
@@ -744,6 +940,7 @@ class Interference {
 
   void generateSparseIntfGraph();
   void countNeighbors();
+  void getExtraInterferenceInfo();
 
   void setupLRs(G4_BB *bb);
 
@@ -793,7 +990,7 @@ public:
   void getNormIntfNum();
   void applyPartitionBias();
   bool interfereBetween(unsigned v1, unsigned v2) const;
-  const std::vector<unsigned> &getSparseIntfForVar(unsigned id) const {
+  llvm::ArrayRef<unsigned> getSparseIntfForVar(unsigned id) const {
     return sparseIntf[id];
   }
 
@@ -942,12 +1139,52 @@ class GraphColor {
   void computeDegreeForGRF();
   void computeDegreeForARF();
   void computeSpillCosts(bool useSplitLLRHeuristic, const RPE *rpe);
-  void determineColorOrdering();
+  // Weighting of the spill cost that orders the live ranges for coloring.
+  enum class ColorOrderWeight {
+    SpillCost,
+    SpillCostPerGRF,
+    SpillCostPerDegree,
+  };
+  // Live ranges, coloring order and spill list that assignColors works on.
+  // Parallel coloring attempts work on private copies of the live ranges.
+  struct ColoringState {
+    LiveRangeVec &ranges;
+    const LiveRangeVec &order;
+    LIVERANGE_LIST &spilled;
+    // Attempts leave the RA type of the kernel alone.
+    bool isAttempt;
+  };
+  // One configuration tried by assignColorsInParallel and its result.
+  struct ColoringAttempt {
+    ColorHeuristic heuristic;
+    bool doBankConflict;
+    ColorOrderWeight weight;
+    bool spillFree = false;
+    float cost = 0.0f;
+    // Assignment of each live range, indexed by id.
+    std::vector<std::pair<G4_VarBase *, unsigned>> assignment;
+  };
+
+  void determineColorOrdering(
+      ColorOrderWeight weight = ColorOrderWeight::SpillCost);
   void removeConstrained();
   void relaxNeighborDegreeGRF(LiveRange *lr);
   void relaxNeighborDegreeARF(LiveRange *lr);
   bool assignColors(ColorHeuristic heuristicGRF, bool doBankConflict,
-                    bool highInternalConflict, bool doBundleConflict = false);
+                    bool highInternalConflict, bool doBundleConflict,
+                    ColoringState &state);
+  bool assignColors(ColorHeuristic heuristicGRF, bool doBankConflict,
+                    bool highInternalConflict, bool doBundleConflict = false) {
+    ColoringState state{lrs, colorOrder, spilledLRs, false};
+    return assignColors(heuristicGRF, doBankConflict, highInternalConflict,
+                        doBundleConflict, state);
+  }
+  unsigned getColoringThreads() const;
+  bool assignColorsInParallel(bool doBankConflictReduction,
+                              bool highInternalConflict, bool doBundleConflict,
+                              bool hasStackCall,
+                              const std::vector<unsigned> &initialDegrees,
+                              unsigned numThreads);
   bool assignColors(ColorHeuristic h) {
     // Do graph coloring without bank conflict reduction.
     return assignColors(h, false, false);
@@ -965,7 +1202,6 @@ class GraphColor {
   void gatherScatterForbiddenWA();
 
 public:
-  void getExtraInterferenceInfo();
   GraphColor(LivenessAnalysis &live, bool hybrid, bool forceSpill_);
 
   const Options *getOptions() const { return m_options; }
@@ -1145,6 +1381,10 @@ public:
 
   const bool use4GRFAlign = false;
 
+  // Copy of vISA_forceBCR; it is only honored in the first RA iteration and
+  // the shared option table must not be modified during compilation.
+  bool forceBCR = false;
+
 private:
   template <class REGION_TYPE>
   static unsigned getRegionDisp(REGION_TYPE *region, const IR_Builder &irb);
@@ -1651,7 +1891,8 @@ public:
             k.fg.builder->useLscForNonStackSpillFill()),
         useLscForScatterSpill(k.fg.builder->supportsLSC() &&
                               k.fg.builder->getOption(vISA_scatterSpill)),
-        use4GRFAlign(k.fg.builder->supports4GRFAlign()) {
+        use4GRFAlign(k.fg.builder->supports4GRFAlign()),
+        forceBCR(k.getOption(vISA_forceBCR)) {
     vars.resize(k.Declares.size());
 
     if (kernel.getOptions()->getOption(vISA_VerifyAugmentation)) {
@@ -1672,7 +1913,10 @@ public:
   void emitFGWithLiveness(const LivenessAnalysis &liveAnalysis) const;
   void reportSpillInfo(const LivenessAnalysis &liveness,
                        const GraphColor &coloring) const;
-  static uint32_t getRefCount(int loopNestLevel);
+  static uint32_t getRefCount(int loopNestLevel) {
+    return FlowGraph::getLoopNestWeight(loopNestLevel);
+  }
+  void reportBankConflicts(std::ostream &os);
   void updateSubRegAlignment(G4_SubReg_Align subAlign);
   bool isChannelSliced();
   // Used by LRA/GRA/hybrid RA
@@ -1842,6 +2086,9 @@ private:
   std::pair<bool, bool> remat(bool fastCompile, bool rematDone,
                               LivenessAnalysis &liveAnalysis,
                               GraphColor &coloring, RPE &rpe);
+  // return whether spilled ranges were rematerialized instead of spilled
+  bool rematSpills(bool fastCompile, LivenessAnalysis &liveAnalysis,
+                   GraphColor &coloring, RPE &rpe);
   // rerun GRA, alignedScalarSplitDone, isEarlyExit
   std::tuple<bool, bool, bool> alignedScalarSplit(bool fastCompile,
                                                   bool alignedScalarSplitDone,
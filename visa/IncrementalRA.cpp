@@ -7,6 +7,7 @@ SPDX-License-Identifier: MIT
 ============================= end_copyright_notice ===========================*/
 
 #include "GraphColor.h"
+#include "PointsToAnalysis.h"
 
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/ADT/StringMap.h>
@@ -348,9 +349,139 @@ void IncrementalRA::skipIncrementalRANextIter() {
   // For passes that rarely executed or for debugging purpose,
   // we can invoke this method to skip running incremental RA
   // in following iteration.
+  clearBBSummaries();
   reset();
 }
 
+uint64_t IncrementalRA::startBBSummaries(const LivenessAnalysis *liveness) {
+  if (liveness->getSelectedRF() != summaryRF) {
+    clearBBSummaries();
+    summaryRF = liveness->getSelectedRF();
+  }
+  prevBBSummaries = std::move(bbSummaries);
+  bbSummaries.clear();
+  unchangedBBs.clear();
+  summaryGeneration = ++lastSummaryGeneration;
+  return summaryGeneration;
+}
+
+std::pair<IncrementalRA::BBSummary &, bool>
+IncrementalRA::lookupBBSummary(const G4_BB *bb, std::vector<uint64_t> &&key) {
+  auto &summary = bbSummaries[bb];
+  auto it = prevBBSummaries.find(bb);
+  if (!key.empty() && it != prevBBSummaries.end() && it->second.key == key) {
+    summary = std::move(it->second);
+    prevBBSummaries.erase(it);
+    unchangedBBs.insert(bb);
+    return {summary, true};
+  }
+  summary.key = std::move(key);
+  return {summary, false};
+}
+
+IncrementalRA::BBSummary *
+IncrementalRA::getBBSummary(const G4_BB *bb,
+                            const LivenessAnalysis *liveness) {
+  if (liveness->getBBSummaryGeneration() == 0 ||
+      liveness->getBBSummaryGeneration() != summaryGeneration)
+    return nullptr;
+  auto it = bbSummaries.find(bb);
+  return it != bbSummaries.end() ? &it->second : nullptr;
+}
+
+void IncrementalRA::countRefs(G4_BB *bb, const LivenessAnalysis *liveness,
+                              BBSummary &summary) const {
+  // Count references the same way as VarReferences for direct references,
+  // and via points-to sets for indirect ones.
+  std::unordered_map<G4_Declare *, unsigned int> direct, indirect;
+  auto &pointsToAnalysis = liveness->getPointsToAnalysis();
+  auto addIndirectRefs = [&](G4_Operand *opnd) {
+    auto pointsTo = pointsToAnalysis.getAllInPointsTo(
+        opnd->getBase()->asRegVar()->getDeclare()->getRootDeclare()
+            ->getRegVar());
+    if (pointsTo) {
+      for (auto &pointee : *pointsTo)
+        ++indirect[pointee.var->getDeclare()->getRootDeclare()];
+    }
+  };
+
+  for (auto inst : *bb) {
+    auto dst = inst->getDst();
+    if (dst && dst->isIndirect())
+      addIndirectRefs(dst);
+    else {
+      for (unsigned int i = 0; i != inst->getNumSrc(); ++i) {
+        auto src = inst->getSrc(i);
+        if (src && src->isSrcRegRegion() &&
+            src->asSrcRegRegion()->isIndirect())
+          addIndirectRefs(src);
+      }
+    }
+
+    if (inst->isPseudoKill())
+      continue;
+    if (dst && !dst->isNullReg() && dst->getTopDcl())
+      ++direct[dst->getTopDcl()];
+    for (unsigned int i = 0; i != inst->getNumSrc(); ++i) {
+      auto src = inst->getSrc(i);
+      if (src && src->isSrcRegRegion() && src->getTopDcl())
+        ++direct[src->getTopDcl()];
+    }
+  }
+
+  summary.hasRefs = true;
+  summary.directRefs.assign(direct.begin(), direct.end());
+  summary.indirectRefs.assign(indirect.begin(), indirect.end());
+}
+
+void IncrementalRA::computeWeightedRefCounts(
+    const LivenessAnalysis *liveness,
+    std::unordered_map<G4_Declare *, unsigned int> &directRefs,
+    std::unordered_map<G4_Declare *, unsigned int> &indirectRefs) {
+  auto &loops = kernel.fg.getLoops();
+  const unsigned int assumeLoopIter = 10;
+
+  for (auto bb : kernel.fg.getBBList()) {
+    BBSummary fullSummary;
+    auto *summary = getBBSummary(bb, liveness);
+    if (!summary)
+      summary = &fullSummary;
+
+    if (!summary->hasRefs || !isBBUnchanged(bb)) {
+      countRefs(bb, liveness, *summary);
+    } else if (isEnabledWithVerification()) {
+      countRefs(bb, liveness, fullSummary);
+      auto sorted = [](auto refs) {
+        std::sort(refs.begin(), refs.end(), [](auto &a, auto &b) {
+          return a.first->getDeclId() < b.first->getDeclId();
+        });
+        return refs;
+      };
+      if (sorted(fullSummary.directRefs) != sorted(summary->directRefs) ||
+          sorted(fullSummary.indirectRefs) != sorted(summary->indirectRefs)) {
+        reportBBSummaryMismatch(bb, "reference counts");
+        summary->directRefs.swap(fullSummary.directRefs);
+        summary->indirectRefs.swap(fullSummary.indirectRefs);
+      }
+    }
+
+    unsigned int weight = 1;
+    if (auto *innerMostLoop = loops.getInnerMostLoop(bb))
+      weight = (unsigned int)std::pow(assumeLoopIter,
+                                      innerMostLoop->getNestingLevel());
+    for (auto &ref : summary->directRefs)
+      directRefs[ref.first] += ref.second * weight;
+    for (auto &ref : summary->indirectRefs)
+      indirectRefs[ref.first] += ref.second * weight;
+  }
+}
+
+void IncrementalRA::reportBBSummaryMismatch(const G4_BB *bb,
+                                            const char *what) const {
+  std::cerr << "BB" << bb->getId() << " : reused " << what
+            << " differ from full recomputation\n";
+}
+
 bool IncrementalRA::verify(const LivenessAnalysis *curLiveness) const {
   // Verify whether candidate set contains:
   // 1. Variables added in previous iteration (eg, spill temp, remat temp),
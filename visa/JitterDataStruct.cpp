@@ -23,7 +23,8 @@ llvm::json::Value toJSON(const PERF_STATS &p) {
     {"numGRFSpillFill", p.numGRFSpillFillWeighted},
     {"GRFSpillSize", p.spillMemUsed},
     {"numCycles", p.numCycles},
-    {"maxGRFPressure", p.maxGRFPressure}
+    {"maxGRFPressure", p.maxGRFPressure},
+    {"tokenStallCycles", p.tokenStallCycles}
   };
 }
 
@@ -52,6 +53,8 @@ llvm::json::Value toJSON(const PERF_STATS_VERBOSE &p) {
     jsonObject.insert({"normIntfNum", p.normIntfNum});
     jsonObject.insert({"augIntfNum", p.augIntfNum});
   }
+  if (p.secondChanceSpillNum)
+    jsonObject.insert({"secondChanceSpillNum", p.secondChanceSpillNum});
 
   return jsonObject;
 }
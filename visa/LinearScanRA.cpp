@@ -16,6 +16,7 @@ SPDX-License-Identifier: MIT
 
 #include <fstream>
 #include <tuple>
+#include <unordered_map>
 
 using namespace vISA;
 
@@ -203,7 +204,7 @@ unsigned int LinearScanRA::convertSubRegOffFromWords(G4_Declare *dcl,
   return subregnum;
 }
 
-void LSLiveRange::recordRef(G4_BB *bb, bool fromEntry) {
+void LSLiveRange::recordRef(G4_BB *bb, bool fromEntry, float weight) {
   if (numRefsInFG < 2) {
     if (fromEntry) {
       numRefsInFG += 2;
@@ -214,6 +215,7 @@ void LSLiveRange::recordRef(G4_BB *bb, bool fromEntry) {
   }
   if (!fromEntry) {
     numRefs++;
+    weightedRefs += weight;
   }
 }
 
@@ -408,6 +410,7 @@ void globalLinearScan::expireAllActive() {
 void LinearScanRA::linearScanMarkReferencesInOpnd(G4_Operand *opnd, bool isEOT,
                                                   bool isCall) {
   G4_Declare *topdcl = NULL;
+  float weight = curBBWeight_;
 
   if ((opnd->isSrcRegRegion() || opnd->isDstRegRegion())) {
     topdcl = GetTopDclFromRegRegion(opnd);
@@ -418,7 +421,7 @@ void LinearScanRA::linearScanMarkReferencesInOpnd(G4_Operand *opnd, bool isEOT,
       vISA_ASSERT(topdcl->getAliasDeclare() == NULL, "Not topdcl");
       LSLiveRange *lr = GetOrCreateLocalLiveRange(topdcl);
 
-      lr->recordRef(curBB_, false);
+      lr->recordRef(curBB_, false, weight);
       if (isEOT && kernel.fg.builder->hasEOTGRFBinding()) {
         lr->markEOT();
       }
@@ -444,7 +447,7 @@ void LinearScanRA::linearScanMarkReferencesInOpnd(G4_Operand *opnd, bool isEOT,
 
     LSLiveRange *lr = GetOrCreateLocalLiveRange(topdcl);
 
-    lr->recordRef(curBB_, false);
+    lr->recordRef(curBB_, false, weight);
     lr->markIndirectRef(true);
     if (topdcl->getRegVar() && topdcl->getRegVar()->isPhyRegAssigned() &&
         topdcl->getRegVar()->getPhyReg()->isGreg()) {
@@ -479,6 +482,8 @@ void LinearScanRA::linearScanMarkReferences(unsigned int &numRowsEOT) {
   // Iterate over all BBs
   for (auto curBB : kernel.fg) {
     curBB_ = curBB;
+    if (builder.getOption(vISA_LinearScanSecondChance))
+      curBBWeight_ = kernel.fg.getBlockWeight(curBB);
     // Iterate over all insts
     for (INST_LIST_ITER inst_it = curBB->begin(), inst_end = curBB->end();
          inst_it != inst_end; ++inst_it) {
@@ -615,6 +620,133 @@ void LinearScanRA::markBackEdges() {
   }
 }
 
+// Splits the live interval of a block-local variable at its holes: every
+// whole-region definition after the first one starts a new value, which
+// is renamed to a fresh declare. Linear scan then sees one short interval per
+// value instead of a single interval spanning all of them, so the GRFs can be
+// reused in between and each value is spilled on its own.
+unsigned LinearScanRA::splitIntervalsAtHoles(GlobalRA &gra) {
+  G4_Kernel &kernel = gra.kernel;
+  IR_Builder &builder = gra.builder;
+
+  struct VarRefs {
+    G4_BB *bb = nullptr;
+    bool splittable = true;
+    // (inst, src index), -1 for the dst; srcs of an instruction come first.
+    std::vector<std::pair<G4_INST *, int>> refs;
+  };
+  std::unordered_map<G4_Declare *, VarRefs> vars;
+
+  for (auto bb : kernel.fg) {
+    for (auto inst : *bb) {
+      auto addRef = [&](G4_Operand *opnd, int pos) {
+        if (!opnd)
+          return;
+        if (opnd->isAddrExp()) {
+          vars[opnd->asAddrExp()->getRegVar()->getDeclare()->getRootDeclare()]
+              .splittable = false;
+          return;
+        }
+        if (!opnd->isSrcRegRegion() && !opnd->isDstRegRegion())
+          return;
+        G4_Declare *topdcl = GetTopDclFromRegRegion(opnd);
+        if (!topdcl || topdcl->getRegFile() != G4_GRF)
+          return;
+        VarRefs &var = vars[topdcl];
+        if ((var.bb && var.bb != bb) || inst->isEOT() ||
+            opnd->getBase()->asRegVar()->getDeclare() != topdcl)
+          var.splittable = false;
+        var.bb = bb;
+        var.refs.emplace_back(inst, pos);
+      };
+      for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; i++)
+        addRef(inst->getSrc(i), i);
+      addRef(inst->getDst(), -1);
+    }
+  }
+
+  auto canSplit = [&](G4_Declare *dcl) {
+    G4_RegVar *var = dcl->getRegVar();
+    return !dcl->isInput() && !dcl->isOutput() && !dcl->getAddressed() &&
+           !dcl->isDoNotSpill() && !dcl->getIsSplittedDcl() &&
+           !dcl->getIsPartialDcl() && dcl != builder.getBuiltinR0() &&
+           dcl != gra.getOldFPDcl() && !var->isPhyRegAssigned() &&
+           !var->isRegVarTransient() && !var->isRegVarTmp() &&
+           !kernel.fg.isPseudoDcl(dcl);
+  };
+
+  // A definition that overwrites every byte of dcl in all channels.
+  auto killsWholeVar = [](G4_BB *bb, G4_INST *inst, G4_Declare *dcl) {
+    if (inst->isPseudoKill())
+      return true;
+    G4_DstRegRegion *dst = inst->getDst();
+    if (inst->getPredicate() || inst->isPartialWrite() ||
+        (!bb->isAllLaneActive() && !inst->isWriteEnableInst()))
+      return false;
+    if (!inst->isSend() && dst->getHorzStride() != 1 && inst->getExecSize() != 1)
+      return false;
+    return dst->getLeftBound() == 0 &&
+           dst->getRightBound() + 1 == dcl->getByteSize();
+  };
+
+  // Visit the variables in declaration order so that the new declares are
+  // created deterministically; they are appended to kernel.Declares.
+  unsigned numSplits = 0;
+  for (size_t d = 0, numDcls = kernel.Declares.size(); d < numDcls; d++) {
+    G4_Declare *dcl = kernel.Declares[d];
+    auto it = vars.find(dcl);
+    if (it == vars.end())
+      continue;
+    VarRefs &var = it->second;
+    if (!var.splittable || var.refs.size() < 3 || !canSplit(dcl))
+      continue;
+    // Unless the first reference defines the whole variable, its value may be
+    // carried into the block, eg around a loop back edge into a reference that
+    // precedes the last definition. Renaming the later values would then cut
+    // them off from that reference.
+    auto [firstInst, firstPos] = var.refs.front();
+    if (firstPos != -1 || !killsWholeVar(var.bb, firstInst, dcl))
+      continue;
+
+    G4_Declare *curDcl = dcl;
+    unsigned numSegments = 0;
+    for (size_t i = 0, numRefs = var.refs.size(); i < numRefs; i++) {
+      auto [inst, pos] = var.refs[i];
+      // A definition that also reads dcl continues the current value.
+      bool readsVar = i > 0 && var.refs[i - 1].first == inst;
+      if (pos == -1 && i > 0 && !readsVar &&
+          killsWholeVar(var.bb, inst, dcl)) {
+        const char *name = builder.getNameString(
+            64, "%s_hs%u", dcl->getName(), ++numSegments);
+        curDcl = builder.createDeclare(name, G4_GRF, dcl->getNumElems(),
+                                       dcl->getNumRows(), dcl->getElemType());
+        curDcl->copyAlign(dcl);
+        gra.copyAlignment(curDcl, dcl);
+        numSplits++;
+      }
+      if (curDcl == dcl)
+        continue;
+
+      if (pos == -1) {
+        G4_DstRegRegion *dst = inst->getDst();
+        inst->setDest(builder.createDst(curDcl->getRegVar(), dst->getRegOff(),
+                                        dst->getSubRegOff(),
+                                        dst->getHorzStride(), dst->getType(),
+                                        dst->getAccRegSel()));
+      } else {
+        inst->setSrc(builder.createSrcWithNewBase(
+                         inst->getSrc(pos)->asSrcRegRegion(),
+                         curDcl->getRegVar()),
+                     pos);
+      }
+    }
+  }
+
+  RA_TRACE(std::cout << "\tlinear scan: split " << numSplits
+                     << " block-local intervals at holes\n");
+  return numSplits;
+}
+
 void LinearScanRA::createLiveIntervals() {
   for (auto dcl : gra.kernel.Declares) {
     // Mark those physical registers busy that are declared with Output
@@ -1791,6 +1923,7 @@ globalLinearScan::globalLinearScan(
       lastLexicalID(lastLexID), numRegLRA(numReg), doBankConflict(bankConflict),
       highInternalConflict(internalConflict) {
   startGRFReg = 0;
+  secondChance = builder.getOption(vISA_LinearScanSecondChance);
   activeGRF.resize(g.kernel.getNumRegTotal());
   for (auto lr : inputLivelIntervals) {
     unsigned int regnum = lr->getRegWordIdx() / builder.numEltPerGRF<Type_UW>();
@@ -2065,7 +2198,19 @@ bool globalLinearScan::runLinearScan(IR_Builder &builder,
       updateGlobalActiveList(lr);
     } else // Spill
     {
-      if (spillFromActiveList(lr, spillLRs)) {
+      float evictCost = 0.0f;
+      int startGRF = findSpillCandidate(lr, evictCost);
+      if (secondChance && canBeSpilledLR(lr) &&
+          (startGRF == -1 || getSpillCost(lr) < evictCost)) {
+        // Spilling lr is cheaper than evicting the active ranges, which keep
+        // their registers. lr gets registers for its fills and spills in the
+        // next iteration.
+        if (auto jitInfo = builder.getJitInfo())
+          jitInfo->statsVerbose.secondChanceSpillNum++;
+        spillLRs.push_back(lr);
+        continue;
+      }
+      if (spillFromActiveList(lr, startGRF, spillLRs)) {
         // Fixme: get the start GRF already, can allocate immediately
         allocateRegResult = allocateRegsLinearScan(lr, builder);
         if (!allocateRegResult) {
@@ -2226,9 +2371,19 @@ bool globalLinearScan::canBeSpilledLR(LSLiveRange *lr) {
   return true;
 }
 
-int globalLinearScan::findSpillCandidate(LSLiveRange *tlr) {
+// Cost of spilling lr in the unit of findSpillCandidate: its references per
+// GRF-instruction it occupies.
+float globalLinearScan::getSpillCost(LSLiveRange *lr) const {
+  unsigned startIdx = 0, endIdx = 0;
+  lr->getFirstRef(startIdx);
+  lr->getLastRef(endIdx);
+  float refs = secondChance ? lr->getWeightedRefs() : (float)lr->getNumRefs();
+  return refs / (1 + (endIdx - startIdx) * lr->getTopDcl()->getNumRows());
+}
+
+int globalLinearScan::findSpillCandidate(LSLiveRange *tlr, float &cost) {
   unsigned short requiredRows = tlr->getTopDcl()->getNumRows();
-  int referenceCount = 0;
+  float referenceCount = 0.0f;
   int startGRF = -1;
   float spillCost = (float)(int)0x7FFFFFFF;
   unsigned lastIdxs = 1;
@@ -2284,7 +2439,8 @@ int globalLinearScan::findSpillCandidate(LSLiveRange *tlr) {
                   : lr->getTopDcl()->getNumRows() - (i - startregnum);
           lr->getLastRef(endIdx);
           lastIdxs += (endIdx - tStartIdx) * effectGRFNum;
-          referenceCount += lr->getNumRefs();
+          referenceCount += secondChance ? lr->getWeightedRefs()
+                                         : (float)lr->getNumRefs();
         }
 
         if (!canBeFree) {
@@ -2303,7 +2459,7 @@ int globalLinearScan::findSpillCandidate(LSLiveRange *tlr) {
 
     if (canBeFree) {
       // Spill cost
-      float currentSpillCost = (float)referenceCount / lastIdxs;
+      float currentSpillCost = referenceCount / lastIdxs;
 
       if (currentSpillCost < spillCost) {
         startGRF = i;
@@ -2312,9 +2468,10 @@ int globalLinearScan::findSpillCandidate(LSLiveRange *tlr) {
     }
 
     lastIdxs = 1;
-    referenceCount = 0;
+    referenceCount = 0.0f;
   }
 
+  cost = spillCost;
   return startGRF;
 }
 
@@ -2391,10 +2548,8 @@ void globalLinearScan::freeSelectedRegistsers(
   }
 }
 
-bool globalLinearScan::spillFromActiveList(LSLiveRange *tlr,
+bool globalLinearScan::spillFromActiveList(LSLiveRange *tlr, int startGRF,
                                            std::list<LSLiveRange *> &spillLRs) {
-  int startGRF = findSpillCandidate(tlr);
-
   if (startGRF == -1) {
 #ifdef DEBUG_VERBOSE_ON
     printActives();
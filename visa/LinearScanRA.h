@@ -152,6 +152,9 @@ private:
 
   // scratch fields used for parameter passing
   G4_BB *curBB_ = nullptr;
+  // Second-chance mode weighs the references of curBB_ by its block weight
+  // for the spill choice; 1 otherwise.
+  float curBBWeight_ = 1.0f;
 
 public:
   static void getRowInfo(int size, int &nrows, int &lastRowSize,
@@ -160,6 +163,10 @@ public:
                                                 int subregnuminwords);
 
   LinearScanRA(BankConflictPass &, GlobalRA &, LivenessAnalysis &);
+  // Renames each block-local GRF variable after every whole-region
+  // redefinition, so that the holes between its definitions are not part of
+  // its live interval. Must run before liveness.
+  static unsigned splitIntervalsAtHoles(GlobalRA &gra);
   void allocForbiddenVector(LSLiveRange *lr);
   int doLinearScanRA();
   void undoLinearScanRAAssignments();
@@ -180,6 +187,10 @@ private:
 
   unsigned int numRefsInFG;
   unsigned int numRefs;
+  // References weighted by the block weight of their BB, used as spill cost
+  // in second-chance mode. All block weights of a kernel are on one scale,
+  // see FlowGraph::getBlockWeight.
+  float weightedRefs;
   G4_BB *prevBBRef;
 
   bool *forbidden = nullptr;
@@ -205,6 +216,7 @@ public:
     isIndirectAccess = false;
     numRefsInFG = 0;
     numRefs = 0;
+    weightedRefs = 0.0f;
     prevBBRef = NULL;
     preg = NULL;
     pregoff = 0;
@@ -237,8 +249,9 @@ public:
     isIndirectAccess = indirectAccess;
   }
 
-  void recordRef(G4_BB *bb, bool fromEntry);
+  void recordRef(G4_BB *bb, bool fromEntry, float weight = 1.0f);
   unsigned int getNumRefs() const { return numRefs; }
+  float getWeightedRefs() const { return weightedRefs; }
   bool isGRFRegAssigned();
 
   void setTopDcl(G4_Declare *dcl) {
@@ -381,10 +394,11 @@ private:
   bool insertLiveRange(std::list<LSLiveRange *> *liveIntervals,
                        LSLiveRange *lr);
   bool canBeSpilledLR(LSLiveRange *lr);
-  int findSpillCandidate(LSLiveRange *tlr);
+  float getSpillCost(LSLiveRange *lr) const;
+  int findSpillCandidate(LSLiveRange *tlr, float &cost);
   void freeSelectedRegistsers(int startGRF, LSLiveRange *tlr,
                               std::list<LSLiveRange *> &spillLRs);
-  bool spillFromActiveList(LSLiveRange *tlr,
+  bool spillFromActiveList(LSLiveRange *tlr, int startGRF,
                            std::list<LSLiveRange *> &spillLRs);
 
   unsigned int startGRFReg = 0;
@@ -394,6 +408,9 @@ private:
 
   bool doBankConflict = false;
   bool highInternalConflict = false;
+  // Weigh spill costs by block frequency and let the interval being
+  // allocated be spilled itself when it is cheaper than any eviction.
+  bool secondChance = false;
 
 public:
   globalLinearScan(GlobalRA &g, LivenessAnalysis *l,
@@ -570,6 +570,710 @@ static unsigned getLatencyHidingThreshold(G4_Kernel &kernel, unsigned NumGrfs) {
   return unsigned(RPThreshold * (std::max(NumGrfs, 128u) - 32u) / 96u);
 }
 
+namespace {
+
+// Moves long-latency loads across block boundaries, ahead of the local
+// schedule. A region is a single-entry single-exit hammock: a block A, the
+// block J that post-dominates it immediately and is dominated by it, and the
+// blocks H in between. A and J are control-equivalent, so a read-only send at
+// the top of J can be issued at the end of A without compensation code, and
+// its latency is then covered by H. Regions are visited from the hottest one
+// down, and a send is only moved while the register pressure over H stays
+// within the latency-hiding threshold.
+class GlobalScheduler {
+  G4_Kernel &kernel;
+  const SchedConfig &config;
+  const LatencyTable &LT;
+  RegisterPressure rp;
+  // Blocks whose instructions changed; their pressure is stale.
+  std::vector<bool> touched;
+
+  static const unsigned MAX_HAMMOCK_BLOCKS = 64;
+
+public:
+  GlobalScheduler(G4_Kernel &kernel, const SchedConfig &config,
+                  const LatencyTable &LT)
+      : kernel(kernel), config(config), LT(LT), rp(kernel, nullptr),
+        touched(kernel.fg.getNumBB(), false) {}
+
+  bool run();
+
+private:
+  bool getHammock(G4_BB *A, G4_BB *J, std::vector<G4_BB *> &H) const;
+  bool scheduleRegion(G4_BB *A, G4_BB *J, const std::vector<G4_BB *> &H);
+};
+
+// Declares read and written by an instruction. Returns false if some operand
+// cannot be tracked by declare, e.g. an indirect or a physical register; the
+// declares of the other operands are still collected.
+static bool getDclRefs(G4_INST *Inst, std::vector<G4_Declare *> &Reads,
+                       std::vector<G4_Declare *> &Writes) {
+  Reads.clear();
+  Writes.clear();
+  auto add = [](G4_Operand *Opnd, std::vector<G4_Declare *> &Dcls) {
+    if (Opnd == nullptr || Opnd->getBase() == nullptr || Opnd->isNullReg())
+      return true;
+    if ((Opnd->isDstRegRegion() && Opnd->asDstRegRegion()->isIndirect()) ||
+        (Opnd->isSrcRegRegion() && Opnd->asSrcRegRegion()->isIndirect()))
+      return false;
+    G4_Declare *Dcl = Opnd->getTopDcl();
+    if (Dcl == nullptr)
+      return !Opnd->isRegRegion() && !Opnd->isPhysicallyAllocatedRegVar();
+    Dcls.push_back(Dcl->getRootDeclare());
+    return true;
+  };
+  bool Tracked = true;
+  for (auto OpNum : {Opnd_dst, Opnd_condMod, Opnd_implAccDst})
+    Tracked &= add(Inst->getOperand(OpNum), Writes);
+  if (Inst->isPseudoAddrMovIntrinsic())
+    return false;
+  for (auto OpNum : {Opnd_src0, Opnd_src1, Opnd_src2, Opnd_src3, Opnd_pred,
+                     Opnd_implAccSrc})
+    Tracked &= add(Inst->getOperand(OpNum), Reads);
+  return Tracked;
+}
+
+static bool isMemoryBarrier(G4_INST *Inst) {
+  if (!Inst->isSend())
+    return false;
+  G4_SendDesc *Desc = Inst->getMsgDesc();
+  return Desc->isWrite() || Desc->isAtomic() || Desc->isFence() ||
+         Desc->isBarrier() || Desc->isScratch() || Inst->isEOT();
+}
+
+bool GlobalScheduler::run() {
+  auto &PDom = kernel.fg.getPostDominator();
+  auto &Dom = kernel.fg.getImmDominator();
+  auto &Loops = kernel.fg.getLoops();
+
+  struct Region {
+    G4_BB *A;
+    G4_BB *J;
+    // Expected execution count of A. FlowGraph::getBlockWeight puts every
+    // block of the kernel on the same scale, so regions can be ranked by it.
+    float Weight;
+  };
+  std::vector<Region> Regions;
+  for (auto A : kernel.fg) {
+    if (A->isDivergent() || A->empty())
+      continue;
+    G4_INST *Last = A->back();
+    if (Last->isCall() || Last->isFCall() || Last->isReturn() ||
+        Last->isFReturn() || Last->isEOT())
+      continue;
+    auto &IPDom = PDom.getImmPostDom(A);
+    if (IPDom.size() < 2)
+      continue;
+    G4_BB *J = IPDom[1];
+    if (J == A || J->isDivergent() || !Dom.dominates(A, J) ||
+        Loops.getInnerMostLoop(A) != Loops.getInnerMostLoop(J))
+      continue;
+    Regions.push_back({A, J, kernel.fg.getBlockWeight(A)});
+  }
+  // Hot regions first; the block order breaks ties.
+  std::stable_sort(Regions.begin(), Regions.end(),
+                   [](const Region &R1, const Region &R2) {
+                     return R1.Weight > R2.Weight;
+                   });
+
+  bool Changed = false;
+  std::vector<G4_BB *> H;
+  for (auto &R : Regions) {
+    if (touched[R.A->getId()] || touched[R.J->getId()])
+      continue;
+    if (!getHammock(R.A, R.J, H) || H.empty())
+      continue;
+    if (std::any_of(H.begin(), H.end(),
+                    [&](G4_BB *BB) { return touched[BB->getId()]; }))
+      continue;
+    if (scheduleRegion(R.A, R.J, H)) {
+      Changed = true;
+      touched[R.A->getId()] = touched[R.J->getId()] = true;
+      for (auto BB : H)
+        touched[BB->getId()] = true;
+    }
+  }
+  return Changed;
+}
+
+// Collects the blocks on the paths from A to J. Fails if the region is not a
+// hammock, is too large, or contains an instruction nothing may be moved
+// across.
+bool GlobalScheduler::getHammock(G4_BB *A, G4_BB *J,
+                                 std::vector<G4_BB *> &H) const {
+  H.clear();
+  std::vector<bool> Visited(kernel.fg.getNumBB(), false);
+  std::vector<G4_BB *> Worklist(A->Succs.begin(), A->Succs.end());
+  while (!Worklist.empty()) {
+    G4_BB *BB = Worklist.back();
+    Worklist.pop_back();
+    if (BB == J || Visited[BB->getId()])
+      continue;
+    if (BB == A || H.size() >= MAX_HAMMOCK_BLOCKS)
+      return false;
+    Visited[BB->getId()] = true;
+    H.push_back(BB);
+    Worklist.insert(Worklist.end(), BB->Succs.begin(), BB->Succs.end());
+  }
+  for (auto BB : H) {
+    for (auto Inst : *BB) {
+      if (Inst->isCall() || Inst->isFCall() || Inst->isReturn() ||
+          Inst->isFReturn() || isMemoryBarrier(Inst))
+        return false;
+      if (!Inst->isLabel() && !Inst->isCFInst() &&
+          preNode::isBarrier(Inst))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool GlobalScheduler::scheduleRegion(G4_BB *A, G4_BB *J,
+                                     const std::vector<G4_BB *> &H) {
+  // Declares read and written between the end of A and the top of J, and the
+  // peak pressure over that range. A's terminator is part of the range as
+  // sends are inserted before it.
+  std::unordered_set<G4_Declare *> Reads, Writes, Killed;
+  std::vector<G4_Declare *> InstReads, InstWrites;
+  // Pressure before the move, and the rows of the sends moved so far which
+  // are live over the whole range.
+  unsigned Pressure = 0;
+  unsigned MovedRows = 0;
+  unsigned Cycles = 0;
+  auto addToRange = [&](G4_INST *Inst) {
+    if (!getDclRefs(Inst, InstReads, InstWrites))
+      return false;
+    Reads.insert(InstReads.begin(), InstReads.end());
+    Writes.insert(InstWrites.begin(), InstWrites.end());
+    if (Inst->isPseudoKill())
+      Killed.insert(InstWrites.begin(), InstWrites.end());
+    else if (!Inst->isLabel())
+      Pressure = std::max(Pressure, rp.getPressure(Inst));
+    return true;
+  };
+
+  auto InsertPos = A->end();
+  if (A->back()->isCFInst()) {
+    InsertPos = std::prev(A->end());
+    if (!addToRange(A->back()))
+      return false;
+  }
+  Pressure = std::max(Pressure, rp.getPressure(A->back()));
+  for (auto BB : H) {
+    for (auto Inst : *BB) {
+      if (!addToRange(Inst))
+        return false;
+      if (!Inst->isLabel() && !Inst->isPseudoKill())
+        Cycles += LT.getOccupancy(Inst);
+    }
+  }
+  // Nothing to hide the latency behind.
+  if (Cycles == 0)
+    return false;
+
+  unsigned Threshold =
+      getLatencyHidingThreshold(kernel, kernel.getNumRegTotal());
+  unsigned GRFSize = kernel.numEltPerGRF<Type_UB>();
+  bool Changed = false;
+
+  // Pseudo kills seen at the top of J, by the declare they kill.
+  std::unordered_map<G4_Declare *, INST_LIST_ITER> Kills;
+  for (auto It = J->begin(); It != J->end(); /*empty*/) {
+    G4_INST *Inst = *It;
+    if (Inst->isLabel()) {
+      ++It;
+      continue;
+    }
+    if (Inst->isCFInst() || isMemoryBarrier(Inst) ||
+        preNode::isBarrier(Inst))
+      break;
+    if (!getDclRefs(Inst, InstReads, InstWrites))
+      break;
+
+    auto conflicts = [&]() {
+      for (auto Dcl : InstReads)
+        if (Writes.count(Dcl))
+          return true;
+      for (auto Dcl : InstWrites)
+        if (Writes.count(Dcl) || Reads.count(Dcl) || Killed.count(Dcl))
+          return true;
+      return false;
+    };
+
+    bool Move = false;
+    G4_Declare *Dst = InstWrites.size() == 1 ? InstWrites[0] : nullptr;
+    if (Inst->isSend() && Inst->getMsgDesc()->isRead() && Dst &&
+        Inst->getPredicate() == nullptr && !conflicts()) {
+      // The latency hidden already within J, up to the first use.
+      unsigned Hidden = 0;
+      bool Used = false;
+      std::vector<G4_Declare *> UseReads, UseWrites;
+      for (auto UseIt = std::next(It); UseIt != J->end(); ++UseIt) {
+        G4_INST *Use = *UseIt;
+        if (!getDclRefs(Use, UseReads, UseWrites) ||
+            std::find(UseReads.begin(), UseReads.end(), Dst) !=
+                UseReads.end()) {
+          Used = true;
+          break;
+        }
+        if (!Use->isLabel() && !Use->isPseudoKill())
+          Hidden += LT.getOccupancy(Use);
+      }
+      unsigned Rows = (Dst->getByteSize() + GRFSize - 1) / GRFSize;
+      Move = Used && Hidden < LT.getLatency(Inst) &&
+             Pressure + MovedRows + Rows <= Threshold;
+      if (Move)
+        MovedRows += Rows;
+    }
+
+    if (!Move) {
+      // Keep it in J; later candidates must not cross it.
+      if (Inst->isPseudoKill() && Dst) {
+        Kills[Dst] = It;
+        ++It;
+        continue;
+      }
+      Reads.insert(InstReads.begin(), InstReads.end());
+      Writes.insert(InstWrites.begin(), InstWrites.end());
+      Pressure = std::max(Pressure, rp.getPressure(Inst));
+      ++It;
+      continue;
+    }
+
+    SCHED_DUMP(std::cerr << "Hoist from BB" << J->getId() << " to BB"
+                         << A->getId() << ": ";
+               Inst->dump());
+    auto Kill = Kills.find(Dst);
+    if (Kill != Kills.end()) {
+      A->insertBefore(InsertPos, *Kill->second);
+      J->erase(Kill->second);
+      Kills.erase(Kill);
+    }
+    A->insertBefore(InsertPos, Inst);
+    It = J->erase(It);
+    Changed = true;
+  }
+
+  return Changed;
+}
+
+// Software pipelining of loads in single-block innermost loops, i.e. a
+// two-stage modulo schedule where the loads form the first stage. A load whose
+// address is computed from values that are final at the end of an iteration
+// is issued one iteration ahead: the preheader issues it for the first
+// iteration, and the loop issues it for the next iteration, predicated like
+// the back edge, into a renamed declare. At the load's original position the
+// renamed declare is copied into the original destination, which emulates the
+// register rotation; the address computation is cloned with renamed
+// declares as well. A load is only pipelined if the LatencyTable estimate of
+// its exposed latency goes down and the extra registers fit the RPE budget.
+class LoopPipeliner {
+  G4_Kernel &kernel;
+  IR_Builder &builder;
+  const SchedConfig &config;
+  const LatencyTable &LT;
+  RegisterPressure rp;
+  // Declares created here are unknown to the liveness of rp.
+  std::unordered_set<G4_Declare *> newDcls;
+
+  struct InstRefs {
+    G4_INST *Inst;
+    std::vector<G4_Declare *> Reads;
+    std::vector<G4_Declare *> Writes;
+    bool Tracked;
+
+    bool reads(G4_Declare *Dcl) const {
+      return std::find(Reads.begin(), Reads.end(), Dcl) != Reads.end();
+    }
+    bool writes(G4_Declare *Dcl) const {
+      return std::find(Writes.begin(), Writes.end(), Dcl) != Writes.end();
+    }
+  };
+
+public:
+  LoopPipeliner(G4_Kernel &kernel, const SchedConfig &config,
+                const LatencyTable &LT)
+      : kernel(kernel), builder(*kernel.fg.builder), config(config), LT(LT),
+        rp(kernel, nullptr) {}
+
+  bool run();
+
+private:
+  bool pipelineLoop(G4_BB *BB, G4_BB *PreHeader);
+  bool pipelineLoad(G4_BB *BB, G4_BB *PreHeader, G4_INST *Load,
+                    unsigned Budget, unsigned &ExtraRows);
+  bool isRenamable(G4_Declare *Dcl) const;
+  unsigned getCycles(G4_INST *Inst) const;
+  void renameOperands(
+      G4_INST *Inst,
+      const std::unordered_map<G4_Declare *, G4_Declare *> &Renamed);
+  void copyDcl(G4_BB *BB, INST_LIST_ITER Pos, G4_Declare *Dst,
+               G4_Declare *Src);
+};
+
+bool LoopPipeliner::run() {
+  bool Changed = false;
+  std::vector<Loop *> Loops = kernel.fg.getLoops().getTopLoops();
+  for (unsigned i = 0; i < Loops.size(); ++i) {
+    Loop *L = Loops[i];
+    Loops.insert(Loops.end(), L->immNested.begin(), L->immNested.end());
+    if (!L->immNested.empty() || L->getBBSize() != 1)
+      continue;
+
+    G4_BB *BB = L->getHeader();
+    if (BB->size() > LARGE_BLOCK_SIZE || !kernel.fg.isBackwardBranch(BB, BB))
+      continue;
+    G4_BB *PreHeader = nullptr;
+    unsigned NumEntries = 0;
+    for (auto Pred : BB->Preds) {
+      if (Pred != BB) {
+        PreHeader = Pred;
+        ++NumEntries;
+      }
+    }
+    if (NumEntries != 1 || PreHeader->Succs.size() != 1)
+      continue;
+    Changed |= pipelineLoop(BB, PreHeader);
+  }
+  return Changed;
+}
+
+bool LoopPipeliner::pipelineLoop(G4_BB *BB, G4_BB *PreHeader) {
+  G4_INST *Branch = BB->back();
+  G4_Predicate *Pred = Branch->getPredicate();
+  if (Pred == nullptr || Pred->getTopDcl() == nullptr)
+    return false;
+
+  // Loads are moved across the whole iteration, so anything that may write
+  // memory or a register behind our back rules the loop out.
+  std::vector<G4_INST *> Loads;
+  for (auto Inst : *BB) {
+    if (Inst->isCall() || Inst->isFCall() || Inst->isReturn() ||
+        Inst->isFReturn() || isMemoryBarrier(Inst))
+      return false;
+    if (Inst->getDst() && Inst->getDst()->isIndirect())
+      return false;
+    // Every instruction but the branch runs with the same execution mask.
+    if (Inst->isCFInst() && Inst != Branch)
+      return false;
+    if (Inst->isSend() && Inst->getMsgDesc()->isRead())
+      Loads.push_back(Inst);
+  }
+
+  unsigned Budget = getLatencyHidingThreshold(kernel, kernel.getNumRegTotal());
+  unsigned Pressure = rp.getPressure(BB);
+  if (Pressure >= Budget)
+    return false;
+
+  bool Changed = false;
+  unsigned ExtraRows = 0;
+  for (auto Load : Loads)
+    Changed |=
+        pipelineLoad(BB, PreHeader, Load, Budget - Pressure, ExtraRows);
+  return Changed;
+}
+
+bool LoopPipeliner::isRenamable(G4_Declare *Dcl) const {
+  return Dcl && Dcl->getRegFile() == G4_GRF && !Dcl->getAliasDeclare() &&
+         !Dcl->isInput() && !Dcl->isOutput() && !Dcl->getAddressed() &&
+         !newDcls.count(Dcl) &&
+         Dcl->getByteSize() % kernel.numEltPerGRF<Type_UB>() == 0;
+}
+
+unsigned LoopPipeliner::getCycles(G4_INST *Inst) const {
+  if (Inst->isLabel() || Inst->isPseudoKill())
+    return 0;
+  // Back-to-back dpas on the same accumulator are latency bound.
+  if (Inst->isDpas())
+    return LT.getDPASLatency(Inst->asDpasInst()->getRepeatCount());
+  return LT.getOccupancy(Inst);
+}
+
+void LoopPipeliner::renameOperands(
+    G4_INST *Inst,
+    const std::unordered_map<G4_Declare *, G4_Declare *> &Renamed) {
+  if (G4_DstRegRegion *Dst = Inst->getDst()) {
+    auto It = Renamed.find(Dst->getTopDcl());
+    if (It != Renamed.end())
+      Inst->setDest(builder.createDst(
+          It->second->getRegVar(), Dst->getRegOff(), Dst->getSubRegOff(),
+          Dst->getHorzStride(), Dst->getType(), Dst->getAccRegSel()));
+  }
+  for (unsigned i = 0, e = Inst->getNumSrc(); i < e; ++i) {
+    G4_Operand *Src = Inst->getSrc(i);
+    if (Src == nullptr || !Src->isSrcRegRegion())
+      continue;
+    auto It = Renamed.find(Src->getTopDcl());
+    if (It != Renamed.end())
+      Inst->setSrc(builder.createSrcWithNewBase(Src->asSrcRegRegion(),
+                                                It->second->getRegVar()),
+                   i);
+  }
+}
+
+void LoopPipeliner::copyDcl(G4_BB *BB, INST_LIST_ITER Pos, G4_Declare *Dst,
+                            G4_Declare *Src) {
+  // Full-GRF movs, two rows at a time, like the loop split copies.
+  unsigned NumRows = Dst->getByteSize() / kernel.numEltPerGRF<Type_UB>();
+  for (unsigned Row = 0; Row < NumRows;) {
+    unsigned Rows = NumRows - Row >= 2 ? 2 : 1;
+    G4_ExecSize ExecSize(kernel.numEltPerGRF<Type_F>() * Rows);
+    auto DstRgn =
+        builder.createDst(Dst->getRegVar(), (short)Row, 0, 1, Type_F);
+    auto SrcRgn = builder.createSrc(Src->getRegVar(), (short)Row, 0,
+                                    builder.getRegionStride1(), Type_F);
+    BB->insertBefore(Pos, builder.createMov(ExecSize, DstRgn, SrcRgn,
+                                            InstOpt_WriteEnable, false));
+    Row += Rows;
+  }
+}
+
+bool LoopPipeliner::pipelineLoad(G4_BB *BB, G4_BB *PreHeader, G4_INST *Load,
+                                 unsigned Budget, unsigned &ExtraRows) {
+  G4_INST *Branch = BB->back();
+  G4_Predicate *Pred = Branch->getPredicate();
+
+  // The load of the next iteration must run on exactly the channels that
+  // take the back edge, so it takes over the predicate of the branch.
+  if (Branch->opcode() == G4_jmpi) {
+    if (Load->getExecSize() != g4::SIMD1)
+      return false;
+  } else if (Load->isWriteEnableInst() ||
+             Load->getExecSize() != Branch->getExecSize() ||
+             Load->getMaskOffset() != Branch->getMaskOffset() ||
+             Pred->getControl() != PRED_DEFAULT) {
+    return false;
+  }
+  G4_SendDesc *Desc = Load->getMsgDesc();
+  if (Load->getPredicate() || Load->isEOT() || Desc->isWrite() ||
+      Desc->isAtomic() || Desc->isScratch())
+    return false;
+  G4_Declare *Dst = Load->getDst() ? Load->getDst()->getTopDcl() : nullptr;
+  if (!isRenamable(Dst) || rp.isLiveOut(PreHeader, Dst))
+    return false;
+
+  std::vector<InstRefs> Insts;
+  unsigned LoadIdx = 0;
+  for (auto Inst : *BB) {
+    if (Inst == Load)
+      LoadIdx = Insts.size();
+    Insts.push_back({Inst, {}, {}, true});
+    Insts.back().Tracked =
+        getDclRefs(Inst, Insts.back().Reads, Insts.back().Writes);
+    for (auto Dcl : Insts.back().Reads)
+      if (newDcls.count(Dcl))
+        Insts.back().Tracked = false;
+  }
+  const unsigned End = Insts.size() - 1;
+  if (!Insts[LoadIdx].Tracked)
+    return false;
+
+  // The address computation of the load within the iteration.
+  std::set<unsigned> Slice;
+  std::unordered_set<G4_Declare *> Needed(Insts[LoadIdx].Reads.begin(),
+                                          Insts[LoadIdx].Reads.end());
+  std::vector<G4_Declare *> RenamedOrder;
+  for (unsigned i = LoadIdx; i-- > 0;) {
+    const InstRefs &Refs = Insts[i];
+    if (std::none_of(Refs.Writes.begin(), Refs.Writes.end(),
+                     [&](G4_Declare *Dcl) { return Needed.count(Dcl); }))
+      continue;
+    G4_INST *Inst = Refs.Inst;
+    if (!Refs.Tracked || Inst->isSend() || Inst->isCFInst() ||
+        Inst->isDpas() || Inst->isLifeTimeEnd())
+      return false;
+    for (auto Dcl : Refs.Writes) {
+      if (!isRenamable(Dcl) || Dcl == Dst)
+        return false;
+      if (std::find(RenamedOrder.begin(), RenamedOrder.end(), Dcl) ==
+          RenamedOrder.end())
+        RenamedOrder.push_back(Dcl);
+    }
+    Slice.insert(i);
+    Needed.insert(Refs.Reads.begin(), Refs.Reads.end());
+  }
+  auto isRenamed = [&](G4_Declare *Dcl) {
+    return std::find(RenamedOrder.begin(), RenamedOrder.end(), Dcl) !=
+           RenamedOrder.end();
+  };
+  // Renamed declares must be referenced by their top declare only.
+  std::vector<unsigned> Cloned(Slice.begin(), Slice.end());
+  Cloned.push_back(LoadIdx);
+  for (unsigned i : Cloned) {
+    G4_INST *Inst = Insts[i].Inst;
+    G4_Operand *Opnd = Inst->getDst();
+    if (Opnd && Opnd->getTopDcl() &&
+        Opnd->getTopDcl() != Opnd->getTopDcl()->getRootDeclare())
+      return false;
+    for (unsigned j = 0, e = Inst->getNumSrc(); j < e; ++j) {
+      Opnd = Inst->getSrc(j);
+      if (Opnd && Opnd->getTopDcl() &&
+          Opnd->getTopDcl() != Opnd->getTopDcl()->getRootDeclare() &&
+          isRenamed(Opnd->getTopDcl()->getRootDeclare()))
+        return false;
+    }
+  }
+
+  // The inputs of the slice must hold at the end of an iteration what they
+  // hold when the next iteration reaches the load: nothing else may define
+  // them above the load, and the clones go below their last definition.
+  std::unordered_set<G4_Declare *> Leaves;
+  for (unsigned i : Slice)
+    for (auto Dcl : Insts[i].Reads)
+      if (!isRenamed(Dcl))
+        Leaves.insert(Dcl);
+  for (auto Dcl : Insts[LoadIdx].Reads)
+    if (!isRenamed(Dcl))
+      Leaves.insert(Dcl);
+  if (Leaves.count(Dst))
+    return false;
+  G4_Declare *Flag = Pred->getTopDcl()->getRootDeclare();
+  unsigned Pos = LoadIdx;
+  for (unsigned i = 0; i < End; ++i) {
+    if (i == LoadIdx || Slice.count(i))
+      continue;
+    for (auto Dcl : Insts[i].Writes) {
+      if (Dcl == Dst || isRenamed(Dcl) || (i < LoadIdx && Leaves.count(Dcl)))
+        return false;
+      if (i > LoadIdx && (Leaves.count(Dcl) || Dcl == Flag))
+        Pos = std::max(Pos, i);
+    }
+  }
+
+  unsigned GRFSize = kernel.numEltPerGRF<Type_UB>();
+  unsigned Rows = Dst->getByteSize() / GRFSize;
+  for (auto Dcl : RenamedOrder)
+    Rows += Dcl->getByteSize() / GRFSize;
+  if (ExtraRows + Rows > Budget)
+    return false;
+
+  // Cycles issued from instruction From up to the next one (wrapping around
+  // the back edge) for which Stop returns true.
+  auto distance = [&](unsigned From, std::function<bool(unsigned)> Stop) {
+    unsigned Cycles = 0;
+    for (unsigned n = 1; n <= End; ++n) {
+      unsigned i = (From + n) % (End + 1);
+      if (Stop(i))
+        return Cycles;
+      Cycles += getCycles(Insts[i].Inst);
+    }
+    return Cycles;
+  };
+  auto exposed = [](unsigned Latency, unsigned Hidden) {
+    return Latency > Hidden ? Latency - Hidden : 0;
+  };
+  bool Used = false;
+  for (auto &Refs : Insts)
+    Used |= Refs.reads(Dst);
+  if (!Used)
+    return false;
+
+  // Exposed latency of the load, plus the stall of the first instruction
+  // overwriting one of its sources before the send has read them.
+  unsigned Latency = LT.getLatency(Load);
+  unsigned SrcRead = LT.getSendSrcReadLatency(Load);
+  const std::vector<G4_Declare *> &LoadReads = Insts[LoadIdx].Reads;
+  auto overwritesLoadSrc = [&](unsigned i) {
+    return std::any_of(LoadReads.begin(), LoadReads.end(),
+                       [&](G4_Declare *Dcl) { return Insts[i].writes(Dcl); });
+  };
+  unsigned Before =
+      exposed(Latency, distance(LoadIdx, [&](unsigned i) {
+                return Insts[i].reads(Dst);
+              })) +
+      exposed(SrcRead, distance(LoadIdx, overwritesLoadSrc));
+  // After pipelining the value is first read by the copy at LoadIdx, and the
+  // renamed sources are not redefined before the next iteration's clones.
+  unsigned After =
+      exposed(Latency,
+              distance(Pos, [&](unsigned i) { return i == LoadIdx; })) +
+      exposed(SrcRead, distance(Pos, [&](unsigned i) {
+                return std::any_of(LoadReads.begin(), LoadReads.end(),
+                                   [&](G4_Declare *Dcl) {
+                                     return !isRenamed(Dcl) &&
+                                            Insts[i].writes(Dcl);
+                                   });
+              }));
+  if (After >= Before)
+    return false;
+
+  // Clone the slice and the load for the prologue and the loop body before
+  // touching anything, as not every instruction can be cloned.
+  std::vector<G4_INST *> Originals;
+  for (unsigned i : Cloned)
+    Originals.push_back(Insts[i].Inst);
+  std::vector<G4_INST *> Prologue, Body;
+  for (auto Inst : Originals) {
+    Prologue.push_back(Inst->cloneInst());
+    Body.push_back(Inst->cloneInst());
+    if (!Prologue.back() || !Body.back())
+      return false;
+  }
+
+  std::unordered_map<G4_Declare *, G4_Declare *> Renamed;
+
+  auto rename = [&](G4_Declare *Dcl) {
+    const char *Name =
+        builder.getNameString(64, "%s_swp", Dcl->getName());
+    G4_Declare *NewDcl =
+        builder.createDeclare(Name, G4_GRF, Dcl->getNumElems(),
+                              Dcl->getNumRows(), Dcl->getElemType());
+    NewDcl->copyAlign(Dcl);
+    newDcls.insert(NewDcl);
+    Renamed[Dcl] = NewDcl;
+  };
+  rename(Dst);
+  for (auto Dcl : RenamedOrder)
+    rename(Dcl);
+  for (unsigned i = 0; i < Originals.size(); ++i) {
+    renameOperands(Prologue[i], Renamed);
+    renameOperands(Body[i], Renamed);
+  }
+  Body.back()->setPredicate(builder.duplicateOperand(Pred));
+
+  SCHED_DUMP(std::cerr << "Pipeline in BB" << BB->getId() << ": ";
+             Load->dump());
+
+  // Prologue: the first iteration's load at the end of the preheader. Parts
+  // of the address that are not redefined in the loop come from the
+  // original declares.
+  auto ProloguePos = PreHeader->end();
+  if (!PreHeader->empty() && PreHeader->back()->isCFInst())
+    ProloguePos = std::prev(ProloguePos);
+  for (auto Dcl : RenamedOrder)
+    if (rp.isLiveOut(PreHeader, Dcl))
+      copyDcl(PreHeader, ProloguePos, Renamed[Dcl], Dcl);
+  for (auto Inst : Prologue)
+    PreHeader->insertBefore(ProloguePos, Inst);
+
+  // Kernel: the next iteration's load below the last definition of its
+  // inputs, and the rotation copy in place of the load.
+  auto BodyPos = std::find(BB->begin(), BB->end(), Insts[Pos + 1].Inst);
+  for (auto Inst : Body)
+    BB->insertBefore(BodyPos, Inst);
+  auto LoadPos = std::find(BB->begin(), BB->end(), Load);
+  copyDcl(BB, LoadPos, Dst, Renamed[Dst]);
+  BB->erase(LoadPos);
+
+  // The original address computation is dead unless something else in the
+  // loop or after it reads it.
+  bool SliceDead = true;
+  for (auto Dcl : RenamedOrder) {
+    SliceDead &= !rp.isLiveOut(BB, Dcl);
+    for (unsigned i = 0; i <= End; ++i)
+      if (i != LoadIdx && !Slice.count(i) && Insts[i].reads(Dcl))
+        SliceDead = false;
+  }
+  if (SliceDead)
+    for (unsigned i : Slice)
+      BB->erase(std::find(BB->begin(), BB->end(), Insts[i].Inst));
+
+  ExtraRows += Rows;
+  return true;
+}
+
+} // namespace
+
 preRA_Scheduler::preRA_Scheduler(G4_Kernel &k) : kernel(k) {}
 
 preRA_Scheduler::~preRA_Scheduler() {}
@@ -586,12 +1290,17 @@ bool preRA_Scheduler::run(unsigned &KernelPressure) {
 
   auto LT = LatencyTable::createLatencyTable(*kernel.fg.builder);
   SchedConfig config(SchedCtrl);
+  bool Changed = false;
+  if (kernel.getOption(vISA_preRA_GlobalSchedule))
+    Changed |= GlobalScheduler(kernel, config, *LT).run();
+  if (kernel.getOption(vISA_preRA_SoftwarePipelining))
+    Changed |= LoopPipeliner(kernel, config, *LT).run();
+
   RegisterPressure rp(kernel, nullptr);
   // skip extreme test cases that scheduling does not good
   // if (kernel.fg.getNumBB() >= 10000 && rp.rpe->getMaxRP() >= 800)
   //   return false;
 
-  bool Changed = false;
   for (auto bb : kernel.fg) {
     if (bb->size() < SMALL_BLOCK_SIZE || bb->size() > LARGE_BLOCK_SIZE) {
       SCHED_DUMP(std::cerr << "Skip block with instructions " << bb->size()
@@ -646,10 +1355,15 @@ bool preRA_Scheduler::runWithGRFSelection(unsigned &KernelPressure) {
 
   unsigned SchedCtrl = kernel.getuInt32Option(vISA_preRA_ScheduleCtrl);
   SchedConfig config(SchedCtrl);
+  auto LT = LatencyTable::createLatencyTable(*kernel.fg.builder);
+  if (kernel.getOption(vISA_preRA_GlobalSchedule))
+    GlobalScheduler(kernel, config, *LT).run();
+  if (kernel.getOption(vISA_preRA_SoftwarePipelining))
+    LoopPipeliner(kernel, config, *LT).run();
+
   RegisterPressure rp(kernel, nullptr);
   KernelPressure = rp.getMaxRP();
   unsigned RPReductionThreshold = getRPReductionThreshold(kernel);
-  auto LT = LatencyTable::createLatencyTable(*kernel.fg.builder);
 
   // Schedule for reg pressure reduction if needed
   for (auto bb : kernel.fg) {
@@ -9,47 +9,53 @@ SPDX-License-Identifier: MIT
 #include "LatencyTable.h"
 #include "../G4_IR.hpp"
 #include "LocalScheduler_G4IR.h"
-#include <type_traits>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Support/Chrono.h>
+#include <llvm/Support/FileSystem.h>
+#include "common/LLVMWarningsPop.hpp"
 
 using namespace vISA;
 
-// c++23 std::to_underlying.
-template <typename Enum>
-inline std::underlying_type_t<Enum> value_of(Enum val) {
-  return static_cast<std::underlying_type_t<Enum>>(val);
-}
-
 class LatencyTableLegacy : public LatencyTable {
 public:
   LatencyTableLegacy(const IR_Builder& builder) : LatencyTable(builder) {
     vASSERT(builder.getPlatformGeneration() < PlatformGen::XE);
   }
-  uint16_t getLatency(const G4_INST *Inst) const override;
-  uint16_t getOccupancy(const G4_INST *Inst) const override;
-  uint16_t getDPASLatency(uint8_t repeatCount) const override;
   uint16_t getSendSrcReadLatency(const G4_INST *Inst) const override;
+
+protected:
+  uint16_t computeLatency(const G4_INST *Inst) const override;
+  uint16_t computeOccupancy(const G4_INST *Inst) const override;
+  uint16_t computeDPASLatency(uint8_t repeatCount) const override;
 };
 
 template <PlatformGen Gen>
 class LatencyTableXe: public LatencyTable {
-  // Select latency information based on platform generation.
-  using LI = typename std::conditional<Gen >= PlatformGen::XE,
-                                       XELatencyInfo,
-                                       void>::type;
 public:
   LatencyTableXe(const IR_Builder& builder) : LatencyTable(builder) {
     static_assert(Gen >= PlatformGen::XE);
   }
+  uint16_t getSendSrcReadLatency(const G4_INST *Inst) const override;
+
+protected:
   // General implementations to get latency and occupancy for the given
   // instruction based on heuristics. The implementation can be specialized if
   // needed.
-  uint16_t getLatency(const G4_INST *Inst) const override;
-  uint16_t getOccupancy(const G4_INST *Inst) const override;
+  uint16_t computeLatency(const G4_INST *Inst) const override;
+  uint16_t computeOccupancy(const G4_INST *Inst) const override;
 
   // The details of heuristics used to calculate the latency. The
   // implementation can be specialized if needed.
-  uint16_t getDPASLatency(uint8_t repeatCount) const override;
-  uint16_t getSendSrcReadLatency(const G4_INST *Inst) const override;
+  uint16_t computeDPASLatency(uint8_t repeatCount) const override;
 
 private:
   uint16_t getMsgLatency(const G4_INST *Inst) const;
@@ -63,14 +69,280 @@ private:
 
 std::unique_ptr<LatencyTable>
 LatencyTable::createLatencyTable(const IR_Builder &builder) {
+  std::unique_ptr<LatencyTable> LT;
   auto GEN = builder.getPlatformGeneration();
   if (GEN >= PlatformGen::XE)
-    return std::make_unique<LatencyTableXe<PlatformGen::XE>>(builder);
+    LT = std::make_unique<LatencyTableXe<PlatformGen::XE>>(builder);
+  else
+    LT = std::make_unique<LatencyTableLegacy>(builder);
+
+  const char *Path = builder.getOptions()->getOptionCstr(vISA_LatencyTableFile);
+  if (Path && *Path) {
+    // The schedulers and SWSB each create a table per kernel, so a file is
+    // parsed and, if bad, reported only the first time it's used. The
+    // parameters and rules loaded on top of the defaults are the same for all
+    // platforms. The cache lives for the whole process, so an entry also
+    // records the size and modification time of the file it was parsed from,
+    // and the file is parsed again when either changes.
+    struct LoadedFile {
+      uint64_t Size = 0;
+      llvm::sys::TimePoint<> ModTime;
+      bool Valid = false;
+      decltype(m_params) Params;
+      std::vector<LatencyRule> Rules;
+    };
+    static std::mutex CacheMutex;
+    static std::unordered_map<std::string, LoadedFile> Cache;
+
+    llvm::sys::fs::file_status Status;
+    bool HasStatus = !llvm::sys::fs::status(Path, Status);
+    uint64_t Size = HasStatus ? Status.getSize() : 0;
+    llvm::sys::TimePoint<> ModTime =
+        HasStatus ? Status.getLastModificationTime() : llvm::sys::TimePoint<>();
+
+    std::lock_guard<std::mutex> Lock(CacheMutex);
+    auto [It, Inserted] = Cache.try_emplace(Path);
+    LoadedFile &File = It->second;
+    if (Inserted || File.Size != Size || File.ModTime != ModTime) {
+      File.Size = Size;
+      File.ModTime = ModTime;
+      std::ifstream IFS(Path);
+      std::string Err = "cannot open file";
+      File.Valid = IFS && LT->load(IFS, Err);
+      if (File.Valid) {
+        File.Params = LT->m_params;
+        File.Rules = LT->m_rules;
+      } else {
+        std::cerr << "warning: ignoring latency table " << Path << ": " << Err
+                  << "\n";
+      }
+    } else if (File.Valid) {
+      LT->m_params = File.Params;
+      LT->m_rules = File.Rules;
+    }
+  }
+  return LT;
+}
+
+namespace {
+const char *const ParamNames[] = {
+#define DEF_LATENCY_PARAM(NAME, CYCLES) #NAME,
+#include "LatencyTableDefs.h"
+#undef DEF_LATENCY_PARAM
+};
+
+const uint16_t ParamDefaults[] = {
+#define DEF_LATENCY_PARAM(NAME, CYCLES) CYCLES,
+#include "LatencyTableDefs.h"
+#undef DEF_LATENCY_PARAM
+};
+
+// Indexed by LatencyRule::InstClass.
+const char *const ClassNames[] = {"any",  "send", "math", "branch", "intrinsic",
+                                  "dpas", "arf",  "alu",  "other"};
+
+// SFID names as printed in the asm.
+const std::pair<const char *, SFID> SFIDNames[] = {
+    {"null", SFID::NULL_SFID}, {"smpl", SFID::SAMPLER}, {"gtwy", SFID::GATEWAY},
+    {"dc2", SFID::DP_DC2},     {"rc", SFID::DP_RC},     {"urb", SFID::URB},
+    {"ts", SFID::SPAWNER},     {"vme", SFID::VME},      {"dcro", SFID::DP_CC},
+    {"dc0", SFID::DP_DC0},     {"pi", SFID::DP_PI},     {"dc1", SFID::DP_DC1},
+    {"cre", SFID::CRE},        {"btd", SFID::BTD},      {"rta", SFID::RTHW},
+    {"tgm", SFID::TGM},        {"slm", SFID::SLM},      {"ugm", SFID::UGM},
+    {"ugml", SFID::UGML}};
+
+bool parseUInt(const std::string &Str, unsigned Max, unsigned &Val) {
+  if (Str.empty())
+    return false;
+  char *End = nullptr;
+  unsigned long V = std::strtoul(Str.c_str(), &End, 10);
+  if (*End != '\0' || V > Max)
+    return false;
+  Val = static_cast<unsigned>(V);
+  return true;
+}
+
+bool parseRuleField(LatencyRule &Rule, const std::string &Key,
+                    const std::string &Value) {
+  unsigned V = 0;
+  if (Key == "class") {
+    auto It = std::find(std::begin(ClassNames), std::end(ClassNames), Value);
+    if (It == std::end(ClassNames))
+      return false;
+    Rule.Class = static_cast<LatencyRule::InstClass>(
+        std::distance(std::begin(ClassNames), It));
+  } else if (Key == "exec") {
+    if (!parseUInt(Value, 32, V) || V == 0)
+      return false;
+    Rule.ExecSize = static_cast<uint8_t>(V);
+  } else if (Key == "repeat") {
+    if (!parseUInt(Value, 8, V) || V == 0)
+      return false;
+    Rule.RepeatCount = static_cast<uint8_t>(V);
+  } else if (Key == "type") {
+    auto It = std::find_if(
+        std::begin(G4_Type_Table), std::end(G4_Type_Table) - 1,
+        [&](const G4_Type_Info &Info) { return Value == Info.syntax; });
+    if (It == std::end(G4_Type_Table) - 1)
+      return false;
+    Rule.Type = It->type;
+  } else if (Key == "sfid") {
+    auto It = std::find_if(std::begin(SFIDNames), std::end(SFIDNames),
+                           [&](const std::pair<const char *, SFID> &Name) {
+                             return Value == Name.first;
+                           });
+    if (It == std::end(SFIDNames))
+      return false;
+    Rule.SFID = static_cast<int>(It->second);
+  } else if (Key == "latency" || Key == "occupancy") {
+    if (!parseUInt(Value, std::numeric_limits<uint16_t>::max(), V))
+      return false;
+    (Key == "latency" ? Rule.Latency : Rule.Occupancy) = static_cast<int>(V);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+LatencyRule::InstClass classify(const G4_INST *Inst) {
+  using InstClass = LatencyRule::InstClass;
+  if (Inst->isSend())
+    return InstClass::Send;
+  if (Inst->isMath())
+    return InstClass::Math;
+  if (Inst->isFlowControl())
+    return InstClass::Branch;
+  if (Inst->isIntrinsic())
+    return InstClass::Intrinsic;
+  if (Inst->isDpas())
+    return InstClass::DPAS;
+  if (Inst->writesFlag() || (Inst->getDst() && Inst->getDst()->isDirectA0()))
+    return InstClass::ARF;
+  if (Inst->isArithmetic())
+    return InstClass::ALU;
+  return InstClass::Other;
+}
+} // namespace
 
-  return std::make_unique<LatencyTableLegacy>(builder);
+LatencyTable::LatencyTable(const IR_Builder &builder) : m_builder(builder) {
+  std::copy(std::begin(ParamDefaults), std::end(ParamDefaults),
+            m_params.begin());
+}
+
+bool LatencyTable::load(std::istream &is, std::string &err) {
+  auto Params = m_params;
+  auto Rules = m_rules;
+  unsigned LineNo = 0;
+  bool SeenVersion = false;
+  auto fail = [&](const std::string &Msg) {
+    err = "line " + std::to_string(LineNo) + ": " + Msg;
+    return false;
+  };
+
+  std::string Line;
+  while (std::getline(is, Line)) {
+    ++LineNo;
+    std::istringstream LS(Line.substr(0, Line.find('#')));
+    std::string Keyword;
+    if (!(LS >> Keyword))
+      continue;
+
+    if (!SeenVersion) {
+      std::string Version;
+      unsigned V = 0;
+      if (Keyword != "version" || !(LS >> Version) ||
+          !parseUInt(Version, ~0u, V))
+        return fail("expected 'version <n>'");
+      if (V != VERSION)
+        return fail("unsupported version " + Version);
+      SeenVersion = true;
+    } else if (Keyword == "param") {
+      std::string Name, Value;
+      unsigned V = 0;
+      if (!(LS >> Name >> Value) ||
+          !parseUInt(Value, std::numeric_limits<uint16_t>::max(), V))
+        return fail("expected 'param <name> <cycles>'");
+      auto It = std::find(std::begin(ParamNames), std::end(ParamNames), Name);
+      if (It == std::end(ParamNames))
+        return fail("unknown parameter " + Name);
+      Params[std::distance(std::begin(ParamNames), It)] =
+          static_cast<uint16_t>(V);
+    } else if (Keyword == "rule") {
+      LatencyRule Rule;
+      std::string Field;
+      while (LS >> Field) {
+        auto Eq = Field.find('=');
+        if (Eq == std::string::npos ||
+            !parseRuleField(Rule, Field.substr(0, Eq), Field.substr(Eq + 1)))
+          return fail("bad rule field " + Field);
+      }
+      if (Rule.Latency < 0 && Rule.Occupancy < 0)
+        return fail("rule sets neither latency nor occupancy");
+      Rules.push_back(Rule);
+    } else {
+      return fail("unknown keyword " + Keyword);
+    }
+  }
+  if (!SeenVersion)
+    return fail("missing version");
+
+  m_params = Params;
+  m_rules = std::move(Rules);
+  return true;
+}
+
+const LatencyRule *LatencyTable::findRule(const G4_INST *Inst,
+                                          bool latency) const {
+  if (m_rules.empty())
+    return nullptr;
+  auto Class = classify(Inst);
+  for (const LatencyRule &Rule : m_rules) {
+    if ((latency ? Rule.Latency : Rule.Occupancy) < 0)
+      continue;
+    if (Rule.Class != LatencyRule::InstClass::Any && Rule.Class != Class)
+      continue;
+    if (Rule.ExecSize && Rule.ExecSize != Inst->getExecSize())
+      continue;
+    if (Rule.Type != Type_UNDEF &&
+        (!Inst->getDst() || Inst->getDst()->getType() != Rule.Type))
+      continue;
+    if (Rule.SFID >= 0 &&
+        (!Inst->isSend() ||
+         static_cast<int>(Inst->getMsgDesc()->getSFID()) != Rule.SFID))
+      continue;
+    if (Rule.RepeatCount &&
+        (!Inst->isDpas() ||
+         Inst->asDpasInst()->getRepeatCount() != Rule.RepeatCount))
+      continue;
+    return &Rule;
+  }
+  return nullptr;
 }
 
-uint16_t LatencyTableLegacy::getLatency(const G4_INST *Inst) const {
+uint16_t LatencyTable::getLatency(const G4_INST *Inst) const {
+  if (const LatencyRule *Rule = findRule(Inst, true))
+    return static_cast<uint16_t>(Rule->Latency);
+  return computeLatency(Inst);
+}
+
+uint16_t LatencyTable::getOccupancy(const G4_INST *Inst) const {
+  if (const LatencyRule *Rule = findRule(Inst, false))
+    return static_cast<uint16_t>(Rule->Occupancy);
+  return computeOccupancy(Inst);
+}
+
+uint16_t LatencyTable::getDPASLatency(uint8_t repeatCount) const {
+  // Only dpas rules that do not depend on the instruction apply here.
+  for (const LatencyRule &Rule : m_rules) {
+    if (Rule.Class == LatencyRule::InstClass::DPAS && Rule.Latency >= 0 &&
+        !Rule.ExecSize && Rule.Type == Type_UNDEF && Rule.SFID < 0 &&
+        (!Rule.RepeatCount || Rule.RepeatCount == repeatCount))
+      return static_cast<uint16_t>(Rule.Latency);
+  }
+  return computeDPASLatency(repeatCount);
+}
+
+uint16_t LatencyTableLegacy::computeLatency(const G4_INST *Inst) const {
   if (Inst->isSend()) {
     G4_SendDesc *MsgDesc = Inst->getMsgDesc();
     int SFIDint = SFIDtoInt(MsgDesc->getSFID());
@@ -86,7 +358,7 @@ uint16_t LatencyTableLegacy::getLatency(const G4_INST *Inst) const {
 }
 
 // This calculates the node's pipeline occupancy (node delay)
-uint16_t LatencyTableLegacy::getOccupancy(const G4_INST *Inst) const {
+uint16_t LatencyTableLegacy::computeOccupancy(const G4_INST *Inst) const {
   int divisor = 8;
   int InstLatency = LegacyLatencies::UNCOMPR_LATENCY;
   if (Inst->isFastHFInstruction()) {
@@ -151,7 +423,7 @@ uint16_t LatencyTableLegacy::getOccupancy(const G4_INST *Inst) const {
   return uint16_t(passes * InstLatency);
 }
 
-uint16_t LatencyTableLegacy::getDPASLatency(uint8_t repeatCount) const {
+uint16_t LatencyTableLegacy::computeDPASLatency(uint8_t repeatCount) const {
   vISA_ASSERT_UNREACHABLE("DPAS is not supported");
   return LegacyLatencies::UNKNOWN_LATENCY;
 }
@@ -162,7 +434,7 @@ uint16_t LatencyTableLegacy::getSendSrcReadLatency(const G4_INST *inst) const {
 
 // General template implementations for XE+.
 template<PlatformGen Gen>
-uint16_t LatencyTableXe<Gen>::getLatency(const G4_INST *Inst) const {
+uint16_t LatencyTableXe<Gen>::computeLatency(const G4_INST *Inst) const {
   if (Inst->isSend())
     return getMsgLatency(Inst);
   if (Inst->isMath())
@@ -180,7 +452,7 @@ uint16_t LatencyTableXe<Gen>::getLatency(const G4_INST *Inst) const {
     return getArithmeticLatency(Inst);
 
   // By default, use the FPU pipeline latency.
-  return value_of(LI::FPU);
+  return getParam(LatencyParam::FPU);
 }
 
 // ARB cycle + GRF read lengths
@@ -196,7 +468,7 @@ uint16_t LatencyTableXe<Gen>::getSendSrcReadLatency(const G4_INST *Inst) const {
     src1RegSize = msgDesc->getSrc1LenRegs();
   }
 
-  return value_of(LI::SEND_ARB) + src0RegSize + src1RegSize;
+  return getParam(LatencyParam::SEND_ARB) + src0RegSize + src1RegSize;
 }
 
 template<PlatformGen Gen>
@@ -207,67 +479,67 @@ uint16_t LatencyTableXe<Gen>::getMsgLatency(const G4_INST *Inst) const {
     if (MsgDesc->getSFID() == SFID::SLM) {
       auto Sz = Inst->getExecSize();
       return MsgDesc->isFence()
-                 ? value_of(LI::SLM_FENCE)
-                 : ((Sz > g4::SIMD16) ? value_of(LI::SLM32)
-                                      : value_of(LI::SLM16));
+                 ? getParam(LatencyParam::SLM_FENCE)
+                 : ((Sz > g4::SIMD16) ? getParam(LatencyParam::SLM32)
+                                      : getParam(LatencyParam::SLM16));
     } else if (MsgDesc->isFence()) {
-      return MsgDesc->isTyped() ? value_of(LI::LSC_TYPED_FENCE)
-                                : value_of(LI::LSC_UNTYPED_FENCE);
+      return MsgDesc->isTyped() ? getParam(LatencyParam::LSC_TYPED_FENCE)
+                                : getParam(LatencyParam::LSC_UNTYPED_FENCE);
     } else {
       bool isCachedInL1 = MsgDesc->getCachingL1() == Caching::CA ||
                           (MsgDesc->getCachingL1() != Caching::UC &&
                            m_builder.getOption(vISA_assumeL1Hit));
       if (MsgDesc->isTyped()) {
-        return isCachedInL1 ? value_of(LI::LSC_TYPED_L1)
-                            : value_of(LI::LSC_TYPED_L3);
+        return isCachedInL1 ? getParam(LatencyParam::LSC_TYPED_L1)
+                            : getParam(LatencyParam::LSC_TYPED_L3);
       } else {
-        return isCachedInL1 ? value_of(LI::LSC_UNTYPED_L1)
-                            : value_of(LI::LSC_UNTYPED_L3);
+        return isCachedInL1 ? getParam(LatencyParam::LSC_UNTYPED_L1)
+                            : getParam(LatencyParam::LSC_UNTYPED_L3);
       }
     }
   }
   if (MsgDesc->isSLM())
-    return Inst->asSendInst()->isFence() ? value_of(LI::SLM_FENCE)
-                                         : value_of(LI::SLM16);
+    return Inst->asSendInst()->isFence() ? getParam(LatencyParam::SLM_FENCE)
+                                         : getParam(LatencyParam::SLM16);
   if (MsgDesc->isSampler())
-    return value_of(LI::SAMPLER_L3);
+    return getParam(LatencyParam::SAMPLER_L3);
   if (MsgDesc->isHDC())
-    return value_of(LI::DP_L3);
+    return getParam(LatencyParam::DP_L3);
   if (MsgDesc->isBarrier())
-    return value_of(LI::BARRIER);
-  return value_of(LI::SEND_OTHERS);
+    return getParam(LatencyParam::BARRIER);
+  return getParam(LatencyParam::SEND_OTHERS);
 }
 
 template<PlatformGen Gen>
 uint16_t LatencyTableXe<Gen>::getMathLatency(const G4_INST *Inst) const {
   vASSERT(Inst->isMath());
-  return value_of(LI::MATH);
+  return getParam(LatencyParam::MATH);
 }
 
 template<PlatformGen Gen>
 uint16_t LatencyTableXe<Gen>::getBranchLatency(const G4_INST *Inst) const {
   vASSERT(Inst->isFlowControl());
-  return value_of(LI::BRANCH);
+  return getParam(LatencyParam::BRANCH);
 }
 
 template<PlatformGen Gen>
 uint16_t LatencyTableXe<Gen>::getIntrinsicLatency(const G4_INST *Inst) const {
   vASSERT(Inst->isIntrinsic());
   if (Inst->isPseudoAddrMovIntrinsic())
-    return value_of(LI::ADDR_MOV);
-  return value_of(LI::FPU);
+    return getParam(LatencyParam::ADDR_MOV);
+  return getParam(LatencyParam::FPU);
 }
 
 template<PlatformGen Gen>
 uint16_t LatencyTableXe<Gen>::getDPASLatency(const G4_InstDpas *dpas) const {
-  return getDPASLatency(dpas->getRepeatCount());
+  return computeDPASLatency(dpas->getRepeatCount());
 }
 
 template<PlatformGen Gen>
 uint16_t LatencyTableXe<Gen>::getARFAccessLatency(const G4_INST *Inst) const {
   vASSERT(Inst->writesFlag() ||
           (Inst->getDst() && Inst->getDst()->isDirectA0()));
-  return value_of(LI::ARF);
+  return getParam(LatencyParam::ARF);
 }
 
 template<PlatformGen Gen>
@@ -275,77 +547,71 @@ uint16_t LatencyTableXe<Gen>::getArithmeticLatency(const G4_INST *Inst) const {
   vASSERT(Inst->isArithmetic());
   auto Dst = Inst->getDst();
   if (Dst && Dst->isAccReg())
-    return value_of(LI::FPU_ACC);
-  return value_of(LI::FPU);
+    return getParam(LatencyParam::FPU_ACC);
+  return getParam(LatencyParam::FPU);
 }
 
 template <PlatformGen Gen>
-uint16_t LatencyTableXe<Gen>::getOccupancy(const G4_INST *Inst) const {
+uint16_t LatencyTableXe<Gen>::computeOccupancy(const G4_INST *Inst) const {
   auto Sz = Inst->getExecSize();
   auto NativeSz = m_builder.getNativeExecSize();
   uint16_t Scale = (Sz <= NativeSz) ? 1 : (Sz == NativeSz * 2) ? 2 : 4;
   if (Inst->isMath())
-    return value_of(LI::OC_MATH) * Scale;
+    return getParam(LatencyParam::OC_MATH) * Scale;
   if (Inst->isFastHFInstruction())
     Scale = (Sz <= NativeSz * 2) ? 1 : 2;
   else if (G4_DstRegRegion *Dst = Inst->getDst()) {
     if (Dst->getTypeSize() == 8)
       Scale = (Sz <= NativeSz / 2) ? 1 : 2;
   }
-  return value_of(LI::OC_OTHERS) * Scale;
+  return getParam(LatencyParam::OC_OTHERS) * Scale;
 }
 
 // XE Specializations.
 template <>
 uint16_t
-LatencyTableXe<PlatformGen::XE>::getDPASLatency(uint8_t repeatCount) const {
+LatencyTableXe<PlatformGen::XE>::computeDPASLatency(uint8_t repeatCount) const {
   switch (m_builder.getPlatform()) {
   case Xe_XeHPSDV:
-    return value_of(LI::DPAS) + repeatCount - 1;
+    return getParam(LatencyParam::DPAS) + repeatCount - 1;
   case Xe_DG2:
     switch (repeatCount) {
     case 1:
-      return 21;
+      return getParam(LatencyParam::DPAS_DG2_RC1);
     case 2:
-      return 22;
-    case 8:
-      return 32;
+      return getParam(LatencyParam::DPAS_DG2_RC2);
     default:
-      return 32;
+      return getParam(LatencyParam::DPAS_DG2_RC8);
     }
   case Xe_ARL:
     switch (repeatCount) {
     case 1:
-      return 21;
+      return getParam(LatencyParam::DPAS_ARL_RC1);
     case 2:
-      return 22;
-    case 8: {
-      if (m_builder.has4DeepSystolic()) {
-        return 32;
-      }
-      return 46;
-    }
+      return getParam(LatencyParam::DPAS_ARL_RC2);
+    case 8:
+      return m_builder.has4DeepSystolic()
+                 ? getParam(LatencyParam::DPAS_ARL_RC8_4DEEP)
+                 : getParam(LatencyParam::DPAS_ARL_RC8);
     default:
-      return 22; // Conservative cycle
+      return getParam(LatencyParam::DPAS_ARL_OTHERS);
     }
   case Xe_PVC:
-    return value_of(LI::DPAS) + repeatCount - 1;
+    return getParam(LatencyParam::DPAS) + repeatCount - 1;
   case Xe_PVCXT:
-    return value_of(LI::DPAS) + repeatCount;
+    return getParam(LatencyParam::DPAS) + repeatCount;
   case Xe2:
     switch (repeatCount) {
     case 1:
-      return 22;
+      return getParam(LatencyParam::DPAS_XE2_RC1);
     case 2:
-      return 23;
-    case 8:
-      return 33;
+      return getParam(LatencyParam::DPAS_XE2_RC2);
     default:
-      return 33;
+      return getParam(LatencyParam::DPAS_XE2_RC8);
     }
   default: // Not supported platform
     // TODO: Add vISA_ASSERT_UNREACHABLE.
-    return 46;
+    return getParam(LatencyParam::DPAS_UNKNOWN);
   }
 }
 template<>
@@ -354,14 +620,14 @@ LatencyTableXe<PlatformGen::XE>::getMathLatency(const G4_INST *Inst) const {
   vASSERT(Inst->isMath());
   int Sz = Inst->getExecSize();
   int Scale = Scale = (Sz <= 8) ? 0 : (Sz == 16) ? 1 : 3;
-  return value_of(LI::MATH) + value_of(LI::DELTA_MATH) * Scale;
+  return getParam(LatencyParam::MATH) + getParam(LatencyParam::DELTA_MATH) * Scale;
 }
 
 template <>
 uint16_t
 LatencyTableXe<PlatformGen::XE>::getDPASLatency(const G4_InstDpas *dpas) const {
 
-  return getDPASLatency(dpas->getRepeatCount());
+  return computeDPASLatency(dpas->getRepeatCount());
 }
 
 template<>
@@ -370,27 +636,27 @@ uint16_t LatencyTableXe<PlatformGen::XE>::getArithmeticLatency(
   vASSERT(Inst->isArithmetic());
   int Sz = Inst->getExecSize();
   int Scale = Scale = (Sz <= 8) ? 0 : (Sz == 16) ? 1 : 3;
-  auto Delta = value_of(LI::DELTA) * Scale;
+  auto Delta = getParam(LatencyParam::DELTA) * Scale;
   auto Dst = Inst->getDst();
   if (Dst && Dst->isAccReg())
-    return value_of(LI::FPU_ACC) + Delta;
-  return value_of(LI::FPU) + Delta;
+    return getParam(LatencyParam::FPU_ACC) + Delta;
+  return getParam(LatencyParam::FPU) + Delta;
 }
 
 // TODO: Update PVC+ to consider native exec size as well so that the
 // specialization can be removed.
 template <>
 uint16_t
-LatencyTableXe<PlatformGen::XE>::getOccupancy(const G4_INST *Inst) const {
+LatencyTableXe<PlatformGen::XE>::computeOccupancy(const G4_INST *Inst) const {
   int Sz = Inst->getExecSize();
   int Scale = (Sz <= 8) ? 1 : (Sz == 16) ? 2 : 4;
   if (Inst->isMath())
-    return value_of(LI::OC_MATH) * Scale;
+    return getParam(LatencyParam::OC_MATH) * Scale;
   if (Inst->isFastHFInstruction())
     Scale = (Sz <= 16) ? 1 : 2;
   else if (G4_DstRegRegion *Dst = Inst->getDst()) {
     if (Dst->getTypeSize() == 8)
       Scale = (Sz <= 4) ? 1 : 2;
   }
-  return value_of(LI::OC_OTHERS) * Scale;
+  return getParam(LatencyParam::OC_OTHERS) * Scale;
 }
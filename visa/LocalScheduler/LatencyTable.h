@@ -10,8 +10,12 @@ SPDX-License-Identifier: MIT
 #define __LATENCY_TABLE_H
 
 #include "../BuildIR.h"
+#include <array>
+#include <iosfwd>
 #include <limits>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace vISA {
 
@@ -51,55 +55,64 @@ static const uint16_t LegacyFFLatency[] = {
     200  // 14: unknown, SFID_NUM
 };
 
-enum class XELatencyInfo : uint16_t {
-  //
-  // General instruction latencies
-  //
-  FPU_ACC = 6,  // SIMD8 latency if dst is acc.
-  FPU = 10,     // SIMD8 latency for general FPU ops.
-  MATH = 17,    // Math latency.
-  BRANCH = 23,  // Latency for SIMD16 branch.
-  BARRIER = 30, // Latency for barrier.
-  DELTA = 1,    // Extra cycles for wider SIMD sizes, compute only.
-  DELTA_MATH = 4,
-  ARF = 16, // latency for ARF dependencies (flag, address, etc.)
-            // Latency for dpas 8x1
-            // Latency for dpas 8x8 is 21 + 7 = 28
-  DPAS = 21,
-
-  //
-  // Message latencies
-  //
-
-  // Latency for SIMD16 SLM messages. If accessing
-  // the same location, it takes 28 cycles. For the
-  // sequential access pattern, it takes 26 cycles.
-  SLM16 = 28,
-  SLM32 = 45,
-  SEND_OTHERS = 50,       // Latency for other messages.
-  DP_L3 = 146,            // Dataport L3 hit
-  SAMPLER_L3 = 214,       // Sampler L3 hit
-  SLM_FENCE = 23,         // Fence SLM
-  LSC_UNTYPED_L1 = 45,    // LSC untyped L1 cache hit
-  LSC_UNTYPED_L3 = 200,   // LSC untyped L3 cache hit
-  LSC_UNTYPED_FENCE = 35, // LSC untyped fence (best case)
-  LSC_TYPED_L1 = 75,      // LSC typed L1 cache hit
-  LSC_TYPED_L3 = 200,     // LSC typed L3 cache hit
-  LSC_TYPED_FENCE = 60,   // LSC typed fence
-  ADDR_MOV = 2,
-  SEND_ARB = 8,          //The cycles for arbitration acquire and release of send
-  UNKNOWN = std::numeric_limits<uint16_t>::max(),
+// Named latency parameters of Xe+ platforms, see LatencyTableDefs.h.
+enum class LatencyParam : unsigned {
+#define DEF_LATENCY_PARAM(NAME, CYCLES) NAME,
+#include "LatencyTableDefs.h"
+#undef DEF_LATENCY_PARAM
+  NUM_PARAMS
+};
 
-  //
-  // Occupancy latencies
-  //
-  OC_MATH = 4,
-  OC_OTHERS = 1,
+// A rule of a latency table file: the latency and/or occupancy of the
+// instructions that match all of the given fields.
+struct LatencyRule {
+  // Instruction classes, in the order the heuristics tell them apart.
+  enum class InstClass : uint8_t {
+    Any,
+    Send,
+    Math,
+    Branch,
+    Intrinsic,
+    DPAS,
+    ARF,
+    ALU,
+    Other,
+  };
+
+  InstClass Class = InstClass::Any;
+  uint8_t ExecSize = 0;      // 0 matches any.
+  uint8_t RepeatCount = 0;   // dpas only, 0 matches any.
+  G4_Type Type = Type_UNDEF; // dst type, Type_UNDEF matches any.
+  int SFID = -1;             // send only, -1 matches any.
+  int Latency = -1;          // -1 if the rule does not set it.
+  int Occupancy = -1;
 };
 
+// Latency and occupancy model used by the pre-RA and post-RA schedulers and
+// by SWSB.
+//
+// The platform heuristics of the subclasses are built from the parameters
+// in LatencyTableDefs.h. A table file given with -latencyTable may override
+// parameters and add rules which take precedence over the heuristics:
+//
+//   # comment
+//   version 1
+//   param LSC_UNTYPED_L3 180
+//   rule class=send sfid=ugm latency=180
+//   rule class=alu exec=16 type=df latency=14 occupancy=4
+//   rule class=dpas repeat=8 latency=32
+//
+// Rule fields are class (send, math, branch, intrinsic, dpas, arf, alu,
+// other), exec, type (dst type as in the asm, e.g. f, hf, df), sfid (as in
+// the asm, e.g. ugm, slm, tgm, smpl), repeat (dpas repeat count), latency
+// and occupancy. The first matching rule that sets a value is used. A file is
+// read once per process; a file that fails to load is reported once and the
+// built-in values are used.
 class LatencyTable {
 public:
-  explicit LatencyTable(const IR_Builder &builder) : m_builder(builder) {}
+  static constexpr unsigned VERSION = 1;
+
+  explicit LatencyTable(const IR_Builder &builder);
 
   virtual ~LatencyTable() = default;
 
@@ -107,14 +120,34 @@ public:
       const IR_Builder &builder);
 
   // Functions to get latencies/occupancy based on platforms
-  virtual uint16_t getLatency(const G4_INST *Inst) const = 0;
-  virtual uint16_t getOccupancy(const G4_INST *Inst) const = 0;
-  // Implement different platform overrides for DPAS
-  virtual uint16_t getDPASLatency(uint8_t repeatCount) const = 0;
+  uint16_t getLatency(const G4_INST *Inst) const;
+  uint16_t getOccupancy(const G4_INST *Inst) const;
+  uint16_t getDPASLatency(uint8_t repeatCount) const;
   virtual uint16_t getSendSrcReadLatency(const G4_INST *Inst) const = 0;
 
+  uint16_t getParam(LatencyParam P) const {
+    return m_params[static_cast<unsigned>(P)];
+  }
+
+  // Reads a table file on top of the current values. On error the table is
+  // left unchanged and false is returned with the reason in err.
+  bool load(std::istream &is, std::string &err);
+
 protected:
+  // Platform heuristics used when no rule matches.
+  virtual uint16_t computeLatency(const G4_INST *Inst) const = 0;
+  virtual uint16_t computeOccupancy(const G4_INST *Inst) const = 0;
+  // Implement different platform overrides for DPAS
+  virtual uint16_t computeDPASLatency(uint8_t repeatCount) const = 0;
+
   const IR_Builder &m_builder;
+
+private:
+  const LatencyRule *findRule(const G4_INST *Inst, bool latency) const;
+
+  std::array<uint16_t, static_cast<unsigned>(LatencyParam::NUM_PARAMS)>
+      m_params;
+  std::vector<LatencyRule> m_rules;
 };
 
 } // namespace vISA
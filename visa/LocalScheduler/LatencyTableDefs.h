@@ -0,0 +1,91 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+// DEF_LATENCY_PARAM(NAME, CYCLES)
+//
+// The built-in latency parameters of Xe+ platforms. The heuristics of the
+// latency table and the SWSB token reuse distances are expressed in terms of
+// these; a latency table file (-latencyTable) may override any of them by
+// name with "param NAME CYCLES".
+
+//
+// General instruction latencies
+//
+DEF_LATENCY_PARAM(FPU_ACC, 6)  // SIMD8 latency if dst is acc.
+DEF_LATENCY_PARAM(FPU, 10)     // SIMD8 latency for general FPU ops.
+DEF_LATENCY_PARAM(MATH, 17)    // Math latency.
+DEF_LATENCY_PARAM(BRANCH, 23)  // Latency for SIMD16 branch.
+DEF_LATENCY_PARAM(BARRIER, 30) // Latency for barrier.
+DEF_LATENCY_PARAM(DELTA, 1)    // Extra cycles for wider SIMD sizes, compute
+                               // only.
+DEF_LATENCY_PARAM(DELTA_MATH, 4)
+DEF_LATENCY_PARAM(ARF, 16) // latency for ARF dependencies (flag, address,
+                           // etc.)
+// Latency for dpas 8x1
+// Latency for dpas 8x8 is 21 + 7 = 28
+DEF_LATENCY_PARAM(DPAS, 21)
+// dpas latencies by repeat count of platforms not following the above. The
+// RC8 value is also used for repeat counts not listed.
+DEF_LATENCY_PARAM(DPAS_DG2_RC1, 21)
+DEF_LATENCY_PARAM(DPAS_DG2_RC2, 22)
+DEF_LATENCY_PARAM(DPAS_DG2_RC8, 32)
+DEF_LATENCY_PARAM(DPAS_ARL_RC1, 21)
+DEF_LATENCY_PARAM(DPAS_ARL_RC2, 22)
+DEF_LATENCY_PARAM(DPAS_ARL_RC8, 46)
+DEF_LATENCY_PARAM(DPAS_ARL_RC8_4DEEP, 32) // with 4 deep systolic
+DEF_LATENCY_PARAM(DPAS_ARL_OTHERS, 22)    // conservative
+DEF_LATENCY_PARAM(DPAS_XE2_RC1, 22)
+DEF_LATENCY_PARAM(DPAS_XE2_RC2, 23)
+DEF_LATENCY_PARAM(DPAS_XE2_RC8, 33)
+DEF_LATENCY_PARAM(DPAS_UNKNOWN, 46) // platforms without a dpas model
+
+//
+// Message latencies
+//
+
+// Latency for SIMD16 SLM messages. If accessing
+// the same location, it takes 28 cycles. For the
+// sequential access pattern, it takes 26 cycles.
+DEF_LATENCY_PARAM(SLM16, 28)
+DEF_LATENCY_PARAM(SLM32, 45)
+DEF_LATENCY_PARAM(SEND_OTHERS, 50)       // Latency for other messages.
+DEF_LATENCY_PARAM(DP_L3, 146)            // Dataport L3 hit
+DEF_LATENCY_PARAM(SAMPLER_L3, 214)       // Sampler L3 hit
+DEF_LATENCY_PARAM(SLM_FENCE, 23)         // Fence SLM
+DEF_LATENCY_PARAM(LSC_UNTYPED_L1, 45)    // LSC untyped L1 cache hit
+DEF_LATENCY_PARAM(LSC_UNTYPED_L3, 200)   // LSC untyped L3 cache hit
+DEF_LATENCY_PARAM(LSC_UNTYPED_FENCE, 35) // LSC untyped fence (best case)
+DEF_LATENCY_PARAM(LSC_TYPED_L1, 75)      // LSC typed L1 cache hit
+DEF_LATENCY_PARAM(LSC_TYPED_L3, 200)     // LSC typed L3 cache hit
+DEF_LATENCY_PARAM(LSC_TYPED_FENCE, 60)   // LSC typed fence
+DEF_LATENCY_PARAM(ADDR_MOV, 2)
+DEF_LATENCY_PARAM(SEND_ARB, 8) // The cycles for arbitration acquire and
+                               // release of send
+
+//
+// Occupancy latencies
+//
+DEF_LATENCY_PARAM(OC_MATH, 4)
+DEF_LATENCY_PARAM(OC_OTHERS, 1)
+
+//
+// SWSB: cycles after which the token of an out-of-order instruction is
+// assumed to be free again. The _XELP variants apply to Xe_LP; the L3 ones
+// apply with -SBIDL3Hit.
+//
+DEF_LATENCY_PARAM(SWSB_MATH, 17)
+DEF_LATENCY_PARAM(SWSB_MATH_XELP, 20)
+DEF_LATENCY_PARAM(SWSB_SEND_SLM, 25)
+DEF_LATENCY_PARAM(SWSB_SEND_SLM_XELP, 33)
+DEF_LATENCY_PARAM(SWSB_SEND_L1_MEMORY, 50)
+DEF_LATENCY_PARAM(SWSB_SEND_L1_MEMORY_XELP, 65)
+DEF_LATENCY_PARAM(SWSB_SEND_L3_MEMORY, 150)
+DEF_LATENCY_PARAM(SWSB_SEND_L3_MEMORY_XELP, 106)
+DEF_LATENCY_PARAM(SWSB_SEND_L1_SAMPLER, 60)
+DEF_LATENCY_PARAM(SWSB_SEND_L3_SAMPLER, 210)
+DEF_LATENCY_PARAM(SWSB_SEND_L3_SAMPLER_XELP, 175)
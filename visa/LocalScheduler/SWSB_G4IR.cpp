@@ -1585,12 +1585,21 @@ void SWSB::SWSBGlobalTokenGenerator(PointsToAnalysis &p, LiveGRFBuckets &LB,
   // count delay of backedge only for the nature loops, i.e with the backedge, if
   // the instruction distance is far enough, there is no need to set dependence.
   // The loop info are get from the orignal flow graph, and kept in the SWSB BB.
+  // The block weights are only used to estimate token stall costs.
+  const bool needBBWeights =
+      fg.builder->getOptions()->getOption(vISA_SWSBStallCostTokenReuse) ||
+      fg.builder->getOptions()->getOption(vISA_DumpPerfStats) ||
+      fg.builder->getOptions()->getOption(vISA_DumpPerfStatsVerbose);
+  if (needBBWeights)
+    BBWeights.resize(BBVector.size());
   for (G4_BB_SB *bb : BBVector) {
     Loop *loop = kernel.fg.getLoops().getInnerMostLoop(bb->getBB());
     if (loop) {
       bb->setLoopStartBBID(loop->getHeader()->getId());
       bb->setLoopEndBBID(loop->backEdgeSrc()->getId());
     }
+    if (needBBWeights)
+      BBWeights[bb->getBB()->getId()] = kernel.fg.getBlockWeight(bb->getBB());
   }
 
   // Global analysis until no live in change
@@ -1629,6 +1638,11 @@ void SWSB::SWSBGlobalTokenGenerator(PointsToAnalysis &p, LiveGRFBuckets &LB,
     tokenAllocation();
   }
 
+  if (fg.builder->getOptions()->getOption(vISA_DumpPerfStats) ||
+      fg.builder->getOptions()->getOption(vISA_DumpPerfStatsVerbose)) {
+    estimateTokenStallCycles();
+  }
+
   // Insert sync instruction in case the dependences are more than token field
   // in the instruction.
   insertTokenSync();
@@ -2104,15 +2118,9 @@ SBNode *SWSB::reuseTokenSelection(const SBNode *node) const {
     // should be fast. As for searching forward, only do that if there's
     // indeed a such node.
     const unsigned short token = curNode->getLastInstruction()->getSBIDSetToken();
-    const unsigned lastBefore =
-        allTokenNodesMap[token].bitset.findLastIn(0, node->getSendID());
-    unsigned firstAfter = INVALID_ID;
-    if (node->getSendID() < allTokenNodesMap[token].maxSendID) {
-      firstAfter = allTokenNodesMap[token].bitset.findFirstIn(
-          node->getSendID() + 1, allTokenNodesMap[token].maxSendID + 1);
-    }
+    const auto [lastBefore, firstAfter] =
+        getClosestTokenUsers(token, node->getSendID());
     if (lastBefore != INVALID_ID) {
-      vASSERT(allTokenNodesMap[token].bitset.isSet(lastBefore));
       const SBNode *n = SBSendNodes[lastBefore];
       auto res = examineNodeForTokenReuse(nodeID, nodeDelay, n, nestLoopLevel,
                                           loopStartBB, loopEndBB);
@@ -2122,7 +2130,6 @@ SBNode *SWSB::reuseTokenSelection(const SBNode *node) const {
       minTokenDistance = std::min(minTokenDistance, res.second);
     }
     if (firstAfter != INVALID_ID) {
-      vASSERT(allTokenNodesMap[token].bitset.isSet(firstAfter));
       const SBNode *n = SBSendNodes[firstAfter];
       auto res = examineNodeForTokenReuse(nodeID, nodeDelay, n, nestLoopLevel,
                                           loopStartBB, loopEndBB);
@@ -2150,6 +2157,211 @@ SBNode *SWSB::reuseTokenSelection(const SBNode *node) const {
   return candidateNode;
 }
 
+// The send IDs of the closest nodes before and after sendID that were
+// assigned token, INVALID_ID if there is none.
+std::pair<unsigned, unsigned>
+SWSB::getClosestTokenUsers(unsigned short token, unsigned sendID) const {
+  const TokenAllocation &tokenNodes = allTokenNodesMap[token];
+  const unsigned lastBefore = tokenNodes.bitset.findLastIn(0, sendID);
+  unsigned firstAfter = INVALID_ID;
+  if ((int)sendID < tokenNodes.maxSendID) {
+    firstAfter =
+        tokenNodes.bitset.findFirstIn(sendID + 1, tokenNodes.maxSendID + 1);
+  }
+  vASSERT(lastBefore == INVALID_ID || tokenNodes.bitset.isSet(lastBefore));
+  vASSERT(firstAfter == INVALID_ID || tokenNodes.bitset.isSet(firstAfter));
+  return {lastBefore, firstAfter};
+}
+
+// Cycles until the token of the node is released: the source read for a send
+// without destination, the whole latency otherwise.
+unsigned SWSB::getTokenLatency(const SBNode *node) const {
+  const G4_INST *inst = node->getLastInstruction();
+  if (inst->isSend() && (!inst->getDst() || inst->getDst()->isNullReg())) {
+    return LT->getSendSrcReadLatency(inst);
+  }
+  return LT->getLatency(inst);
+}
+
+// Estimated stall if earlier and later, two nodes without dependence between
+// them, are assigned the same token: later cannot be issued before the token
+// of earlier is released. The instruction distance is used as the issue
+// cycles in between. If both nodes are in a loop, earlier of the next
+// iteration in turn waits for later around the back edge. Each stall is
+// weighted by the expected execution count of the stalling block (see
+// FlowGraph::getBlockWeight), which is a block frequency when every block has
+// one and a loop nesting weight otherwise.
+float SWSB::getTokenStallCost(const SBNode *earlier,
+                              const SBNode *later) const {
+  vASSERT(earlier->getNodeID() < later->getNodeID());
+  const unsigned distance = later->getNodeID() - earlier->getNodeID();
+  const unsigned earlierLatency = getTokenLatency(earlier);
+  float cost = 0.0f;
+  if (distance < earlierLatency) {
+    cost += (earlierLatency - distance) * BBWeights[later->getBBID()];
+  }
+
+  const G4_BB_SB *laterBB = BBVector[later->getBBID()];
+  const unsigned loopStartBB = laterBB->getLoopStartBBID();
+  const unsigned loopEndBB = laterBB->getLoopEndBBID();
+  if (loopStartBB == INVALID_ID || loopEndBB == INVALID_ID ||
+      BBVector[loopStartBB]->first_node == INVALID_ID ||
+      BBVector[loopEndBB]->last_node == INVALID_ID) {
+    return cost;
+  }
+  const unsigned loopStartID = BBVector[loopStartBB]->first_node;
+  const unsigned loopEndID = BBVector[loopEndBB]->last_node;
+  if (earlier->getNodeID() >= loopStartID && later->getNodeID() <= loopEndID) {
+    const unsigned backEdgeDistance = loopEndID - loopStartID + 1 - distance;
+    const unsigned laterLatency = getTokenLatency(later);
+    if (backEdgeDistance < laterLatency) {
+      cost += (laterLatency - backEdgeDistance) * BBWeights[earlier->getBBID()];
+    }
+  }
+  return cost;
+}
+
+// Number of sync instructions an instruction needs before it to wait for
+// numTokens different tokens of one kind (.dst or .src). An instruction
+// without SBID can carry one token wait itself, a send or math none. The
+// remaining ones take one sync.nop, or one sync.allwr/sync.allrd with a token
+// mask when there are several (see insertSyncToken).
+static unsigned getTokenSyncCount(unsigned numTokens, bool carriesToken) {
+  if (carriesToken && numTokens > 0)
+    numTokens--;
+  return numTokens > 0 ? 1 : 0;
+}
+
+// Tokens of the sends other than excluded that consumer waits for, after
+// write (RAW/WAW) or after read (WAR). Only the tokens assigned so far are
+// known.
+BitSet SWSB::getWaitedTokens(const SBNode *consumer, bool afterWrite,
+                             const SBNode *excluded) const {
+  BitSet tokens(totalTokenNum, false);
+  for (const SBDEP_ITEM &pred : consumer->preds) {
+    const G4_INST *predInst = pred.node->getLastInstruction();
+    if (pred.node != excluded && pred.attr == DEP_EXPLICT &&
+        tokenHonourInstruction(predInst) &&
+        predInst->getSBIDSetToken() != (unsigned short)UNKNOWN_TOKEN &&
+        afterWrite == (pred.type == RAW || pred.type == WAW)) {
+      tokens.set(predInst->getSBIDSetToken(), true);
+    }
+  }
+  return tokens;
+}
+
+static unsigned countTokens(const BitSet &tokens) {
+  unsigned num = 0;
+  for (int token = tokens.findFirstIn(0, tokens.getSize()); token != INVALID_ID;
+       token = tokens.findFirstIn(token + 1, tokens.getSize())) {
+    num++;
+  }
+  return num;
+}
+
+// Weighted syncs that node's consumers gain if node is assigned token. A
+// consumer waiting for node and for other sends holding different tokens
+// needs a sync.nop, or a sync.allwr/sync.allrd, in front of it. Picking a
+// token the consumer already waits for adds no wait. Each sync costs an issue
+// cycle of the consumer's block.
+float SWSB::getTokenSyncCost(const SBNode *node, unsigned short token) const {
+  float cost = 0.0f;
+  for (const SBDEP_ITEM &succ : node->succs) {
+    if (succ.attr != DEP_EXPLICT) {
+      continue;
+    }
+    const SBNode *consumer = succ.node;
+    const BitSet others = getWaitedTokens(
+        consumer, succ.type == RAW || succ.type == WAW, node);
+    if (others.isSet(token)) {
+      continue;
+    }
+    const unsigned numOthers = countTokens(others);
+    const bool carriesToken =
+        !tokenHonourInstruction(consumer->getLastInstruction());
+    cost += (getTokenSyncCount(numOthers + 1, carriesToken) -
+             getTokenSyncCount(numOthers, carriesToken)) *
+            BBWeights[consumer->getBBID()];
+  }
+  return cost;
+}
+
+// Selects the live node whose token is the cheapest to reuse for node: the
+// one whose closest users of the same token cause the least weighted stall
+// with node, counting the syncs node's consumers need with that token.
+SBNode *SWSB::reuseTokenSelectionByStallCost(const SBNode *node) const {
+  vASSERT(linearScanLiveNodes.size() <= totalTokenNum);
+
+  SBNode *candidateNode = linearScanLiveNodes.front();
+  float minCost = std::numeric_limits<float>::max();
+  for (SBNode *curNode : linearScanLiveNodes) {
+    const unsigned short token = curNode->getLastInstruction()->getSBIDSetToken();
+    const auto [lastBefore, firstAfter] =
+        getClosestTokenUsers(token, node->getSendID());
+    float cost = 0.0f;
+    if (lastBefore != INVALID_ID) {
+      cost += getTokenStallCost(SBSendNodes[lastBefore], node);
+    }
+    if (firstAfter != INVALID_ID) {
+      cost += getTokenStallCost(node, SBSendNodes[firstAfter]);
+    }
+    cost += getTokenSyncCost(node, token);
+    if (cost < minCost) {
+      minCost = cost;
+      candidateNode = curNode;
+    }
+  }
+
+  return candidateNode;
+}
+
+// Sums the weighted stalls of consecutive users of each token, skipping the
+// ones that wait for the previous user anyway because they depend on it, and
+// the issue cycles of the syncs that instructions waiting for several tokens
+// need.
+void SWSB::estimateTokenStallCycles() {
+  float stallCycles = 0.0f;
+  for (unsigned token = 0; token < allTokenNodesMap.size(); token++) {
+    const BitSet &tokenNodes = allTokenNodesMap[token].bitset;
+    const SBNode *prev = nullptr;
+    for (int sendID = tokenNodes.findFirstIn(0, tokenNodes.getSize());
+         sendID != INVALID_ID;
+         sendID = tokenNodes.findFirstIn(sendID + 1, tokenNodes.getSize())) {
+      const SBNode *cur = SBSendNodes[sendID];
+      // The token may have been changed after the assignment, e.g. when
+      // shared with a predecessor.
+      if (cur->getLastInstruction()->getSBIDSetToken() != token) {
+        continue;
+      }
+      if (prev) {
+        bool dependent = false;
+        for (const SBDEP_ITEM &pred : cur->preds) {
+          if (pred.node == prev && (pred.type == RAW || pred.type == WAW)) {
+            dependent = true;
+            break;
+          }
+        }
+        if (!dependent) {
+          stallCycles += getTokenStallCost(prev, cur);
+        }
+      }
+      prev = cur;
+    }
+  }
+  for (const SBNode *node : SBNodes) {
+    const bool carriesToken =
+        !tokenHonourInstruction(node->getLastInstruction());
+    for (bool afterWrite : {true, false}) {
+      stallCycles +=
+          getTokenSyncCount(
+              countTokens(getWaitedTokens(node, afterWrite, nullptr)),
+              carriesToken) *
+          BBWeights[node->getBBID()];
+    }
+  }
+  kernel.fg.builder->getJitInfo()->stats.tokenStallCycles = stallCycles;
+}
+
 /*
  * If the cycles of the instruction which occupied
  */
@@ -2524,7 +2736,10 @@ void SWSB::assignToken(SBNode *node, unsigned short assignedToken,
 #endif
     } else {
       // Have no free, use the oldest
-      SBNode *oldNode = reuseTokenSelection(node);
+      SBNode *oldNode =
+          fg.builder->getOptions()->getOption(vISA_SWSBStallCostTokenReuse)
+              ? reuseTokenSelectionByStallCost(node)
+              : reuseTokenSelection(node);
       token = oldNode->getLastInstruction()->getSBIDSetToken();
       tokenDepReduction(oldNode, node);
       freeTokenList[token] = node;
@@ -2744,8 +2959,6 @@ bool SWSB::propogateDist(G4_BB *bb) {
 
   vASSERT(!BBVector[bbID]->send_live_in.isEmpty());
 
-  SBBitSets temp_live_in;
-  temp_live_in = BBVector[bbID]->send_live_in;
   std::vector<unsigned> tokenLiveInDist;
   tokenLiveInDist.resize(globalSendNum);
 
@@ -2754,15 +2967,34 @@ bool SWSB::propogateDist(G4_BB *bb) {
   }
 
   // Get the live out from all predicator BBs
+#ifdef _DEBUG
+  const bool fullScans =
+      fg.builder->getOptions()->getOption(vISA_SWSBFullTokenScans);
+#endif
   for (const G4_BB *predBB : bb->Preds) {
     unsigned predID = predBB->getId();
 
-    for (unsigned i = 0; i < globalSendNum; i++) {
-      if (BBVector[predID]->send_live_out.isDstSet(i) &&
-          BBVector[predID]->tokenLiveOutDist[i] != INVALID_ID &&
+    auto mergeLiveOut = [&](unsigned i) {
+      if (BBVector[predID]->tokenLiveOutDist[i] != INVALID_ID &&
           BBVector[predID]->tokenLiveOutDist[i] < tokenLiveInDist[i]) {
         tokenLiveInDist[i] = BBVector[predID]->tokenLiveOutDist[i];
       }
+    };
+#ifdef _DEBUG
+    if (fullScans) {
+      for (unsigned i = 0; i < globalSendNum; i++) {
+        if (BBVector[predID]->send_live_out.isDstSet(i))
+          mergeLiveOut(i);
+      }
+    } else
+#endif
+    {
+      // Walking the set bits visits the same sends, in the same order, as
+      // scanning all global sends.
+      for (unsigned i : BBVector[predID]->send_live_out.dst) {
+        vASSERT(i < globalSendNum);
+        mergeLiveOut(i);
+      }
     }
   }
 
@@ -2777,13 +3009,26 @@ bool SWSB::propogateDist(G4_BB *bb) {
 
   // Update the live out
   if (changed) {
-    for (unsigned i = 0; i < globalSendNum; i++) {
-      if (BBVector[bbID]->send_live_in.isDstSet(i) &&
-          BBVector[bbID]->send_live_out.isDstSet(i) &&
+    auto updateLiveOut = [&](unsigned i) {
+      if (BBVector[bbID]->send_live_out.isDstSet(i) &&
           !BBVector[bbID]->send_may_kill.isDstSet(i)) {
         BBVector[bbID]->tokenLiveOutDist[i] =
             BBVector[bbID]->tokenLiveInDist[i] + bb->size();
       }
+    };
+#ifdef _DEBUG
+    if (fullScans) {
+      for (unsigned i = 0; i < globalSendNum; i++) {
+        if (BBVector[bbID]->send_live_in.isDstSet(i))
+          updateLiveOut(i);
+      }
+    } else
+#endif
+    {
+      for (unsigned i : BBVector[bbID]->send_live_in.dst) {
+        vASSERT(i < globalSendNum);
+        updateLiveOut(i);
+      }
     }
   }
 
@@ -2953,7 +3198,7 @@ void SWSB::tokenAllocation() {
 
   if (fg.builder->getOptions()->getOption(vISA_SWSBDepReduction)) {
     for (G4_BB_SB *sb_bb : BBVector) {
-      sb_bb->getLiveOutToken(unsigned(SBSendNodes.size()), SBNodes);
+      sb_bb->getLiveOutToken(SBNodes);
     }
 #ifdef DEBUG_VERBOSE_ON
     dumpTokenLiveInfo();
@@ -3223,8 +3468,15 @@ void SWSB::allocateToken(G4_BB *bb) {
          (BBVector[bb->getId()]->first_send_node <=
           BBVector[bb->getId()]->last_send_node));
 
-  SBBitSets send_live;
-  SBBitSets send_use;
+  // The reaching sends of the last node that had any. The bit sets are only
+  // walked over their set bits, so that the cost per node is proportional to
+  // the number of live sends instead of to the number of sends in the kernel.
+  const SBBitSets noSends;
+  const SBBitSets *send_live = &noSends;
+#ifdef _DEBUG
+  const bool fullScans =
+      fg.builder->getOptions()->getOption(vISA_SWSBFullTokenScans);
+#endif
 
   for (int i = BBVector[bb->getId()]->first_send_node;
        i <= BBVector[bb->getId()]->last_send_node; i++) {
@@ -3241,7 +3493,7 @@ void SWSB::allocateToken(G4_BB *bb) {
     }
 
     if (!node->reachingSends.isEmpty()) {
-      send_live = node->reachingSends; // The tokens will reach current node
+      send_live = &node->reachingSends; // The tokens will reach current node
     }
 
     for (unsigned k = 0; k < totalTokenNum; k++) {
@@ -3249,35 +3501,62 @@ void SWSB::allocateToken(G4_BB *bb) {
       reachUseArray[k].clear();
     }
 
-    for (size_t k = 0; k < SBSendNodes.size(); k++) {
-      SBNode *liveNode = SBSendNodes[k];
-      if ((liveNode->getLastInstruction()->getSBIDSetToken() !=
-           (unsigned short)UNKNOWN_TOKEN) &&
-          (send_live.isDstSet(k) ||
-           (send_live.isSrcSet(k) &&
-            isPrefetch(liveNode->getLastInstruction())))) {
+    auto addReachToken = [&](SBNode *liveNode) {
+      if (liveNode->getLastInstruction()->getSBIDSetToken() !=
+          (unsigned short)UNKNOWN_TOKEN) {
         reachTokenArray[liveNode->getLastInstruction()->getSBIDSetToken()]
             .push_back(liveNode);
       }
+    };
+#ifdef _DEBUG
+    if (fullScans) {
+      for (size_t k = 0; k < SBSendNodes.size(); k++) {
+        SBNode *liveNode = SBSendNodes[k];
+        if (send_live->isDstSet(k) ||
+            (send_live->isSrcSet(k) &&
+             isPrefetch(liveNode->getLastInstruction())))
+          addReachToken(liveNode);
+      }
+    } else
+#endif
+    {
+      // Live sends in ascending send ID order: every dst and the prefetches
+      // among the srcs.
+      SparseBitVector liveSends = send_live->src & prefetchSendIDs;
+      liveSends |= send_live->dst;
+      for (unsigned k : liveSends) {
+        vASSERT(k < SBSendNodes.size() && SBSendNodes[k]->sendID == (int)k);
+        addReachToken(SBSendNodes[k]);
+      }
     }
 
     if (!fg.builder->getOptions()->getOption(vISA_DistPropTokenAllocation) &&
         (!node->reachedUses.isEmpty())) {
-      send_use = node->reachedUses; // The uses of other sends can be reached by
-                                    // current node.
-      for (size_t k = 0; k < SBSendUses.size(); k++) {
-        SBNode *liveNode = SBSendUses[k];
-        if (send_use.isDstSet(k)) {
-          for (size_t m = 0; m < liveNode->preds.size(); m++) {
-            SBDEP_ITEM &curPred = liveNode->preds[m];
-            SBNode *pred = curPred.node;
-            if (pred->getLastInstruction()->getSBIDSetToken() !=
-                (unsigned short)UNKNOWN_TOKEN) {
-              reachUseArray[pred->getLastInstruction()->getSBIDSetToken()]
-                  .push_back(liveNode);
-            }
+      // The uses of other sends can be reached by current node.
+      auto addReachUse = [&](SBNode *liveNode) {
+        for (size_t m = 0; m < liveNode->preds.size(); m++) {
+          SBDEP_ITEM &curPred = liveNode->preds[m];
+          SBNode *pred = curPred.node;
+          if (pred->getLastInstruction()->getSBIDSetToken() !=
+              (unsigned short)UNKNOWN_TOKEN) {
+            reachUseArray[pred->getLastInstruction()->getSBIDSetToken()]
+                .push_back(liveNode);
           }
         }
+      };
+#ifdef _DEBUG
+      if (fullScans) {
+        for (size_t k = 0; k < SBSendUses.size(); k++) {
+          if (node->reachedUses.isDstSet(k))
+            addReachUse(SBSendUses[k]);
+        }
+      } else
+#endif
+      {
+        for (unsigned k : node->reachedUses.dst) {
+          vASSERT(k < SBSendUses.size());
+          addReachUse(SBSendUses[k]);
+        }
       }
     }
 
@@ -3430,6 +3709,10 @@ void SWSB::tokenAllocationWithDistPropogation() {
 }
 
 void SWSB::buildExclusiveForCoalescing() {
+#ifdef _DEBUG
+  const bool fullScans =
+      fg.builder->getOptions()->getOption(vISA_SWSBFullTokenScans);
+#endif
   for (SBNode *node : SBSendNodes) {
     G4_INST *inst = node->getLastInstruction();
 
@@ -3443,18 +3726,13 @@ void SWSB::buildExclusiveForCoalescing() {
       continue;
     }
 
-    SBBitSets send_live;
-
     for (SBDEP_ITEM &curSucc : node->succs) {
       SBNode *succ = curSucc.node;
       DepType type = curSucc.type;
       if (((type == RAW) || (type == WAW)) &&
           (!succ->reachingSends.isEmpty())) {
-        send_live = succ->reachingSends;
-        // FIXME, the complexity may be a little big high, n*n*succSize
-        for (size_t k = 0; k < SBSendNodes.size(); k++) {
-          SBNode *liveNode = SBSendNodes[k];
-          if (send_live.isDstSet(k) && (liveNode != node) &&
+        auto addExclusive = [&](SBNode *liveNode) {
+          if ((liveNode != node) &&
               (!(liveNode->reachingSends.isDstSet(node->sendID) ||
                  node->reachingSends.isDstSet(liveNode->sendID)) ||
                tokenHonourInstruction(succ->GetInstruction())))
@@ -3465,6 +3743,21 @@ void SWSB::buildExclusiveForCoalescing() {
           {
             addReachingUseSet(liveNode, succ);
           }
+        };
+#ifdef _DEBUG
+        if (fullScans) {
+          for (size_t k = 0; k < SBSendNodes.size(); k++) {
+            if (succ->reachingSends.isDstSet(k))
+              addExclusive(SBSendNodes[k]);
+          }
+        } else
+#endif
+        {
+          // Only the sends reaching the succ are visited.
+          for (unsigned k : succ->reachingSends.dst) {
+            vASSERT(k < SBSendNodes.size());
+            addExclusive(SBSendNodes[k]);
+          }
         }
       }
 
@@ -3511,12 +3804,17 @@ void SWSB::tokenAllocationGlobalWithPropogation() {
 
   reachTokenArray.resize(totalTokenNum);
   reachUseArray.resize(totalTokenNum);
+  for (const SBNode *node : SBSendNodes) {
+    vASSERT(SBSendNodes[node->sendID] == node);
+    if (isPrefetch(node->getLastInstruction()))
+      prefetchSendIDs.set(node->sendID);
+  }
 
   tokenAllocationWithDistPropogation();
 
   if (fg.builder->getOptions()->getOption(vISA_SWSBDepReduction)) {
     for (G4_BB_SB *bb : BBVector) {
-      bb->getLiveOutToken(unsigned(SBSendNodes.size()), SBNodes);
+      bb->getLiveOutToken(SBNodes);
     }
 #ifdef DEBUG_VERBOSE_ON
     dumpTokenLiveInfo();
@@ -3556,12 +3854,17 @@ void SWSB::tokenAllocationGlobal() {
 
   reachTokenArray.resize(totalTokenNum);
   reachUseArray.resize(totalTokenNum);
+  for (const SBNode *node : SBSendNodes) {
+    vASSERT(SBSendNodes[node->sendID] == node);
+    if (isPrefetch(node->getLastInstruction()))
+      prefetchSendIDs.set(node->sendID);
+  }
 
   tokenAllocationBB(bb);
 
   if (fg.builder->getOptions()->getOption(vISA_SWSBDepReduction)) {
     for (G4_BB_SB *bb : BBVector) {
-      bb->getLiveOutToken(unsigned(SBSendNodes.size()), SBNodes);
+      bb->getLiveOutToken(SBNodes);
     }
 #ifdef DEBUG_VERBOSE_ON
     dumpTokenLiveInfo();
@@ -4805,6 +5108,25 @@ void SWSB::tokenEdgePrune(unsigned &prunedEdgeNum,
                           unsigned &prunedGlobalEdgeNum,
                           unsigned &prunedDiffBBEdgeNum,
                           unsigned &prunedDiffBBSameTokenEdgeNum) {
+  // Killing a token removes the sends of allTokenNodesMap[token] from the
+  // live set. Rather than subtracting the whole bit set for every kill, the
+  // live sends of each token are listed, so that a kill only touches the
+  // sends made live since the previous kill of the token.
+  std::vector<std::vector<unsigned short>> sendTokens(SBSendNodes.size());
+  for (unsigned token = 0; token < allTokenNodesMap.size(); token++) {
+    const BitSet &tokenNodes = allTokenNodesMap[token].bitset;
+    for (int sendID = tokenNodes.findFirstIn(0, tokenNodes.getSize());
+         sendID != INVALID_ID;
+         sendID = tokenNodes.findFirstIn(sendID + 1, tokenNodes.getSize())) {
+      sendTokens[sendID].push_back(token);
+    }
+  }
+  std::vector<std::vector<unsigned>> liveTokenSends(allTokenNodesMap.size());
+#ifdef _DEBUG
+  const bool fullScans =
+      fg.builder->getOptions()->getOption(vISA_SWSBFullTokenScans);
+#endif
+
   for (size_t i = 0; i < BBVector.size(); i++) {
     if (BBVector[i]->first_node == INVALID_ID) {
       continue;
@@ -4812,6 +5134,29 @@ void SWSB::tokenEdgePrune(unsigned &prunedEdgeNum,
 
     BitSet activateLiveIn(SBSendNodes.size(), false);
     activateLiveIn |= BBVector[i]->liveInTokenNodes;
+    for (auto &sends : liveTokenSends) {
+      sends.clear();
+    }
+    for (int sendID = activateLiveIn.findFirstIn(0, activateLiveIn.getSize());
+         sendID != INVALID_ID;
+         sendID = activateLiveIn.findFirstIn(sendID + 1,
+                                             activateLiveIn.getSize())) {
+      for (unsigned short token : sendTokens[sendID]) {
+        liveTokenSends[token].push_back(sendID);
+      }
+    }
+    auto killToken = [&](unsigned short token) {
+#ifdef _DEBUG
+      if (fullScans) {
+        activateLiveIn -= allTokenNodesMap[token].bitset;
+        return;
+      }
+#endif
+      for (unsigned sendID : liveTokenSends[token]) {
+        activateLiveIn.set(sendID, false);
+      }
+      liveTokenSends[token].clear();
+    };
 
     // Scan the instruction nodes of current BB
     for (int j = BBVector[i]->first_node; j <= BBVector[i]->last_node; j++) {
@@ -4909,7 +5254,7 @@ void SWSB::tokenEdgePrune(unsigned &prunedEdgeNum,
             if (type == RAW || type == WAW) {
               int token = predNode->getLastInstruction()->getSBIDSetToken();
               if (token != (unsigned short)UNKNOWN_TOKEN) {
-                activateLiveIn -= allTokenNodesMap[token].bitset;
+                killToken(token);
                 killedToken.set(token, true);
               }
             }
@@ -4924,16 +5269,18 @@ void SWSB::tokenEdgePrune(unsigned &prunedEdgeNum,
           !node->GetInstruction()->isEOT()) {
         int token = node->getLastInstruction()->getSBIDSetToken();
         if (token != (unsigned short)UNKNOWN_TOKEN) {
-          activateLiveIn -= allTokenNodesMap[token].bitset;
+          killToken(token);
           activateLiveIn.set(node->sendID, true);
+          for (unsigned short sendToken : sendTokens[node->sendID]) {
+            liveTokenSends[sendToken].push_back(node->sendID);
+          }
         }
       }
     }
   }
 }
 
-void G4_BB_SB::getLiveOutToken(unsigned allSendNum,
-                               const SBNODE_VECT &SBNodes) {
+void G4_BB_SB::getLiveOutToken(const SBNODE_VECT &SBNodes) {
   // Empty BB
   if (first_node == INVALID_ID) {
     return;
@@ -4941,13 +5288,9 @@ void G4_BB_SB::getLiveOutToken(unsigned allSendNum,
 
   uint32_t totalTokenNum = builder.kernel.getNumSWSBTokens();
   std::vector<unsigned> liveNodeID(totalTokenNum, 0);
-
-  if (tokeNodesMap.empty()) {
-    tokeNodesMap.resize(totalTokenNum, BitSet(allSendNum, false));
-  } else {
-    for (size_t i = 0; i < totalTokenNum; i++)
-      tokeNodesMap[i].clear();
-  }
+  // A token is set by at most one live send at a time, so the live send of
+  // each token is tracked instead of a bit set over all sends per token.
+  std::vector<int> liveSendID(totalTokenNum, INVALID_ID);
 
   // Scan instructions forward to get the live out of current BB
   for (int i = first_node; i <= last_node; i++) {
@@ -4978,8 +5321,9 @@ void G4_BB_SB::getLiveOutToken(unsigned allSendNum,
           // liveNodeID is used to track the live node id of each send. predNode
           // can kill
           if (liveNodeID[token] < predNode->getNodeID()) {
-            tokeNodesMap[token].clear(); // Kill all dependence in following
-                                         // instructions with the same token
+            // Kill all dependence in following instructions with the same
+            // token
+            liveSendID[token] = INVALID_ID;
 
             // Record the killed token by current BB, Kill may kill all previous
             // nodes which reach current node
@@ -4997,19 +5341,20 @@ void G4_BB_SB::getLiveOutToken(unsigned allSendNum,
         node->getLastInstruction()->getSBIDSetToken() !=
             (unsigned short)UNKNOWN_TOKEN) {
       unsigned short token = node->getLastInstruction()->getSBIDSetToken();
-      tokeNodesMap[token].clear();
 
       // For future live in, will always be killed by current instruction
       killedTokens.set(token, true);
 
       // Current node may be in live out, if not be killed in following insts.
-      tokeNodesMap[token].set(node->sendID, true);
+      liveSendID[token] = node->sendID;
       liveNodeID[token] = node->getNodeID();
     }
   }
 
-  for (size_t i = 0; i < totalTokenNum; i++) {
-    liveOutTokenNodes |= tokeNodesMap[i];
+  for (int sendID : liveSendID) {
+    if (sendID != INVALID_ID) {
+      liveOutTokenNodes.set(sendID, true);
+    }
   }
 }
 
@@ -674,7 +674,6 @@ public:
   BitSet liveInTokenNodes;
   BitSet liveOutTokenNodes;
   BitSet killedTokens;
-  std::vector<BitSet> tokeNodesMap;
   int first_DPASID = 0;
   int last_DPASID = 0;
   unsigned *tokenLiveInDist;
@@ -804,7 +803,7 @@ public:
   bool src2SameFootPrintDiffType(SBNode *curNode, SBNode *nextNode) const;
   bool isLastDpas(SBNode *curNode, SBNode *nextNode);
 
-  void getLiveOutToken(unsigned allSendNum, const SBNODE_VECT &SBNodes);
+  void getLiveOutToken(const SBNODE_VECT &SBNodes);
 
   unsigned getLoopStartBBID() const { return loopStartBBID; }
   unsigned getLoopEndBBID() const { return loopEndBBID; }
@@ -927,6 +926,8 @@ class SWSB {
   SBBUCKET_VECTOR globalSendOpndList; // All send operands which live out their
                                       // instructions' BBs. No redundant.
   const uint32_t totalTokenNum;
+  // Token reuse distances below come from the latency table.
+  const std::unique_ptr<LatencyTable> LT;
   static constexpr unsigned TOKEN_AFTER_READ_CYCLE = 4;
   const unsigned tokenAfterWriteMathCycle;
   const unsigned tokenAfterWriteSendSlmCycle;
@@ -950,6 +951,8 @@ class SWSB {
 
   std::vector<SBNODE_VECT> reachTokenArray;
   std::vector<SBNODE_VECT> reachUseArray;
+  // Send IDs of the prefetches, whose src liveness also reaches a token.
+  SparseBitVector prefetchSendIDs;
   SBNODE_VECT localTokenUsage;
 
   int topIndex = -1;
@@ -970,6 +973,10 @@ class SWSB {
   };
   std::vector<TokenAllocation> allTokenNodesMap;
   SWSB_TOKEN_PROFILE tokenProfile;
+  // Expected execution count of each BB, to weight the token stalls. All of
+  // them are on the same scale, see FlowGraph::getBlockWeight. Only computed
+  // when the stall costs are used.
+  std::vector<float> BBWeights;
 
   // Global dependence analysis
   bool globalDependenceDefReachAnalysis(G4_BB *bb);
@@ -1004,6 +1011,15 @@ class SWSB {
                            unsigned curLoopStartBB,
                            unsigned curLoopEndBB) const;
   SBNode *reuseTokenSelection(const SBNode *node) const;
+  SBNode *reuseTokenSelectionByStallCost(const SBNode *node) const;
+  std::pair<unsigned /*lastBefore*/, unsigned /*firstAfter*/>
+  getClosestTokenUsers(unsigned short token, unsigned sendID) const;
+  unsigned getTokenLatency(const SBNode *node) const;
+  float getTokenStallCost(const SBNode *earlier, const SBNode *later) const;
+  BitSet getWaitedTokens(const SBNode *consumer, bool afterWrite,
+                         const SBNode *excluded) const;
+  float getTokenSyncCost(const SBNode *node, unsigned short token) const;
+  void estimateTokenStallCycles();
   unsigned short reuseTokenSelectionGlobal(SBNode *node, G4_BB *bb,
                                            SBNode *&candidateNode,
                                            bool &fromUse);
@@ -1106,23 +1122,27 @@ public:
   SWSB(G4_Kernel &k)
       : kernel(k), fg(k.fg), SWSBMem(4096),
         totalTokenNum(k.fg.builder->kernel.getNumSWSBTokens()),
-        tokenAfterWriteMathCycle(k.fg.builder->isXeLP() ? 20u : 17u),
-        tokenAfterWriteSendSlmCycle(
-            k.fg.builder->isXeLP() ? 33u : 25u), // unlocaled 25
-        tokenAfterWriteSendMemoryCycle(
+        LT(LatencyTable::createLatencyTable(*k.fg.builder)),
+        tokenAfterWriteMathCycle(LT->getParam(
+            k.fg.builder->isXeLP() ? LatencyParam::SWSB_MATH_XELP
+                                   : LatencyParam::SWSB_MATH)),
+        tokenAfterWriteSendSlmCycle(LT->getParam(
+            k.fg.builder->isXeLP() ? LatencyParam::SWSB_SEND_SLM_XELP
+                                   : LatencyParam::SWSB_SEND_SLM)),
+        tokenAfterWriteSendMemoryCycle(LT->getParam(
             k.fg.builder->getOptions()->getOption(vISA_USEL3HIT)
                 ? (k.fg.builder->isXeLP()
-                       ? 106u
-                       : 150u) // TOKEN_AFTER_WRITE_SEND_L3_MEMORY_CYCLE
+                       ? LatencyParam::SWSB_SEND_L3_MEMORY_XELP
+                       : LatencyParam::SWSB_SEND_L3_MEMORY)
                 : (k.fg.builder->isXeLP()
-                       ? 65u
-                       : 50u)), // TOKEN_AFTER_WRITE_SEND_L1_MEMORY_CYCLE
-        tokenAfterWriteSendSamplerCycle(
+                       ? LatencyParam::SWSB_SEND_L1_MEMORY_XELP
+                       : LatencyParam::SWSB_SEND_L1_MEMORY))),
+        tokenAfterWriteSendSamplerCycle(LT->getParam(
             k.fg.builder->getOptions()->getOption(vISA_USEL3HIT)
                 ? (k.fg.builder->isXeLP()
-                       ? 175u
-                       : 210u) // TOKEN_AFTER_WRITE_SEND_L3_SAMPLER_CYCLE
-                : 60u)         // TOKEN_AFTER_WRITE_SEND_L1_SAMPLER_CYCLE
+                       ? LatencyParam::SWSB_SEND_L3_SAMPLER_XELP
+                       : LatencyParam::SWSB_SEND_L3_SAMPLER)
+                : LatencyParam::SWSB_SEND_L1_SAMPLER))
   {
     indexes.instIndex = 0;
     indexes.ALUIndex = 0;
@@ -1131,8 +1151,7 @@ public:
     indexes.longIndex = 0;
     indexes.DPASIndex = 0;
     indexes.mathIndex = 0;
-    tokenAfterDPASCycle =
-        LatencyTable::createLatencyTable(*k.fg.builder)->getDPASLatency(8);
+    tokenAfterDPASCycle = LT->getDPASLatency(8);
   }
   ~SWSB() {}
   void SWSBGenerator();
@@ -30,6 +30,8 @@ public:
     return _arenaManager.AllocDataSpace(size, static_cast<size_t>(al));
   }
 
+  const ArenaStats &getStats() const { return _arenaManager.getStats(); }
+
 private:
   vISA::ArenaManager _arenaManager;
 };
@@ -87,6 +89,9 @@ public:
     // No deallocation for arena allocator.
   }
 
+  // Stats of the Mem_Manager shared by all copies of this allocator.
+  const ArenaStats &getStats() const { return mem_manager_ptr->getStats(); }
+
   pointer address(reference x) const { return &x; }
   const_pointer address(const_reference x) const { return &x; }
 
@@ -1047,10 +1047,9 @@ void Optimizer::insertFenceAtEntry() {
   // and that option is, in turn, same as the value in WA table
   if (kernel.getInt32KernelAttr(Attributes::ATTR_Target) == VISA_CM) {
     injectEntryFences = injectEntryFences ||
-                        builder.getOption(vISA_LSCBackupMode) ||
+                        builder.getLscBackupMode() ||
                         VISA_WA_CHECK(builder.getPWaTable(), Wa_14010198302);
-    const_cast<Options *>(builder.getOptions())
-        ->setOption(vISA_LSCBackupMode, injectEntryFences);
+    builder.setLscBackupMode(injectEntryFences);
   }
 
   if (injectEntryFences) {
@@ -1062,12 +1061,10 @@ void Optimizer::insertFenceAtEntry() {
     builder.translateLscFence(nullptr, SFID::UGM, LSC_FENCE_OP_EVICT,
                               LSC_SCOPE_GPU);
     // according to architects the invalidate fence should not use backup mode
-    const_cast<Options *>(builder.getOptions())
-        ->setOption(vISA_LSCBackupMode, false);
+    builder.setLscBackupMode(false);
     builder.translateLscFence(nullptr, SFID::UGM, LSC_FENCE_OP_INVALIDATE,
                               LSC_SCOPE_GPU);
-    const_cast<Options *>(builder.getOptions())
-        ->setOption(vISA_LSCBackupMode, true);
+    builder.setLscBackupMode(true);
     entryBB->insert(iter, builder.instList.begin(), builder.instList.end());
     builder.instList.clear();
   }
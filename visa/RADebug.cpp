@@ -256,7 +256,7 @@ static G4_Declare *findDeclare(G4_Kernel &kernel, char *name) {
 
 // For RA debugging
 // Add extra interference info into intf graph
-void GraphColor::getExtraInterferenceInfo() {
+void Interference::getExtraInterferenceInfo() {
   // Get the file name
   llvm::SmallString<32> intfName;
   const char *fileName =
@@ -271,8 +271,9 @@ void GraphColor::getExtraInterferenceInfo() {
 #else
     llvm::sys::path::append(intfName, "/", "tmp", "IntelIGC", "ShaderOVerride");
 #endif
-    vASSERT(m_options->getOptionCstr(VISA_AsmFileName));
-    llvm::StringRef asmName = m_options->getOptionCstr(VISA_AsmFileName);
+    vASSERT(builder.getOptions()->getOptionCstr(VISA_AsmFileName));
+    llvm::StringRef asmName =
+        builder.getOptions()->getOptionCstr(VISA_AsmFileName);
     llvm::sys::path::append(
         intfName, sanitizePathString(llvm::sys::path::stem(asmName).str()));
     intfName.append(".extraintf");
@@ -313,7 +314,7 @@ void GraphColor::getExtraInterferenceInfo() {
         int src1Id = varDeclare->getRegVar()->getId();
 
         // Set inteference
-        intf.checkAndSetIntf(src0Id, src1Id);
+        checkAndSetIntf(src0Id, src1Id);
         VISA_DEBUG_VERBOSE(std::cout << keyDeclare->getName() << ":"
                                      << varDeclare->getName() << "\n");
       }
@@ -24,15 +24,59 @@ RPE::RPE(const GlobalRA &g, const LivenessAnalysis *l, DECLARE_LIST *spills)
   }
 }
 
-void RPE::run() {
+void RPE::run(IncrementalRA *incRA) {
   TIME_SCOPE(RPE);
   if (!vars.empty()) {
     for (auto &bb : gra.kernel.fg) {
-      runBB(bb);
+      // Spilled variables don't contribute to pressure, so recorded pressure
+      // is valid only without them.
+      if (incRA && spilledVars.empty())
+        runBBIncrementally(bb, *incRA);
+      else
+        runBB(bb);
     }
   }
 }
 
+void RPE::runBBIncrementally(G4_BB *bb, IncrementalRA &incRA) {
+  auto *summary = incRA.getBBSummary(bb, liveAnalysis);
+  if (!summary) {
+    runBB(bb);
+    return;
+  }
+
+  // Pressure within a BB depends only on its instructions and on the
+  // variables live at its exit.
+  SparseBitVector liveOut = liveAnalysis->use_out[bb->getId()];
+  liveOut &= liveAnalysis->def_out[bb->getId()];
+  bool reuse = summary->hasRP && incRA.isBBUnchanged(bb) &&
+               summary->rp.size() == bb->size() &&
+               summary->rpLiveOut == liveOut;
+  if (reuse && !incRA.isEnabledWithVerification()) {
+    unsigned int i = 0;
+    for (auto rInst = bb->rbegin(), rEnd = bb->rend(); rInst != rEnd; ++rInst)
+      rp[*rInst] = summary->rp[i++];
+    maxRP = std::max(maxRP, summary->maxRP);
+    return;
+  }
+
+  auto prevMaxRP = maxRP;
+  maxRP = 0;
+  runBB(bb);
+  std::vector<unsigned int> bbRP;
+  bbRP.reserve(bb->size());
+  for (auto rInst = bb->rbegin(), rEnd = bb->rend(); rInst != rEnd; ++rInst)
+    bbRP.push_back(rp[*rInst]);
+  if (reuse && (bbRP != summary->rp || maxRP != summary->maxRP))
+    incRA.reportBBSummaryMismatch(bb, "register pressure");
+
+  summary->hasRP = true;
+  summary->rpLiveOut = std::move(liveOut);
+  summary->rp = std::move(bbRP);
+  summary->maxRP = maxRP;
+  maxRP = std::max(prevMaxRP, maxRP);
+}
+
 void RPE::runBB(G4_BB *bb) {
   G4_Declare *topdcl = nullptr;
   unsigned int id = 0;
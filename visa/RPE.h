@@ -13,6 +13,8 @@ SPDX-License-Identifier: MIT
 #include <unordered_map>
 
 namespace vISA {
+class IncrementalRA;
+
 class RPE {
 public:
   RPE(const GlobalRA &, const LivenessAnalysis *,
@@ -20,7 +22,9 @@ public:
 
   ~RPE() {}
 
-  void run();
+  // With incRA, pressure of BBs unchanged since the previous RA iteration
+  // is reused.
+  void run(IncrementalRA *incRA = nullptr);
   void runBB(G4_BB *);
   unsigned int getRegisterPressure(G4_INST *inst) {
     auto it = rp.find(inst);
@@ -54,6 +58,7 @@ private:
   // iteration).
   std::unordered_set<const G4_Declare *> spilledVars;
 
+  void runBBIncrementally(G4_BB *, IncrementalRA &);
   void regPressureBBExit(G4_BB *);
   void updateRegisterPressure(bool change, bool clean, unsigned int);
   void updateLiveness(SparseBitVector &, uint32_t, bool);
@@ -20,6 +20,7 @@ SPDX-License-Identifier: MIT
 #include <cmath>
 #include <fstream>
 #include <optional>
+#include <queue>
 #include <vector>
 
 using namespace vISA;
@@ -230,6 +231,9 @@ LivenessAnalysis::LivenessAnalysis(GlobalRA &g, unsigned char kind,
 
   numBBId = (unsigned)fg.size();
 
+  incrementalGenKill =
+      !verifyRA && gra.incRA.isEnabled() && livenessClass(G4_GRF);
+
   def_in.resize(numBBId);
   def_out.resize(numBBId);
   use_in.resize(numBBId);
@@ -555,11 +559,16 @@ void LivenessAnalysis::computeLiveness() {
   //
   // compute def_out and use_in vectors for each BB
   //
+  if (incrementalGenKill)
+    bbSummaryGeneration = gra.incRA.startBBSummaries(this);
   for (G4_BB *bb : fg) {
     unsigned id = bb->getId();
 
-    computeGenKillandPseudoKill(bb, def_out[id], use_in[id], use_gen[id],
-                                use_kill[id]);
+    if (incrementalGenKill)
+      computeGenKillIncrementally(bb);
+    else
+      computeGenKillandPseudoKill(bb, def_out[id], use_in[id], use_gen[id],
+                                  use_kill[id]);
 
     //
     // exit block: mark output parameters live
@@ -631,41 +640,11 @@ void LivenessAnalysis::computeLiveness() {
     maydefAnalysis();
   }
 
-  auto getPostOrder = [](G4_BB *S, std::vector<G4_BB *> &PO) {
-    std::stack<std::pair<G4_BB *, BB_LIST_ITER>> Stack;
-    std::set<G4_BB *> Visited;
-
-    Stack.push({S, S->Succs.begin()});
-    Visited.insert(S);
-    while (!Stack.empty()) {
-      G4_BB *Curr = Stack.top().first;
-      BB_LIST_ITER It = Stack.top().second;
-
-      if (It != Curr->Succs.end()) {
-        G4_BB *Child = *Stack.top().second++;
-        if (Visited.insert(Child).second) {
-          Stack.push({Child, Child->Succs.begin()});
-        }
-        continue;
-      }
-      PO.push_back(Curr);
-      Stack.pop();
-    }
-  };
-
-  std::vector<G4_BB *> PO;
-  getPostOrder(fg.getEntryBB(), PO);
-
-  bool change;
-
   //
   // backward flow analysis to propagate uses (locate last uses)
   //
-  do {
-    change = false;
-    for (auto I = PO.begin(), E = PO.end(); I != E; ++I)
-      change |= contextFreeUseAnalyze(*I, change);
-  } while (change);
+  LivenessSCCs sccs(fg.getEntryBB(), numBBId);
+  solveUses(sccs);
 
   //
   // initialize entry block with payload input
@@ -675,11 +654,7 @@ void LivenessAnalysis::computeLiveness() {
   //
   // forward flow analysis to propagate defs (locate first defs)
   //
-  do {
-    change = false;
-    for (auto I = PO.rbegin(), E = PO.rend(); I != E; ++I)
-      change |= contextFreeDefAnalyze(*I, change);
-  } while (change);
+  solveDefs(sccs);
 
   //
   // dump vectors for debugging
@@ -1140,6 +1115,18 @@ void LivenessAnalysis::footprintSrc(const G4_INST *i, G4_Operand *opnd,
 void LivenessAnalysis::computeGenKillandPseudoKill(
     G4_BB *bb, SparseBitVector &def_out, SparseBitVector &use_in,
     SparseBitVector &use_gen, SparseBitVector &use_kill) const {
+  PseudoKillList pseudoKills;
+  computeGenKill(bb, def_out, use_in, use_gen, use_kill, pseudoKills);
+  insertPseudoKills(bb, pseudoKills);
+}
+
+// Compute gen/kill sets of bb and collect the pseudo kills that
+// computeGenKillandPseudoKill() inserts, without modifying bb.
+void LivenessAnalysis::computeGenKill(G4_BB *bb, SparseBitVector &def_out,
+                                      SparseBitVector &use_in,
+                                      SparseBitVector &use_gen,
+                                      SparseBitVector &use_kill,
+                                      PseudoKillList &killsToInsert) const {
   //
   // Mark each fcall as using all globals and arg pre-defined var
   //
@@ -1546,26 +1533,19 @@ void LivenessAnalysis::computeGenKillandPseudoKill(
   }
 
   //
-  // Insert pseudo_kill nodes in BB
+  // Collect positions of pseudo_kill nodes to insert in BB
   //
-  for (auto &&pseudoKill : pseudoKills) {
-    INST_LIST_ITER iterToInsert = pseudoKill.second.base();
-    do {
-      --iterToInsert;
-    } while ((*iterToInsert)->isPseudoKill());
-    G4_INST *killInst = fg.builder->createPseudoKill(
-        pseudoKill.first, PseudoKillType::FromLiveness, false);
-    bb->insertBefore(iterToInsert, killInst);
-  }
-  for (auto &pseudoKill : pseudoKillsForSpills) {
-    INST_LIST_ITER iterToInsert = pseudoKill.second.base();
+  auto addKill = [&](G4_Declare *dcl, INST_LIST_RITER rit) {
+    INST_LIST_ITER iterToInsert = rit.base();
     do {
       --iterToInsert;
     } while ((*iterToInsert)->isPseudoKill());
-    G4_INST *killInst = fg.builder->createPseudoKill(
-        pseudoKill.first, PseudoKillType::FromLiveness, false);
-    bb->insertBefore(iterToInsert, killInst);
-  }
+    killsToInsert.emplace_back(dcl, iterToInsert);
+  };
+  for (auto &&pseudoKill : pseudoKills)
+    addKill(pseudoKill.first, pseudoKill.second);
+  for (auto &pseudoKill : pseudoKillsForSpills)
+    addKill(pseudoKill.first, pseudoKill.second);
 
   //
   // initialize use_in
@@ -1573,70 +1553,346 @@ void LivenessAnalysis::computeGenKillandPseudoKill(
   use_in = use_gen;
 }
 
+void LivenessAnalysis::insertPseudoKills(
+    G4_BB *bb, const PseudoKillList &pseudoKills) const {
+  for (auto &pseudoKill : pseudoKills) {
+    G4_INST *killInst = fg.builder->createPseudoKill(
+        pseudoKill.first, PseudoKillType::FromLiveness, false);
+    bb->insertBefore(pseudoKill.second, killInst);
+  }
+}
+
+// Key of everything computeGenKill() reads from bb: its instructions and
+// operands, and the per-variable properties that decide where kills are.
+// Spill/fill insertion, remat and splitting replace instructions or operands,
+// so the key of each BB they touch changes. The summary of a BB is reused only
+// if its key is equal, not just a hash of it. Pseudo kills inserted by
+// liveness are left out: they are erased along with the liveness that inserted
+// them, and are inserted again from the summary or by computeGenKill(). BBs
+// with indirect accesses depend on points-to analysis; they get an empty key
+// and are always recomputed.
+std::vector<uint64_t> LivenessAnalysis::computeBBKey(G4_BB *bb) const {
+  std::vector<uint64_t> key;
+  auto add = [&key](uint64_t value) { key.push_back(value); };
+  auto addPtr = [&key](const void *ptr) {
+    key.push_back(reinterpret_cast<uintptr_t>(ptr));
+  };
+  auto addDcl = [&](const G4_Declare *topdcl) {
+    if (!topdcl)
+      return;
+    addPtr(topdcl);
+    const G4_RegVar *var = topdcl->getRegVar();
+    add(var->getId());
+    add(gra.isBlockLocal(topdcl));
+    add(var->isRegVarTransient() | (var->isRegVarCoalesced() << 1) |
+        (var->isSpilled() << 2) | (doesVarNeedNoMaskForKill(topdcl) << 3) |
+        (neverDefinedRows.count(const_cast<G4_Declare *>(topdcl)) << 4));
+    if (auto *localLR = gra.getLocalLR(topdcl)) {
+      addPtr(localLR);
+      add(localLR->getAssigned() | (localLR->isLiveRangeLocal() << 1));
+    }
+  };
+
+  add(bb->getId());
+  add(bb->isAllLaneActive());
+  for (const G4_INST *inst : *bb) {
+    if (inst->isPseudoKill() &&
+        inst->getSrc(0)->asImm()->getImm() ==
+            static_cast<int64_t>(PseudoKillType::FromLiveness))
+      continue;
+    addPtr(inst);
+    add(inst->getMaskOption());
+    add(inst->getExecSize());
+    if (auto *dst = inst->getDst()) {
+      if (dst->isIndirect())
+        return {};
+      addPtr(dst);
+      addDcl(dst->getTopDcl());
+    }
+    for (unsigned i = 0, numSrc = inst->getNumSrc(); i < numSrc; i++) {
+      const G4_Operand *src = inst->getSrc(i);
+      if (!src) {
+        addPtr(nullptr);
+        continue;
+      }
+      if (src->isAddrExp() || (src->isSrcRegRegion() && src->isIndirect()))
+        return {};
+      addPtr(src);
+      addDcl(src->getTopDcl());
+    }
+    if (auto *mod = inst->getCondMod()) {
+      addPtr(mod);
+      addDcl(mod->getTopDcl());
+    }
+    if (auto *pred = inst->getPredicate()) {
+      addPtr(pred);
+      addDcl(pred->getTopDcl());
+    }
+  }
+  return key;
+}
+
+// Compute gen/kill sets of bb, reusing the ones from the previous RA
+// iteration if bb didn't change since then. With incremental RA
+// verification, the reused sets are compared against a full recomputation.
+void LivenessAnalysis::computeGenKillIncrementally(G4_BB *bb) {
+  unsigned id = bb->getId();
+  auto &incRA = gra.incRA;
+  auto [summary, unchanged] =
+      incRA.lookupBBSummary(bb, computeBBKey(bb));
+
+  PseudoKillList pseudoKills;
+  if (!unchanged || incRA.isEnabledWithVerification()) {
+    computeGenKill(bb, def_out[id], use_in[id], use_gen[id], use_kill[id],
+                   pseudoKills);
+  }
+
+  if (unchanged && incRA.isEnabledWithVerification()) {
+    bool killsMatch = pseudoKills.size() == summary.pseudoKills.size();
+    for (unsigned i = 0; killsMatch && i != pseudoKills.size(); ++i) {
+      killsMatch = pseudoKills[i].first == summary.pseudoKills[i].first &&
+                   *pseudoKills[i].second == summary.pseudoKills[i].second;
+    }
+    if (def_out[id] != summary.def_out || use_gen[id] != summary.use_gen ||
+        use_kill[id] != summary.use_kill || !killsMatch) {
+      incRA.reportBBSummaryMismatch(bb, "liveness gen/kill");
+      unchanged = false;
+      summary.pseudoKills.clear();
+    } else {
+      // Insert the recorded pseudo kills below to exercise the same path
+      // as without verification.
+      pseudoKills.clear();
+    }
+  }
+
+  if (unchanged) {
+    def_out[id] = summary.def_out;
+    use_gen[id] = summary.use_gen;
+    use_kill[id] = summary.use_kill;
+    use_in[id] = summary.use_gen;
+    if (!summary.pseudoKills.empty()) {
+      std::unordered_map<const G4_INST *, INST_LIST_ITER> instIts;
+      for (auto it = bb->begin(), end = bb->end(); it != end; ++it)
+        instIts[*it] = it;
+      for (auto &pseudoKill : summary.pseudoKills)
+        pseudoKills.emplace_back(pseudoKill.first,
+                                 instIts.at(pseudoKill.second));
+    }
+    insertPseudoKills(bb, pseudoKills);
+    return;
+  }
+
+  summary.def_out = def_out[id];
+  summary.use_gen = use_gen[id];
+  summary.use_kill = use_kill[id];
+  for (auto &pseudoKill : pseudoKills)
+    summary.pseudoKills.emplace_back(pseudoKill.first, *pseudoKill.second);
+  insertPseudoKills(bb, pseudoKills);
+}
+
 //
 // use_out = use_in(s1) + use_in(s2) + ... where s1 s2 ... are the successors of
 // bb use_in  = use_gen + (use_out - use_kill)
+// Returns true if use_in of bb changed. Both sets only ever grow, so only the
+// new bits are computed.
 //
-bool LivenessAnalysis::contextFreeUseAnalyze(G4_BB *bb, bool isChanged) {
-  bool changed;
-
+bool LivenessAnalysis::contextFreeUseAnalyze(G4_BB *bb) {
   unsigned bbid = bb->getId();
 
-  if (bb->Succs.empty()) // exit block
-  {
-    changed = false;
-  } else if (isChanged) {
-    // no need to update changed. This saves a memcpy
-    for (auto succBB : bb->Succs) {
-      use_out[bbid] |= use_in[succBB->getId()];
-    }
-    changed = true;
-  } else {
-    SparseBitVector old = use_out[bbid];
-    for (auto succBB : bb->Succs) {
-      use_out[bbid] |= use_in[succBB->getId()];
-    }
-
-    changed = (old != use_out[bbid]);
+  for (auto succBB : bb->Succs) {
+    use_out[bbid] |= use_in[succBB->getId()];
   }
 
   //
   // in = gen + (out - kill)
   //
-  use_in[bbid] = use_out[bbid];
-  use_in[bbid] = use_in[bbid] - use_kill[bbid];
-  use_in[bbid] |= use_gen[bbid];
-
-  return changed;
+  SparseBitVector newUseIn = use_out[bbid] - use_kill[bbid];
+  newUseIn.intersectWithComplement(use_in[bbid]);
+  if (newUseIn.empty())
+    return false;
+  use_in[bbid] |= newUseIn;
+  return true;
 }
 
 //
 // def_in = def_out(p1) + def_out(p2) + ... where p1 p2 ... are the predecessors
 // of bb def_out |= def_in
+// Returns true if def_out of bb changed.
 //
-bool LivenessAnalysis::contextFreeDefAnalyze(G4_BB *bb, bool isChanged) {
-  bool changed = false;
+bool LivenessAnalysis::contextFreeDefAnalyze(G4_BB *bb) {
   unsigned bbid = bb->getId();
 
-  if (bb->Preds.empty()) {
-    changed = false;
-  } else if (isChanged) {
-    // no need to update changed. This saves a memcpy
-    for (auto predBB : bb->Preds) {
-      def_in[bbid] |= def_out[predBB->getId()];
+  for (auto predBB : bb->Preds) {
+    def_in[bbid] |= def_out[predBB->getId()];
+  }
+
+  SparseBitVector newDefOut = def_in[bbid] - def_out[bbid];
+  if (newDefOut.empty())
+    return false;
+  def_out[bbid] |= newDefOut;
+  return true;
+}
+
+LivenessSCCs::LivenessSCCs(G4_BB *entryBB, unsigned numBBId)
+    : poNumber(numBBId, UINT_MAX), sccId(numBBId, UINT_MAX) {
+  // Iterative Tarjan's algorithm over the BBs reachable from entryBB. The
+  // post-order number of a BB is assigned when its DFS visit finishes.
+  std::vector<unsigned> index(numBBId, UINT_MAX);
+  std::vector<unsigned> lowLink(numBBId);
+  std::vector<G4_BB *> sccStack;
+  std::vector<std::pair<G4_BB *, BB_LIST_ITER>> dfsStack;
+  unsigned nextIndex = 0;
+  unsigned nextPONumber = 0;
+
+  auto visit = [&](G4_BB *bb) {
+    unsigned id = bb->getId();
+    index[id] = lowLink[id] = nextIndex++;
+    sccStack.push_back(bb);
+    dfsStack.push_back({bb, bb->Succs.begin()});
+  };
+
+  visit(entryBB);
+  while (!dfsStack.empty()) {
+    G4_BB *bb = dfsStack.back().first;
+    unsigned id = bb->getId();
+    if (dfsStack.back().second != bb->Succs.end()) {
+      G4_BB *succBB = *dfsStack.back().second++;
+      unsigned succId = succBB->getId();
+      if (index[succId] == UINT_MAX) {
+        visit(succBB);
+      } else if (sccId[succId] == UINT_MAX) {
+        // succBB is still on the SCC stack.
+        lowLink[id] = std::min(lowLink[id], index[succId]);
+      }
+      continue;
     }
-    changed = true;
-  } else {
-    SparseBitVector old = def_in[bbid];
-    for (auto predBB : bb->Preds) {
-      def_in[bbid] |= def_out[predBB->getId()];
+
+    poNumber[id] = nextPONumber++;
+    dfsStack.pop_back();
+    if (!dfsStack.empty()) {
+      unsigned parentId = dfsStack.back().first->getId();
+      lowLink[parentId] = std::min(lowLink[parentId], lowLink[id]);
+    }
+    if (lowLink[id] != index[id])
+      continue;
+
+    // bb is the root of an SCC; its members are on top of the stack.
+    unsigned scc = static_cast<unsigned>(SCCs.size());
+    SCCs.emplace_back();
+    G4_BB *member;
+    do {
+      member = sccStack.back();
+      sccStack.pop_back();
+      sccId[member->getId()] = scc;
+      SCCs.back().push_back(member);
+    } while (member != bb);
+  }
+}
+
+bool LivenessSCCs::isCyclic(unsigned scc) const {
+  if (SCCs[scc].size() > 1)
+    return true;
+  G4_BB *bb = SCCs[scc].front();
+  return std::find(bb->Succs.begin(), bb->Succs.end(), bb) != bb->Succs.end();
+}
+
+//
+// Worklist solver for the backward use analysis. SCCs are visited in reverse
+// topological order, so the successors outside of an SCC are final before the
+// SCC is solved, and an acyclic SCC (a BB outside of any loop) is visited
+// exactly once. Inside a loop the BBs are visited in post-order, which solves
+// inner loops first, and a BB is only revisited when the use_in of one of its
+// successors in the same SCC has changed.
+//
+void LivenessAnalysis::solveUses(const LivenessSCCs &sccs) {
+  std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>>
+      worklist;
+  std::vector<G4_BB *> bbByPONumber(numBBId);
+  std::vector<bool> onWorklist(numBBId, false);
+
+  // contextFreeUseAnalyze() only adds bits to use_in, so start from use_gen:
+  // performScoping() may have removed bits from use_gen after use_in was
+  // initialized.
+  for (unsigned scc = 0, e = sccs.getNumSCCs(); scc != e; ++scc) {
+    for (G4_BB *bb : sccs.getMembers(scc))
+      use_in[bb->getId()] = use_gen[bb->getId()];
+  }
+
+  for (unsigned scc = 0, e = sccs.getNumSCCs(); scc != e; ++scc) {
+    const std::vector<G4_BB *> &members = sccs.getMembers(scc);
+    if (!sccs.isCyclic(scc)) {
+      contextFreeUseAnalyze(members.front());
+      continue;
+    }
+
+    for (G4_BB *bb : members) {
+      unsigned po = sccs.getPONumber(bb);
+      bbByPONumber[po] = bb;
+      onWorklist[po] = true;
+      worklist.push(po);
+    }
+    while (!worklist.empty()) {
+      unsigned po = worklist.top();
+      worklist.pop();
+      onWorklist[po] = false;
+      G4_BB *bb = bbByPONumber[po];
+      if (!contextFreeUseAnalyze(bb))
+        continue;
+      for (G4_BB *predBB : bb->Preds) {
+        if (sccs.getSCC(predBB) != scc)
+          continue;
+        unsigned predPO = sccs.getPONumber(predBB);
+        if (!onWorklist[predPO]) {
+          bbByPONumber[predPO] = predBB;
+          onWorklist[predPO] = true;
+          worklist.push(predPO);
+        }
+      }
     }
-    changed = (old != def_in[bbid]);
   }
+}
 
-  def_out[bb->getId()] |= def_in[bb->getId()];
+//
+// Worklist solver for the forward def analysis; the mirror image of
+// solveUses(): SCCs in topological order and reverse post-order within an SCC.
+//
+void LivenessAnalysis::solveDefs(const LivenessSCCs &sccs) {
+  std::priority_queue<unsigned> worklist;
+  std::vector<G4_BB *> bbByPONumber(numBBId);
+  std::vector<bool> onWorklist(numBBId, false);
+
+  for (unsigned scc = sccs.getNumSCCs(); scc-- != 0;) {
+    const std::vector<G4_BB *> &members = sccs.getMembers(scc);
+    if (!sccs.isCyclic(scc)) {
+      contextFreeDefAnalyze(members.front());
+      continue;
+    }
 
-  return changed;
+    for (G4_BB *bb : members) {
+      unsigned po = sccs.getPONumber(bb);
+      bbByPONumber[po] = bb;
+      onWorklist[po] = true;
+      worklist.push(po);
+    }
+    while (!worklist.empty()) {
+      unsigned po = worklist.top();
+      worklist.pop();
+      onWorklist[po] = false;
+      G4_BB *bb = bbByPONumber[po];
+      if (!contextFreeDefAnalyze(bb))
+        continue;
+      for (G4_BB *succBB : bb->Succs) {
+        if (sccs.getSCC(succBB) != scc)
+          continue;
+        unsigned succPO = sccs.getPONumber(succBB);
+        if (!onWorklist[succPO]) {
+          bbByPONumber[succPO] = succBB;
+          onWorklist[succPO] = true;
+          worklist.push(succPO);
+        }
+      }
+    }
+  }
 }
 
 void LivenessAnalysis::dump_bb_vector(char *vname, std::vector<BitSet> &vec) {
@@ -3023,6 +3279,11 @@ int regAlloc(IR_Builder &builder, PhyRegPool &regPool, G4_Kernel &kernel) {
     gra.verifyRA(liveAnalysis);
   }
 
+  if (builder.getOption(vISA_DumpBankConflictReport) &&
+      builder.hasBankCollision()) {
+    gra.reportBankConflicts(std::cerr);
+  }
+
   // printf("EU Fusion WA insts for func: %s\n", kernel.getName());
   for (auto inst : gra.getEUFusionCallWAInsts()) {
     kernel.setMaskOffset(inst, InstOpt_M16);
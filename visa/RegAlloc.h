@@ -56,6 +56,30 @@ struct VarRangeListPackage {
   VAR_RANGE_LIST list;
 };
 
+// Strongly connected components of the BBs reachable from the entry BB
+// following all successor edges, as used by the context-free liveness
+// solvers. SCCs are numbered in reverse topological order, i.e. every SCC
+// comes before the SCCs that have edges into it.
+class LivenessSCCs {
+  std::vector<unsigned> poNumber;
+  std::vector<unsigned> sccId;
+  std::vector<std::vector<G4_BB *>> SCCs;
+
+public:
+  LivenessSCCs(G4_BB *entryBB, unsigned numBBId);
+
+  unsigned getNumSCCs() const { return static_cast<unsigned>(SCCs.size()); }
+  const std::vector<G4_BB *> &getMembers(unsigned scc) const {
+    return SCCs[scc];
+  }
+  // Returns UINT_MAX for BBs unreachable from the entry BB.
+  unsigned getSCC(const G4_BB *bb) const { return sccId[bb->getId()]; }
+  unsigned getPONumber(const G4_BB *bb) const { return poNumber[bb->getId()]; }
+  // True if the SCC contains a cycle, i.e. it has more than one BB or its
+  // only BB branches to itself.
+  bool isCyclic(unsigned scc) const;
+};
+
 class LivenessAnalysis {
   unsigned numVarId = 0;           // the var count
   unsigned numSplitVar = 0;        // the split var count
@@ -69,13 +93,30 @@ class LivenessAnalysis {
   const PointsToAnalysis &pointsToAnalysis;
   std::unordered_map<G4_Declare *, BitSet> neverDefinedRows;
   std::unordered_set<const G4_Declare *> defWriteEnable;
+  // Reuse gen/kill sets of BBs left unchanged since the previous RA
+  // iteration (see IncrementalRA::BBSummary).
+  bool incrementalGenKill = false;
+  // Generation of the BB summaries recorded by this liveness, 0 if none.
+  uint64_t bbSummaryGeneration = 0;
+
+  // Pseudo kills to insert, with the instruction each goes before.
+  using PseudoKillList = std::vector<std::pair<G4_Declare *, INST_LIST_ITER>>;
 
   void computeGenKillandPseudoKill(G4_BB *bb, SparseBitVector &def_out,
                                    SparseBitVector &use_in, SparseBitVector &use_gen,
                                    SparseBitVector &use_kill) const;
-
-  bool contextFreeUseAnalyze(G4_BB *bb, bool isChanged);
-  bool contextFreeDefAnalyze(G4_BB *bb, bool isChanged);
+  void computeGenKill(G4_BB *bb, SparseBitVector &def_out,
+                      SparseBitVector &use_in, SparseBitVector &use_gen,
+                      SparseBitVector &use_kill,
+                      PseudoKillList &pseudoKills) const;
+  void insertPseudoKills(G4_BB *bb, const PseudoKillList &pseudoKills) const;
+  std::vector<uint64_t> computeBBKey(G4_BB *bb) const;
+  void computeGenKillIncrementally(G4_BB *bb);
+
+  bool contextFreeUseAnalyze(G4_BB *bb);
+  bool contextFreeDefAnalyze(G4_BB *bb);
+  void solveUses(const LivenessSCCs &sccs);
+  void solveDefs(const LivenessSCCs &sccs);
 
   bool livenessCandidate(const G4_Declare *decl, bool verifyRA) const;
 
@@ -137,6 +178,7 @@ public:
     return addr_taken.isSet(num);
   }
   unsigned int getSelectedRF() const { return selectedRF; }
+  uint64_t getBBSummaryGeneration() const { return bbSummaryGeneration; }
   static bool livenessClass(G4_RegFileKind kind1, G4_RegFileKind kind2) {
     return (kind1 & kind2) != 0;
   }
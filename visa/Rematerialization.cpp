@@ -1145,4 +1145,242 @@ void Rematerialization::run() {
 
   kernel.dumpToFile("after.remat");
 }
+
+bool Rematerialization::isCheapSpillRemat(
+    G4_Declare *dcl, const std::vector<SpillRematUse> &uses,
+    const Reference *&uniqueDef) {
+  // A spilled range is rematerialized instead of spilled when:
+  // - it has a single def that is a plain ALU instruction,
+  // - the def's sources are immediates, inputs (payload, live-in args) or
+  //   loop invariant values, and
+  // - each source is still live at every use so that no other range has to
+  //   be extended.
+  // Each use then costs one instruction, which is cheaper than a fill.
+  if (uses.empty() || uses.size() > MAX_USES_REMAT)
+    return false;
+
+  if (dcl->getAddressed() || dcl->getSpilledDeclare() || dcl->isInput() ||
+      dcl->getRegVar()->getPhyReg() || dcl->getRegFile() != G4_GRF)
+    return false;
+
+  auto opIt = operations.find(dcl);
+  if (opIt == operations.end() || opIt->second.def.size() != 1)
+    return false;
+
+  auto &&refs = opIt->second;
+  auto defInst = refs.def.front().first;
+  auto defBB = refs.def.front().second;
+
+  if (!isRematCandidateOp(defInst) || defInst->isSend() ||
+      defInst->isIntrinsic() || defInst->getCondMod() ||
+      defInst->getPredicate() || gra.isNoRemat(defInst))
+    return false;
+
+  if (defInst->getDst()->isIndirect())
+    return false;
+
+  if (cr0DefBB && IS_TYPE_FLOAT_ALL(defInst->getExecType()))
+    return false;
+
+  unsigned int defLexId = defInst->getLexicalId();
+  for (auto &use : uses) {
+    auto useInst = *use.instIt;
+    auto useSrc = useInst->getSrc(use.srcNum)->asSrcRegRegion();
+
+    if (useInst->isSplitIntrinsic() || useSrc->isIndirect())
+      return false;
+
+    G4_AccRegSel accRegSel = useSrc->getAccRegSel();
+    if (accRegSel != ACC_UNDEFINED && accRegSel != NOACC)
+      return false;
+
+    if (useInst->getLexicalId() <= defLexId ||
+        !inSameSubroutine(use.bb, defBB))
+      return false;
+
+    // The def has to produce the whole region read by the use.
+    if (findUniqueDef(refs, useSrc) != &refs.def.front())
+      return false;
+
+    if (!defBB->isDivergent() && use.bb->isDivergent() &&
+        !defInst->isWriteEnableInst() && useInst->isWriteEnableInst())
+      return false;
+  }
+
+  for (unsigned int i = 0, numSrc = defInst->getNumSrc(); i < numSrc; i++) {
+    auto src = defInst->getSrc(i);
+    if (!src || src->isImm() || src->isNullReg())
+      continue;
+
+    if (!src->isSrcRegRegion() || !src->getBase()->isRegVar() ||
+        src->asSrcRegRegion()->isIndirect())
+      return false;
+
+    auto srcRgn = src->asSrcRegRegion();
+    auto srcDcl = srcRgn->getTopDcl();
+    if (!srcDcl || srcDcl->getAddressed() || srcDcl->isSpilled() ||
+        srcDcl->getSpilledDeclare() ||
+        !srcDcl->getRegVar()->isRegAllocPartaker())
+      return false;
+
+    auto srcOpIt = operations.find(srcDcl);
+    if (srcOpIt == operations.end())
+      return false;
+
+    auto &&srcRefs = srcOpIt->second;
+    if (srcDcl->isInput()) {
+      // Payload or live-in arg that is never redefined.
+      if (!srcRefs.def.empty())
+        return false;
+    } else {
+      if (srcRgn->getBase()->asRegVar()->getPhyReg())
+        return false;
+
+      // Any other source must be loop invariant: a single def outside of
+      // loops that precedes the def of the spilled range.
+      auto srcDef = findUniqueDef(srcRefs, srcRgn);
+      if (!srcDef || srcRefs.def.size() != 1 ||
+          srcDef->second->getNestLevel() != 0 ||
+          srcDef->first->getLexicalId() >= defLexId ||
+          srcDef->first->getPredicate())
+        return false;
+    }
+
+    unsigned int id = srcDcl->getRegVar()->getId();
+    for (auto &use : uses) {
+      unsigned int useLexId = (*use.instIt)->getLexicalId();
+      if (srcRefs.lastUseLexId >= useLexId || liveness.isLiveAtExit(use.bb, id))
+        continue;
+
+      if (srcDcl->isInput() && isPartGRFBusyInput(srcDcl, useLexId))
+        continue;
+
+      return false;
+    }
+  }
+
+  uniqueDef = &refs.def.front();
+  return true;
+}
+
+void Rematerialization::rematerializeSpill(
+    G4_Declare *dcl, const Reference *uniqueDef,
+    const std::vector<SpillRematUse> &uses) {
+  // Uses within a BB that are close to each other share one remat'd value.
+  // <Remat'd def, Lexical id of last ref>
+  std::unordered_map<G4_BB *, std::pair<G4_INST *, unsigned int>> rematValues;
+  auto defDst = uniqueDef->first->getDst();
+
+  for (auto &use : uses) {
+    auto useInst = *use.instIt;
+    auto src = useInst->getSrc(use.srcNum)->asSrcRegRegion();
+    unsigned int useLexId = useInst->getLexicalId();
+    G4_SrcRegRegion *rematSrc = nullptr;
+
+    auto prevRematIt = rematValues.find(use.bb);
+    if (prevRematIt != rematValues.end() &&
+        (useLexId - prevRematIt->second.second) <=
+            MAX_LOCAL_REMAT_REUSE_DISTANCE) {
+      rematSrc = createSrcRgn(src, defDst,
+                              prevRematIt->second.first->getDst()->getTopDcl());
+      prevRematIt->second.second = useLexId;
+    } else {
+      std::list<G4_INST *> newInsts;
+      G4_INST *cacheInst = nullptr;
+      rematSrc = rematerialize(src, use.bb, uniqueDef, newInsts, cacheInst);
+
+      while (!newInsts.empty()) {
+        use.bb->insertBefore(use.instIt, newInsts.front());
+        if (newInsts.front()->isWriteEnableInst() &&
+            gra.EUFusionNoMaskWANeeded()) {
+          gra.addEUFusionNoMaskWAInst(use.bb, newInsts.front());
+        }
+        // The REMAT_ temps may spill in turn; they must not be rematerialized
+        // again, or each RA iteration would just clone them once more.
+        gra.addNoRemat(newInsts.front());
+        newInsts.pop_front();
+      }
+
+      rematValues[use.bb] = std::make_pair(cacheInst, useLexId);
+    }
+
+    if (src->getAccRegSel() == NOACC) {
+      rematSrc->setAccRegSel(NOACC);
+    }
+
+    useInst->setSrc(rematSrc, use.srcNum);
+  }
+
+  // The spilled range is now dead.
+  uniqueDef->second->remove(uniqueDef->first);
+  auto &&refs = operations[dcl];
+  refs.def.clear();
+  refs.numUses = 0;
+  IRChanged = true;
+}
+
+unsigned int Rematerialization::rematerializeSpills() {
+  populateRefs();
+
+  std::unordered_map<G4_Declare *, std::vector<SpillRematUse>> spillUses;
+  for (auto &&lr : coloring.getSpilledLiveRanges()) {
+    spillUses[lr->getDcl()->getRootDeclare()];
+  }
+
+  // Collect the uses of all spilled ranges. Pseudo kills and lifetime ends are
+  // not uses; they are deleted along with a remat'd range.
+  std::unordered_map<G4_Declare *, std::vector<Reference>> pseudoRefs;
+  auto firstProgInst = kernel.fg.getEntryBB()->getFirstInst();
+  for (auto bb : kernel.fg) {
+    for (auto instIt = bb->begin(); instIt != bb->end(); ++instIt) {
+      auto inst = *instIt;
+      auto dst = inst->getDst();
+      cr0DefBB |= dst && dst->isCrReg() && (inst != firstProgInst);
+
+      if (inst->isPseudoKill() || inst->isLifeTimeEnd()) {
+        G4_Operand *opnd = inst->isPseudoKill()
+                               ? static_cast<G4_Operand *>(dst)
+                               : inst->getSrc(0);
+        auto topdcl = opnd ? opnd->getTopDcl() : nullptr;
+        if (topdcl && spillUses.count(topdcl))
+          pseudoRefs[topdcl].push_back(std::make_pair(inst, bb));
+        continue;
+      }
+
+      for (unsigned int i = 0, numSrc = inst->getNumSrc(); i < numSrc; i++) {
+        auto src = inst->getSrc(i);
+        if (!src || !src->isSrcRegRegion())
+          continue;
+
+        auto usesIt = spillUses.find(src->getTopDcl());
+        if (usesIt != spillUses.end())
+          usesIt->second.push_back({bb, instIt, i});
+      }
+    }
+  }
+
+  unsigned int numRematted = 0;
+  for (auto &&lr : coloring.getSpilledLiveRanges()) {
+    auto dcl = lr->getDcl()->getRootDeclare();
+    auto usesIt = spillUses.find(dcl);
+    // A root may be reached from several spilled live ranges.
+    if (usesIt == spillUses.end())
+      continue;
+
+    const Reference *uniqueDef = nullptr;
+    if (isCheapSpillRemat(dcl, usesIt->second, uniqueDef)) {
+      rematerializeSpill(dcl, uniqueDef, usesIt->second);
+      for (auto &ref : pseudoRefs[dcl]) {
+        ref.second->remove(ref.first);
+      }
+      numRematted++;
+    }
+    spillUses.erase(usesIt);
+  }
+
+  if (numRematted > 0)
+    kernel.dumpToFile("after.remat_spills");
+
+  return numRematted;
+}
 } // namespace vISA
@@ -50,6 +50,13 @@ public:
   std::unordered_set<unsigned int> rowsUsed;
 };
 
+// A source operand reading a spilled range.
+struct SpillRematUse {
+  G4_BB *bb;
+  INST_LIST_ITER instIt;
+  unsigned int srcNum;
+};
+
 class Rematerialization {
 private:
   G4_Kernel &kernel;
@@ -176,6 +183,11 @@ private:
   bool inSameSubroutine(G4_BB *, G4_BB *);
 
   bool isPartGRFBusyInput(G4_Declare *inputDcl, unsigned int atLexId);
+  bool isCheapSpillRemat(G4_Declare *dcl,
+                         const std::vector<SpillRematUse> &uses,
+                         const Reference *&uniqueDef);
+  void rematerializeSpill(G4_Declare *dcl, const Reference *uniqueDef,
+                          const std::vector<SpillRematUse> &uses);
 
 public:
   Rematerialization(G4_Kernel &k, const LivenessAnalysis &l, GraphColor &c,
@@ -200,7 +212,7 @@ public:
 
       // Mark all simultaneously live variables as remat candidates
       unsigned int spillId = dcl->getRegVar()->getId();
-      const auto &intfVec = coloring.getIntf()->getSparseIntfForVar(spillId);
+      auto intfVec = coloring.getIntf()->getSparseIntfForVar(spillId);
 
       for (auto intfId : intfVec) {
         rematCandidates[intfId] = true;
@@ -238,6 +250,12 @@ public:
   bool getChangesMade() const { return IRChanged; }
 
   void run();
+
+  // Instead of spilling a range whose only def is cheap to recompute at its
+  // uses (a constant, a payload value or an address computed from live-in
+  // args), re-emit that def before each use and delete the range. Returns
+  // the number of spilled ranges removed this way.
+  unsigned int rematerializeSpills();
 };
 } // namespace vISA
 #endif
@@ -248,13 +248,9 @@ bool CoalesceSpillFills::fillHeuristic(
     std::list<INST_LIST_ITER> &instList,
     const std::list<INST_LIST_ITER> &origInstList, unsigned int &min,
     unsigned int &max) {
-#if 0
-    std::bitset<8> bits(0);
-    vISA_ASSERT(cMaxFillPayloadSize == 8, "Handle other max fill payload size");
-#else
-  std::bitset<4> bits(0);
-  vISA_ASSERT(cMaxFillPayloadSize == 4, "Handle other max fill payload size");
-#endif
+  std::bitset<8> bits(0);
+  vISA_ASSERT(maxFillPayloadSize == 4 || maxFillPayloadSize == 8,
+              "Handle other max fill payload size");
 
   if (coalesceableFills.size() <= 1) {
     return false;
@@ -361,6 +357,21 @@ bool CoalesceSpillFills::fillHeuristic(
       // 1001
       return false;
     }
+  } else {
+    // Will emit an 8GRF read. Require that at least half of the rows read
+    // are used so that the wider message doesn't mostly load rows that are
+    // dead, which would also needlessly raise register pressure.
+    vISA_ASSERT(max - min < maxFillPayloadSize,
+                "Unexpected fills coalesced beyond max payload size");
+    std::bitset<8> rows(0);
+    for (const auto &f : coalesceableFills) {
+      unsigned int scratchOffset, scratchSize;
+      getScratchMsgInfo(*f, scratchOffset, scratchSize);
+      for (auto i = scratchOffset; i < (scratchOffset + scratchSize); i++)
+        rows.set(i - min);
+    }
+    if (rows.count() < 4)
+      return false;
   }
 
   return true;
@@ -436,22 +447,22 @@ void CoalesceSpillFills::sendsInRange(std::list<INST_LIST_ITER> &instList,
 
       // Check whether min/max can be extended
       if (scratchOffset <= min &&
-          (min - scratchOffset) <= (cMaxFillPayloadSize - 1) &&
-          (max - scratchOffset) <= (cMaxFillPayloadSize - 1) &&
+          (min - scratchOffset) <= (maxPayloadSize - 1) &&
+          (max - scratchOffset) <= (maxPayloadSize - 1) &&
           notOOB(scratchOffset, max)) {
         // This instruction can be coalesced
         min = scratchOffset;
         if (max < lastScratchOffset)
           max = lastScratchOffset;
 
-        // vISA_ASSERT(max - min <= (cMaxFillPayloadSize - 1), "Unexpected
+        // vISA_ASSERT(max - min <= (maxPayloadSize - 1), "Unexpected
         // fills coalesced. (max - min) is out of bounds - 1");
 
         coalescable.push_back(*iter);
         iter = instList.erase(iter);
       } else if (scratchOffset >= max &&
-                 (lastScratchOffset - min) <= (cMaxFillPayloadSize - 1) &&
-                 (lastScratchOffset - max) <= (cMaxFillPayloadSize - 1) &&
+                 (lastScratchOffset - min) <= (maxPayloadSize - 1) &&
+                 (lastScratchOffset - max) <= (maxPayloadSize - 1) &&
                  notOOB(min, scratchOffset)) {
         max = lastScratchOffset;
 
@@ -598,7 +609,12 @@ void CoalesceSpillFills::keepConsecutiveSpills(
 
   while (allowed.size() > 1) {
     unsigned int slots = maxOffset - minOffset + 1;
-    if (slots == 2 || slots == 4) {
+    // LSC expansion splits a non-NoMask spill wider than 4 GRFs back into
+    // 4 GRF messages when GRFs are wider than 32 bytes, so only coalesce 8
+    // GRFs where a single message is emitted.
+    bool allow8GRF = maxPayloadSize >= 8 &&
+                     (useNoMask || kernel.numEltPerGRF<Type_UB>() <= 32);
+    if (slots == 2 || slots == 4 || (slots == 8 && allow8GRF)) {
       // Insert coalescable spills in order of appearance
       for (const auto &origInst : origInstList) {
         for (const auto &allowedSpills : allowed) {
@@ -654,8 +670,8 @@ CoalesceSpillFills::analyzeSpillCoalescing(std::list<INST_LIST_ITER> &instList,
   unsigned int min, max;
   G4_InstOption mask;
   bool useNoMask;
-  keepConsecutiveSpills(instList, coalesceableSpills, cMaxSpillPayloadSize, min,
-                        max, useNoMask, mask);
+  keepConsecutiveSpills(instList, coalesceableSpills, maxSpillPayloadSize,
+                        min, max, useNoMask, mask);
   if (coalesceableSpills.size() > 1) {
     coalesceSpills(coalesceableSpills, min, max, useNoMask, mask, bb);
   } else {
@@ -693,7 +709,7 @@ CoalesceSpillFills::analyzeFillCoalescing(std::list<INST_LIST_ITER> &instList,
   std::list<INST_LIST_ITER> coalesceableFills;
   auto origInstList = instList;
   unsigned int min, max;
-  sendsInRange(instList, coalesceableFills, cMaxFillPayloadSize, min, max);
+  sendsInRange(instList, coalesceableFills, maxFillPayloadSize, min, max);
 
   bool heuristic =
       fillHeuristic(coalesceableFills, instList, origInstList, min, max);
@@ -1893,7 +1909,22 @@ void CoalesceSpillFills::removeRedundantWrites() {
   }
 }
 
+void CoalesceSpillFills::setMaxPayloadSizes() {
+  maxFillPayloadSize = cMaxFillPayloadSize;
+  maxSpillPayloadSize = cMaxSpillPayloadSize;
+  // LSC spill/fill expansion emits up to 8 GRFs per message. Wider coalescing
+  // is opt-in until it has been measured on workloads. It only widens the
+  // messages of the existing per-BB coalescing.
+  if ((gra.useLscForNonStackCallSpillFill || gra.useLscForSpillFill) &&
+      kernel.getOptions()->getuInt32Option(vISA_SpillCoalescingMaxGRFs) >= 8) {
+    maxFillPayloadSize = 8;
+    maxSpillPayloadSize = 8;
+  }
+}
+
 void CoalesceSpillFills::run() {
+  setMaxPayloadSizes();
+
   removeRedundantSplitMovs();
 
   fills();
@@ -38,6 +38,12 @@ private:
   const unsigned int cHighRegPressureForWindow = 70;
   const unsigned int cInputSizeLimit = 70;
 
+  // Widest fill/spill message that coalescing may create, in GRFs. LSC
+  // spill/fill messages carry up to 8 GRFs; other messages use the 4 GRF
+  // limits above.
+  unsigned int maxFillPayloadSize = 0;
+  unsigned int maxSpillPayloadSize = 0;
+
   unsigned int fillWindowSizeThreshold = 0;
   unsigned int spillWindowSizeThreshold = 0;
   unsigned int highRegPressureForCleanup = 0;
@@ -90,6 +96,7 @@ private:
   void removeRedundantSplitMovs();
   G4_Declare *createCoalescedSpillDcl(unsigned int);
   void populateSendDstDcl();
+  void setMaxPayloadSizes();
   void spillFillCleanup();
   void removeRedundantWrites();
 
@@ -374,8 +374,7 @@ unsigned SpillManagerGRF::calculateSpillDisp(G4_RegVar *regVar) const {
                       : regVar->getId();
   vASSERT(lrId < varIdCount_);
 
-  const std::vector<unsigned int> &intfs =
-      spillIntf_->getSparseIntfForVar(lrId);
+  auto intfs = spillIntf_->getSparseIntfForVar(lrId);
   for (auto edge : intfs) {
     auto lrEdge = getRegVar(edge);
     if (lrEdge->isRegVarTransient())
@@ -7,9 +7,13 @@ SPDX-License-Identifier: MIT
 ============================= end_copyright_notice ===========================*/
 
 #include "Timer.h"
+#include "Arena.h"
 #include "Assertions.h"
+#include "CompileTrace.h"
 #include "Option.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -98,31 +102,45 @@ bool QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount) {
 
 namespace vISA {
 
+// Timers may be started and stopped concurrently by threads finalizing
+// different kernels (see vISA_CompileThreads). The start time of a running
+// timer is kept per thread and the accumulated ticks/hits are atomic, so the
+// reported time of a phase is the sum over all threads.
 struct Timer {
-  double time;
-  LONGLONG currentStart;
   const char *name;
-  LONGLONG ticks;
-  bool started;
-  unsigned int hits;
+  std::atomic<LONGLONG> ticks;
+  std::atomic<unsigned int> hits;
 };
 
 } // namespace vISA
 
 static vISA::Timer timers[static_cast<int>(TimerID::NUM_TIMERS)];
+static thread_local LONGLONG timerStarts[static_cast<int>(TimerID::NUM_TIMERS)];
+#if defined(_DEBUG) && defined(CHECK_TIMER)
+static thread_local bool timerStarted[static_cast<int>(TimerID::NUM_TIMERS)];
+#endif
+static thread_local uint64_t traceStarts[static_cast<int>(TimerID::NUM_TIMERS)];
+static thread_local PhaseMemoryProfile *memoryProfile = nullptr;
+static thread_local bool memoryStarted[static_cast<int>(TimerID::NUM_TIMERS)];
+// High-water mark of the enclosing phases when a phase was started.
+static thread_local size_t
+    savedHighWater[static_cast<int>(TimerID::NUM_TIMERS)];
 static LARGE_INTEGER proc_freq;
 static int numTimers = static_cast<int>(TimerID::NUM_TIMERS);
 
+static double getTimerTime(unsigned int idx) {
+  if (proc_freq.QuadPart == 0)
+    return 0;
+  return timers[idx].ticks / (double)proc_freq.QuadPart;
+}
+
 void initTimer() {
 
 #ifdef MEASURE_COMPILATION_TIME
   numTimers = 0;
   for (int i = 0; i < static_cast<int>(TimerID::NUM_TIMERS); i++) {
-    timers[i].time = 0;
-    timers[i].currentStart = 0;
     timers[i].name = NULL;
     timers[i].ticks = 0;
-    timers[i].started = false;
     timers[i].hits = 0;
     createNewTimer(timerNames[i]);
   }
@@ -140,10 +158,7 @@ void resetPerKernel() {
         ti == TimerID::VISA_BUILDER_IR_CONSTRUCTION) {
       continue;
     }
-    timers[i].time = 0;
-    timers[i].currentStart = 0;
     timers[i].ticks = 0;
-    timers[i].started = false;
     timers[i].hits = 0;
   }
 }
@@ -153,12 +168,54 @@ int createNewTimer(const char *name) {
   return numTimers++;
 }
 
+const char *getTimerName(TimerID timerId) {
+  const char *name = timerNames[static_cast<int>(timerId)];
+  while (*name == '\t' || *name == ' ')
+    ++name;
+  return name;
+}
+
+PhaseMemoryScope::PhaseMemoryScope(PhaseMemoryProfile *profile)
+    : savedProfile(memoryProfile) {
+  memoryProfile = profile;
+}
+
+PhaseMemoryScope::~PhaseMemoryScope() { memoryProfile = savedProfile; }
+
+static void startPhaseMemory(int timer) {
+  size_t reserved = vISA::ArenaTotals::getReservedBytes();
+  memoryStarted[timer] = true;
+  savedHighWater[timer] = vISA::ArenaTotals::getThreadHighWater();
+  vISA::ArenaTotals::setThreadHighWater(reserved);
+  PhaseMemoryStats &phase = memoryProfile->phases[timer];
+  if (phase.hits == 0)
+    phase.startBytes = reserved;
+}
+
+static void stopPhaseMemory(int timer) {
+  size_t reserved = vISA::ArenaTotals::getReservedBytes();
+  size_t peak = std::max(vISA::ArenaTotals::getThreadHighWater(), reserved);
+  memoryStarted[timer] = false;
+  PhaseMemoryStats &phase = memoryProfile->phases[timer];
+  phase.hits++;
+  phase.endBytes = reserved;
+  phase.peakBytes = std::max(phase.peakBytes, peak);
+  phase.numArenas = vISA::ArenaTotals::getNumArenas();
+  phase.wastedBytes = vISA::ArenaTotals::getWastedBytes();
+  // The enclosing phases have seen this peak as well.
+  vISA::ArenaTotals::setThreadHighWater(std::max(savedHighWater[timer], peak));
+}
+
 void startTimer(TimerID timerId) {
   int timer = static_cast<int>(timerId);
+  if (CompileTrace::isEnabled() && isPhaseTimer(timerId))
+    traceStarts[timer] = CompileTrace::Recorder::get().now();
+  if (memoryProfile && isPhaseTimer(timerId))
+    startPhaseMemory(timer);
 #ifdef MEASURE_COMPILATION_TIME
   if (timer < static_cast<int>(TimerID::NUM_TIMERS)) {
 #if defined(_DEBUG) && defined(CHECK_TIMER)
-    if (timers[timer].started) {
+    if (timerStarted[timer]) {
       std::cerr << "***********************************************\n";
       std::cerr << "Timer already started.\n";
       vASSERT(false);
@@ -166,10 +223,10 @@ void startTimer(TimerID timerId) {
 #endif
     LARGE_INTEGER start;
     QueryPerformanceCounter(&start);
-    timers[timer].currentStart = start.QuadPart;
+    timerStarts[timer] = start.QuadPart;
     timers[timer].hits++;
 #if defined(_DEBUG) && defined(CHECK_TIMER)
-    timers[timer].started = true;
+    timerStarted[timer] = true;
 #endif
   } else {
 #ifdef _DEBUG
@@ -182,16 +239,30 @@ void startTimer(TimerID timerId) {
 
 void stopTimer(TimerID timerId) {
   int timer = static_cast<int>(timerId);
+  // A timer may be stopped on another thread than it was started on (e.g.
+  // TOTAL when the builder is destroyed); such events are dropped.
+  if (CompileTrace::isEnabled() && isPhaseTimer(timerId) &&
+      traceStarts[timer]) {
+    CompileTrace::Recorder::get().record(
+        timerId == TimerID::IGA_ENCODER ? "IGA" : "vISA",
+        getTimerName(timerId), traceStarts[timer]);
+    traceStarts[timer] = 0;
+  }
+  // A phase may have been started before the profile was installed, or the
+  // profile may have been removed while it was running.
+  if (isPhaseTimer(timerId) && memoryStarted[timer]) {
+    if (memoryProfile)
+      stopPhaseMemory(timer);
+    memoryStarted[timer] = false;
+  }
 #ifdef MEASURE_COMPILATION_TIME
   if (timer < static_cast<int>(TimerID::NUM_TIMERS)) {
     LARGE_INTEGER stop;
     QueryPerformanceCounter(&stop);
-    timers[timer].time += (stop.QuadPart - timers[timer].currentStart) /
-                          (double)proc_freq.QuadPart;
-    timers[timer].ticks += (stop.QuadPart - timers[timer].currentStart);
-    timers[timer].currentStart = 0;
+    timers[timer].ticks += (stop.QuadPart - timerStarts[timer]);
+    timerStarts[timer] = 0;
 #if defined(_DEBUG) && defined(CHECK_TIMER)
-    timers[timer].started = false;
+    timerStarted[timer] = false;
 #endif
   } else {
 #ifdef _DEBUG
@@ -204,7 +275,7 @@ void stopTimer(TimerID timerId) {
 
 extern "C" unsigned int getTotalTimers() { return numTimers; }
 
-extern "C" double getTimerCounts(unsigned int idx) { return timers[idx].time; }
+extern "C" double getTimerCounts(unsigned int idx) { return getTimerTime(idx); }
 
 extern "C" int64_t getTimerTicks(unsigned int idx) { return timers[idx].ticks; }
 
@@ -224,7 +295,7 @@ void dumpAllTimers(const char *asmFileName, bool outputTime) {
   std::ofstream krnlOutput;
   krnlOutput.open("jit_time.txt", std::ios_base::app);
 
-  double totalTime = timers[static_cast<int>(TimerID::TOTAL)].time;
+  double totalTime = getTimerTime(static_cast<int>(TimerID::TOTAL));
   for (unsigned int i = 0; i < getTotalTimers(); i++) {
 #ifndef TIME_BUILDER
     TimerID ti = static_cast<TimerID>(i);
@@ -238,11 +309,11 @@ void dumpAllTimers(const char *asmFileName, bool outputTime) {
     krnlOutput << std::left << std::setw(24) << timerNames[i] << "\t";
     if (outputTime) {
       krnlOutput << std::left << std::setw(12) << std::setprecision(6)
-                 << timers[i].time << "\t";
+                 << getTimerTime(i) << "\t";
     } else {
-      krnlOutput << timers[i].ticks << "\t";
+      krnlOutput << timers[i].ticks.load() << "\t";
     }
-    krnlOutput << std::setprecision(4) << (timers[i].time / totalTime * 100)
+    krnlOutput << std::setprecision(4) << (getTimerTime(i) / totalTime * 100)
                << "%";
     krnlOutput << "\n";
   }
@@ -260,9 +331,9 @@ void dumpAllTimers(const char *asmFileName, bool outputTime) {
   for (unsigned i = 0, e = getTotalTimers(); i < e; i++) {
     timerFile << timerNames[i] << ":";
     if (outputTime) {
-      timerFile << timers[i].time << "\n";
+      timerFile << getTimerTime(i) << "\n";
     } else {
-      timerFile << timers[i].ticks << "\n";
+      timerFile << timers[i].ticks.load() << "\n";
     }
   }
   timerFile.close();
@@ -17,6 +17,8 @@ SPDX-License-Identifier: MIT
 
 #include "Option.h"
 
+#include <cstddef>
+
 // Timer library for the compiler
 // To collect compile time information, do the following:
 //
@@ -37,6 +39,37 @@ enum class TimerID {
   NUM_TIMERS
 };
 
+// Arena memory (see ArenaTotals) at the boundaries of one phase of a kernel.
+// Phases with several hits report the start of the first and the end of the
+// last hit.
+struct PhaseMemoryStats {
+  unsigned hits = 0;
+  size_t startBytes = 0;
+  size_t endBytes = 0;
+  // High-water mark of the reserved bytes while the phase was running.
+  size_t peakBytes = 0;
+  size_t numArenas = 0;
+  size_t wastedBytes = 0;
+};
+
+struct PhaseMemoryProfile {
+  PhaseMemoryStats phases[static_cast<int>(TimerID::NUM_TIMERS)];
+};
+
+// While a scope is live, the timer phases started and stopped by the calling
+// thread snapshot the arena memory into the given profile. This does not
+// depend on MEASURE_COMPILATION_TIME. When kernels are compiled concurrently
+// the totals include the memory of the other kernels.
+class PhaseMemoryScope {
+  PhaseMemoryProfile *savedProfile;
+
+public:
+  PhaseMemoryScope(PhaseMemoryProfile *profile);
+  ~PhaseMemoryScope();
+  PhaseMemoryScope(const PhaseMemoryScope &) = delete;
+  PhaseMemoryScope &operator=(const PhaseMemoryScope &) = delete;
+};
+
 int createNewTimer(const char *timerName);
 void initTimer();
 void startTimer(TimerID timer);
@@ -44,8 +77,20 @@ void stopTimer(TimerID timer);
 void dumpAllTimers(const char *asmFileName, bool outputTime = false);
 void dumpEncoderStats(Options *opt, std::string &asmName);
 void resetPerKernel();
+// Timer description without the indentation used by dumpAllTimers.
+const char *getTimerName(TimerID timer);
 // double getTimerUS(unsigned idx);
 
+// The builder timers are hit once per vISA instruction/variable/operand; they
+// are not compiler phases and are neither traced nor memory profiled.
+constexpr bool isPhaseTimer(TimerID timerId) {
+  return timerId != TimerID::VISA_BUILDER_APPEND_INST &&
+         timerId != TimerID::VISA_BUILDER_CREATE_VAR &&
+         timerId != TimerID::VISA_BUILDER_CREATE_OPND &&
+         timerId != TimerID::VISA_BUILDER_IR_CONSTRUCTION &&
+         timerId < TimerID::NUM_TIMERS;
+}
+
 struct TimerScope {
   const TimerID timerId;
   TimerScope(const TimerID _timerId) : timerId(_timerId) {
@@ -54,10 +99,26 @@ struct TimerScope {
   ~TimerScope() { stopTimer(timerId); }
 };
 
+// Without MEASURE_COMPILATION_TIME timers accumulate nothing, and only the
+// phase timers are started and stopped (for CompileTrace and
+// PhaseMemoryScope); the scopes of the builder timers compile to nothing.
+template <TimerID timerId> struct PhaseTimerScope {
+  static constexpr bool isPhase = isPhaseTimer(timerId);
+  PhaseTimerScope() {
+    if (isPhase)
+      startTimer(timerId);
+  }
+  ~PhaseTimerScope() {
+    if (isPhase)
+      stopTimer(timerId);
+  }
+};
+
 #if defined(MEASURE_COMPILATION_TIME)
 #define TIME_SCOPE(TIMER_ID) TimerScope __timerScope(TimerID::TIMER_ID);
 #else
-#define TIME_SCOPE(TIMER_ID)
+#define TIME_SCOPE(TIMER_ID)                                                   \
+  PhaseTimerScope<TimerID::TIMER_ID> __timerScope;
 #endif
 
 #undef DEF_TIMER
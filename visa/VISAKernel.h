@@ -15,6 +15,7 @@ SPDX-License-Identifier: MIT
 #include "JitterDataStruct.h"
 #include "KernelInfo.h"
 #include "Mem_Manager.h"
+#include "Timer.h"
 #include "VISABuilderAPIDefinition.h"
 #include "visa_wa.h"
 
@@ -1218,7 +1219,8 @@ private:
   void recordFinalizerInfo();
   // dump PERF_STATS into the .stats.json file
   // filename is the full path of output file name without the extension
-  void dumpPerfStatsInJson(const std::string &filename);
+  void dumpPerfStatsInJson(const std::string &filename, unsigned binarySize);
+  llvm::json::Object getMemoryStatsInJson() const;
 
   // Re-adjust indirect call target after swsb
   void adjustIndirectCallOffset();
@@ -1326,6 +1328,8 @@ private:
   // It is very important that the same allocator is used by all instruction
   // lists that might be joined/spliced.
   INST_LIST_NODE_ALLOCATOR m_instListNodeAllocator;
+  // Arena memory per phase, collected only when the JSON stats are dumped.
+  std::unique_ptr<PhaseMemoryProfile> m_phaseMemory;
   unsigned int m_inputSize;
   VISA_opnd m_fastPathOpndPool[vISA_NUMBER_OF_OPNDS_IN_POOL];
   unsigned int m_opndCounter;
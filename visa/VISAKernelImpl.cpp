@@ -21,6 +21,7 @@ SPDX-License-Identifier: MIT
 #include "Common_ISA.h"
 #include "Common_ISA_framework.h"
 #include "Common_ISA_util.h"
+#include "CompileTrace.h"
 #include "DebugInfo.h"
 #include "FlowGraph.h"
 #include "InstSplit.h"
@@ -119,6 +120,12 @@ int VISAKernelImpl::calculateTotalInputSize() {
 
 int VISAKernelImpl::compileFastPath() {
   int status = VISA_SUCCESS;
+  CompileTrace::KernelScope traceKernel(getName(), m_kernel->getSimdSize());
+  if (m_options->getOption(vISA_DumpPerfStats) ||
+      m_options->getOption(vISA_DumpPerfStatsVerbose)) {
+    m_phaseMemory = std::make_unique<PhaseMemoryProfile>();
+  }
+  PhaseMemoryScope phaseMemory(m_phaseMemory.get());
 
   vISA_ASSERT_INPUT(
       (getIsKernel() || getIsPayload() ||
@@ -337,6 +344,8 @@ void VISAKernelImpl::compilePostOptimize() {
 
 void *VISAKernelImpl::encodeAndEmit(unsigned int &binarySize) {
   void *binary = NULL;
+  CompileTrace::KernelScope traceKernel(getName(), m_kernel->getSimdSize());
+  PhaseMemoryScope phaseMemory(m_phaseMemory.get());
 
   //
   // Entry point to LIR conversion & transformations
@@ -450,9 +459,10 @@ void *VISAKernelImpl::encodeAndEmit(unsigned int &binarySize) {
   }
 
   if (m_options->getOption(vISA_asmToConsole)) {
-    m_kernel->emitDeviceAsm(std::cout, binary, binarySize);
-    emitPerfStats(std::cout);
-    std::cout.flush();
+    std::ostream &os = m_builder->consoleStream();
+    m_kernel->emitDeviceAsm(os, binary, binarySize);
+    emitPerfStats(os);
+    os.flush();
   } else if (m_options->getOption(vISA_outputToFile)) {
     std::stringstream ss;
     ss << m_asmName << ".asm";
@@ -475,7 +485,7 @@ void *VISAKernelImpl::encodeAndEmit(unsigned int &binarySize) {
     // set BinaryHash
     m_jitInfo->stats.binaryHash =
         std::hash<std::string>{}(std::string((char*)binary, binarySize));
-    dumpPerfStatsInJson(m_asmName);
+    dumpPerfStatsInJson(m_asmName, binarySize);
   }
 
   return binary;
@@ -639,9 +649,50 @@ void KERNEL_INFO::collectStats(G4_Kernel &kernel) {
   }
 }
 
+static llvm::json::Object toJSON(const ArenaStats &stats) {
+  return llvm::json::Object{
+      {"reservedBytes", static_cast<int64_t>(stats.reservedBytes)},
+      {"usedBytes", static_cast<int64_t>(stats.usedBytes)},
+      {"numArenas", static_cast<int64_t>(stats.numArenas)},
+      {"wastedBytes", static_cast<int64_t>(stats.wastedBytes)},
+  };
+}
+
+// Arena memory of the kernel's own managers, the process-wide arena peak and,
+// if collected, the arena totals at the boundaries of each phase.
+llvm::json::Object VISAKernelImpl::getMemoryStatsInJson() const {
+  llvm::json::Object memory{
+      {"kernelArena", toJSON(m_kernelMem->getStats())},
+      {"instListArena", toJSON(m_instListNodeAllocator.getStats())},
+      {"peakReservedBytes",
+       static_cast<int64_t>(ArenaTotals::getPeakReservedBytes())},
+  };
+  if (m_phaseMemory) {
+    llvm::json::Object phases;
+    for (int i = 0; i < static_cast<int>(TimerID::NUM_TIMERS); i++) {
+      const PhaseMemoryStats &phase = m_phaseMemory->phases[i];
+      if (phase.hits == 0)
+        continue;
+      phases.insert(
+          {getTimerName(static_cast<TimerID>(i)),
+           llvm::json::Object{
+               {"hits", phase.hits},
+               {"startBytes", static_cast<int64_t>(phase.startBytes)},
+               {"endBytes", static_cast<int64_t>(phase.endBytes)},
+               {"peakBytes", static_cast<int64_t>(phase.peakBytes)},
+               {"numArenas", static_cast<int64_t>(phase.numArenas)},
+               {"wastedBytes", static_cast<int64_t>(phase.wastedBytes)},
+           }});
+    }
+    memory.insert({"phases", std::move(phases)});
+  }
+  return memory;
+}
+
 // dump PERF_STATS into the .stats.json file
 // filename is the full path of output file name without the extension
-void VISAKernelImpl::dumpPerfStatsInJson(const std::string &filename) {
+void VISAKernelImpl::dumpPerfStatsInJson(const std::string &filename,
+                                         unsigned binarySize) {
   std::string outputName = filename + ".stats.json";
   if (!allowDump(*m_options, outputName)) {
     return;
@@ -655,6 +706,8 @@ void VISAKernelImpl::dumpPerfStatsInJson(const std::string &filename) {
   llvm::json::Value pv = m_jitInfo->stats;
   llvm::json::Object* po = pv.getAsObject();
   po->insert({"name", m_name});
+  po->insert({"binarySize", binarySize});
+  po->insert({"memory", getMemoryStatsInJson()});
 
   if (m_options->getOption(vISA_DumpPerfStatsVerbose)) {
     llvm::json::Value pvv = m_jitInfo->statsVerbose;
@@ -54,15 +54,26 @@ void LoopVarSplit::run() {
 
   sortedDcls.sort(SpillCostDesc);
 
-  // TODO: Iterating sequence based on spill cost may not be very accurate.
-  // Thats because long living variables typically have lower spill cost.
-  // But they may be referenced in some nested loop multiple times. In such
-  // cases, it is beneficial to split the variable around such loops. To
-  // accommodate such cases, we should be looking at reference count of
-  // variables in loops and iterate in an order based on that.
+  // Iterating based on spill cost alone is not very accurate: long living
+  // variables typically have lower spill cost, but they may be referenced in
+  // some nested loop multiple times, and splitting those around the loop
+  // removes the most spill code. So visit variables in descending order of
+  // the weight of their references inside loops, spill cost breaking ties.
+  if (kernel.getOption(vISA_SplitOnSpillByCost)) {
+    std::unordered_map<G4_Declare *, float> inLoopWeight;
+    for (const auto &var : sortedDcls)
+      inLoopWeight[var.first] = getInLoopRefWeight(var.first);
+    sortedDcls.sort([&](const std::pair<G4_Declare *, float> &first,
+                        const std::pair<G4_Declare *, float> &second) {
+      return inLoopWeight[first.first] > inLoopWeight[second.first];
+    });
+  }
+
   for (const auto &var : sortedDcls) {
     const auto &loops = getLoopsToSplitAround(var.first);
     for (auto &loop : loops) {
+      RA_TRACE(std::cout << "\t--split " << var.first->getName()
+                         << " around L" << loop->id << "\n");
       split(var.first, *loop);
     }
   }
@@ -578,6 +589,56 @@ G4_Declare *LoopVarSplit::getNewDcl(G4_Declare *dcl1, G4_Declare *dcl2,
   return newDcl;
 }
 
+// Weighted number of references of dcl in BBs that belong to a loop. Each
+// of them becomes a spill or a fill when dcl is spilled.
+float LoopVarSplit::getInLoopRefWeight(G4_Declare *dcl) {
+  float weight = 0.0f;
+  auto addRefs = [&](const auto *refs) {
+    if (!refs)
+      return;
+    for (auto &ref : *refs) {
+      auto bb = std::get<1>(ref);
+      if (kernel.fg.getLoops().getInnerMostLoop(bb))
+        weight += kernel.fg.getBlockWeight(bb);
+    }
+  };
+  addRefs(references.getDefs(dcl));
+  addRefs(references.getUses(dcl));
+  return weight;
+}
+
+// Spill code that splitting dcl around loop saves: the spills and fills of
+// its references in the loop, which are replaced by copies in the pre-header
+// and, if dcl is written in the loop, in the loop exit. A non-positive
+// benefit means the copies execute at least as often as the references,
+// e.g. when the loop is entered from a hotter region than its body.
+// Only loop boundaries are considered as split points.
+float LoopVarSplit::getSplitBenefit(G4_Declare *dcl, Loop &loop) {
+  float benefit = 0.0f;
+  bool written = false;
+  if (auto defs = references.getDefs(dcl)) {
+    for (auto &def : *defs) {
+      auto bb = std::get<1>(def);
+      if (loop.contains(bb)) {
+        benefit += kernel.fg.getBlockWeight(bb);
+        written = true;
+      }
+    }
+  }
+  if (auto uses = references.getUses(dcl)) {
+    for (auto &use : *uses) {
+      auto bb = std::get<1>(use);
+      if (loop.contains(bb))
+        benefit += kernel.fg.getBlockWeight(bb);
+    }
+  }
+
+  benefit -= kernel.fg.getBlockWeight(loop.preHeader);
+  if (written && loop.getLoopExits().size() == 1)
+    benefit -= kernel.fg.getBlockWeight(loop.getLoopExits().front());
+  return benefit;
+}
+
 std::vector<Loop *> LoopVarSplit::getLoopsToSplitAround(G4_Declare *dcl) {
   // return a list of Loop* around which variable dcl should be split
   std::vector<Loop *> loopsToSplitAround;
@@ -681,6 +742,17 @@ std::vector<Loop *> LoopVarSplit::getLoopsToSplitAround(G4_Declare *dcl) {
     if (dontSplit)
       continue;
 
+    // copies on the loop boundary must execute less often than the spill
+    // code they replace
+    if (kernel.getOption(vISA_SplitOnSpillByCost)) {
+      float benefit = getSplitBenefit(dcl, *loop);
+      RA_TRACE(std::cout << "\t--split cost of " << dcl->getName()
+                         << " around L" << loop->id << ": benefit " << benefit
+                         << (benefit <= 0.0f ? ", skipped" : "") << "\n");
+      if (benefit <= 0.0f)
+        continue;
+    }
+
     auto subRegAlign = coloring->getGRA().getSubRegAlign(dcl);
     // apply cost heuristic
     if (dcl->getNumElems() == 1 &&
@@ -73,6 +73,8 @@ private:
   G4_Declare *getNewDcl(G4_Declare *dcl1, G4_Declare *dcl2, const Loop &loop);
   std::vector<Loop *> getLoopsToSplitAround(G4_Declare *dcl);
   void adjustLoopMaxPressure(Loop &loop, unsigned int numRows);
+  float getInLoopRefWeight(G4_Declare *dcl);
+  float getSplitBenefit(G4_Declare *dcl, Loop &loop);
 
   G4_Kernel &kernel;
   GraphColor *coloring = nullptr;
@@ -0,0 +1,293 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2023 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#ifndef _COMPILETRACE_H_
+#define _COMPILETRACE_H_
+
+// Scoped compile-time event recorder shared by IGC and vISA.
+//
+// Events are recorded per thread and written as Chrome trace events
+// (chrome://tracing, Perfetto) in the JSON array format. Each event carries
+// the kernel and SIMD width that the recording thread is working on, as set
+// by the innermost KernelScope.
+//
+// The recorder is always compiled; while it is disabled the cost of a scope is
+// a relaxed atomic load. It is header only so that IGC and the vISA library
+// linked into it share a single instance.
+//
+// Typical use:
+//   CompileTrace::Recorder::get().enable("trace.json", CompileTrace::Phases);
+//   {
+//     CompileTrace::KernelScope kernel("foo", 16);
+//     CompileTrace::Scope phase("vISA", "RA");
+//     ...
+//   }
+//   CompileTrace::Recorder::get().flush();
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace CompileTrace {
+
+enum Level : unsigned {
+  Off = 0,
+  // Compiler phases: IGC time-stat intervals and vISA timers.
+  Phases = 1,
+  // Additionally every pass run by an IGC pass manager.
+  Passes = 2,
+};
+
+struct Event {
+  const char *category;
+  std::string name;
+  std::string kernel;
+  unsigned simd;
+  uint64_t startNS;
+  uint64_t durationNS;
+};
+
+class Recorder {
+public:
+  static Recorder &get() {
+    static Recorder recorder;
+    return recorder;
+  }
+
+  // Starts recording at the given level; events are appended to path on
+  // every flush(). Enabling an already enabled recorder only raises the level.
+  void enable(const char *path, unsigned level) {
+    if (!path || !*path || level == Off)
+      return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_path.empty())
+      m_path = path;
+    if (level > m_level.load(std::memory_order_relaxed))
+      m_level.store(level, std::memory_order_relaxed);
+  }
+
+  bool isEnabled(unsigned level = Phases) const {
+    return m_level.load(std::memory_order_relaxed) >= level;
+  }
+
+  uint64_t now() const {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_epoch)
+            .count());
+  }
+
+  // Records an event of the calling thread that started at startNS (as
+  // returned by now()) and ends now.
+  void record(const char *category, std::string name, uint64_t startNS) {
+    uint64_t endNS = now();
+    ThreadBuffer &buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({category, std::move(name), buffer.kernel,
+                             buffer.simd, startNS, endNS - startNS});
+  }
+
+  // Appends all events recorded so far to the trace file. The file is
+  // started with '[' and each event is followed by ",\n"; the closing ']' is
+  // optional in the Chrome trace format, which lets later flushes (and other
+  // compilations in the same process) keep appending to it.
+  void flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_path.empty())
+      return;
+    FILE *file = fopen(m_path.c_str(), m_fileStarted ? "a" : "w");
+    if (!file)
+      return;
+    if (!m_fileStarted) {
+      fputs("[\n", file);
+      m_fileStarted = true;
+    }
+    std::string line;
+    for (const auto &event : m_exitedEvents) {
+      formatEvent(event.second, event.first, line);
+      fputs(line.c_str(), file);
+    }
+    m_exitedEvents.clear();
+    for (auto &buffer : m_buffers) {
+      std::vector<Event> events;
+      {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        events.swap(buffer->events);
+      }
+      for (const Event &event : events) {
+        formatEvent(event, buffer->tid, line);
+        fputs(line.c_str(), file);
+      }
+    }
+    fclose(file);
+  }
+
+  // Attribution of the events recorded by the calling thread.
+  void setKernel(const std::string &kernel, unsigned simd) {
+    ThreadBuffer &buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.kernel = kernel;
+    buffer.simd = simd;
+  }
+  std::pair<std::string, unsigned> getKernel() {
+    ThreadBuffer &buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    return {buffer.kernel, buffer.simd};
+  }
+
+private:
+  struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::string kernel;
+    unsigned simd = 0;
+    unsigned tid = 0;
+  };
+
+  Recorder() : m_epoch(std::chrono::steady_clock::now()) {}
+  Recorder(const Recorder &) = delete;
+  Recorder &operator=(const Recorder &) = delete;
+
+  // Releases the buffer of a thread when the thread exits. Its unflushed
+  // events (e.g. of pool workers) are kept until the next flush().
+  struct ThreadBufferHandle {
+    ThreadBuffer *buffer = nullptr;
+    ~ThreadBufferHandle() {
+      if (buffer)
+        Recorder::get().releaseThreadBuffer(buffer);
+    }
+  };
+
+  ThreadBuffer &getThreadBuffer() {
+    thread_local ThreadBufferHandle handle;
+    if (!handle.buffer) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_buffers.push_back(std::make_unique<ThreadBuffer>());
+      handle.buffer = m_buffers.back().get();
+      handle.buffer->tid = ++m_lastTid;
+    }
+    return *handle.buffer;
+  }
+
+  void releaseThreadBuffer(ThreadBuffer *buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Event &event : buffer->events)
+      m_exitedEvents.emplace_back(buffer->tid, std::move(event));
+    for (auto it = m_buffers.begin(); it != m_buffers.end(); ++it) {
+      if (it->get() == buffer) {
+        m_buffers.erase(it);
+        break;
+      }
+    }
+  }
+
+  static void appendEscaped(std::string &out, const std::string &str) {
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char hex[8];
+        snprintf(hex, sizeof(hex), "\\u%04x", static_cast<unsigned char>(c));
+        out += hex;
+      } else {
+        out += c;
+      }
+    }
+  }
+
+  static void formatEvent(const Event &event, unsigned tid, std::string &out) {
+    char times[96];
+    snprintf(times, sizeof(times),
+             "\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", tid,
+             event.startNS / 1000.0, event.durationNS / 1000.0);
+    out = "{\"name\":\"";
+    appendEscaped(out, event.name);
+    out += "\",\"cat\":\"";
+    out += event.category;
+    out += "\",";
+    out += times;
+    if (!event.kernel.empty()) {
+      out += ",\"args\":{\"kernel\":\"";
+      appendEscaped(out, event.kernel);
+      out += "\"";
+      if (event.simd)
+        out += ",\"simd\":" + std::to_string(event.simd);
+      out += "}";
+    }
+    out += "},\n";
+  }
+
+  const std::chrono::steady_clock::time_point m_epoch;
+  std::atomic<unsigned> m_level{Off};
+  std::mutex m_mutex;
+  std::string m_path;
+  bool m_fileStarted = false;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+  unsigned m_lastTid = 0;
+  // Events of threads that exited before the last flush, with their tid.
+  std::vector<std::pair<unsigned, Event>> m_exitedEvents;
+};
+
+inline bool isEnabled(unsigned level = Phases) {
+  return Recorder::get().isEnabled(level);
+}
+
+// Records one event covering the lifetime of the scope.
+class Scope {
+public:
+  Scope(const char *category, const char *name, unsigned level = Phases)
+      : m_category(category), m_name(name), m_active(isEnabled(level)),
+        m_startNS(m_active ? Recorder::get().now() : 0) {}
+  ~Scope() {
+    if (m_active)
+      Recorder::get().record(m_category, m_name, m_startNS);
+  }
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  const char *m_category;
+  const char *m_name;
+  bool m_active;
+  uint64_t m_startNS;
+};
+
+// Attributes the events recorded by this thread within the scope to a kernel
+// (and SIMD width, 0 if unknown). Scopes nest; the previous attribution is
+// restored on exit.
+class KernelScope {
+public:
+  KernelScope(const std::string &kernel, unsigned simd)
+      : m_active(isEnabled()) {
+    if (m_active) {
+      m_saved = Recorder::get().getKernel();
+      Recorder::get().setKernel(kernel, simd);
+    }
+  }
+  ~KernelScope() {
+    if (m_active)
+      Recorder::get().setKernel(m_saved.first, m_saved.second);
+  }
+  KernelScope(const KernelScope &) = delete;
+  KernelScope &operator=(const KernelScope &) = delete;
+
+private:
+  bool m_active;
+  std::pair<std::string, unsigned> m_saved;
+};
+
+} // namespace CompileTrace
+
+#endif // _COMPILETRACE_H_
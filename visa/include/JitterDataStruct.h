@@ -80,6 +80,13 @@ public:
   uint32_t staticCycle = 0;
   uint32_t loopNestedStallCycle = 0;
   uint32_t loopNestedCycle = 0;
+
+  // Estimated cycles instructions stall waiting for a token to be released by
+  // an unrelated instruction that was assigned the same token, weighted by
+  // the expected execution count of the stalling block. The count is a block
+  // frequency with -blockFreqWeights or -freqBasedSpillCost when every block
+  // has one, and a 4^loop-depth weight otherwise.
+  float tokenStallCycles = 0;
 };
 
 // PERF_STATS_VERBOSE - the verbose vISA static performance stats.
@@ -152,6 +159,10 @@ struct PERF_STATS_VERBOSE {
   // Number of SIMD inteference edges.
   uint32_t augIntfNum = 0;
 
+  // Number of live ranges second-chance linear scan RA spilled because that
+  // was cheaper than evicting the active ranges, over all RA iterations.
+  uint32_t secondChanceSpillNum = 0;
+
   // preRA scheduler counters
   uint32_t minRegClusterCount;
   uint32_t minRegSUCount;
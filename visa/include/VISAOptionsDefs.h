@@ -232,6 +232,14 @@ DEF_VISA_OPTION(vISA_renderTargetWriteSendReloc, ET_BOOL,
         "Enables adding offsets of all Render Target Write send instructions to the relocation table.", false)
 DEF_VISA_OPTION(vISA_CodePatch, ET_INT32, "-codePatch", UNUSED, 0)
 DEF_VISA_OPTION(vISA_Linker, ET_INT32, "-linker", UNUSED, 0)
+// Number of worker threads used to compile the kernels and functions of one
+// builder concurrently. 0 or 1 compiles them one after another.
+DEF_VISA_OPTION(vISA_CompileThreads, ET_INT32, "-compileThreads",
+                "USAGE: -compileThreads <num>\n", 0)
+// Records compile phases as Chrome trace events and appends them to the
+// given file when the builder is destroyed.
+DEF_VISA_OPTION(vISA_CompileTraceFile, ET_CSTR, "-compileTrace",
+                "USAGE: -compileTrace <file>\n", NULL)
 DEF_VISA_OPTION(vISA_SSOShifter, ET_INT32, "-paddingSSOShifter", UNUSED, 0)
 DEF_VISA_OPTION(vISA_SkipPaddingScratchSpaceSize, ET_INT32, "-skipPaddingScratchSpaceSize", UNUSED, 4096)
 DEF_VISA_OPTION(vISA_enableInterleaveMacro, ET_BOOL, "-enableInterleaveMacro",
@@ -300,10 +308,20 @@ DEF_VISA_OPTION(vISA_LocalDeclareSplitInGlobalRA, ET_BOOL, "-noLocalSplit",
                 UNUSED, true)
 DEF_VISA_OPTION(vISA_DisableSpillCoalescing, ET_BOOL, "-nospillcleanup", UNUSED,
                 false)
+// Widest message, in GRFs, that spill/fill coalescing may create when
+// spills and fills use LSC messages (4 or 8). Coalescing only merges
+// spills/fills of one BB whose slots are already adjacent; spill slots are
+// not re-laid out to make more of them adjacent.
+DEF_VISA_OPTION(vISA_SpillCoalescingMaxGRFs, ET_INT32, "-spillCoalescingMaxGRFs",
+                "USAGE: -spillCoalescingMaxGRFs <4|8>\n", 4)
 DEF_VISA_OPTION(vISA_GlobalSendVarSplit, ET_BOOL, "-globalSendVarSplit", UNUSED,
                 false)
 DEF_VISA_OPTION(vISA_NoRemat, ET_BOOL, "-noremat", UNUSED, false)
 DEF_VISA_OPTION(vISA_ForceRemat, ET_BOOL, "-forceremat", UNUSED, false)
+// Rematerialize spilled ranges that are cheap to recompute instead of spilling
+// them to scratch. Opt-in; unlike the remat pass it is not limited to the SIMD
+// sizes that pass runs on.
+DEF_VISA_OPTION(vISA_RematSpills, ET_BOOL, "-rematSpills", UNUSED, false)
 DEF_VISA_OPTION(vISA_SpillMemOffset, ET_INT32, "-spilloffset",
                 "USAGE: -spilloffset <offset>\n", 0)
 DEF_VISA_OPTION(vISA_ReservedGRFNum, ET_INT32, "-reservedGRFNum",
@@ -330,6 +348,11 @@ DEF_VISA_OPTION(vISA_LraFFWindowSize, ET_INT32, "-lraFFWindowSize", UNUSED, 12)
 DEF_VISA_OPTION(vISA_SplitGRFAlignedScalar, ET_BOOL, "-nosplitGRFalignedscalar",
                 UNUSED, true)
 DEF_VISA_OPTION(vISA_DoSplitOnSpill, ET_BOOL, "-nosplitonspill", UNUSED, true)
+// Orders and filters the loop splits of spilled variables by the spill code
+// they move out of loops, using block frequencies when available. Off until
+// its effect on spill code has been measured.
+DEF_VISA_OPTION(vISA_SplitOnSpillByCost, ET_BOOL, "-splitonspillbycost",
+                UNUSED, false)
 DEF_VISA_OPTION(vISA_IncSpillCostAllAddrTaken, ET_BOOL, "-allowaddrtakenspill",
                 UNUSED, false)
 DEF_VISA_OPTION(vISA_NewSpillCostFunction, ET_BOOL, "-newspillcost", UNUSED,
@@ -345,10 +368,20 @@ DEF_VISA_OPTION(vISA_DumpRegChart, ET_BOOL, "-dumpregchart", UNUSED, false)
 DEF_VISA_OPTION(vISA_SpillAnalysis, ET_BOOL, "-spillanalysis", UNUSED, false)
 DEF_VISA_OPTION(vISA_DynPerfModel, ET_BOOL, "-perfmodel", UNUSED, false)
 DEF_VISA_OPTION(vISA_DumpAllBCInfo, ET_BOOL, "-dumpAllBCInfo", UNUSED, false)
+DEF_VISA_OPTION(vISA_GlobalBankConflictGraph, ET_BOOL, "-globalBCGraph", UNUSED,
+                false)
+DEF_VISA_OPTION(vISA_DumpBankConflictReport, ET_BOOL, "-dumpBCReport", UNUSED,
+                false)
 DEF_VISA_OPTION(vISA_FreqBasedSpillCost, ET_BOOL, "-freqBasedSpillCost", UNUSED, false)
 DEF_VISA_OPTION(vISA_DumpFreqBasedSpillCost, ET_BOOL, "-dumpFreqBasedSpillCost", UNUSED, false)
+// Weighs blocks by the frontend's block frequencies instead of their loop
+// nesting wherever FlowGraph::getBlockWeight is used. -freqBasedSpillCost
+// implies it.
+DEF_VISA_OPTION(vISA_BlockFreqWeights, ET_BOOL, "-blockFreqWeights", UNUSED, false)
 DEF_VISA_OPTION(vISA_LinearScan, ET_BOOL, "-linearScan", UNUSED, false)
 DEF_VISA_OPTION(vISA_LSFristFit, ET_BOOL, "-lsRoundRobin", UNUSED, true)
+DEF_VISA_OPTION(vISA_LinearScanSecondChance, ET_BOOL,
+                "-linearScanSecondChance", UNUSED, false)
 DEF_VISA_OPTION(vISA_verifyLinearScan, ET_BOOL, "-verifyLinearScan", UNUSED,
                 false)
 DEF_VISA_OPTION(vISA_boundsChecking, ET_BOOL, "-boundsChecking", UNUSED, false)
@@ -368,6 +401,15 @@ DEF_VISA_OPTION(vISA_SplitAlignedScalarMinDist, ET_INT32,
 DEF_VISA_OPTION(vISA_SplitAlignedScalarBloatPPT, ET_INT32,
                 "-splitAlignedScalarBloatRatio",
                 "instuction increase ppt (part per thousand) for controlling when to split aligned scalars in RA", 10)
+// Number of worker threads used to build the interference graph of large
+// kernels. 0 or 1 walks the basic blocks serially.
+DEF_VISA_OPTION(vISA_InterferenceThreads, ET_INT32, "-intfThreads",
+                "USAGE: -intfThreads <num>\n", 0)
+// Number of worker threads that try several GRF coloring heuristics at once
+// and keep the best spill-free result. 0 or 1 tries them one after another
+// until one succeeds.
+DEF_VISA_OPTION(vISA_ColoringThreads, ET_INT32, "-coloringThreads",
+                "USAGE: -coloringThreads <num>\n", 0)
 //=== scheduler options ===
 DEF_VISA_OPTION(vISA_LocalScheduling, ET_BOOL, "-noschedule", UNUSED, true)
 DEF_VISA_OPTION(vISA_preRA_Schedule, ET_BOOL, "-nopresched", UNUSED, true)
@@ -378,6 +420,13 @@ DEF_VISA_OPTION(vISA_preRA_ScheduleRPThreshold, ET_INT32, "-presched-rp",
                 "USAGE: -presched-rp <threshold>\n", 0)
 DEF_VISA_OPTION(vISA_preRA_ScheduleExtraGRF, ET_INT32, "-presched-extra-grf",
                 "USAGE: -presched-extra-grf <num>\n", 0)
+// Before the per-block schedule, hoist loads into the control-equivalent
+// block that precedes an if/else hammock.
+DEF_VISA_OPTION(vISA_preRA_GlobalSchedule, ET_BOOL, "-presched-global", UNUSED,
+                false)
+// Issue loads of single-block innermost loops one iteration ahead.
+DEF_VISA_OPTION(vISA_preRA_SoftwarePipelining, ET_BOOL, "-presched-swp",
+                UNUSED, false)
 DEF_VISA_OPTION(vISA_ScheduleStartBBID, ET_INT32, "-sched-start",
                 "USAGE: -sched-start <BB ID>\n", 0)
 DEF_VISA_OPTION(vISA_ScheduleEndBBID, ET_INT32, "-sched-end",
@@ -436,6 +485,10 @@ DEF_VISA_OPTION(vISA_ScheduleACCDep, ET_BOOL, "-scheduleACCDep",
                 "coarse grained dependence",
                 false)
 DEF_VISA_OPTION(vISA_schedWithSendSrcReadCycle, ET_BOOL, "-schedWithSendSrcReadCycle", UNUSED, false)
+DEF_VISA_OPTION(vISA_LatencyTableFile, ET_CSTR, "-latencyTable",
+                "USAGE: -latencyTable <file> overrides the scheduler and SWSB "
+                "latencies, see LocalScheduler/LatencyTable.h",
+                NULL)
 
 //=== SWSB options ===
 DEF_VISA_OPTION(vISA_USEL3HIT, ET_BOOL, "-SBIDL3Hit", UNUSED, false)
@@ -462,6 +515,13 @@ DEF_VISA_OPTION(vISA_QuickTokenAllocation, ET_BOOL, "-quickTokenAllocation",
                 UNUSED, false)
 DEF_VISA_OPTION(vISA_DistPropTokenAllocation, ET_BOOL,
                 "-distPropTokenAllocation", UNUSED, false)
+// Token allocation and pruning scan every send of the kernel instead of only
+// the live ones. The output must be identical; used to test the live scans.
+// Debug builds only, release builds ignore it.
+DEF_VISA_OPTION(vISA_SWSBFullTokenScans, ET_BOOL, "-SWSBFullTokenScans",
+                UNUSED, false)
+DEF_VISA_OPTION(vISA_SWSBStallCostTokenReuse, ET_BOOL,
+                "-SWSBStallCostTokenReuse", UNUSED, false)
 DEF_VISA_OPTION(vISA_SWSBStitch, ET_BOOL, "-SWSBStitch", UNUSED, false)
 DEF_VISA_OPTION(vISA_SBIDDepLoc, ET_BOOL, "-SBIDDepLoc", UNUSED, false)
 DEF_VISA_OPTION(vISA_DumpSBID, ET_BOOL, "-dumpSBID", UNUSED, false)
@@ -25,5 +25,12 @@ extern "C" int CreateVISABuilder(VISABuilder *&builder, vISABuilderMode mode,
 // info, as they may have longer life time than the builder itself.
 extern "C" int DestroyVISABuilder(VISABuilder *&builder);
 
+// Returns true if separate vISA builders may be created and compiled
+// concurrently on different threads. This is not the case when the finalizer
+// is built with compile time measurement, as the timers are process-wide and
+// are reset by every new builder. Clients must not compile in parallel when
+// this returns false.
+extern "C" bool VISABuilderSupportsConcurrentCompile();
+
 // Interface to free the kernel ISA and debug info binary.
 extern "C" void freeBlock(void *ptr);
\ No newline at end of file
@@ -7,6 +7,7 @@ SPDX-License-Identifier: MIT
 ============================= end_copyright_notice ===========================*/
 
 #include "Common_ISA_framework.h"
+#include "Timer.h"
 #include "VISAKernel.h"
 #include "inc/common/sku_wa.h"
 #include "visa_igc_common_header.h"
@@ -31,4 +32,11 @@ extern "C" VISA_BUILDER_API int DestroyVISABuilder(VISABuilder *&builder) {
     return VISA_FAILURE;
   int status = CISA_IR_Builder::DestroyBuilder(cisa_builder);
   return status;
-}
\ No newline at end of file
+}
+extern "C" VISA_BUILDER_API bool VISABuilderSupportsConcurrentCompile() {
+#if defined(MEASURE_COMPILATION_TIME)
+  return false;
+#else
+  return true;
+#endif
+}